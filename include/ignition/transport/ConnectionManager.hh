@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2015 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef __IGN_TRANSPORT_CONNECTIONMANAGER_HH_INCLUDED__
+#define __IGN_TRANSPORT_CONNECTIONMANAGER_HH_INCLUDED__
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ignition/transport/Helpers.hh"
+
+namespace ignition
+{
+  namespace transport
+  {
+    /// \def ConnectionTask
+    /// \brief Work executed by the connection manager for a given endpoint.
+    /// The task receives the endpoint and all the topics that were queued for
+    /// that endpoint since the last execution of the task.
+    typedef std::function<void(const std::string &_endpoint,
+      const std::vector<std::string> &_topics)> ConnectionTask;
+
+    /// \class ConnectionManager ConnectionManager.hh
+    /// ignition/transport/ConnectionManager.hh
+    /// \brief Asynchronous work queue used to establish connections with
+    /// remote endpoints. Connecting to a remote endpoint might block for a
+    /// while (e.g. waiting for the 0MQ handshake), so this work should not be
+    /// executed in the discovery thread. The manager runs a pool of worker
+    /// threads. Work is queued per endpoint: all the topics queued for the
+    /// same endpoint are coalesced and handled by a single task execution,
+    /// and two tasks for the same endpoint never run at the same time.
+    /// Different endpoints are handled in parallel.
+    class IGNITION_VISIBLE ConnectionManager
+    {
+      /// \brief Constructor.
+      /// \param[in] _numWorkers Number of worker threads.
+      public: explicit ConnectionManager(
+        const unsigned int _numWorkers = DefNumWorkers);
+
+      /// \brief Destructor. Pending work that has not started yet is
+      /// discarded. The destructor waits for the running tasks to finish.
+      /// On Windows, the workers are detached and the wait is bounded by
+      /// ExitTimeout. The work queue is shared with the workers, so a worker
+      /// that is still running after the destructor returns does not access
+      /// this object.
+      public: virtual ~ConnectionManager();
+
+      /// \brief Queue a new task for an endpoint. If there is already pending
+      /// work for the same endpoint, the topic is added to it and the task
+      /// will be executed only once for all the pending topics. Each endpoint
+      /// keeps only its latest task: it replaces the task of the pending
+      /// work, and it is executed with all the topics queued for the
+      /// endpoint, including the ones queued with the previous task. Use a
+      /// different endpoint for work that needs a different task.
+      /// \param[in] _endpoint Endpoint (e.g. "tcp://10.0.0.1:6000").
+      /// \param[in] _topic Topic associated to the work.
+      /// \param[in] _task Task to be executed.
+      public: void Queue(const std::string &_endpoint,
+                         const std::string &_topic,
+                         const ConnectionTask &_task);
+
+      /// \brief Check if there is pending or running work for an endpoint.
+      /// \param[in] _endpoint Endpoint.
+      /// \return True if there is work queued or running for the endpoint.
+      public: bool HasPendingWork(const std::string &_endpoint);
+
+      /// \brief Block until all the queued work has been executed or the
+      /// timeout expires.
+      /// \param[in] _timeout Maximum waiting time in milliseconds.
+      /// \return True if there is no more pending work.
+      public: bool WaitForPendingWork(const unsigned int _timeout);
+
+      /// \brief Get the number of worker threads.
+      /// \return The number of worker threads.
+      public: unsigned int GetNumWorkers() const;
+
+      /// \brief Get the CPU time consumed by all the worker threads.
+      /// \return CPU time in nanoseconds.
+      public: uint64_t GetCpuTime();
+
+      /// \brief Default number of worker threads.
+      public: static const unsigned int DefNumWorkers = 4;
+
+      /// \brief Maximum time (ms) that the destructor waits for the workers
+      /// on platforms where the worker threads are detached instead of joined.
+      public: static const unsigned int ExitTimeout = 1000;
+
+      /// \brief Work queued for a given endpoint.
+      private: struct PendingWork
+      {
+        /// \brief Task to be executed.
+        ConnectionTask task;
+
+        /// \brief Topics pending for the endpoint.
+        std::set<std::string> topics;
+      };
+
+      /// \brief Work queue shared by the manager and its worker threads.
+      private: struct State
+      {
+        /// \brief Pending work. The key is the endpoint.
+        std::map<std::string, PendingWork> pending;
+
+        /// \brief Endpoints with pending work in FIFO order.
+        std::deque<std::string> ready;
+
+        /// \brief Endpoints that are being processed by a worker.
+        std::set<std::string> running;
+
+        /// \brief Number of worker threads that have not finished yet.
+        unsigned int activeWorkers = 0;
+
+        /// \brief Mutex to protect the work queue.
+        std::mutex mutex;
+
+        /// \brief Used to notify the workers that there is new work
+        /// available.
+        std::condition_variable workAvailable;
+
+        /// \brief Used to notify that a task has finished.
+        std::condition_variable workDone;
+
+        /// \brief When true, the worker threads will finish.
+        bool exit = false;
+      };
+
+      /// \brief Function executed by each worker thread.
+      /// \param[in] _state Work queue, co-owned by the worker.
+      private: static void RunWorkerTask(std::shared_ptr<State> _state);
+
+      /// \brief Work queue.
+      private: std::shared_ptr<State> state;
+
+      /// \brief Worker threads.
+      private: std::vector<std::thread> workers;
+    };
+  }
+}
+#endif
@@ -21,7 +21,9 @@
 #ifdef _MSC_VER
 # pragma warning(push, 0)
 #endif
+#include <cstdint>
 #include <functional>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -32,6 +34,7 @@
 
 #include "ignition/transport/Helpers.hh"
 #include "ignition/transport/TransportTypes.hh"
+#include "ignition/transport/Uuid.hh"
 
 namespace ignition
 {
@@ -51,7 +54,8 @@ namespace ignition
     {
       /// \brief Constructor.
       /// \param[in] _pUuid This discovery instance will run inside a
-      /// transport process. This parameter is the transport process' UUID.
+      /// transport process. This parameter is the transport process' UUID,
+      /// in the format of Uuid::ToString(). It is sent in binary form.
       /// \param[in] _verbose true for enabling verbose mode.
       public: Discovery(const std::string &_pUuid, bool _verbose = false);
 
@@ -63,14 +67,17 @@ namespace ignition
       /// \param[in] _topic Topic name to be advertised.
       /// \param[in] _addr ZeroMQ address of the topic's publisher.
       /// \param[in] _ctrl ZeroMQ control address of the topic's publisher.
-      /// \param[in] _nUuid Node UUID.
+      /// \param[in] _nUuid Node UUID, in the format of Uuid::ToString().
       /// \param[in] _scope Topic scope.
+      /// \param[in] _relay True if the node republishes the messages of other
+      /// publishers (see Relay). Only used with messages.
       public: void Advertise(const MsgType &_advType,
                              const std::string &_topic,
                              const std::string &_addr,
                              const std::string &_ctrl,
                              const std::string &_nUuid,
-                             const Scope &_scope);
+                             const Scope &_scope,
+                             const bool _relay = false);
 
       /// \brief Request discovery information about a topic or service.
       /// When using this method with messages, the user might want to use
@@ -89,6 +96,17 @@ namespace ignition
       /// \param[in] _isSrv True if the topic corresponds to a service.
       public: void Discover(const std::string &_topic, bool _isSrv);
 
+      /// \brief Ask all the remote processes to advertise their topics and
+      /// services right away, and block until their answers stop arriving.
+      /// The answers are delayed randomly by up to DiscoveryPrivate::
+      /// MaxReplyDelay ms., so this function returns after that delay plus
+      /// a short quiet period, unless the answers keep arriving.
+      /// \param[in] _prefix Only the topics and services starting with this
+      /// prefix are advertised (e.g. a partition "@/p@"). Empty for all.
+      /// \param[in] _maxWait Maximum waiting time (ms.).
+      public: void DiscoverAll(const std::string &_prefix,
+                               const unsigned int _maxWait);
+
       /// \brief Get all the addresses known for a given topic.
       /// \param[in] _topic Topic name.
       /// \param[out] _addresses Addresses requested.
@@ -103,6 +121,21 @@ namespace ignition
       public: bool GetSrvAddresses(const std::string &_topic,
                                    Addresses_M &_addresses);
 
+      /// \brief Check if a node advertises a topic as a relay.
+      /// \param[in] _topic Topic name.
+      /// \param[in] _nUuid Node UUID.
+      /// \return True if the node is a relay for the topic.
+      public: bool IsRelay(const std::string &_topic,
+                           const std::string &_nUuid);
+
+      /// \brief Check if a topic is relayed.
+      /// \param[in] _topic Topic name.
+      /// \param[in] _local False to look for relays in other processes, true
+      /// to look for relays in this process.
+      /// \return True if at least one node advertises the topic as a relay.
+      public: bool HasRelay(const std::string &_topic,
+                            const bool _local = false);
+
       /// \brief Unadvertise a new message or service. Broadcast a discovery
       /// message that will cancel all the discovery information for the topic
       /// or service advertised by a specific node.
@@ -131,7 +164,10 @@ namespace ignition
       public: unsigned int GetHeartbeatInterval() const;
 
       /// \brief While a topic is being advertised by a node, a beacon is sent
-      /// periodically every 'advertise interval' milliseconds.
+      /// periodically every 'advertise interval' milliseconds. After a local
+      /// advertisement or after discovering a new remote process, beacons are
+      /// sent faster and the interval grows exponentially until it reaches
+      /// the 'advertise interval' (see DiscoverySchedule).
       /// \sa SetAdvertiseInterval.
       /// \return The value in milliseconds.
       public: unsigned int GetAdvertiseInterval() const;
@@ -290,9 +326,16 @@ namespace ignition
       /// and invalids the old topics.
       public: void RunActivityTask();
 
-      /// \brief Broadcast periodic heartbeats.
+      /// \brief Broadcast periodic heartbeats and re-advertise the topics
+      /// and services of this process using an adaptive schedule.
       public: void RunHeartbeatTask();
 
+      /// \brief Schedule a fast re-advertisement of the local topics and
+      /// services and restart the exponential backoff of the advertise
+      /// interval. Called after local changes or when a new remote process
+      /// is discovered.
+      public: void ResetAdvertiseInterval();
+
       /// \brief Receive discovery messages.
       public: void RunReceptionTask();
 
@@ -302,8 +345,9 @@ namespace ignition
       /// \brief Parse a discovery message received via the UDP broadcast socket
       /// \param[in] _fromIp IP address of the message sender.
       /// \param[in] _msg Received message.
+      /// \param[in] _len Length of the received message in bytes.
       public: void DispatchDiscoveryMsg(const std::string &_fromIp,
-                                        char *_msg);
+                                        char *_msg, const size_t _len);
 
       /// \brief Broadcast a discovery message.
       /// \param[in] _type Message type.
@@ -311,16 +355,52 @@ namespace ignition
       /// \param[in] _addr 0MQ Address.
       /// \param[in] _ctrl 0MQ control address.
       /// \param[in] _nUuid Node's UUID.
-      /// \param[in] _flags Optional flags. Currently, the flags are not used
-      /// but they will in the future for specifying things like compression,
-      /// or encryption.
+      /// \param[in] _flags Optional flags. RelayFlag is added automatically
+      /// to the advertisements of local relays.
+      /// \param[in] _knownAnswers Node UUIDs already known by this process.
+      /// Only used in subscription messages.
       public: void SendMsg(uint8_t _type,
                            const std::string &_topic,
                            const std::string &_addr,
                            const std::string &_ctrl,
                            const std::string &_nUuid,
                            const Scope &_scope,
-                           int _flags = 0);
+                           int _flags = 0,
+                           const std::vector<Uuid> &_knownAnswers =
+                             std::vector<Uuid>());
+
+      /// \brief Create the socket used for sending host-scoped discovery
+      /// messages. These messages are delivered to the processes running in
+      /// this host through the loopback and never reach the network.
+      public: void CreateHostSocket();
+
+      /// \brief Accept the discovery messages of the partition contained in a
+      /// topic name. Called when a topic is advertised or discovered. Once a
+      /// partition is registered, messages from other partitions are
+      /// discarded.
+      /// \param[in] _topic Fully qualified topic name.
+      public: void RegisterPartition(const std::string &_topic);
+
+      /// \brief Schedule an advertise message as an answer to a discovery
+      /// request. The message is sent after a random delay and answers all
+      /// the requests received in the meantime.
+      /// \param[in] _type Advertise message type (AdvType or AdvSrvType).
+      /// \param[in] _topic Topic or service name.
+      /// \param[in] _node Addressing information of the local node.
+      public: void ScheduleReply(const uint8_t _type,
+                                 const std::string &_topic,
+                                 const Address_t &_node);
+
+      /// \brief Forget that a node is a relay for a topic.
+      /// \param[in] _topic Topic name.
+      /// \param[in] _nUuid Node UUID.
+      public: void DelRelay(const std::string &_topic,
+                            const std::string &_nUuid);
+
+      /// \brief Send all the answers to subscription requests whose deadline
+      /// has expired.
+      /// \return The deadline of the next pending answer.
+      public: Timestamp SendPendingReplies();
 
       /// \brief Print the current discovery state (info, activity, unknown).
       public: void PrintCurrentState();
@@ -333,6 +413,11 @@ namespace ignition
       /// \param[out] _topics List of advertised topics.
       public: void GetServiceList(std::vector<std::string> &_services) const;
 
+      /// \brief Get the CPU time consumed by the discovery threads.
+      /// \param[out] _times CPU time (ns.) of each thread. The key is the
+      /// thread name.
+      public: void GetThreadTimes(std::map<std::string, uint64_t> &_times);
+
       /// \brief Get mutex used in the Discovery class.
       /// \return The discovery mutex.
       public: std::recursive_mutex& GetMutex();
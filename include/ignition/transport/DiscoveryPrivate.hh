@@ -26,20 +26,26 @@
 #else
   #include <arpa/inet.h>
 #endif
+#include <condition_variable>
 #include <functional>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <random>
+#include <set>
 #include <thread>
 #include <string>
+#include <tuple>
 #include <vector>
 #ifdef _MSC_VER
 # pragma warning(pop)
 #endif
+#include "ignition/transport/DiscoverySchedule.hh"
 #include "ignition/transport/Helpers.hh"
 #include "ignition/transport/Packet.hh"
 #include "ignition/transport/TopicStorage.hh"
 #include "ignition/transport/TransportTypes.hh"
+#include "ignition/transport/Uuid.hh"
 
 namespace ignition
 {
@@ -74,7 +80,20 @@ namespace ignition
       /// \brief Default advertise interval value (ms.).
       /// \sa GetAdvertiseInterval.
       /// \sa SetAdvertiseInterval.
-      public: static const unsigned int DefAdvertiseInterval = 1000;
+      public: static const unsigned int DefAdvertiseInterval = 5000;
+
+      /// \brief Minimum delay before answering a subscription request (ms.).
+      public: static const unsigned int MinReplyDelay = 20;
+
+      /// \brief Maximum delay before answering a subscription request (ms.).
+      /// The delay is random, so when multiple nodes subscribe at the same
+      /// time their requests are answered by a single advertise message.
+      public: static const unsigned int MaxReplyDelay = 120;
+
+      /// \brief Time without new discovery information after which the
+      /// answers to a query are considered complete (ms.).
+      /// \sa Discovery::DiscoverAll.
+      public: static const unsigned int QueryQuietPeriod = 50;
 
       /// \brief Port used to broadcast the discovery messages.
       public: static const int DiscoveryPort = 11319;
@@ -89,7 +108,7 @@ namespace ignition
       public: static const int MaxRcvStr = 65536;
 
       /// \brief Discovery protocol version.
-      static const uint8_t Version = 1;
+      static const uint8_t Version = 2;
 
       /// \brief Host IP address.
       public: std::string hostAddr;
@@ -97,6 +116,10 @@ namespace ignition
       /// \brief Process UUID.
       public: std::string pUuid;
 
+      /// \brief Process UUID in the binary form sent in the header of the
+      /// discovery messages.
+      public: Uuid processId;
+
       /// \brief Silence interval value (ms.).
       /// \sa GetMaxSilenceInterval.
       /// \sa SetMaxSilenceInterval.
@@ -117,6 +140,43 @@ namespace ignition
       /// \sa SetHeartbeatInterval.
       public: unsigned int heartbeatInterval;
 
+      /// \brief Time when the next pending reply should be sent.
+      public: Timestamp nextReply = Timestamp::max();
+
+      /// \brief Time when the last new remote topic or service was
+      /// discovered.
+      public: Timestamp lastUpdate;
+
+      /// \brief Answer scheduled for a subscription request.
+      public: struct PendingReply
+      {
+        /// \brief Time when the answer should be sent.
+        Timestamp deadline;
+
+        /// \brief Addressing information of the local node.
+        Address_t info;
+      };
+
+      /// \brief Answers scheduled for subscription requests. The key is the
+      /// advertise message type, the topic and the node UUID. Multiple
+      /// requests for the same topic are answered once.
+      public: std::map<std::tuple<uint8_t, std::string, std::string>,
+                       PendingReply> pendingReplies;
+
+      /// \brief Mutex to protect the scheduling information of the heartbeat
+      /// thread.
+      public: std::mutex schedulerMutex;
+
+      /// \brief Schedule of the heartbeats and re-advertisements.
+      public: DiscoverySchedule schedule{std::random_device()()};
+
+      /// \brief Used to wake up the heartbeat thread when the schedule has
+      /// changed or when it is time to exit.
+      public: std::condition_variable schedulerCondition;
+
+      /// \brief Random engine used for generating the reply delays.
+      public: std::mt19937 randomEngine;
+
       /// \brief Callback executed when new topics are discovered.
       public: DiscoveryCallback connectionCb;
 
@@ -135,11 +195,21 @@ namespace ignition
       /// \brief Service addressing information.
       public: TopicStorage infoSrv;
 
+      /// \brief Nodes that advertise a topic as a relay. The key is the topic
+      /// name and the value contains the node UUIDs.
+      public: std::map<std::string, std::set<std::string>> relays;
+
+      /// \brief Hashes of the partitions used inside this process. Discovery
+      /// messages from other partitions are discarded before unpacking their
+      /// body. If empty, messages from all the partitions are accepted.
+      /// \sa TopicUtils::GetPartitionHash.
+      public: std::set<uint32_t> partitions;
+
       /// \brief Activity information. Every time there is a message from a
       /// remote node, its activity information is updated. If we do not hear
       /// from a node in a while, its entries in 'info' will be invalided. The
       /// key is the process uuid.
-      public: std::map<std::string, Timestamp> activity;
+      public: std::map<Uuid, Timestamp> activity;
 
       /// \brief Print discovery information to stdout.
       public: bool verbose;
@@ -147,6 +217,11 @@ namespace ignition
       /// \brief UDP socket used for sending/receiving discovery messages.
       public: int sock;
 
+      /// \brief UDP socket used for sending discovery messages with
+      /// 'Scope::Host'. The multicast TTL is 0, so the messages never leave
+      /// this host. The value is -1 if the socket could not be created.
+      public: int hostSock = -1;
+
       /// \brief Internet socket address for sending to the multicast group.
       public: sockaddr_in mcastAddr;
 
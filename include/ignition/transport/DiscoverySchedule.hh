@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2015 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef __IGN_TRANSPORT_DISCOVERYSCHEDULE_HH_INCLUDED__
+#define __IGN_TRANSPORT_DISCOVERYSCHEDULE_HH_INCLUDED__
+
+#include <chrono>
+#include <random>
+#include "ignition/transport/Helpers.hh"
+#include "ignition/transport/TransportTypes.hh"
+
+namespace ignition
+{
+  namespace transport
+  {
+    /// \class DiscoverySchedule DiscoverySchedule.hh
+    /// ignition/transport/DiscoverySchedule.hh
+    /// \brief Schedule of the periodic discovery messages: heartbeats and
+    /// re-advertisements of the local topics. After a local advertisement or
+    /// after discovering a new remote process, the topics are re-advertised
+    /// every 'MinAdvertiseInterval' milliseconds and the interval is doubled
+    /// after each round until it reaches the advertise interval. A random
+    /// variation of +/- 'JitterPercent' is applied to every interval.
+    ///
+    /// The current time is passed to all the functions, so the schedule does
+    /// not depend on the clock. The class is not thread safe.
+    class IGNITION_VISIBLE DiscoverySchedule
+    {
+      /// \brief Constructor. The first heartbeat and the first
+      /// re-advertisement are due immediately.
+      /// \param[in] _seed Seed of the random engine used for the jitter.
+      public: explicit DiscoverySchedule(const unsigned int _seed);
+
+      /// \brief Get the time of the next event.
+      /// \return The earliest of the next heartbeat and the next
+      /// re-advertisement.
+      public: Timestamp GetNextEvent() const;
+
+      /// \brief Check if the heartbeat is due.
+      /// \param[in] _now Current time.
+      /// \return True if the heartbeat is due.
+      public: bool IsHeartbeatDue(const Timestamp &_now) const;
+
+      /// \brief Check if the re-advertisement is due.
+      /// \param[in] _now Current time.
+      /// \return True if the re-advertisement is due.
+      public: bool IsAdvertiseDue(const Timestamp &_now) const;
+
+      /// \brief Schedule the next events once the due ones are handled. Any
+      /// discovery message refreshes our activity in the remote processes,
+      /// so the heartbeat is skipped if an advertisement has been sent.
+      /// \param[in] _now Current time.
+      /// \param[in] _heartbeatDue Value of IsHeartbeatDue().
+      /// \param[in] _advertiseDue Value of IsAdvertiseDue().
+      /// \param[in] _sent Number of advertisements sent.
+      /// \param[in] _heartbeatInterval Heartbeat interval (ms.).
+      /// \param[in] _advertiseInterval Advertise interval (ms.).
+      /// \return True if the heartbeat has to be sent.
+      public: bool Update(const Timestamp &_now,
+                          const bool _heartbeatDue,
+                          const bool _advertiseDue,
+                          const unsigned int _sent,
+                          const unsigned int _heartbeatInterval,
+                          const unsigned int _advertiseInterval);
+
+      /// \brief Restart the exponential backoff of the advertise interval.
+      /// \param[in] _now Current time.
+      /// \return True if the next re-advertisement is now earlier than
+      /// before.
+      public: bool ResetAdvertiseInterval(const Timestamp &_now);
+
+      /// \brief Get the interval used for the next re-advertisement before
+      /// the jitter is applied.
+      /// \return The interval in milliseconds.
+      public: unsigned int GetCurrentAdvertiseInterval() const;
+
+      /// \brief Minimum advertise interval value (ms.).
+      /// \sa Discovery::GetAdvertiseInterval.
+      public: static const unsigned int MinAdvertiseInterval = 100;
+
+      /// \brief Maximum random variation applied to the heartbeat and
+      /// advertise intervals (percentage). It avoids that multiple processes
+      /// send their discovery messages in synchronized bursts.
+      public: static const unsigned int JitterPercent = 10;
+
+      /// \brief Apply a random variation of +/- 'JitterPercent' to an
+      /// interval.
+      /// \param[in] _ms Interval in milliseconds.
+      /// \return The interval with jitter.
+      private: std::chrono::milliseconds Jitter(const unsigned int _ms);
+
+      /// \brief Time when the next heartbeat is scheduled.
+      private: Timestamp nextHeartbeat;
+
+      /// \brief Time when the next re-advertisement is scheduled.
+      private: Timestamp nextAdvertise;
+
+      /// \brief Current advertise interval value (ms.). It grows from
+      /// 'MinAdvertiseInterval' to the advertise interval.
+      private: unsigned int currentAdvertiseInterval = MinAdvertiseInterval;
+
+      /// \brief Random engine used for generating the jitter.
+      private: std::mt19937 randomEngine;
+    };
+  }
+}
+#endif
@@ -18,9 +18,14 @@
 #ifndef __IGN_TRANSPORT_HANDLERSTORAGE_HH_INCLUDED__
 #define __IGN_TRANSPORT_HANDLERSTORAGE_HH_INCLUDED__
 
+#include <cstddef>
 #include <map>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 #include "ignition/transport/TransportTypes.hh"
+#include "ignition/transport/Uuid.hh"
 
 namespace ignition
 {
@@ -28,14 +33,51 @@ namespace ignition
   {
     /// \class HandlerStorage HandlerStorage.hh
     /// ignition/transport/HandlerStorage.hh
-    /// \brief Class to store and manage service call handlers.
+    /// \brief Class to store and manage service call handlers. The handlers
+    /// are indexed by topic, node UUID and handler UUID for the (rare) add
+    /// and remove operations. For each topic there is also a flat list of
+    /// all its handlers, rebuilt on every change, that is used for
+    /// dispatching. Topics are interned: TopicId() returns a stable index
+    /// that can be cached to get the list without any string lookup.
     template<typename T> class HandlerStorage
     {
+      /// \brief Handler of a topic in the flat list.
+      public: struct Entry
+      {
+        /// \brief UUID of the node that registered the handler.
+        std::string nUuid;
+
+        /// \brief The handler.
+        std::shared_ptr<T> handler;
+      };
+
+      /// \def HandlerList
+      /// \brief Flat list of handlers of a topic.
+      public: typedef std::vector<Entry> HandlerList;
+
+      /// \def HandlerListPtr
+      /// \brief Immutable snapshot of the handlers of a topic. A snapshot
+      /// remains valid while it is iterated, even if a callback adds or
+      /// removes handlers.
+      public: typedef std::shared_ptr<const HandlerList> HandlerListPtr;
+
+      /// \brief Get the list of topics with at least one handler.
+      /// \param[out] _topics List of topics.
+      public: void GetTopicList(std::vector<std::string> &_topics) const
+      {
+        _topics.clear();
+        for (auto const &topic : this->data)
+        {
+          if (!topic.second.empty())
+            _topics.push_back(topic.first);
+        }
+      }
+
       /// \brief Stores all the service call data for each topic. The key of
       /// _data is the topic name. The value is another map, where the key is
       /// the node UUID and the value is a smart pointer to the handler.
       /// \TODO: Carlos, review this names and fix them
-      typedef std::map<std::string, std::shared_ptr<T>> UUIDHandler_M;
+      typedef std::map<Uuid, std::shared_ptr<T>> UUIDHandler_M;
       typedef std::map<std::string, UUIDHandler_M> UUIDHandler_Collection_M;
 
       /// \brief key is a topic name and value is UUIDHandler_M
@@ -57,8 +99,7 @@ namespace ignition
       /// UUID and the value is a smart pointer to the handler.
       /// \return true if the topic contains at least one request.
       public: bool GetHandlers(const std::string &_topic,
-        std::map<std::string,
-          std::map<std::string, std::shared_ptr<T> >> &_handlers)
+        std::map<std::string, UUIDHandler_M> &_handlers)
       {
         if (this->data.find(_topic) == this->data.end())
           return false;
@@ -89,7 +130,7 @@ namespace ignition
       /// \return true if the handler was found.
       public: bool GetHandler(const std::string &_topic,
                               const std::string &_nUuid,
-                              const std::string &_hUuid,
+                              const Uuid &_hUuid,
                               std::shared_ptr<T> &_handler)
       {
         if (this->data.find(_topic) == this->data.end())
@@ -106,6 +147,45 @@ namespace ignition
         return true;
       }
 
+      /// \brief Get the interned identifier of a topic. The identifier is
+      /// created if needed and it never changes.
+      /// \param[in] _topic Topic name.
+      /// \return The topic identifier.
+      public: size_t TopicId(const std::string &_topic)
+      {
+        auto it = this->ids.find(_topic);
+        if (it != this->ids.end())
+          return it->second;
+
+        size_t id = this->lists.size();
+        this->ids[_topic] = id;
+        this->lists.push_back(nullptr);
+        return id;
+      }
+
+      /// \brief Get the flat list of handlers of a topic.
+      /// \param[in] _id Topic identifier returned by TopicId().
+      /// \return The handlers or nullptr if the topic has no handlers.
+      public: HandlerListPtr Handlers(const size_t _id) const
+      {
+        if (_id >= this->lists.size())
+          return nullptr;
+
+        return this->lists[_id];
+      }
+
+      /// \brief Get the flat list of handlers of a topic.
+      /// \param[in] _topic Topic name.
+      /// \return The handlers or nullptr if the topic has no handlers.
+      public: HandlerListPtr Handlers(const std::string &_topic) const
+      {
+        auto it = this->ids.find(_topic);
+        if (it == this->ids.end())
+          return nullptr;
+
+        return this->lists[it->second];
+      }
+
       /// \brief Add a request handler to a topic. A request handler stores
       /// the callback and types associated to a service call request.
       /// \param[in] _topic Topic name.
@@ -126,6 +206,8 @@ namespace ignition
         // Add/Replace the Req handler.
         this->data[_topic][_nUuid].insert(
           std::make_pair(_handler->GetHandlerUuid(), _handler));
+
+        this->Rebuild(_topic);
       }
 
       /// \brief Return true if we have stored at least one request for the
@@ -161,7 +243,7 @@ namespace ignition
       /// \return True when the handler is removed or false otherwise.
       public: bool RemoveHandler(const std::string &_topic,
                                  const std::string &_nUuid,
-                                 const std::string &_reqUuid)
+                                 const Uuid &_reqUuid)
       {
         unsigned int counter = 0;
         if (this->data.find(_topic) != this->data.end())
@@ -174,6 +256,7 @@ namespace ignition
             if (this->data[_topic].empty())
               this->data.erase(_topic);
           }
+          this->Rebuild(_topic);
         }
 
         return counter > 0;
@@ -192,15 +275,45 @@ namespace ignition
           counter = this->data[_topic].erase(_nUuid);
           if (this->data[_topic].empty())
             this->data.erase(_topic);
+          this->Rebuild(_topic);
         }
 
         return counter > 0;
       }
 
+      /// \brief Rebuild the flat list of handlers of a topic after a change.
+      /// The previous list is not modified, it might be in use.
+      /// \param[in] _topic Topic name.
+      private: void Rebuild(const std::string &_topic)
+      {
+        size_t id = this->TopicId(_topic);
+        auto it = this->data.find(_topic);
+        if (it == this->data.end())
+        {
+          this->lists[id] = nullptr;
+          return;
+        }
+
+        std::shared_ptr<HandlerList> list(new HandlerList());
+        for (auto const &node : it->second)
+        {
+          for (auto const &handler : node.second)
+            list->push_back({node.first, handler.second});
+        }
+        this->lists[id] = list;
+      }
+
       /// \brief Stores all the service call data for each topic. The key of
       /// _data is the topic name. The value is another map, where the key is
       /// the node UUID and the value is a smart pointer to the handler.
       private: TopicServiceCalls_M data;
+
+      /// \brief Interned topic identifiers. The key is the topic name and
+      /// the value is the index in lists.
+      private: std::unordered_map<std::string, size_t> ids;
+
+      /// \brief Flat list of handlers of each interned topic.
+      private: std::vector<HandlerListPtr> lists;
     };
   }
 }
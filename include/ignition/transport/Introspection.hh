@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2015 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef __IGN_TRANSPORT_INTROSPECTION_HH_INCLUDED__
+#define __IGN_TRANSPORT_INTROSPECTION_HH_INCLUDED__
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "ignition/transport/Helpers.hh"
+#include "ignition/transport/Statistics.hh"
+
+namespace ignition
+{
+  namespace transport
+  {
+    /// \brief Prefix of the reserved service answered by each process with
+    /// its introspection state. The service name is the prefix followed by
+    /// the process UUID, so every process can be queried individually.
+    static const std::string IntrospectionPrefix = "/__introspection/";
+
+    /// \class TopicState Introspection.hh
+    /// ignition/transport/Introspection.hh
+    /// \brief State of a topic in a process.
+    class IGNITION_VISIBLE TopicState
+    {
+      /// \brief Topic name (without the partition).
+      public: std::string name;
+
+      /// \brief True if a node of the process advertises the topic.
+      public: bool advertised = false;
+
+      /// \brief True if a node of the process is subscribed to the topic.
+      public: bool subscribed = false;
+
+      /// \brief Number of remote nodes subscribed to the topic.
+      public: uint64_t remoteSubscribers = 0;
+
+      /// \brief Counters of the topic in the process.
+      public: TopicStatistics stats;
+    };
+
+    /// \class ServiceState Introspection.hh
+    /// ignition/transport/Introspection.hh
+    /// \brief State of a service in a process.
+    class IGNITION_VISIBLE ServiceState
+    {
+      /// \brief Service name (without the partition).
+      public: std::string name;
+
+      /// \brief True if a node of the process advertises the service.
+      public: bool advertised = false;
+
+      /// \brief Counters of the service in the process.
+      public: ServiceStatistics stats;
+    };
+
+    /// \class ProcessState Introspection.hh
+    /// ignition/transport/Introspection.hh
+    /// \brief Snapshot of the transport state of a process, as answered by
+    /// its introspection service.
+    class IGNITION_VISIBLE ProcessState
+    {
+      /// \brief Serialize the state. The format is line oriented text, one
+      /// line for the process and one line for each thread, topic and
+      /// service.
+      /// \return The serialized state.
+      public: std::string Serialize() const;
+
+      /// \brief Unserialize a state.
+      /// \param[in] _data Serialized state.
+      /// \return True if the state was parsed or false otherwise.
+      public: bool Unserialize(const std::string &_data);
+
+      /// \brief Process UUID.
+      public: std::string pUuid;
+
+      /// \brief IP address of the host.
+      public: std::string hostAddr;
+
+      /// \brief Process ID.
+      public: uint64_t pid = 0;
+
+      /// \brief Number of remote publishers the process is connected to.
+      public: uint64_t connections = 0;
+
+      /// \brief CPU time consumed by the process (ns).
+      public: uint64_t cpuTime = 0;
+
+      /// \brief CPU time consumed by the transport threads (ns). The key is
+      /// the thread name.
+      public: std::map<std::string, uint64_t> threads;
+
+      /// \brief Topics used by the process.
+      public: std::vector<TopicState> topics;
+
+      /// \brief Services used by the process.
+      public: std::vector<ServiceState> services;
+    };
+  }
+}
+#endif
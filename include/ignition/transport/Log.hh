@@ -0,0 +1,353 @@
+/*
+ * Copyright (C) 2015 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef __IGN_TRANSPORT_LOG_HH_INCLUDED__
+#define __IGN_TRANSPORT_LOG_HH_INCLUDED__
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "ignition/transport/Helpers.hh"
+
+namespace ignition
+{
+  namespace transport
+  {
+    /// \class LogTopic Log.hh ignition/transport/Log.hh
+    /// \brief Topic stored in a log.
+    class IGNITION_VISIBLE LogTopic
+    {
+      /// \brief Topic name.
+      public: std::string topic;
+
+      /// \brief Message type name.
+      public: std::string type;
+
+      /// \brief Number of messages.
+      public: uint64_t messages = 0;
+    };
+
+    /// \class LogRecord Log.hh ignition/transport/Log.hh
+    /// \brief Message read from a log.
+    class IGNITION_VISIBLE LogRecord
+    {
+      /// \brief Topic name.
+      public: std::string topic;
+
+      /// \brief Message type name.
+      public: std::string type;
+
+      /// \brief Reception time (ns since the Unix epoch).
+      public: uint64_t time = 0;
+
+      /// \brief Serialized message. It points into the memory mapped
+      /// segment and is valid until the next call to LogReader::Next() or
+      /// LogReader::Close().
+      public: const char *data = nullptr;
+
+      /// \brief Size of the serialized message.
+      public: size_t size = 0;
+    };
+
+    /// \class LogWriter Log.hh ignition/transport/Log.hh
+    /// \brief Append-only log of serialized messages. The log is a directory
+    /// with a sequence of segments. Each segment has two files:
+    ///
+    /// * NNNNNN.seg: Memory mapped file with a header (magic "IGNLOGSG" and
+    ///   the format version, 16 bytes) followed by the records. Each record
+    ///   contains: record size (uint32, including this field), topic length
+    ///   (uint16), type length (uint16), reception time (uint64, ns since
+    ///   the Unix epoch), topic name, type name and serialized message.
+    ///   Records are self-describing, so a segment can be read even if its
+    ///   index was not written (e.g. the recorder crashed).
+    /// * NNNNNN.idx: Index written when the segment is closed: header (magic
+    ///   "IGNLOGIX" and version), first and last reception time (uint64),
+    ///   number of topics (uint32) followed by each topic (uint16 length +
+    ///   name, uint16 length + type, uint64 number of messages), number of
+    ///   entries (uint64) followed by each entry (uint64 time, uint64 offset
+    ///   of the record in the segment, uint32 topic position in the topic
+    ///   table).
+    ///
+    /// All the integers are stored in the byte order of the host. The
+    /// writer is not thread safe. Use LogReader to read the log.
+    class IGNITION_VISIBLE LogWriter
+    {
+      /// \brief Constructor.
+      public: LogWriter() = default;
+
+      /// \brief Destructor. Closes the log.
+      public: virtual ~LogWriter();
+
+      /// \brief Create a new log.
+      /// \param[in] _dir Directory of the log. It is created if it does not
+      /// exist. It should not contain another log.
+      /// \param[in] _segmentSize Size of each segment in bytes. A record
+      /// bigger than this size uses a segment of its own.
+      /// \return True when success or false otherwise.
+      public: bool Open(const std::string &_dir,
+                        const uint64_t _segmentSize = DefSegmentSize);
+
+      /// \brief Check if the log is open.
+      /// \return True if the log is open.
+      public: bool IsOpen() const;
+
+      /// \brief Append a message to the log.
+      /// \param[in] _topic Topic name.
+      /// \param[in] _type Message type name.
+      /// \param[in] _data Serialized message.
+      /// \param[in] _size Size of the serialized message.
+      /// \param[in] _time Reception time (ns since the Unix epoch).
+      /// \return True when success or false otherwise.
+      public: bool Write(const std::string &_topic, const std::string &_type,
+                         const char *_data, const size_t _size,
+                         const uint64_t _time);
+
+      /// \brief Close the current segment, write its index and close the
+      /// log.
+      public: void Close();
+
+      /// \brief Get the number of messages written.
+      /// \return Number of messages.
+      public: uint64_t GetMessages() const;
+
+      /// \brief Get the number of bytes written, including the headers.
+      /// \return Number of bytes.
+      public: uint64_t GetBytes() const;
+
+      /// \brief Get the number of segments created.
+      /// \return Number of segments.
+      public: unsigned int GetSegments() const;
+
+      /// \brief Get the current system time, used as reception time.
+      /// \return Time in ns since the Unix epoch.
+      public: static uint64_t Now();
+
+      /// \brief Get the path of a segment file.
+      /// \param[in] _dir Directory of the log.
+      /// \param[in] _segment Position of the segment.
+      /// \param[in] _index True for the index file, false for the data file.
+      /// \return The path of the file.
+      public: static std::string SegmentPath(const std::string &_dir,
+                                             const unsigned int _segment,
+                                             const bool _index);
+
+      /// \brief Default size of a segment (64 MB).
+      public: static const uint64_t DefSegmentSize = 64 * 1024 * 1024;
+
+      /// \brief Magic number of the segment files.
+      public: static const char SegmentMagic[9];
+
+      /// \brief Magic number of the index files.
+      public: static const char IndexMagic[9];
+
+      /// \brief Version of the log format.
+      public: static const uint32_t Version = 1;
+
+      /// \brief Size of the file headers.
+      public: static const uint32_t HeaderSize = 16;
+
+      /// \brief Size of the fixed part of a record.
+      public: static const uint32_t RecordHeaderSize = 16;
+
+      /// \brief Create and map a new segment.
+      /// \param[in] _minSize Minimum space required for records.
+      /// \return True when success or false otherwise.
+      private: bool OpenSegment(const uint64_t _minSize);
+
+      /// \brief Unmap the current segment, trim it and write its index.
+      /// \return True when success or false otherwise.
+      private: bool CloseSegment();
+
+      /// \brief Write the index of the current segment.
+      /// \return True when success or false otherwise.
+      private: bool WriteIndex();
+
+      /// \brief Entry of the segment index.
+      private: struct IndexEntry
+      {
+        /// \brief Reception time.
+        uint64_t time;
+
+        /// \brief Offset of the record in the segment.
+        uint64_t offset;
+
+        /// \brief Position of the topic in the topic table.
+        uint32_t topic;
+      };
+
+      /// \brief Directory of the log.
+      private: std::string dir;
+
+      /// \brief Size of the segments.
+      private: uint64_t segmentSize = DefSegmentSize;
+
+      /// \brief File descriptor of the current segment (-1 if none).
+      private: int fd = -1;
+
+      /// \brief Memory mapping of the current segment.
+      private: char *base = nullptr;
+
+      /// \brief Size of the current mapping.
+      private: uint64_t mappedSize = 0;
+
+      /// \brief Write position in the current segment.
+      private: uint64_t offset = 0;
+
+      /// \brief Number of segments created.
+      private: unsigned int segments = 0;
+
+      /// \brief Number of messages written.
+      private: uint64_t messages = 0;
+
+      /// \brief Number of bytes written.
+      private: uint64_t bytes = 0;
+
+      /// \brief Topic table of the current segment.
+      private: std::vector<LogTopic> indexTopics;
+
+      /// \brief Position in the topic table of each topic and type. The key
+      /// is the topic name followed by '\0' and the type name.
+      private: std::map<std::string, uint32_t> topicIds;
+
+      /// \brief Index entries of the current segment.
+      private: std::vector<IndexEntry> indexEntries;
+    };
+
+    /// \class LogReader Log.hh ignition/transport/Log.hh
+    /// \brief Sequential reader of the logs created by LogWriter. The
+    /// segments are memory mapped one at a time and the messages are
+    /// returned without copying them. The reader uses the segment indexes
+    /// when available and scans the segments otherwise. The reader is not
+    /// thread safe.
+    class IGNITION_VISIBLE LogReader
+    {
+      /// \brief Constructor.
+      public: LogReader() = default;
+
+      /// \brief Destructor. Closes the log.
+      public: virtual ~LogReader();
+
+      /// \brief Open a log.
+      /// \param[in] _dir Directory of the log.
+      /// \return True when success or false otherwise.
+      public: bool Open(const std::string &_dir);
+
+      /// \brief Check if the log is open.
+      /// \return True if the log is open.
+      public: bool IsOpen() const;
+
+      /// \brief Read the next message.
+      /// \param[out] _record Message read.
+      /// \return True if a message was read or false at the end of the log.
+      public: bool Next(LogRecord &_record);
+
+      /// \brief Go back to the first message.
+      public: void Rewind();
+
+      /// \brief Close the log.
+      public: void Close();
+
+      /// \brief Get the topics stored in the log.
+      /// \return The list of topics.
+      public: std::vector<LogTopic> GetTopics() const;
+
+      /// \brief Get the number of messages in the log.
+      /// \return Number of messages.
+      public: uint64_t GetMessages() const;
+
+      /// \brief Get the time of the first message.
+      /// \return Time (ns since the Unix epoch).
+      public: uint64_t GetStartTime() const;
+
+      /// \brief Get the time of the last message.
+      /// \return Time (ns since the Unix epoch).
+      public: uint64_t GetEndTime() const;
+
+      /// \brief Get the number of segments.
+      /// \return Number of segments.
+      public: unsigned int GetSegments() const;
+
+      /// \brief Map a segment.
+      /// \param[in] _segment Position of the segment.
+      /// \return True when success or false otherwise.
+      private: bool MapSegment(const unsigned int _segment);
+
+      /// \brief Unmap the current segment.
+      private: void UnmapSegment();
+
+      /// \brief Read the index of a segment.
+      /// \param[in] _segment Position of the segment.
+      /// \return True if the index exists and is valid.
+      private: bool ReadIndex(const unsigned int _segment);
+
+      /// \brief Scan the records of the current segment to build its
+      /// summary. Used when the index is not available.
+      private: void ScanSegment();
+
+      /// \brief Parse the record at the current position.
+      /// \param[out] _record Record parsed.
+      /// \return True if there is a valid record.
+      private: bool ParseRecord(LogRecord &_record) const;
+
+      /// \brief Add a topic to the summary of the log.
+      /// \param[in] _topic Topic name.
+      /// \param[in] _type Message type name.
+      /// \param[in] _messages Number of messages.
+      private: void AddTopic(const std::string &_topic,
+                             const std::string &_type,
+                             const uint64_t _messages);
+
+      /// \brief Directory of the log.
+      private: std::string dir;
+
+      /// \brief Number of segments.
+      private: unsigned int segments = 0;
+
+      /// \brief Position of the mapped segment.
+      private: unsigned int segment = 0;
+
+      /// \brief File descriptor of the mapped segment (-1 if none).
+      private: int fd = -1;
+
+      /// \brief Memory mapping of the current segment.
+      private: const char *base = nullptr;
+
+      /// \brief Size of the mapped segment.
+      private: uint64_t mappedSize = 0;
+
+      /// \brief Read position in the mapped segment.
+      private: uint64_t offset = 0;
+
+      /// \brief Topics of the log.
+      private: std::vector<LogTopic> topics;
+
+      /// \brief Number of messages.
+      private: uint64_t messages = 0;
+
+      /// \brief Time of the first message.
+      private: uint64_t startTime = 0;
+
+      /// \brief Time of the last message.
+      private: uint64_t endTime = 0;
+
+      /// \brief True while the log is open.
+      private: bool open = false;
+    };
+  }
+}
+#endif
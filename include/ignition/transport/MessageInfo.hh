@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2015 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef __IGN_TRANSPORT_MESSAGEINFO_HH_INCLUDED__
+#define __IGN_TRANSPORT_MESSAGEINFO_HH_INCLUDED__
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "ignition/transport/Helpers.hh"
+
+namespace ignition
+{
+  namespace transport
+  {
+    /// \class MessageInfo MessageInfo.hh ignition/transport/MessageInfo.hh
+    /// \brief Metadata of a topic update. The metadata travels in the sender
+    /// frame of each message: the publisher address, followed by a '\0', the
+    /// sequence number, the send time and the message type name. Publishers
+    /// that do not send the metadata only include their address.
+    class IGNITION_VISIBLE MessageInfo
+    {
+      /// \brief Constructor.
+      public: MessageInfo() = default;
+
+      /// \brief Destructor.
+      public: virtual ~MessageInfo() = default;
+
+      /// \brief Get the topic name (without the partition).
+      /// \return The topic name.
+      public: std::string GetTopic() const;
+
+      /// \brief Get the protobuf type name of the message.
+      /// E.g.: "ignition.transport.msgs.Int".
+      /// \return The type name or empty if not available.
+      public: std::string GetType() const;
+
+      /// \brief Get the 0MQ address of the publisher. Empty for messages
+      /// published in the same process.
+      /// \return The publisher address.
+      public: std::string GetPublisherAddress() const;
+
+      /// \brief Check if the message contains a sequence number and a send
+      /// time.
+      /// \return True if the metadata is available.
+      public: bool HasMetadata() const;
+
+      /// \brief Get the sequence number. Each process numbers the messages
+      /// of each topic consecutively starting at 1.
+      /// \return The sequence number or 0 if not available.
+      public: uint64_t GetSequence() const;
+
+      /// \brief Get the time when the message was published, in
+      /// nanoseconds since the epoch of the publisher's steady clock. Only
+      /// comparable with the steady clock of processes in the same host.
+      /// \return The send time or 0 if not available.
+      public: uint64_t GetSendTime() const;
+
+      /// \brief Set the topic name.
+      /// \param[in] _topic Topic name.
+      public: void SetTopic(const std::string &_topic);
+
+      /// \brief Set the protobuf type name of the message.
+      /// \param[in] _type Type name.
+      public: void SetType(const std::string &_type);
+
+      /// \brief Set the 0MQ address of the publisher.
+      /// \param[in] _addr Publisher address.
+      public: void SetPublisherAddress(const std::string &_addr);
+
+      /// \brief Set the sequence number and the send time.
+      /// \param[in] _seq Sequence number.
+      /// \param[in] _sendTime Send time (ns).
+      public: void SetMetadata(const uint64_t _seq, const uint64_t _sendTime);
+
+      /// \brief Serialize the publisher address and the metadata.
+      /// \return The content of the sender frame.
+      public: std::string Pack() const;
+
+      /// \brief Parse the content of a sender frame.
+      /// \param[in] _frame Content of the sender frame.
+      /// \return True if the frame contains the metadata or false if it only
+      /// contains the publisher address (or the metadata is corrupted).
+      public: bool Unpack(const std::string &_frame);
+
+      /// \brief Replace the sequence number and the send time of a sender
+      /// frame created with Pack(), without parsing the rest of the frame.
+      /// Used to reuse a frame packed once for many messages.
+      /// \param[in, out] _frame Content of the sender frame.
+      /// \param[in] _size Size of the frame.
+      /// \param[in] _seq Sequence number.
+      /// \param[in] _sendTime Send time (ns).
+      /// \return True if the frame contains the metadata or false otherwise.
+      public: static bool Repack(char *_frame, const size_t _size,
+                                 const uint64_t _seq,
+                                 const uint64_t _sendTime);
+
+      /// \brief Get the current value of the clock used for the send time.
+      /// \return Time in ns since the epoch of the steady clock.
+      public: static uint64_t Now();
+
+      /// \brief Topic name.
+      private: std::string topic = "";
+
+      /// \brief Message type name.
+      private: std::string type = "";
+
+      /// \brief Publisher address.
+      private: std::string publisherAddress = "";
+
+      /// \brief Whether the sequence number and send time are available.
+      private: bool hasMetadata = false;
+
+      /// \brief Sequence number.
+      private: uint64_t seq = 0;
+
+      /// \brief Send time (ns).
+      private: uint64_t sendTime = 0;
+    };
+  }
+}
+#endif
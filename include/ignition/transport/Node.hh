@@ -23,6 +23,7 @@
 #endif
 #include <google/protobuf/message.h>
 #include <algorithm>
+#include <chrono>
 #include <condition_variable>
 #include <functional>
 #include <map>
@@ -35,12 +36,17 @@
 #endif
 #include "ignition/transport/HandlerStorage.hh"
 #include "ignition/transport/Helpers.hh"
+#include "ignition/transport/Introspection.hh"
+#include "ignition/transport/MessageInfo.hh"
 #include "ignition/transport/NodePrivate.hh"
 #include "ignition/transport/NodeShared.hh"
 #include "ignition/transport/Packet.hh"
+#include "ignition/transport/Publisher.hh"
 #include "ignition/transport/RepHandler.hh"
 #include "ignition/transport/ReqHandler.hh"
+#include "ignition/transport/Statistics.hh"
 #include "ignition/transport/SubscriptionHandler.hh"
+#include "ignition/transport/TopicQueue.hh"
 #include "ignition/transport/TopicUtils.hh"
 #include "ignition/transport/TransportTypes.hh"
 
@@ -74,6 +80,22 @@ namespace ignition
       public: bool Advertise(const std::string &_topic,
                              const Scope &_scope = Scope::All);
 
+      /// \brief Advertise a new topic and get a handle to publish messages
+      /// of type T on it. The handle caches the state of the topic, so
+      /// publishing through it is cheaper than calling Publish().
+      /// \param[in] _topic Topic name to be advertised.
+      /// \param[in] _scope Topic scope.
+      /// \return The publisher handle. The handle is not valid if the topic
+      /// could not be advertised.
+      public: template<typename T> Publisher<T> Advertise(
+        const std::string &_topic, const Scope &_scope = Scope::All)
+      {
+        if (!this->Advertise(_topic, _scope))
+          return Publisher<T>();
+
+        return Publisher<T>(this->CreatePublisher(_topic, T().GetTypeName()));
+      }
+
       /// \brief Get the list of topics advertised by this node.
       /// \return A vector containing all the topics advertised by this node.
       public: std::vector<std::string> AdvertisedTopics() const;
@@ -90,6 +112,17 @@ namespace ignition
       public: bool Publish(const std::string &_topic,
                            const ProtoMsg &_msg);
 
+      /// \brief Publish an already serialized message. The payload is not
+      /// parsed or copied unless there are local subscribers, which makes
+      /// this function suitable to replay or forward messages.
+      /// \param[in] _topic Topic to be published.
+      /// \param[in] _data Pointer to the serialized message.
+      /// \param[in] _size Size of the serialized message in bytes.
+      /// \param[in] _type Message type name (e.g. "ignition.msgs.Int").
+      /// \return true when success.
+      public: bool PublishRaw(const std::string &_topic, const char *_data,
+                              const size_t _size, const std::string &_type);
+
       /// \brief Subscribe to a topic registering a callback.
       /// In this version the callback is a free function.
       /// \param[in] _topic Topic to be subscribed.
@@ -117,6 +150,7 @@ namespace ignition
         // Create a new subscription handler.
         std::shared_ptr<SubscriptionHandler<T>> subscrHandlerPtr(
             new SubscriptionHandler<T>(this->dataPtr->nUuid));
+        subscrHandlerPtr->SetReuseMsg(this->dataPtr->reuseMsgs);
 
         // Insert the callback into the handler.
         subscrHandlerPtr->SetCallback(_cb);
@@ -127,6 +161,7 @@ namespace ignition
         // will invoke the callback.
         this->dataPtr->shared->localSubscriptions.AddHandler(
           fullyQualifiedTopic, this->dataPtr->nUuid, subscrHandlerPtr);
+        this->dataPtr->shared->RefreshPublication(fullyQualifiedTopic);
 
         // Add the topic to the list of subscribed topics (if it was not before)
         this->dataPtr->topicsSubscribed.insert(fullyQualifiedTopic);
@@ -166,6 +201,7 @@ namespace ignition
         // Create a new subscription handler.
         std::shared_ptr<SubscriptionHandler<T>> subscrHandlerPtr(
           new SubscriptionHandler<T>(this->dataPtr->nUuid));
+        subscrHandlerPtr->SetReuseMsg(this->dataPtr->reuseMsgs);
 
         // Insert the callback into the handler by creating a free function.
         subscrHandlerPtr->SetCallback(
@@ -177,6 +213,57 @@ namespace ignition
         // will invoke the callback.
         this->dataPtr->shared->localSubscriptions.AddHandler(
           fullyQualifiedTopic, this->dataPtr->nUuid, subscrHandlerPtr);
+        this->dataPtr->shared->RefreshPublication(fullyQualifiedTopic);
+
+        // Add the topic to the list of subscribed topics (if it was not before)
+        this->dataPtr->topicsSubscribed.insert(fullyQualifiedTopic);
+
+        // Discover the list of nodes that publish on the topic.
+        this->dataPtr->shared->discovery->Discover(fullyQualifiedTopic, false);
+
+        return true;
+      }
+
+      /// \brief Subscribe to a topic registering a callback that also
+      /// receives the metadata of each message (sequence number, send time
+      /// and publisher address). In this version the callback is a free
+      /// function.
+      /// \param[in] _topic Topic to be subscribed.
+      /// \param[in] _cb Pointer to the callback function with the following
+      /// parameters:
+      ///   \param[in] _topic Topic name.
+      ///   \param[in] _msg Protobuf message containing a new topic update.
+      ///   \param[in] _info Metadata of the message.
+      /// \return true when successfully subscribed or false otherwise.
+      public: template<typename T> bool Subscribe(
+          const std::string &_topic,
+          void(*_cb)(const std::string &_topic, const T &_msg,
+                     const MessageInfo &_info))
+      {
+        std::string fullyQualifiedTopic;
+        if (!TopicUtils::GetFullyQualifiedName(this->dataPtr->partition,
+          this->dataPtr->ns, _topic, fullyQualifiedTopic))
+        {
+          std::cerr << "Topic [" << _topic << "] is not valid." << std::endl;
+          return false;
+        }
+
+        std::lock_guard<std::recursive_mutex> discLk(
+          this->dataPtr->shared->discovery->GetMutex());
+        std::lock_guard<std::recursive_mutex> lk(this->dataPtr->shared->mutex);
+
+        // Create a new subscription handler.
+        std::shared_ptr<SubscriptionHandler<T>> subscrHandlerPtr(
+            new SubscriptionHandler<T>(this->dataPtr->nUuid));
+        subscrHandlerPtr->SetReuseMsg(this->dataPtr->reuseMsgs);
+
+        // Insert the callback into the handler.
+        subscrHandlerPtr->SetInfoCallback(_cb);
+
+        // Store the subscription handler.
+        this->dataPtr->shared->localSubscriptions.AddHandler(
+          fullyQualifiedTopic, this->dataPtr->nUuid, subscrHandlerPtr);
+        this->dataPtr->shared->RefreshPublication(fullyQualifiedTopic);
 
         // Add the topic to the list of subscribed topics (if it was not before)
         this->dataPtr->topicsSubscribed.insert(fullyQualifiedTopic);
@@ -187,6 +274,71 @@ namespace ignition
         return true;
       }
 
+      /// \brief Subscribe to a topic registering a callback that also
+      /// receives the metadata of each message (sequence number, send time
+      /// and publisher address). In this version the callback is a member
+      /// function.
+      /// \param[in] _topic Topic to be subscribed.
+      /// \param[in] _cb Pointer to the callback function with the following
+      /// parameters:
+      ///   \param[in] _topic Topic name.
+      ///   \param[in] _msg Protobuf message containing a new topic update.
+      ///   \param[in] _info Metadata of the message.
+      /// \param[in] _obj Instance containing the member function.
+      /// \return true when successfully subscribed or false otherwise.
+      public: template<typename C, typename T> bool Subscribe(
+          const std::string &_topic,
+          void(C::*_cb)(const std::string &_topic, const T &_msg,
+                        const MessageInfo &_info),
+          C *_obj)
+      {
+        std::string fullyQualifiedTopic;
+        if (!TopicUtils::GetFullyQualifiedName(this->dataPtr->partition,
+          this->dataPtr->ns, _topic, fullyQualifiedTopic))
+        {
+          std::cerr << "Topic [" << _topic << "] is not valid." << std::endl;
+          return false;
+        }
+
+        std::lock_guard<std::recursive_mutex> discLk(
+          this->dataPtr->shared->discovery->GetMutex());
+        std::lock_guard<std::recursive_mutex> lk(this->dataPtr->shared->mutex);
+
+        // Create a new subscription handler.
+        std::shared_ptr<SubscriptionHandler<T>> subscrHandlerPtr(
+          new SubscriptionHandler<T>(this->dataPtr->nUuid));
+        subscrHandlerPtr->SetReuseMsg(this->dataPtr->reuseMsgs);
+
+        // Insert the callback into the handler by creating a free function.
+        subscrHandlerPtr->SetInfoCallback(
+          std::bind(_cb, _obj, std::placeholders::_1, std::placeholders::_2,
+            std::placeholders::_3));
+
+        // Store the subscription handler.
+        this->dataPtr->shared->localSubscriptions.AddHandler(
+          fullyQualifiedTopic, this->dataPtr->nUuid, subscrHandlerPtr);
+        this->dataPtr->shared->RefreshPublication(fullyQualifiedTopic);
+
+        // Add the topic to the list of subscribed topics (if it was not before)
+        this->dataPtr->topicsSubscribed.insert(fullyQualifiedTopic);
+
+        // Discover the list of nodes that publish on the topic.
+        this->dataPtr->shared->discovery->Discover(fullyQualifiedTopic, false);
+
+        return true;
+      }
+
+      /// \brief Subscribe to a topic without deserializing the messages.
+      /// The callback receives the serialized payload, which is useful for
+      /// tools that only forward or measure the messages. The message type
+      /// name is available via MessageInfo::GetType(). Publishers in the
+      /// same process serialize the message only if a raw subscriber exists.
+      /// \param[in] _topic Topic to be subscribed.
+      /// \param[in] _cb Callback executed for each topic update.
+      /// \return true when successfully subscribed or false otherwise.
+      public: bool SubscribeRaw(const std::string &_topic,
+                                const RawCallback &_cb);
+
       /// \brief Get the list of topics subscribed by this node. Note that
       /// we might be interested in one topic but we still don't know the
       /// address of a publisher.
@@ -235,6 +387,7 @@ namespace ignition
         // Create a new service reply handler.
         std::shared_ptr<RepHandler<T1, T2>> repHandlerPtr(
           new RepHandler<T1, T2>());
+        repHandlerPtr->SetReuseMsg(this->dataPtr->reuseMsgs);
 
         // Insert the callback into the handler.
         repHandlerPtr->SetCallback(_cb);
@@ -293,6 +446,7 @@ namespace ignition
         // Create a new service reply handler.
         std::shared_ptr<RepHandler<T1, T2>> repHandlerPtr(
           new RepHandler<T1, T2>());
+        repHandlerPtr->SetReuseMsg(this->dataPtr->reuseMsgs);
 
         // Insert the callback into the handler.
         repHandlerPtr->SetCallback(
@@ -347,6 +501,10 @@ namespace ignition
           this->dataPtr->shared->discovery->GetMutex());
         std::lock_guard<std::recursive_mutex> lk(this->dataPtr->shared->mutex);
 
+        auto counters =
+          this->dataPtr->shared->stats.Service(fullyQualifiedTopic);
+        counters->AddRequest();
+
         // If the responser is within my process.
         IRepHandlerPtr repHandler;
         if (this->dataPtr->shared->repliers.GetHandler(fullyQualifiedTopic,
@@ -355,7 +513,10 @@ namespace ignition
           // There is a responser in my process, let's use it.
           T2 rep;
           bool result;
+          auto start = std::chrono::steady_clock::now();
           repHandler->RunLocalCallback(fullyQualifiedTopic, _req, rep, result);
+          counters->AddServed(ElapsedNs(start));
+          counters->AddResponse(result, ElapsedNs(start));
 
           // Notify the requester with the response and remove the partition
           // part from the topic name.
@@ -426,6 +587,10 @@ namespace ignition
           this->dataPtr->shared->discovery->GetMutex());
         std::lock_guard<std::recursive_mutex> lk(this->dataPtr->shared->mutex);
 
+        auto counters =
+          this->dataPtr->shared->stats.Service(fullyQualifiedTopic);
+        counters->AddRequest();
+
         // If the responser is within my process.
         IRepHandlerPtr repHandler;
         if (this->dataPtr->shared->repliers.GetHandler(fullyQualifiedTopic,
@@ -434,7 +599,10 @@ namespace ignition
           // There is a responser in my process, let's use it.
           T2 rep;
           bool result;
+          auto start = std::chrono::steady_clock::now();
           repHandler->RunLocalCallback(fullyQualifiedTopic, _req, rep, result);
+          counters->AddServed(ElapsedNs(start));
+          counters->AddResponse(result, ElapsedNs(start));
 
           // Notify the requester with the response and remove the partition
           // part from the topic name.
@@ -503,14 +671,21 @@ namespace ignition
         this->dataPtr->shared->discovery->GetMutex().lock();
         std::unique_lock<std::recursive_mutex> lk(this->dataPtr->shared->mutex);
 
+        auto counters =
+          this->dataPtr->shared->stats.Service(fullyQualifiedTopic);
+        counters->AddRequest();
+
         // If the responser is within my process.
         IRepHandlerPtr repHandler;
         if (this->dataPtr->shared->repliers.GetHandler(fullyQualifiedTopic,
           repHandler))
         {
           // There is a responser in my process, let's use it.
+          auto start = std::chrono::steady_clock::now();
           repHandler->RunLocalCallback(fullyQualifiedTopic, _req, _rep,
             _result);
+          counters->AddServed(ElapsedNs(start));
+          counters->AddResponse(_result, ElapsedNs(start));
           this->dataPtr->shared->discovery->GetMutex().unlock();
           return true;
         }
@@ -550,6 +725,8 @@ namespace ignition
 
           _result = reqHandlerPtr->GetResult();
         }
+        else
+          counters->AddTimeout();
 
         lk.unlock();
 
@@ -573,6 +750,73 @@ namespace ignition
       /// \return The partition name.
       public: std::string Partition() const;
 
+      /// \brief Get the runtime statistics of a topic in this process. The
+      /// counters are shared by all the nodes of the process.
+      /// \param[in] _topic Topic name.
+      /// \param[out] _stats Snapshot of the topic counters.
+      /// \return True if the topic has been used in this process or false
+      /// otherwise.
+      public: bool GetTopicStats(const std::string &_topic,
+                                 TopicStatistics &_stats) const;
+
+      /// \brief Get the runtime statistics of a service in this process. The
+      /// counters are shared by all the nodes of the process.
+      /// \param[in] _topic Service name.
+      /// \param[out] _stats Snapshot of the service counters.
+      /// \return True if the service has been used in this process or false
+      /// otherwise.
+      public: bool GetServiceStats(const std::string &_topic,
+                                   ServiceStatistics &_stats) const;
+
+      /// \brief Get the transport state of all the processes in the
+      /// partition of this node, including this one. Each process answers
+      /// its own introspection service (see IntrospectionPrefix), which is
+      /// limited to the processes of the same host unless they set
+      /// IGN_TRANSPORT_INTROSPECTION=all. The processes that set
+      /// IGN_TRANSPORT_INTROSPECTION=none don't answer. The processes are
+      /// discovered and queried in parallel, so this call takes up to twice
+      /// the timeout.
+      /// \param[in] _timeout Maximum waiting time for the discovery and for
+      /// the responses (ms.).
+      /// \param[out] _states State of each process that answered in time.
+      /// Only the topics and services of the partition are included.
+      public: void GetProcessStates(const unsigned int _timeout,
+                                    std::vector<ProcessState> &_states) const;
+
+      /// \brief Bound the memory used by the messages received on a topic.
+      /// The messages of a topic with limits are queued when they arrive
+      /// from remote publishers and delivered to the subscribers by a
+      /// separate thread. When the queue is full, messages are discarded
+      /// following the drop policy and accounted in TopicStatistics. The
+      /// limits are shared by all the nodes of the process.
+      /// \param[in] _topic Topic name.
+      /// \param[in] _limits Bounds of the queue.
+      /// \return True when success or false if the topic is not valid.
+      public: bool SetTopicLimits(const std::string &_topic,
+                                  const QueueLimits &_limits);
+
+      /// \brief Reuse the messages received by the subscriptions and the
+      /// services created by this node from now on, instead of allocating
+      /// a new message for each message or request received from other
+      /// processes. The messages passed to the callbacks are then only valid
+      /// during the callback: a callback that needs a message later has to
+      /// copy it (e.g. with CopyFrom()). Disabled by default.
+      /// \param[in] _reuse True to reuse the messages.
+      public: void SetReuseMsgs(const bool _reuse);
+
+      /// \brief Check if the new subscriptions and services of this node
+      /// reuse their messages.
+      /// \return True if the reuse is enabled.
+      public: bool ReuseMsgs() const;
+
+      /// \brief Create the state of a publisher handle for a topic already
+      /// advertised by this node.
+      /// \param[in] _topic Topic name.
+      /// \param[in] _type Message type name.
+      /// \return The state of the handle.
+      private: PublisherStatePtr CreatePublisher(const std::string &_topic,
+                                                 const std::string &_type);
+
       /// \internal
       /// \brief Pointer to private data.
       protected: NodePrivatePtr dataPtr;
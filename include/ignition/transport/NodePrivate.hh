@@ -18,11 +18,13 @@
 #ifndef __IGN_TRANSPORT_NODEPRIVATE_HH_INCLUDED__
 #define __IGN_TRANSPORT_NODEPRIVATE_HH_INCLUDED__
 
+#include <map>
 #include <string>
 #include <unordered_set>
 #include <vector>
 #include "ignition/transport/Helpers.hh"
 #include "ignition/transport/NodeShared.hh"
+#include "ignition/transport/Publisher.hh"
 
 using namespace ignition;
 using namespace transport;
@@ -47,6 +49,10 @@ namespace ignition
       /// \brief The list of topics advertised by this node.
       public: std::unordered_set<std::string> topicsAdvertised;
 
+      /// \brief Publisher handles created by this node. The key is the fully
+      /// qualified topic name.
+      public: std::multimap<std::string, PublisherStatePtr> publishers;
+
       /// \brief The list of service calls advertised by this node.
       public: std::unordered_set<std::string> srvsAdvertised;
 
@@ -62,6 +68,10 @@ namespace ignition
 
       /// \brief Default namespace for this node.
       public: std::string ns = "";
+
+      /// \brief When true, the new subscription and replier handlers reuse
+      /// their messages.
+      public: bool reuseMsgs = false;
     };
   }
 }
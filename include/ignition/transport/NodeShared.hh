@@ -26,16 +26,24 @@
 # pragma warning(pop)
 #endif
 #include <zmq.hpp>
+#include <condition_variable>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <set>
 #include <string>
 #include <thread>
 #include <vector>
+#include "ignition/transport/ConnectionManager.hh"
 #include "ignition/transport/Discovery.hh"
 #include "ignition/transport/HandlerStorage.hh"
 #include "ignition/transport/Helpers.hh"
+#include "ignition/transport/Introspection.hh"
+#include "ignition/transport/MessageInfo.hh"
 #include "ignition/transport/RepHandler.hh"
 #include "ignition/transport/ReqHandler.hh"
+#include "ignition/transport/Statistics.hh"
+#include "ignition/transport/TopicQueue.hh"
 #include "ignition/transport/TopicStorage.hh"
 #include "ignition/transport/Uuid.hh"
 
@@ -43,6 +51,9 @@ namespace ignition
 {
   namespace transport
   {
+    class Publication;
+    class PublisherState;
+
     /// \class NodeShared NodeShared.hh ignition/transport/NodeShared.hh
     /// \brief Private data for the Node class. This class should not be
     /// directly used. You should use the Node class.
@@ -59,12 +70,87 @@ namespace ignition
       /// \brief Publish data.
       /// \param[in] _topic Topic to be published.
       /// \param[in] _data Data to publish.
+      /// \param[in] _info Metadata sent with the data. The publisher
+      /// address is filled by this function.
+      /// \return true when success or false otherwise.
+      public: bool Publish(const std::string &_topic,
+                           const std::string &_data,
+                           const MessageInfo &_info = MessageInfo());
+
+      /// \brief Publish data stored in an external buffer.
+      /// \param[in] _topic Topic to be published.
+      /// \param[in] _data Pointer to the data to publish.
+      /// \param[in] _size Size of the data in bytes.
+      /// \param[in] _info Metadata sent with the data. The publisher
+      /// address is filled by this function.
       /// \return true when success or false otherwise.
       public: bool Publish(const std::string &_topic,
-                           const std::string &_data);
+                           const char *_data,
+                           const size_t _size,
+                           const MessageInfo &_info = MessageInfo());
+
+      /// \brief Publish a message through a Publisher handle. The message is
+      /// delivered to the local subscribers and serialized at most once,
+      /// straight into the 0MQ frame, for the remote subscribers. 'mutex' is
+      /// only locked if there are local subscribers.
+      /// \param[in] _state State of the handle.
+      /// \param[in] _msg Message to publish.
+      /// \return true when success or false otherwise.
+      public: bool Publish(PublisherState &_state, const ProtoMsg &_msg);
+
+      /// \brief Publish a message.
+      /// \param[in] _pub Publication of the topic.
+      /// \param[in] _msg Message to publish.
+      /// \param[in] _type Message type name.
+      /// \param[in] _header Sender frame created by PackHeader(). If empty,
+      /// it is packed only when there are remote subscribers.
+      /// \return true when success or false otherwise.
+      public: bool Publish(Publication &_pub, const ProtoMsg &_msg,
+                           const std::string &_type,
+                           const std::string &_header);
+
+      /// \brief Create the sender frame of the messages published by this
+      /// process. The metadata is updated for each message with
+      /// MessageInfo::Repack().
+      /// \param[in] _type Message type name.
+      /// \return The sender frame.
+      public: std::string PackHeader(const std::string &_type) const;
+
+      /// \brief Get the publication of a topic. It is created if it does not
+      /// exist. The caller must hold 'mutex'.
+      /// \param[in] _topic Fully qualified topic name.
+      /// \return The publication of the topic.
+      public: std::shared_ptr<Publication> GetPublication(
+        const std::string &_topic);
+
+      /// \brief Update the subscriber flags of a publication after a change
+      /// in the local or remote subscribers of the topic. The caller must
+      /// hold 'mutex'.
+      /// \param[in] _topic Fully qualified topic name.
+      public: void RefreshPublication(const std::string &_topic);
+
+      /// \brief Update the subscriber flags of all the publications. The
+      /// caller must hold 'mutex'.
+      public: void RefreshPublications();
 
       /// \brief Method in charge of receiving the topic updates.
-      public: void RecvMsgUpdate();
+      /// \param[in] _socket Subscriber socket with a pending message:
+      /// 'subscriber' or 'relaySubscriber'.
+      public: void RecvMsgUpdate(zmq::socket_t &_socket);
+
+      /// \brief Bound the reception queue of a topic. The messages received
+      /// on a topic with limits are queued by the reception thread and
+      /// delivered to the subscribers by a dispatch thread, so a slow
+      /// callback does not make the messages pile up inside 0MQ. The
+      /// dispatch thread runs the callbacks without holding 'mutex', so a
+      /// callback might be executed shortly after its subscriber is removed.
+      /// \param[in] _topic Fully qualified topic name.
+      /// \param[in] _limits Bounds of the queue.
+      public: void SetTopicLimits(const std::string &_topic,
+                                  const QueueLimits &_limits);
+
+      /// \brief Deliver the messages queued in the topics with limits.
+      public: void RunDispatchTask();
 
       /// \brief Method in charge of receiving the control updates (when a new
       /// remote subscriber notifies its presence for example).
@@ -94,6 +180,67 @@ namespace ignition
                                    const std::string &_nUuid,
                                    const Scope &_scope);
 
+      /// \brief Connect to a publisher of a topic and notify it about the
+      /// local subscribers.
+      /// \param[in] _topic Topic name.
+      /// \param[in] _addr 0MQ address of the publisher.
+      /// \param[in] _ctrl 0MQ control address of the publisher.
+      /// \param[in] _pUuid Process UUID of the publisher.
+      /// \param[in] _nUuid Node UUID of the publisher.
+      /// \param[in] _scope Topic scope.
+      /// \param[in] _relay True if the publisher is a relay. The relays are
+      /// connected through 'relaySubscriber'.
+      /// \return True if the connection was established.
+      public: bool ConnectToPublisher(const std::string &_topic,
+                                      const std::string &_addr,
+                                      const std::string &_ctrl,
+                                      const std::string &_pUuid,
+                                      const std::string &_nUuid,
+                                      const Scope &_scope,
+                                      const bool _relay);
+
+      /// \brief Disconnect from the publishers of a topic that are not
+      /// relays. Called when a relay for the topic is found and
+      /// 'preferRelay' is set. The filter of the topic is removed from
+      /// 'subscriber' and the publishers are notified, so they stop sending
+      /// the topic to this process even if they share the connection with
+      /// other topics.
+      /// \param[in] _topic Topic name.
+      public: void DropOrigins(const std::string &_topic);
+
+      /// \brief Check if a subscriber socket is still needed for an address.
+      /// The caller must hold 'mutex' and 'subscriberMutex'.
+      /// \param[in] _addr 0MQ address of a publisher.
+      /// \param[in] _relay True to check 'relaySubscriber', false to check
+      /// 'subscriber'.
+      /// \return True if a connection registered for the socket uses the
+      /// address.
+      public: bool SubscriberHasAddress(const std::string &_addr,
+                                        const bool _relay);
+
+      /// \brief Connect to the publishers of a topic that are not relays.
+      /// Called when the last relay used for the topic disappears.
+      /// \param[in] _topic Topic name.
+      public: void ConnectToOrigins(const std::string &_topic);
+
+      /// \brief Notify a remote publisher about all my local subscribers for a
+      /// list of topics. This function is executed by the connection manager
+      /// because it blocks until the control connection is established. The
+      /// end of the subscriptions is notified instead for the topics that
+      /// are no longer received from the publisher.
+      /// \param[in] _ctrl 0MQ control address of the publisher.
+      /// \param[in] _topics List of topics.
+      public: void NotifyRemotePublisher(const std::string &_ctrl,
+        const std::vector<std::string> &_topics);
+
+      /// \brief Wait until the connection with a service call responser is
+      /// established and send all the pending requests for a list of services.
+      /// This function is executed by the connection manager.
+      /// \param[in] _addr 0MQ address of the service call responser.
+      /// \param[in] _topics List of services.
+      public: void OnSrvConnectionReady(const std::string &_addr,
+        const std::vector<std::string> &_topics);
+
       /// \brief Callback executed when the discovery detects disconnections.
       /// \param[in] _topic Topic name.
       /// \param[in] _addr 0MQ address of the publisher.
@@ -136,6 +283,62 @@ namespace ignition
                                          const std::string &_nUuid,
                                          const Scope &_scope);
 
+      /// \brief Advertise the introspection service of this process in a
+      /// partition (see IntrospectionPrefix). Nothing is done if it is
+      /// already advertised in the partition or if the introspection is
+      /// disabled.
+      /// \param[in] _partition Partition name.
+      public: void EnableIntrospection(const std::string &_partition);
+
+      /// \brief Get a snapshot of the transport state of this process.
+      /// \param[in] _prefix Only the topics and services starting with this
+      /// prefix are included (e.g. a partition "@/p@"). Empty for all.
+      /// \param[out] _state State of the process.
+      public: void GetProcessState(const std::string &_prefix,
+                                   ProcessState &_state);
+
+      /// \brief Callback of the introspection service. The request contains
+      /// the prefix passed to GetProcessState() and the response is the
+      /// serialized state.
+      /// \param[in] _topic Service name.
+      /// \param[in] _req Serialized request.
+      /// \param[out] _rep Serialized response.
+      /// \param[out] _result Service call result.
+      private: void OnIntrospectionRequest(const std::string &_topic,
+                                           const std::string &_req,
+                                           std::string &_rep,
+                                           bool &_result);
+
+      /// \brief Get the counters of a topic with limits. It does not
+      /// require 'mutex'.
+      /// \param[in] _topic Fully qualified topic name.
+      /// \return The counters of the topic or nullptr if the topic does not
+      /// have limits.
+      private: TopicCountersPtr QueueCounters(const std::string &_topic);
+
+      /// \brief Queue a message received on a topic with limits. The
+      /// QueueLimits::onLimit callback is executed if the queue reaches its
+      /// limits, so the caller should not hold any lock.
+      /// \param[in] _topic Fully qualified topic name.
+      /// \param[in, out] _data Serialized message. It is moved into the
+      /// queue.
+      /// \param[in] _info Metadata of the message.
+      /// \param[in] _counters Counters of the topic.
+      private: void EnqueueMsg(const std::string &_topic, std::string &_data,
+                               const MessageInfo &_info,
+                               const TopicCountersPtr &_counters);
+
+      /// \brief Execute the callbacks of the local subscribers of a topic.
+      /// \param[in] _topic Fully qualified topic name.
+      /// \param[in] _handlers Subscribers of the topic.
+      /// \param[in] _data Serialized message.
+      /// \param[in] _info Metadata of the message.
+      /// \param[in] _counters Counters of the topic.
+      private: void DispatchMsg(const std::string &_topic,
+        const HandlerStorage<ISubscriptionHandler>::HandlerListPtr &_handlers,
+        const std::string &_data, const MessageInfo &_info,
+        const TopicCountersPtr &_counters);
+
       /// \brief Constructor.
       protected: NodeShared();
 
@@ -148,6 +351,18 @@ namespace ignition
       /// \brief Print activity to stdout.
       public: int verbose;
 
+      /// \brief When true, the topics are received through a relay (see
+      /// Relay) instead of the original publishers, when there is one.
+      /// Set with IGN_TRANSPORT_PREFER_RELAY=1.
+      public: bool preferRelay = false;
+
+      /// \brief When true, this process answers its introspection service.
+      /// Set with IGN_TRANSPORT_INTROSPECTION=none|host|all (default host).
+      public: bool introspection = true;
+
+      /// \brief Scope of the introspection service.
+      public: Scope introspectionScope = Scope::Host;
+
       /// \brief My pub/sub address.
       public: std::string myAddress;
 
@@ -175,6 +390,12 @@ namespace ignition
       /// \brief ZMQ socket to receive topic updates.
       public: std::unique_ptr<zmq::socket_t> subscriber;
 
+      /// \brief ZMQ socket to receive the topics from the relays. The filters
+      /// of a 0MQ socket apply to all its connections, so the relays use
+      /// their own socket. That way, the filter of a relayed topic can be
+      /// removed from the original publishers.
+      public: std::unique_ptr<zmq::socket_t> relaySubscriber;
+
       /// \brief ZMQ socket to receive control updates (new connections, ...).
       public: std::unique_ptr<zmq::socket_t> control;
 
@@ -203,6 +424,9 @@ namespace ignition
       public: std::thread *threadReception;
 
       /// \brief Mutex to guarantee exclusive access between all threads.
+      /// When the discovery mutex is also needed, it is locked before this
+      /// one. The discovery callbacks run holding the discovery mutex, and
+      /// most of the discovery functions lock it.
       public: std::recursive_mutex mutex;
 
       /// \brief When true, the reception thread will finish.
@@ -217,6 +441,14 @@ namespace ignition
       /// \brief List of connected zmq end points for request/response.
       private: std::vector<std::string> srvConnections;
 
+      /// \brief List of zmq end points for request/response that are still
+      /// being connected by the connection manager.
+      private: std::vector<std::string> srvConnectionsPending;
+
+      /// \brief Connection manager used to establish the connections with the
+      /// remote publishers and responsers outside of the discovery thread.
+      public: std::unique_ptr<ConnectionManager> connectionManager;
+
       /// \brief Remote subscribers.
       public: TopicStorage remoteSubscribers;
 
@@ -228,6 +460,69 @@ namespace ignition
 
       /// \brief Pending service call requests.
       public: HandlerStorage<IReqHandler> requests;
+
+      /// \brief Number of local nodes advertising each topic. The key is the
+      /// topic name. The discovery layer knows it as well, but this copy can
+      /// be read holding only 'mutex'.
+      public: std::map<std::string, unsigned int> advertisedTopics;
+
+      /// \brief Runtime statistics of the topics and services used in this
+      /// process.
+      public: StatisticsStorage stats;
+
+      /// \brief Topics published by this process. The key is the fully
+      /// qualified topic name. The publications are never removed, so the
+      /// sequence numbers continue if a topic is advertised again.
+      public: std::map<std::string, std::shared_ptr<Publication>>
+        publications;
+
+      /// \brief Mutex to protect the publisher socket. When both are needed,
+      /// 'mutex' is locked before this one.
+      public: std::mutex publisherMutex;
+
+      /// \brief Mutex to protect the subscriber sockets, 'lastSequences' and
+      /// 'relayConnections'. The reception thread receives the messages
+      /// holding only this mutex. When both are needed, 'mutex' is locked
+      /// before this one.
+      public: std::mutex subscriberMutex;
+
+      /// \brief Last sequence number received from each remote publisher.
+      /// Used to detect lost messages. The first key is the publisher
+      /// address and the second key is the topic name.
+      private: std::map<std::string, std::map<std::string, uint64_t>>
+        lastSequences;
+
+      /// \brief Relays used to receive each topic when 'preferRelay' is set.
+      /// The key is the topic name and the value maps the process UUID of
+      /// each relay to its 0MQ address.
+      private: std::map<std::string, std::map<std::string, std::string>>
+        relayConnections;
+
+      /// \brief Partitions where the introspection service is advertised.
+      private: std::set<std::string> introspectionPartitions;
+
+      /// \brief Reception queues of the topics with limits. The key is the
+      /// fully qualified topic name.
+      private: std::map<std::string, std::unique_ptr<TopicQueue>> topicQueues;
+
+      /// \brief Counters of the topics with limits, so the reception thread
+      /// can update them without locking 'mutex'. The key is the fully
+      /// qualified topic name.
+      private: std::map<std::string, TopicCountersPtr> queueCounters;
+
+      /// \brief Mutex to protect the topic queues and 'queueCounters'. When
+      /// both are needed, 'mutex' is locked before this one.
+      private: std::mutex topicQueuesMutex;
+
+      /// \brief Used to notify the dispatch thread about queued messages.
+      private: std::condition_variable topicQueuesCv;
+
+      /// \brief Thread in charge of delivering the queued messages. It is
+      /// started when the first topic limits are set.
+      private: std::thread threadDispatch;
+
+      /// \brief When true, the dispatch thread will finish.
+      private: bool dispatchExit = false;
     };
   }
 }
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2015 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef __IGN_TRANSPORT_PACER_HH_INCLUDED__
+#define __IGN_TRANSPORT_PACER_HH_INCLUDED__
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include "ignition/transport/Helpers.hh"
+
+namespace ignition
+{
+  namespace transport
+  {
+    /// \class Pacer Pacer.hh ignition/transport/Pacer.hh
+    /// \brief Schedule events at a fixed rate. The events are scheduled
+    /// on an absolute timeline (start + n * period), so a late event does
+    /// not delay the following ones. To wake up on time, the pacer sleeps
+    /// until shortly before the deadline and busy-waits for the rest.
+    class IGNITION_VISIBLE Pacer
+    {
+      /// \brief Constructor.
+      /// \param[in] _rate Events per second. A rate <= 0 disables the
+      /// pacing: Wait() returns immediately.
+      public: explicit Pacer(const double _rate);
+
+      /// \brief Restart the timeline. The next event is due now.
+      public: void Reset();
+
+      /// \brief Wait until the next event is due.
+      /// \return Delay of the event with respect to its deadline (ns).
+      public: uint64_t Wait();
+
+      /// \brief Get the number of events scheduled since the last Reset().
+      /// \return Number of events.
+      public: uint64_t GetEvents() const;
+
+      /// \brief Wait until a deadline.
+      /// \param[in] _target Deadline.
+      /// \param[in] _stop Flag checked while sleeping. When it becomes true
+      /// the function returns before the deadline.
+      /// \return Delay with respect to the deadline (ns).
+      public: static uint64_t WaitUntil(
+        const std::chrono::steady_clock::time_point &_target,
+        const std::atomic<bool> &_stop);
+
+      /// \brief Time before a deadline when the pacer stops sleeping and
+      /// starts busy-waiting (ns).
+      public: static const uint64_t SpinTime = 200000;
+
+      /// \brief Maximum time slept in a row (ms), so a stop request is
+      /// noticed.
+      public: static const unsigned int MaxSleep = 100;
+
+      /// \brief Time between two events (ns). 0 when there is no pacing.
+      private: uint64_t period;
+
+      /// \brief Start of the timeline.
+      private: std::chrono::steady_clock::time_point start;
+
+      /// \brief Events scheduled so far.
+      private: uint64_t events = 0;
+
+      /// \brief Never set: Wait() is not interruptible.
+      private: std::atomic<bool> noStop;
+    };
+  }
+}
+#endif
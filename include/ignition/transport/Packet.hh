@@ -24,6 +24,7 @@
 #include <vector>
 #include "ignition/transport/TransportTypes.hh"
 #include "ignition/transport/Helpers.hh"
+#include "ignition/transport/Uuid.hh"
 
 namespace ignition
 {
@@ -41,13 +42,26 @@ namespace ignition
     static const uint8_t UnadvSrvType   = 8;
     static const uint8_t NewConnection  = 9;
     static const uint8_t EndConnection  = 10;
+    static const uint8_t QueryType      = 11;
+
+    /// \brief Header flag set when a subscription message includes a list of
+    /// known answers.
+    static const uint16_t KnownAnswersFlag = 0x0100;
+
+    /// \brief Maximum number of known answers included in a subscription
+    /// message. It keeps the message within a single Ethernet frame.
+    static const uint64_t MaxKnownAnswers = 20;
+
+    /// \brief Header flag set when a topic is advertised by a relay, a node
+    /// that republishes the messages of other publishers.
+    static const uint16_t RelayFlag = 0x0200;
 
     /// \brief Used for debugging the message type received/send.
     static const std::vector<std::string> MsgTypesStr =
     {
       "UNINITIALIZED", "ADVERTISE", "SUBSCRIBE", "UNADVERTISE", "HEARTBEAT",
       "BYE", "ADV_SRV", "SUB_SRV", "UNADVERTISE_SRV", "NEW_CONNECTION",
-      "END_CONNECTION"
+      "END_CONNECTION", "QUERY"
     };
 
     /// \class Header Packet.hh ignition/transport/Packet.hh
@@ -66,7 +80,7 @@ namespace ignition
       /// \param[in] _type Message type (ADVERTISE, SUBSCRIPTION, ...)
       /// \param[in] _flags Optional flags included in the header.
       public: Header(const uint16_t _version,
-                     const std::string &_pUuid,
+                     const Uuid &_pUuid,
                      const uint8_t _type,
                      const uint16_t _flags = 0);
 
@@ -79,7 +93,7 @@ namespace ignition
 
       /// \brief Get the process uuid.
       /// \return A unique global identifier for every process.
-      public: std::string GetPUuid() const;
+      public: Uuid GetPUuid() const;
 
       /// \brief Get the message type.
       /// \return Message type (ADVERTISE, SUBSCRIPTION, ...)
@@ -89,13 +103,19 @@ namespace ignition
       /// \return Message flags used for compression or other optional features.
       public: uint16_t GetFlags() const;
 
+      /// \brief Get the partition hash.
+      /// \return Hash of the partition of the topic contained in the message
+      /// or 0 if the message does not belong to any partition.
+      /// \sa TopicUtils::GetPartitionHash.
+      public: uint32_t GetPartitionHash() const;
+
       /// \brief Set the discovery protocol version.
       /// \param[in] _version Discovery protocol version.
       public: void SetVersion(const uint16_t _version);
 
       /// \brief Set the process uuid.
       /// \param[in] _pUuid A unique global identifier for every process.
-      public: void SetPUuid(const std::string &_pUuid);
+      public: void SetPUuid(const Uuid &_pUuid);
 
       /// \brief Set the message type.
       /// \param[in] _type Message type (ADVERTISE, SUBSCRIPTION, ...).
@@ -105,6 +125,11 @@ namespace ignition
       /// \param[in] _flags Used for enable optional features.
       public: void SetFlags(const uint16_t _flags);
 
+      /// \brief Set the partition hash.
+      /// \param[in] _hash Hash of the partition of the topic contained in the
+      /// message or 0 if the message does not belong to any partition.
+      public: void SetPartitionHash(const uint32_t _hash);
+
       /// \brief Get the header length.
       /// \return The header length in bytes.
       public: int GetHeaderLength();
@@ -118,7 +143,10 @@ namespace ignition
 
       /// \brief Unserialize the header.
       /// \param[in] _buffer Input buffer with the data to be unserialized.
-      public: size_t Unpack(const char *_buffer);
+      /// \param[in] _len Number of bytes available in the buffer.
+      /// \return The number of bytes from the header or 0 if the buffer is
+      /// NULL or shorter than the header.
+      public: size_t Unpack(const char *_buffer, const size_t _len);
 
       /// \brief Stream insertion operator.
       /// \param[out] _out The output stream.
@@ -138,14 +166,18 @@ namespace ignition
       /// \brief Discovery protocol version.
       private: uint16_t version = 0;
 
-      /// \brief Global identifier. Every process has a unique guid.
-      private: std::string pUuid = "";
+      /// \brief Global identifier. Every process has a unique guid. It is
+      /// sent in its binary form (Uuid::Size bytes).
+      private: Uuid pUuid;
 
       /// \brief Message type (ADVERTISE, SUBSCRIPTION, ...).
       private: uint8_t type = Uninitialized;
 
       /// \brief Optional flags that you want to include in the header.
       private: uint16_t flags = 0;
+
+      /// \brief Hash of the partition of the topic contained in the message.
+      private: uint32_t partitionHash = 0;
     };
 
     /// \class SubscriptionMsg Packet.hh ignition/transport/Packet.hh
@@ -178,6 +210,17 @@ namespace ignition
       /// \param[in] _topic Topic name.
       public: void SetTopic(const std::string &_topic);
 
+      /// \brief Get the list of known answers. A known answer is the UUID of
+      /// a node that the sender already knows is advertising the topic. These
+      /// nodes do not need to answer the subscription request.
+      /// \return List of node UUIDs.
+      public: std::vector<Uuid> GetKnownAnswers() const;
+
+      /// \brief Set the list of known answers.
+      /// \param[in] _nUuids List of node UUIDs.
+      /// \sa GetKnownAnswers.
+      public: void SetKnownAnswers(const std::vector<Uuid> &_nUuids);
+
       /// \brief Get the total length of the message.
       /// \return Return the length of the message in bytes.
       public: size_t GetMsgLength();
@@ -192,24 +235,37 @@ namespace ignition
              << "Body:" << std::endl
              << "\tTopic: [" << _msg.GetTopic() << "]" << std::endl;
 
+        for (auto const &nUuid : _msg.GetKnownAnswers())
+          _out << "\tKnown answer: [" << nUuid << "]" << std::endl;
+
         return _out;
       }
 
-      /// \brief Serialize the subscription message.
+      /// \brief Serialize the subscription message. The known answers are
+      /// appended after the topic and the 'KnownAnswersFlag' flag of the
+      /// header is set when the list is not empty. Receivers that do not
+      /// understand the flag ignore the extra bytes.
       /// \param[out] _buffer Buffer where the message will be serialized.
       /// \return The length of the serialized message in bytes.
       public: size_t Pack(char *_buffer);
 
-      /// \brief Unserialize a stream of bytes into a Sub.
+      /// \brief Unserialize a stream of bytes into a Sub. The header should
+      /// be set before calling this function, because the known answers are
+      /// only unpacked when the 'KnownAnswersFlag' flag is set.
       /// \param[out] _buffer Unpack the body from the buffer.
-      /// \return The number of bytes from the body.
-      public: size_t UnpackBody(char *_buffer);
+      /// \param[in] _len Number of bytes available in the buffer.
+      /// \return The number of bytes from the body or 0 if the body is
+      /// truncated or contains more than 'MaxKnownAnswers' known answers.
+      public: size_t UnpackBody(char *_buffer, const size_t _len);
 
       /// \brief Message header.
       private: Header header;
 
       /// \brief Topic.
       private: std::string topic = "";
+
+      /// \brief List of known answers (node UUIDs).
+      private: std::vector<Uuid> knownAnswers;
     };
 
     /// \class AdvertiseBase Packet.hh ignition/transport/Packet.hh
@@ -233,7 +289,7 @@ namespace ignition
                                const std::string &_topic,
                                const std::string &_addr,
                                const std::string &_ctrl,
-                               const std::string &_nUuid,
+                               const Uuid &_nUuid,
                                const Scope &_scope);
 
       /// \brief Get the message header.
@@ -254,7 +310,7 @@ namespace ignition
 
       /// \brief Get the node UUID.
       /// \return Return the node UUID.
-      public: std::string GetNodeUuid() const;
+      public: Uuid GetNodeUuid() const;
 
       /// \brief Get the topic scope.
       /// \return Return the topic scope.
@@ -278,7 +334,7 @@ namespace ignition
 
       /// \brief Set the node UUID.
       /// \param[in] _nUuid Node UUID.
-      public: void SetNodeUuid(const std::string &_nUuid);
+      public: void SetNodeUuid(const Uuid &_nUuid);
 
       /// \brief Set the topic scope.
       /// \param[in] _scope Topic scope.
@@ -333,8 +389,9 @@ namespace ignition
       /// \brief ZMQ valid address (e.g., "tcp://10.0.0.1:6000").
       private: std::string ctrl = "";
 
-      /// \brief Node's UUID.
-      private: std::string nUuid = "";
+      /// \brief Node's UUID. It is sent in its binary form (Uuid::Size
+      /// bytes).
+      private: Uuid nUuid;
 
       // Topic scope;
       private: Scope scope = Scope::All;
@@ -361,7 +418,7 @@ namespace ignition
                            const std::string &_topic,
                            const std::string &_addr,
                            const std::string &_ctrl,
-                           const std::string &_nUuid,
+                           const Uuid &_nUuid,
                            const Scope &_scope,
                            const std::string &_msgTypeName);
 
@@ -419,7 +476,7 @@ namespace ignition
                            const std::string &_topic,
                            const std::string &_addr,
                            const std::string &_ctrl,
-                           const std::string &_nUuid,
+                           const Uuid &_nUuid,
                            const Scope &_scope,
                            const std::string &_reqTypeName,
                            const std::string &_repTypeName);
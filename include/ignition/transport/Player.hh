@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2015 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef __IGN_TRANSPORT_PLAYER_HH_INCLUDED__
+#define __IGN_TRANSPORT_PLAYER_HH_INCLUDED__
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "ignition/transport/Helpers.hh"
+#include "ignition/transport/Log.hh"
+#include "ignition/transport/Node.hh"
+
+namespace ignition
+{
+  namespace transport
+  {
+    /// \class Player Player.hh ignition/transport/Player.hh
+    /// \brief Replay a log written by the Recorder. The messages are
+    /// published on their original topics, preserving the relative time
+    /// between them (optionally scaled). The payloads are published straight
+    /// from the mapped log segments, without being parsed or copied. To keep
+    /// the timing accurate, the player sleeps until shortly before each
+    /// message is due and busy-waits for the rest of the time (see Pacer).
+    class IGNITION_VISIBLE Player
+    {
+      /// \brief Constructor. The partition is read from IGN_PARTITION.
+      public: Player();
+
+      /// \brief Constructor.
+      /// \param[in] _partition Partition where the messages are published.
+      public: explicit Player(const std::string &_partition);
+
+      /// \brief Destructor.
+      public: virtual ~Player();
+
+      /// \brief Open a log and advertise all its topics.
+      /// \param[in] _dir Directory of the log.
+      /// \return True when success or false otherwise.
+      public: bool Open(const std::string &_dir);
+
+      /// \brief Play the log from the beginning. This function blocks until
+      /// all the messages have been published or Stop() is called.
+      /// \param[in] _rate Playback rate (e.g. 2.0 plays twice as fast as
+      /// the original). A rate <= 0 publishes as fast as possible.
+      /// \return True when all the messages were published.
+      public: bool Play(const double _rate = 1.0);
+
+      /// \brief Interrupt Play(). It can be called from any thread.
+      public: void Stop();
+
+      /// \brief Get the log being played.
+      /// \return The log reader.
+      public: const LogReader &GetLog() const;
+
+      /// \brief Get the number of messages published by the last Play().
+      /// \return Number of messages.
+      public: uint64_t GetMessages() const;
+
+      /// \brief Get the number of payload bytes published by the last Play().
+      /// \return Number of bytes.
+      public: uint64_t GetBytes() const;
+
+      /// \brief Get the duration that the last Play() should have taken,
+      /// this is, the time spanned by the messages divided by the rate.
+      /// \return Duration in nanoseconds.
+      public: uint64_t GetRequestedDuration() const;
+
+      /// \brief Get the duration that the last Play() took.
+      /// \return Duration in nanoseconds.
+      public: uint64_t GetDuration() const;
+
+      /// \brief Get the mean delay of the messages published by the last
+      /// Play() with respect to their scheduled time.
+      /// \return Mean timing error in nanoseconds.
+      public: uint64_t GetMeanError() const;
+
+      /// \brief Get the maximum delay of a message published by the last
+      /// Play() with respect to its scheduled time.
+      /// \return Max timing error in nanoseconds.
+      public: uint64_t GetMaxError() const;
+
+      /// \brief Node used to publish.
+      private: std::unique_ptr<Node> node;
+
+      /// \brief Log.
+      private: LogReader reader;
+
+      /// \brief When true, Play() returns.
+      private: std::atomic<bool> stop;
+
+      /// \brief Messages published.
+      private: uint64_t messages = 0;
+
+      /// \brief Bytes published.
+      private: uint64_t bytes = 0;
+
+      /// \brief Requested duration (ns).
+      private: uint64_t requestedDuration = 0;
+
+      /// \brief Achieved duration (ns).
+      private: uint64_t duration = 0;
+
+      /// \brief Accumulated timing error (ns).
+      private: uint64_t totalError = 0;
+
+      /// \brief Max timing error (ns).
+      private: uint64_t maxError = 0;
+    };
+  }
+}
+#endif
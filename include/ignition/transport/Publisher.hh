@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2015 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef __IGN_TRANSPORT_PUBLISHER_HH_INCLUDED__
+#define __IGN_TRANSPORT_PUBLISHER_HH_INCLUDED__
+
+#ifdef _MSC_VER
+# pragma warning(push, 0)
+#endif
+#include <zmq.hpp>
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "ignition/transport/Helpers.hh"
+#include "ignition/transport/NodeShared.hh"
+#include "ignition/transport/Statistics.hh"
+
+namespace ignition
+{
+  namespace transport
+  {
+    /// \class Publication Publisher.hh ignition/transport/Publisher.hh
+    /// \brief State of a topic published by this process, shared by all
+    /// the publishers of the topic. Everything that the publication path
+    /// needs is computed once, and the subscriber flags are kept up to date
+    /// by NodeShared, so a message can be sent without any string work and
+    /// without the NodeShared mutex.
+    class IGNITION_VISIBLE Publication
+    {
+      /// \brief Constructor.
+      /// \param[in] _topic Fully qualified topic name.
+      /// \param[in] _counters Counters of the topic.
+      /// \param[in] _handlersId Identifier of the topic in
+      /// NodeShared::localSubscriptions.
+      public: Publication(const std::string &_topic,
+                          const TopicCountersPtr &_counters,
+                          const size_t _handlersId);
+
+      /// \brief Fully qualified topic name.
+      public: const std::string topic;
+
+      /// \brief Topic name without the partition.
+      public: const std::string topicName;
+
+      /// \brief Topic frame of the 0MQ messages. It is copied (not rebuilt)
+      /// for each message, holding NodeShared::publisherMutex.
+      public: zmq::message_t topicFrame;
+
+      /// \brief Counters of the topic.
+      public: const TopicCountersPtr counters;
+
+      /// \brief Identifier of the topic in NodeShared::localSubscriptions.
+      public: const size_t handlersId;
+
+      /// \brief Last sequence number assigned to the topic.
+      public: std::atomic<uint64_t> sequence{0};
+
+      /// \brief True if a node of this process is subscribed to the topic.
+      public: std::atomic<bool> hasLocal{false};
+
+      /// \brief True if a remote node is subscribed to the topic.
+      public: std::atomic<bool> hasRemote{false};
+    };
+
+    /// \class PublisherState Publisher.hh ignition/transport/Publisher.hh
+    /// \brief State of a Publisher handle, shared by its copies and by the
+    /// node that created it.
+    class IGNITION_VISIBLE PublisherState
+    {
+      /// \brief Publication of the topic.
+      public: std::shared_ptr<Publication> publication;
+
+      /// \brief Message type name.
+      public: std::string type;
+
+      /// \brief Sender frame (see MessageInfo::Pack()) with the address of
+      /// this process and the message type. Only the metadata changes
+      /// between messages.
+      public: std::string header;
+
+      /// \brief Cleared when the node unadvertises the topic or it is
+      /// destroyed.
+      public: std::atomic<bool> advertised{true};
+    };
+
+    /// \def PublisherStatePtr
+    /// \brief Shared pointer to PublisherState.
+    typedef std::shared_ptr<PublisherState> PublisherStatePtr;
+
+    /// \class Publisher Publisher.hh ignition/transport/Publisher.hh
+    /// \brief Handle returned by Node::Advertise<T>() to publish messages
+    /// of type T on a topic. Publishing through the handle skips the
+    /// validation and the lookups of Node::Publish(). The handle can be
+    /// copied and it becomes invalid when the node unadvertises the topic
+    /// or it is destroyed.
+    template <typename T> class Publisher
+    {
+      /// \brief Default constructor. The handle is not valid.
+      public: Publisher() = default;
+
+      /// \brief Constructor.
+      /// \param[in] _state State of the handle.
+      public: explicit Publisher(const PublisherStatePtr &_state)
+        : state(_state)
+      {
+      }
+
+      /// \brief Check if the handle can publish.
+      /// \return True if the topic is advertised.
+      public: bool Valid() const
+      {
+        return this->state && this->state->advertised;
+      }
+
+      /// \brief Check if the handle can publish.
+      /// \return True if the topic is advertised.
+      public: explicit operator bool() const
+      {
+        return this->Valid();
+      }
+
+      /// \brief Get the topic name.
+      /// \return The topic name (without the partition) or an empty string
+      /// if the handle was never valid.
+      public: std::string Topic() const
+      {
+        if (!this->state)
+          return "";
+        return this->state->publication->topicName;
+      }
+
+      /// \brief Check if there are local or remote subscribers.
+      /// \return True if someone is subscribed to the topic.
+      public: bool HasSubscribers() const
+      {
+        return this->Valid() &&
+          (this->state->publication->hasLocal ||
+           this->state->publication->hasRemote);
+      }
+
+      /// \brief Publish a message.
+      /// \param[in] _msg Message to publish.
+      /// \return True when success or false if the handle is not valid or
+      /// the message could not be sent.
+      public: bool Publish(const T &_msg)
+      {
+        if (!this->Valid())
+          return false;
+
+        return NodeShared::GetInstance()->Publish(*this->state, _msg);
+      }
+
+      /// \brief State of the handle.
+      private: PublisherStatePtr state;
+    };
+  }
+}
+#endif
@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2015 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef __IGN_TRANSPORT_RECORDER_HH_INCLUDED__
+#define __IGN_TRANSPORT_RECORDER_HH_INCLUDED__
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ignition/transport/Helpers.hh"
+#include "ignition/transport/Log.hh"
+#include "ignition/transport/MessageInfo.hh"
+#include "ignition/transport/Node.hh"
+
+namespace ignition
+{
+  namespace transport
+  {
+    /// \class Recorder Recorder.hh ignition/transport/Recorder.hh
+    /// \brief Record the messages published on a partition into a log (see
+    /// LogWriter). The recorder uses raw subscriptions, so the messages are
+    /// never deserialized. When no topics are specified, the recorder
+    /// periodically checks the discovery information and records every
+    /// topic advertised in the partition.
+    class IGNITION_VISIBLE Recorder
+    {
+      /// \brief Constructor. The partition is read from IGN_PARTITION.
+      public: Recorder();
+
+      /// \brief Constructor.
+      /// \param[in] _partition Partition to record.
+      public: explicit Recorder(const std::string &_partition);
+
+      /// \brief Destructor. Stops the recording.
+      public: virtual ~Recorder();
+
+      /// \brief Start recording.
+      /// \param[in] _dir Directory of the log.
+      /// \param[in] _topics Topics to record. Empty to record all the topics
+      /// of the partition, including the topics that appear later.
+      /// \param[in] _segmentSize Size of each log segment in bytes.
+      /// \return True when success or false otherwise.
+      public: bool Start(const std::string &_dir,
+                    const std::vector<std::string> &_topics =
+                      std::vector<std::string>(),
+                    const uint64_t _segmentSize = LogWriter::DefSegmentSize);
+
+      /// \brief Stop recording and close the log.
+      public: void Stop();
+
+      /// \brief Check if the recorder is running.
+      /// \return True if the recorder is running.
+      public: bool IsRecording() const;
+
+      /// \brief Get the topics recorded so far.
+      /// \return The list of topics.
+      public: std::vector<std::string> GetTopics() const;
+
+      /// \brief Get the number of messages recorded.
+      /// \return Number of messages.
+      public: uint64_t GetMessages() const;
+
+      /// \brief Get the number of bytes written to the log.
+      /// \return Number of bytes.
+      public: uint64_t GetBytes() const;
+
+      /// \brief Get the number of messages that could not be written.
+      /// \return Number of messages.
+      public: uint64_t GetDropped() const;
+
+      /// \brief Time between two checks of the advertised topics (ms).
+      public: static const unsigned int DiscoveryPeriod = 500;
+
+      /// \brief Subscribe to a topic (if not subscribed before).
+      /// \param[in] _topic Topic name.
+      private: void Subscribe(const std::string &_topic);
+
+      /// \brief Raw subscription callback.
+      /// \param[in] _topic Topic name.
+      /// \param[in] _data Serialized message.
+      /// \param[in] _size Size of the message.
+      /// \param[in] _info Metadata of the message.
+      private: void OnMessage(const std::string &_topic, const char *_data,
+                              const size_t _size, const MessageInfo &_info);
+
+      /// \brief Subscribe to the new topics advertised in the partition.
+      private: void RunDiscoveryTask();
+
+      /// \brief Node used for the subscriptions.
+      private: std::unique_ptr<Node> node;
+
+      /// \brief Log.
+      private: LogWriter writer;
+
+      /// \brief Protect the log. The callbacks are executed by the transport
+      /// threads and by the publishers of this process.
+      private: mutable std::mutex writerMutex;
+
+      /// \brief Messages that could not be written.
+      private: uint64_t dropped = 0;
+
+      /// \brief Topics subscribed.
+      private: std::set<std::string> topics;
+
+      /// \brief Protect the list of topics.
+      private: mutable std::mutex topicsMutex;
+
+      /// \brief Thread that looks for new topics.
+      private: std::thread discoveryThread;
+
+      /// \brief When true, the discovery thread will finish.
+      private: bool exit = false;
+
+      /// \brief Protect 'exit'.
+      private: std::mutex exitMutex;
+
+      /// \brief Used to wake up the discovery thread.
+      private: std::condition_variable exitCv;
+
+      /// \brief True while recording.
+      private: bool recording = false;
+    };
+  }
+}
+#endif
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2015 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef __IGN_TRANSPORT_RELAY_HH_INCLUDED__
+#define __IGN_TRANSPORT_RELAY_HH_INCLUDED__
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "ignition/transport/Helpers.hh"
+#include "ignition/transport/MessageInfo.hh"
+#include "ignition/transport/Node.hh"
+
+namespace ignition
+{
+  namespace transport
+  {
+    class NodeShared;
+
+    /// \class Relay Relay.hh ignition/transport/Relay.hh
+    /// \brief Republish the messages of remote publishers. A relay subscribes
+    /// once to each topic (without deserializing the messages) and sends
+    /// them to its own subscribers, so the cost of sending a message to many
+    /// subscribers moves from the original publisher to the relay host.
+    ///
+    /// The topics are advertised with a relay flag. Subscribers ignore
+    /// relays, unless they set IGN_TRANSPORT_PREFER_RELAY=1: then they
+    /// receive a topic only through a relay when there is one, and fall back
+    /// to the original publishers when the relay disappears. The relayed
+    /// messages keep the send time of the original publisher.
+    class IGNITION_VISIBLE Relay
+    {
+      /// \brief Constructor. The partition is read from IGN_PARTITION.
+      public: Relay();
+
+      /// \brief Constructor.
+      /// \param[in] _partition Partition of the relayed topics.
+      public: explicit Relay(const std::string &_partition);
+
+      /// \brief Destructor. Stops the relay.
+      public: virtual ~Relay();
+
+      /// \brief Start relaying.
+      /// \param[in] _topics Topics to relay.
+      /// \return True when success or false otherwise.
+      public: bool Start(const std::vector<std::string> &_topics);
+
+      /// \brief Stop relaying.
+      public: void Stop();
+
+      /// \brief Check if the relay is running.
+      /// \return True if the relay is running.
+      public: bool IsRunning() const;
+
+      /// \brief Get the relayed topics.
+      /// \return The list of topics.
+      public: std::vector<std::string> GetTopics() const;
+
+      /// \brief Get the number of messages relayed.
+      /// \return Number of messages.
+      public: uint64_t GetMessages() const;
+
+      /// \brief Get the number of bytes relayed.
+      /// \return Number of bytes.
+      public: uint64_t GetBytes() const;
+
+      /// \brief Raw subscription callback.
+      /// \param[in] _topic Topic name.
+      /// \param[in] _data Serialized message.
+      /// \param[in] _size Size of the message.
+      /// \param[in] _info Metadata of the message.
+      private: void OnMessage(const std::string &_topic, const char *_data,
+                              const size_t _size, const MessageInfo &_info);
+
+      /// \brief Node used for the subscriptions.
+      private: std::unique_ptr<Node> node;
+
+      /// \brief Shared transport data.
+      private: NodeShared *shared;
+
+      /// \brief UUID used to advertise the relayed topics.
+      private: std::string nUuid;
+
+      /// \brief Relayed topics. The key is the topic name and the value is
+      /// the fully qualified topic name.
+      private: std::map<std::string, std::string> topics;
+
+      /// \brief Messages relayed.
+      private: uint64_t messages = 0;
+
+      /// \brief Bytes relayed.
+      private: uint64_t bytes = 0;
+
+      /// \brief True while relaying.
+      private: bool running = false;
+    };
+  }
+}
+#endif
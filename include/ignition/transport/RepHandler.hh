@@ -25,6 +25,7 @@
 #ifdef _MSC_VER
 # pragma warning(pop)
 #endif
+#include <atomic>
 #include <functional>
 #include <iostream>
 #include <memory>
@@ -43,7 +44,7 @@ namespace ignition
     {
       /// \brief Constructor.
       public: IRepHandler()
-        : hUuid(Uuid().ToString())
+        : hUuid()
       {
       }
 
@@ -73,14 +74,14 @@ namespace ignition
                                        bool &_result) = 0;
 
       /// \brief Get the unique UUID of this handler.
-      /// \return a string representation of the handler UUID.
-      public: std::string GetHandlerUuid() const
+      /// \return The handler UUID.
+      public: Uuid GetHandlerUuid() const
       {
         return this->hUuid;
       }
 
       /// \brief Unique handler's UUID.
-      protected: std::string hUuid;
+      protected: Uuid hUuid;
     };
 
     /// \class RepHandler RepHandler.hh
@@ -108,6 +109,25 @@ namespace ignition
         this->cb = _cb;
       }
 
+      /// \brief Parse the requests into a message owned by the handler and
+      /// reuse another one for the responses, instead of creating new
+      /// messages for each request. See SubscriptionHandler::SetReuseMsg().
+      /// The messages passed to the callback are only valid during the
+      /// callback: they have to be copied to keep them.
+      /// \param[in] _reuse True to enable the reuse of the messages.
+      public: void SetReuseMsg(const bool _reuse)
+      {
+        this->reuse = _reuse;
+      }
+
+      /// \brief Check if the handler reuses the request and response
+      /// messages.
+      /// \return True if the reuse is enabled.
+      public: bool ReuseMsg() const
+      {
+        return this->reuse;
+      }
+
       // Documentation inherited.
       public: void RunLocalCallback(const std::string &_topic,
                                     const transport::ProtoMsg &_msgReq,
@@ -143,15 +163,32 @@ namespace ignition
         // Execute the callback (if existing).
         if (this->cb)
         {
+          // Remove the partition part from the topic.
+          std::string topicName = _topic;
+          topicName.erase(0, topicName.find_last_of("@") + 1);
+
+          // Use the messages of the handler, unless they are already in use.
+          if (this->reuse && !this->busy.exchange(true))
+          {
+            if (!this->reusedReq)
+            {
+              this->reusedReq.reset(new Req());
+              this->reusedRep.reset(new Rep());
+            }
+            this->reusedReq->ParseFromString(_req);
+            this->reusedRep->Clear();
+
+            this->cb(topicName, *this->reusedReq, *this->reusedRep, _result);
+            this->reusedRep->SerializeToString(&_rep);
+            this->busy = false;
+            return;
+          }
+
           // Instantiate the specific protobuf message associated to this topic.
           Rep msgRep;
 
           auto msgReq = this->CreateMsg(_req);
 
-          // Remove the partition part from the topic.
-          std::string topicName = _topic;
-          topicName.erase(0, topicName.find_last_of("@") + 1);
-
           this->cb(topicName, *msgReq, msgRep, _result);
           msgRep.SerializeToString(&_rep);
         }
@@ -180,6 +217,82 @@ namespace ignition
       /// \brief Callback to the function registered for this handler.
       private: std::function
         <void(const std::string &, const Req &, Rep &, bool &)> cb;
+
+      /// \brief When true, the requests are parsed into reusedReq and
+      /// the responses are written into reusedRep.
+      private: bool reuse = false;
+
+      /// \brief Request message reused for each request.
+      private: std::unique_ptr<Req> reusedReq;
+
+      /// \brief Response message reused for each request.
+      private: std::unique_ptr<Rep> reusedRep;
+
+      /// \brief True while the messages are in use.
+      private: std::atomic<bool> busy{false};
+    };
+
+    /// \class RawRepHandler RepHandler.hh
+    /// \brief Service reply handler that passes the serialized request to
+    /// the callback and sends the serialized response written by it,
+    /// without creating any protobuf message.
+    class RawRepHandler : public IRepHandler
+    {
+      /// \brief Constructor.
+      /// \param[in] _cb Callback executed for each request.
+      public: explicit RawRepHandler(const RawRepCallback &_cb)
+        : cb(_cb)
+      {
+      }
+
+      // Documentation inherited.
+      public: void RunLocalCallback(const std::string &_topic,
+                                    const transport::ProtoMsg &_msgReq,
+                                    transport::ProtoMsg &_msgRep,
+                                    bool &_result)
+      {
+        std::string req;
+        std::string rep;
+        if (!_msgReq.SerializeToString(&req))
+        {
+          std::cerr << "RawRepHandler::RunLocalCallback() error: "
+                    << "Unable to serialize the request" << std::endl;
+          _result = false;
+          return;
+        }
+
+        this->RunCallback(_topic, req, rep, _result);
+        if (_result && !_msgRep.ParseFromString(rep))
+        {
+          std::cerr << "RawRepHandler::RunLocalCallback() error: "
+                    << "Unable to parse the response" << std::endl;
+          _result = false;
+        }
+      }
+
+      // Documentation inherited.
+      public: void RunCallback(const std::string &_topic,
+                               const std::string &_req,
+                               std::string &_rep,
+                               bool &_result)
+      {
+        if (!this->cb)
+        {
+          std::cerr << "RawRepHandler::RunCallback() error: "
+                    << "Callback is NULL" << std::endl;
+          _result = false;
+          return;
+        }
+
+        // Remove the partition part from the topic.
+        std::string topicName = _topic;
+        topicName.erase(0, topicName.find_last_of("@") + 1);
+
+        this->cb(topicName, _req, _rep, _result);
+      }
+
+      /// \brief Callback registered for this handler.
+      private: RawRepCallback cb;
     };
   }
 }
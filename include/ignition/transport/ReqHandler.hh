@@ -19,6 +19,7 @@
 #define __IGN_TRANSPORT_REQHANDLER_HH_INCLUDED__
 
 #include <google/protobuf/message.h>
+#include <chrono>
 #include <condition_variable>
 #include <functional>
 #include <iostream>
@@ -41,10 +42,11 @@ namespace ignition
       public: IReqHandler(const std::string &_nUuid)
         : rep(""),
           result(false),
-          hUuid(Uuid().ToString()),
+          hUuid(),
           nUuid(_nUuid),
           requested(false),
-          repAvailable(false)
+          repAvailable(false),
+          creationTime(std::chrono::steady_clock::now())
       {
       }
 
@@ -101,13 +103,20 @@ namespace ignition
       /// \return The serialized data.
       public: virtual std::string Serialize() = 0;
 
-      /// \brief Returns the unique handler UUID.
-      /// \return The handler's UUID.
-      public: std::string GetHandlerUuid() const
+      /// \brief Get the unique UUID of this handler.
+      /// \return The handler UUID.
+      public: Uuid GetHandlerUuid() const
       {
         return this->hUuid;
       }
 
+      /// \brief Get the time when the request was created.
+      /// \return The creation time.
+      public: std::chrono::steady_clock::time_point GetCreationTime() const
+      {
+        return this->creationTime;
+      }
+
       /// \brief Block the current thread until the response to the
       /// service request is available or until the timeout expires.
       /// This method uses a condition variable to notify when the response is
@@ -138,7 +147,7 @@ namespace ignition
       protected: bool result;
 
       /// \brief Unique handler's UUID.
-      protected: std::string hUuid;
+      protected: Uuid hUuid;
 
       /// \brief Node UUID.
       private: std::string nUuid;
@@ -151,6 +160,10 @@ namespace ignition
       /// be unlocked when a service call REP is available. This variable
       /// captures if we have found a node that can satisty our request.
       public: bool repAvailable;
+
+      /// \brief Time when the request was created. Used to measure the
+      /// service call latency.
+      private: std::chrono::steady_clock::time_point creationTime;
     };
 
     /// \class ReqHandler ReqHandler.hh
@@ -248,6 +261,43 @@ namespace ignition
       private: std::function<void(const std::string &_topic, const Rep &_rep,
         bool _result)> cb;
     };
+
+    /// \class RawReqHandler ReqHandler.hh
+    /// \brief Request handler for a service request that is already
+    /// serialized. The response is stored without deserializing it and is
+    /// available with GetRep() once the request has been executed.
+    class RawReqHandler : public IReqHandler
+    {
+      /// \brief Constructor.
+      /// \param[in] _nUuid UUID of the node registering the handler.
+      /// \param[in] _req Serialized request.
+      public: RawReqHandler(const std::string &_nUuid,
+                            const std::string &_req)
+        : IReqHandler(_nUuid),
+          req(_req)
+      {
+      }
+
+      // Documentation inherited.
+      public: std::string Serialize()
+      {
+        return this->req;
+      }
+
+      // Documentation inherited.
+      public: void NotifyResult(const std::string &/*_topic*/,
+                                const std::string &_rep,
+                                const bool _result)
+      {
+        this->rep = _rep;
+        this->result = _result;
+        this->repAvailable = true;
+        this->condition.notify_one();
+      }
+
+      /// \brief Serialized request.
+      private: std::string req;
+    };
   }
 }
 
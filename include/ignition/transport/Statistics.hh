@@ -0,0 +1,332 @@
+/*
+ * Copyright (C) 2015 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef __IGN_TRANSPORT_STATISTICS_HH_INCLUDED__
+#define __IGN_TRANSPORT_STATISTICS_HH_INCLUDED__
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ignition/transport/Helpers.hh"
+
+namespace ignition
+{
+  namespace transport
+  {
+    /// \class TopicStatistics Statistics.hh
+    /// ignition/transport/Statistics.hh
+    /// \brief Snapshot of the counters of a topic in this process.
+    class IGNITION_VISIBLE TopicStatistics
+    {
+      /// \brief Messages published.
+      public: uint64_t published = 0;
+
+      /// \brief Bytes sent to remote subscribers.
+      public: uint64_t bytesPublished = 0;
+
+      /// \brief Time spent serializing published messages (ns).
+      public: uint64_t serializationTime = 0;
+
+      /// \brief Messages received (local or remote).
+      public: uint64_t received = 0;
+
+      /// \brief Bytes received from remote publishers.
+      public: uint64_t bytesReceived = 0;
+
+      /// \brief Time spent executing the subscription callbacks, including
+      /// the deserialization of remote messages (ns).
+      public: uint64_t callbackTime = 0;
+
+      /// \brief Messages that could not be sent or delivered.
+      public: uint64_t dropped = 0;
+
+      /// \brief Messages lost, detected by gaps in the sequence numbers of
+      /// the remote publishers.
+      public: uint64_t lost = 0;
+
+      /// \brief Number of latency samples. Only the messages received from
+      /// publishers in the same host are measured.
+      public: uint64_t latencySamples = 0;
+
+      /// \brief Total time between the publication and the reception (ns).
+      public: uint64_t latencyTotal = 0;
+
+      /// \brief Longest time between the publication and the reception (ns).
+      public: uint64_t latencyMax = 0;
+
+      /// \brief Messages waiting in the reception queue of the topic. Only
+      /// used by topics with queue limits.
+      public: uint64_t queuedMessages = 0;
+
+      /// \brief Bytes waiting in the reception queue of the topic.
+      public: uint64_t queuedBytes = 0;
+
+      /// \brief Number of times that the reception queue reached its limits.
+      public: uint64_t limitReached = 0;
+    };
+
+    /// \class ServiceStatistics Statistics.hh
+    /// ignition/transport/Statistics.hh
+    /// \brief Snapshot of the counters of a service in this process.
+    class IGNITION_VISIBLE ServiceStatistics
+    {
+      /// \brief Requests made.
+      public: uint64_t requests = 0;
+
+      /// \brief Responses received.
+      public: uint64_t responses = 0;
+
+      /// \brief Responses received with a false result.
+      public: uint64_t failures = 0;
+
+      /// \brief Blocking requests that expired before receiving a response.
+      public: uint64_t timeouts = 0;
+
+      /// \brief Total time between a request and its response (ns).
+      public: uint64_t latencyTotal = 0;
+
+      /// \brief Longest time between a request and its response (ns).
+      public: uint64_t latencyMax = 0;
+
+      /// \brief Requests served by the repliers of this process.
+      public: uint64_t served = 0;
+
+      /// \brief Time spent executing the service callbacks (ns).
+      public: uint64_t callbackTime = 0;
+    };
+
+    /// \class TopicCounters Statistics.hh
+    /// ignition/transport/Statistics.hh
+    /// \brief Live counters of a topic. All the counters are atomic, so they
+    /// can be updated from any thread without taking a lock.
+    class IGNITION_VISIBLE TopicCounters
+    {
+      /// \brief Account for a published message.
+      /// \param[in] _bytes Bytes sent to remote subscribers.
+      /// \param[in] _serializationTime Serialization time (ns).
+      public: void AddPublished(const uint64_t _bytes,
+                                const uint64_t _serializationTime);
+
+      /// \brief Account for a received message.
+      /// \param[in] _bytes Bytes received from a remote publisher.
+      public: void AddReceived(const uint64_t _bytes);
+
+      /// \brief Account for the execution of a subscription callback.
+      /// \param[in] _time Execution time (ns).
+      public: void AddCallbackTime(const uint64_t _time);
+
+      /// \brief Account for a message that could not be sent or delivered.
+      public: void AddDropped();
+
+      /// \brief Account for messages lost.
+      /// \param[in] _count Number of messages lost.
+      public: void AddLost(const uint64_t _count);
+
+      /// \brief Account for the latency of a received message.
+      /// \param[in] _latency Time between the publication and the reception
+      /// (ns).
+      public: void AddLatency(const uint64_t _latency);
+
+      /// \brief Update the size of the reception queue.
+      /// \param[in] _messages Messages in the queue.
+      /// \param[in] _bytes Bytes in the queue.
+      public: void SetQueued(const uint64_t _messages, const uint64_t _bytes);
+
+      /// \brief Account for a reception queue that reached its limits.
+      public: void AddLimitReached();
+
+      /// \brief Get the current value of the counters.
+      /// \param[out] _stats Current value of the counters.
+      public: void Snapshot(TopicStatistics &_stats) const;
+
+      /// \brief Messages published.
+      private: std::atomic<uint64_t> published{0};
+
+      /// \brief Bytes published.
+      private: std::atomic<uint64_t> bytesPublished{0};
+
+      /// \brief Serialization time (ns).
+      private: std::atomic<uint64_t> serializationTime{0};
+
+      /// \brief Messages received.
+      private: std::atomic<uint64_t> received{0};
+
+      /// \brief Bytes received.
+      private: std::atomic<uint64_t> bytesReceived{0};
+
+      /// \brief Callback time (ns).
+      private: std::atomic<uint64_t> callbackTime{0};
+
+      /// \brief Messages dropped.
+      private: std::atomic<uint64_t> dropped{0};
+
+      /// \brief Messages lost.
+      private: std::atomic<uint64_t> lost{0};
+
+      /// \brief Latency samples.
+      private: std::atomic<uint64_t> latencySamples{0};
+
+      /// \brief Total latency (ns).
+      private: std::atomic<uint64_t> latencyTotal{0};
+
+      /// \brief Maximum latency (ns).
+      private: std::atomic<uint64_t> latencyMax{0};
+
+      /// \brief Messages in the reception queue.
+      private: std::atomic<uint64_t> queuedMessages{0};
+
+      /// \brief Bytes in the reception queue.
+      private: std::atomic<uint64_t> queuedBytes{0};
+
+      /// \brief Number of times that the queue limits were reached.
+      private: std::atomic<uint64_t> limitReached{0};
+    };
+
+    /// \class ServiceCounters Statistics.hh
+    /// ignition/transport/Statistics.hh
+    /// \brief Live counters of a service. All the counters are atomic, so
+    /// they can be updated from any thread without taking a lock.
+    class IGNITION_VISIBLE ServiceCounters
+    {
+      /// \brief Account for a new request.
+      public: void AddRequest();
+
+      /// \brief Account for a response.
+      /// \param[in] _result Result of the service call.
+      /// \param[in] _latency Time between the request and the response (ns).
+      public: void AddResponse(const bool _result, const uint64_t _latency);
+
+      /// \brief Account for a blocking request that expired.
+      public: void AddTimeout();
+
+      /// \brief Account for a request served by a local replier.
+      /// \param[in] _time Execution time of the service callback (ns).
+      public: void AddServed(const uint64_t _time);
+
+      /// \brief Get the current value of the counters.
+      /// \param[out] _stats Current value of the counters.
+      public: void Snapshot(ServiceStatistics &_stats) const;
+
+      /// \brief Requests made.
+      private: std::atomic<uint64_t> requests{0};
+
+      /// \brief Responses received.
+      private: std::atomic<uint64_t> responses{0};
+
+      /// \brief Failed responses.
+      private: std::atomic<uint64_t> failures{0};
+
+      /// \brief Expired requests.
+      private: std::atomic<uint64_t> timeouts{0};
+
+      /// \brief Total latency (ns).
+      private: std::atomic<uint64_t> latencyTotal{0};
+
+      /// \brief Maximum latency (ns).
+      private: std::atomic<uint64_t> latencyMax{0};
+
+      /// \brief Requests served.
+      private: std::atomic<uint64_t> served{0};
+
+      /// \brief Service callback time (ns).
+      private: std::atomic<uint64_t> callbackTime{0};
+    };
+
+    /// \def TopicCountersPtr
+    /// \brief Shared pointer to the counters of a topic.
+    typedef std::shared_ptr<TopicCounters> TopicCountersPtr;
+
+    /// \def ServiceCountersPtr
+    /// \brief Shared pointer to the counters of a service.
+    typedef std::shared_ptr<ServiceCounters> ServiceCountersPtr;
+
+    /// \class StatisticsStorage Statistics.hh
+    /// ignition/transport/Statistics.hh
+    /// \brief Store the counters of all the topics and services used in this
+    /// process. The storage is not thread safe: the caller must serialize the
+    /// calls (NodeShared uses its own mutex). The counters returned can be
+    /// updated and read without any lock and they are never removed from the
+    /// storage, so a counter pointer stays valid.
+    class IGNITION_VISIBLE StatisticsStorage
+    {
+      /// \brief Get the counters of a topic. The counters are created if
+      /// they do not exist.
+      /// \param[in] _topic Fully qualified topic name.
+      /// \return The counters of the topic.
+      public: TopicCountersPtr Topic(const std::string &_topic);
+
+      /// \brief Get the counters of a service. The counters are created if
+      /// they do not exist.
+      /// \param[in] _topic Fully qualified service name.
+      /// \return The counters of the service.
+      public: ServiceCountersPtr Service(const std::string &_topic);
+
+      /// \brief Get a snapshot of the counters of a topic.
+      /// \param[in] _topic Fully qualified topic name.
+      /// \param[out] _stats Snapshot of the counters.
+      /// \return True if the topic has counters or false otherwise.
+      public: bool GetTopicStats(const std::string &_topic,
+                                 TopicStatistics &_stats) const;
+
+      /// \brief Get a snapshot of the counters of a service.
+      /// \param[in] _topic Fully qualified service name.
+      /// \param[out] _stats Snapshot of the counters.
+      /// \return True if the service has counters or false otherwise.
+      public: bool GetServiceStats(const std::string &_topic,
+                                   ServiceStatistics &_stats) const;
+
+      /// \brief Get the list of topics with counters.
+      /// \param[out] _topics List of fully qualified topic names.
+      public: void GetTopicList(std::vector<std::string> &_topics) const;
+
+      /// \brief Get the list of services with counters.
+      /// \param[out] _services List of fully qualified service names.
+      public: void GetServiceList(std::vector<std::string> &_services) const;
+
+      /// \brief Topic counters. The key is the topic name.
+      private: std::map<std::string, TopicCountersPtr> topics;
+
+      /// \brief Service counters. The key is the service name.
+      private: std::map<std::string, ServiceCountersPtr> services;
+    };
+
+    /// \brief Get the CPU time consumed by a thread.
+    /// \param[in] _thread Thread. It must be running.
+    /// \return CPU time in nanoseconds or 0 if it is not available.
+    IGNITION_VISIBLE uint64_t ThreadCpuNs(std::thread &_thread);
+
+    /// \brief Get the CPU time consumed by this process (user plus system).
+    /// \return CPU time in nanoseconds or 0 if it is not available.
+    IGNITION_VISIBLE uint64_t ProcessCpuNs();
+
+    /// \brief Get the time elapsed since a given time point.
+    /// \param[in] _start Start time.
+    /// \return Elapsed time in nanoseconds.
+    inline uint64_t ElapsedNs(
+      const std::chrono::steady_clock::time_point &_start)
+    {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - _start).count();
+    }
+  }
+}
+#endif
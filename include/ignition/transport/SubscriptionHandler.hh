@@ -25,11 +25,13 @@
 #ifdef _MSC_VER
 # pragma warning(pop)
 #endif
+#include <atomic>
 #include <functional>
 #include <iostream>
 #include <memory>
 #include <string>
 #include "ignition/transport/Helpers.hh"
+#include "ignition/transport/MessageInfo.hh"
 #include "ignition/transport/TransportTypes.hh"
 #include "ignition/transport/Uuid.hh"
 
@@ -45,7 +47,7 @@ namespace ignition
       /// \brief Constructor.
       /// \param[in] _nUuid UUID of the node registering the handler.
       public: ISubscriptionHandler(const std::string &_nUuid)
-        : hUuid(Uuid().ToString()),
+        : hUuid(),
           nUuid(_nUuid)
       {
       }
@@ -58,18 +60,32 @@ namespace ignition
       /// \brief Executes the local callback registered for this handler.
       /// \param[in] _topic Topic to be passed to the callback.
       /// \param[in] _msg Protobuf message received.
+      /// \param[in] _info Metadata of the message.
       /// \return True when success, false otherwise.
       public: virtual bool RunLocalCallback(const std::string &_topic,
-                                           const transport::ProtoMsg &_msg) = 0;
+                                           const transport::ProtoMsg &_msg,
+                                           const MessageInfo &_info) = 0;
 
       /// \brief Executes the callback registered for this handler.
       /// \param[in] _topic Topic to be passed to the callback.
       /// \param[in] _data Serialized data received. The data will be used
       /// to compose a specific protobuf message and will be passed to the
       /// callback function.
+      /// \param[in] _info Metadata of the message.
       /// \return True when success, false otherwise.
       public: virtual bool RunCallback(const std::string &_topic,
-                                       const std::string &_data) = 0;
+                                       const std::string &_data,
+                                       const MessageInfo &_info) = 0;
+
+      /// \brief Check if the callback consumes the serialized message. The
+      /// publishers in the same process use it to serialize the message only
+      /// once for all the raw subscribers, and only when one exists.
+      /// \return True if the handler should be executed with RunCallback()
+      /// even for local messages.
+      public: virtual bool IsRaw() const
+      {
+        return false;
+      }
 
       /// \brief Get the node UUID.
       /// \return The string representation of the node UUID.
@@ -79,14 +95,14 @@ namespace ignition
       }
 
       /// \brief Get the unique UUID of this handler.
-      /// \return a string representation of the handler UUID.
-      public: std::string GetHandlerUuid() const
+      /// \return The handler UUID.
+      public: Uuid GetHandlerUuid() const
       {
         return this->hUuid;
       }
 
       /// \brief Unique handler's UUID.
-      protected: std::string hUuid;
+      protected: Uuid hUuid;
 
       /// \brief Node UUID.
       private: std::string nUuid;
@@ -125,13 +141,31 @@ namespace ignition
       /// \param[in] _msg Protobuf message containing the topic update.
       public: void SetCallback(const std::function <void(
         const std::string &_topic, const T &_msg)> &_cb)
+      {
+        this->cb = [_cb](const std::string &_topic, const T &_msg,
+          const MessageInfo &/*_info*/)
+        {
+          _cb(_topic, _msg);
+        };
+      }
+
+      /// \brief Set the callback for this handler. In this version the
+      /// callback also receives the metadata of the message.
+      /// \param[in] _cb The callback with the following parameters:
+      /// \param[in] _topic Topic name.
+      /// \param[in] _msg Protobuf message containing the topic update.
+      /// \param[in] _info Metadata of the message.
+      public: void SetInfoCallback(const std::function <void(
+        const std::string &_topic, const T &_msg,
+        const MessageInfo &_info)> &_cb)
       {
         this->cb = _cb;
       }
 
       // Documentation inherited.
       public: bool RunLocalCallback(const std::string &_topic,
-                                    const transport::ProtoMsg &_msg)
+                                    const transport::ProtoMsg &_msg,
+                                    const MessageInfo &_info)
       {
         // Execute the callback (if existing)
         if (this->cb)
@@ -142,7 +176,7 @@ namespace ignition
           std::string topicName = _topic;
           topicName.erase(0, topicName.find_last_of("@") + 1);
 
-          this->cb(topicName, *msgPtr);
+          this->cb(topicName, *msgPtr, _info);
           return true;
         }
         else
@@ -153,12 +187,48 @@ namespace ignition
         }
       }
 
+      /// \brief Parse the received messages into a message owned by the
+      /// handler instead of creating a new one for each message. Protobuf
+      /// keeps the memory of the nested messages, repeated fields and strings
+      /// of a cleared message, so the allocations are amortized. The message
+      /// passed to the callback is only valid during the callback: it has to
+      /// be copied (e.g. with CopyFrom()) to keep it. If the handler is
+      /// dispatching another message, a new message is created as usual.
+      /// \param[in] _reuse True to enable the reuse of the message.
+      public: void SetReuseMsg(const bool _reuse)
+      {
+        this->reuse = _reuse;
+      }
+
+      /// \brief Check if the handler reuses the received messages.
+      /// \return True if the reuse is enabled.
+      public: bool ReuseMsg() const
+      {
+        return this->reuse;
+      }
+
       // Documentation inherited.
       public: bool RunCallback(const std::string &_topic,
-                               const std::string &_data)
+                               const std::string &_data,
+                               const MessageInfo &_info)
       {
-        // Instantiate the specific protobuf message associated to this topic.
-        auto msg = this->CreateMsg(_data);
+        // Use the message of the handler, unless it is already in use.
+        bool reused = false;
+        std::shared_ptr<T> msg;
+        if (this->reuse && !this->busy.exchange(true))
+        {
+          reused = true;
+          if (!this->reusedMsg)
+            this->reusedMsg.reset(new T());
+          this->reusedMsg->ParseFromString(_data);
+          msg = this->reusedMsg;
+        }
+        else
+        {
+          // Instantiate the specific protobuf message associated to this
+          // topic.
+          msg = this->CreateMsg(_data);
+        }
 
         // Execute the callback (if existing).
         if (this->cb)
@@ -167,11 +237,15 @@ namespace ignition
           std::string topicName = _topic;
           topicName.erase(0, topicName.find_last_of("@") + 1);
 
-          this->cb(topicName, *msg);
+          this->cb(topicName, *msg, _info);
+          if (reused)
+            this->busy = false;
           return true;
         }
         else
         {
+          if (reused)
+            this->busy = false;
           std::cerr << "SubscriptionHandler::RunCallback() error: "
                     << "Callback is NULL" << std::endl;
           return false;
@@ -182,7 +256,80 @@ namespace ignition
       /// following parameters:
       /// \param[in] _topic Topic name.
       /// \param[in] _msg Protobuf message containing the topic update.
-      private: std::function<void(const std::string &_topic, const T &_msg)> cb;
+      /// \param[in] _info Metadata of the message.
+      private: std::function<void(const std::string &_topic, const T &_msg,
+        const MessageInfo &_info)> cb;
+
+      /// \brief When true, the received messages are parsed into reusedMsg.
+      private: bool reuse = false;
+
+      /// \brief Message reused for each received message.
+      private: std::shared_ptr<T> reusedMsg;
+
+      /// \brief True while reusedMsg is being dispatched.
+      private: std::atomic<bool> busy{false};
+    };
+
+    /// \class RawSubscriptionHandler SubscriptionHandler.hh
+    /// \brief Subscription handler that passes the serialized messages to
+    /// the callback without creating a protobuf message. The type name of
+    /// the message is available in the MessageInfo passed to the callback.
+    class RawSubscriptionHandler : public ISubscriptionHandler
+    {
+      /// \brief Constructor.
+      /// \param[in] _nUuid UUID of the node registering the handler.
+      /// \param[in] _cb Callback executed for each topic update.
+      public: RawSubscriptionHandler(const std::string &_nUuid,
+                                     const RawCallback &_cb)
+        : ISubscriptionHandler(_nUuid),
+          cb(_cb)
+      {
+      }
+
+      // Documentation inherited.
+      public: bool IsRaw() const
+      {
+        return true;
+      }
+
+      // Documentation inherited.
+      public: bool RunLocalCallback(const std::string &_topic,
+                                    const transport::ProtoMsg &_msg,
+                                    const MessageInfo &_info)
+      {
+        std::string data;
+        if (!_msg.SerializeToString(&data))
+        {
+          std::cerr << "RawSubscriptionHandler::RunLocalCallback() error: "
+                    << "Unable to serialize the message" << std::endl;
+          return false;
+        }
+
+        return this->RunCallback(_topic, data, _info);
+      }
+
+      // Documentation inherited.
+      public: bool RunCallback(const std::string &_topic,
+                               const std::string &_data,
+                               const MessageInfo &_info)
+      {
+        if (!this->cb)
+        {
+          std::cerr << "RawSubscriptionHandler::RunCallback() error: "
+                    << "Callback is NULL" << std::endl;
+          return false;
+        }
+
+        // Remove the partition part from the topic.
+        std::string topicName = _topic;
+        topicName.erase(0, topicName.find_last_of("@") + 1);
+
+        this->cb(topicName, _data.data(), _data.size(), _info);
+        return true;
+      }
+
+      /// \brief Callback registered for this handler.
+      private: RawCallback cb;
     };
   }
 }
@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2015 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef __IGN_TRANSPORT_TOPICQUEUE_HH_INCLUDED__
+#define __IGN_TRANSPORT_TOPICQUEUE_HH_INCLUDED__
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include "ignition/transport/Helpers.hh"
+#include "ignition/transport/MessageInfo.hh"
+
+namespace ignition
+{
+  namespace transport
+  {
+    /// \def DropPolicy
+    /// \brief Message discarded when a topic queue is full:
+    /// * DropNewest: The incoming message is discarded.
+    /// * DropOldest: The oldest queued messages are discarded to make room
+    ///               for the incoming message.
+    enum class DropPolicy {DropNewest, DropOldest};
+
+    /// \def LimitCallback
+    /// \brief Callback executed when a topic queue reaches its limits, with
+    /// the following parameters:
+    /// \param[in] _topic Topic name.
+    /// \param[in] _messages Messages in the queue.
+    /// \param[in] _bytes Bytes in the queue.
+    typedef std::function<void(const std::string &_topic,
+      const uint64_t _messages, const uint64_t _bytes)> LimitCallback;
+
+    /// \class QueueLimits TopicQueue.hh ignition/transport/TopicQueue.hh
+    /// \brief Bounds of the reception queue of a topic.
+    class IGNITION_VISIBLE QueueLimits
+    {
+      /// \brief Maximum number of queued messages (0 for no limit).
+      public: uint64_t maxMessages = 0;
+
+      /// \brief Maximum number of queued bytes (0 for no limit).
+      public: uint64_t maxBytes = 0;
+
+      /// \brief Policy applied when the queue is full.
+      public: DropPolicy policy = DropPolicy::DropOldest;
+
+      /// \brief Optional callback executed when the queue reaches its
+      /// limits. It is executed once and then re-armed when the queue
+      /// becomes empty, so a sustained overload does not flood the
+      /// application with alerts.
+      public: LimitCallback onLimit;
+    };
+
+    /// \class QueuedMsg TopicQueue.hh ignition/transport/TopicQueue.hh
+    /// \brief Serialized message waiting in a topic queue.
+    class IGNITION_VISIBLE QueuedMsg
+    {
+      /// \brief Fully qualified topic name.
+      public: std::string topic;
+
+      /// \brief Serialized message.
+      public: std::string data;
+
+      /// \brief Metadata of the message.
+      public: MessageInfo info;
+    };
+
+    /// \class TopicQueue TopicQueue.hh ignition/transport/TopicQueue.hh
+    /// \brief Bounded FIFO of the messages received on a topic. The queue
+    /// is bounded by number of messages and by bytes. This class is not
+    /// thread safe.
+    class IGNITION_VISIBLE TopicQueue
+    {
+      /// \brief Constructor.
+      /// \param[in] _limits Bounds of the queue.
+      public: explicit TopicQueue(const QueueLimits &_limits);
+
+      /// \brief Destructor.
+      public: virtual ~TopicQueue() = default;
+
+      /// \brief Get the bounds of the queue.
+      /// \return The bounds of the queue.
+      public: const QueueLimits &GetLimits() const;
+
+      /// \brief Set the bounds of the queue. The new limits are applied to
+      /// the next messages pushed.
+      /// \param[in] _limits Bounds of the queue.
+      public: void SetLimits(const QueueLimits &_limits);
+
+      /// \brief Add a message to the queue, applying the drop policy if the
+      /// queue is full.
+      /// \param[in] _msg Message to be queued.
+      /// \param[out] _alert True if the application should be notified that
+      /// the queue reached its limits (see QueueLimits::onLimit).
+      /// \return Number of messages discarded.
+      public: uint64_t Push(QueuedMsg &&_msg, bool &_alert);
+
+      /// \brief Remove the oldest message from the queue.
+      /// \param[out] _msg Message removed.
+      /// \return True if a message was removed or false if the queue was
+      /// empty.
+      public: bool Pop(QueuedMsg &_msg);
+
+      /// \brief Get the number of queued messages.
+      /// \return The number of queued messages.
+      public: uint64_t GetMessages() const;
+
+      /// \brief Get the number of queued bytes.
+      /// \return The number of queued bytes.
+      public: uint64_t GetBytes() const;
+
+      /// \brief Check if a new message of a given size would exceed the
+      /// limits.
+      /// \param[in] _size Size of the new message.
+      /// \return True if the message does not fit.
+      private: bool IsFull(const uint64_t _size) const;
+
+      /// \brief Bounds of the queue.
+      private: QueueLimits limits;
+
+      /// \brief Queued messages.
+      private: std::deque<QueuedMsg> msgs;
+
+      /// \brief Queued bytes.
+      private: uint64_t bytes = 0;
+
+      /// \brief When true, the next time that the queue is full an alert
+      /// is raised.
+      private: bool alertArmed = true;
+    };
+  }
+}
+#endif
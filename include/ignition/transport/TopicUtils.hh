@@ -18,6 +18,7 @@
 #ifndef __IGN_TRANSPORT_TOPICUTILS_HH_INCLUDED__
 #define __IGN_TRANSPORT_TOPICUTILS_HH_INCLUDED__
 
+#include <cstdint>
 #include <string>
 #include "ignition/transport/Helpers.hh"
 
@@ -58,6 +59,15 @@ namespace ignition
                                                 const std::string &_ns,
                                                 const std::string &_topic,
                                                 std::string &_name);
+
+      /// \brief Get a hash of the partition contained in a fully qualified
+      /// topic name (e.g.: "@/partition@/topic"). The hash is used by the
+      /// discovery to discard messages from other partitions without parsing
+      /// them. The hash function is the 32-bit FNV-1a.
+      /// \param[in] _name Fully qualified topic name.
+      /// \return The partition hash or 0 if the name does not contain a
+      /// partition.
+      public: static uint32_t GetPartitionHash(const std::string &_name);
     };
   }
 }
@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2015 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef __IGN_TRANSPORT_TRACE_HH_INCLUDED__
+#define __IGN_TRANSPORT_TRACE_HH_INCLUDED__
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ignition/transport/config.hh"
+#include "ignition/transport/Helpers.hh"
+
+namespace ignition
+{
+  namespace transport
+  {
+    /// \class TraceEvent Trace.hh ignition/transport/Trace.hh
+    /// \brief A section of code executed by a thread.
+    class IGNITION_VISIBLE TraceEvent
+    {
+      /// \brief Name of the section. It must be a string literal.
+      public: const char *name = nullptr;
+
+      /// \brief Start time (ns since the epoch of the steady clock).
+      public: uint64_t start = 0;
+
+      /// \brief Duration (ns).
+      public: uint64_t duration = 0;
+
+      /// \brief Index of the thread that executed the section.
+      public: uint32_t thread = 0;
+    };
+
+    /// \class Tracer Trace.hh ignition/transport/Trace.hh
+    /// \brief Collects trace events. Each thread writes its events into its
+    /// own ring buffer without taking any lock. When a buffer is full, the
+    /// oldest events are overwritten. The events of all the threads can be
+    /// written to a file in the Chrome trace format (chrome://tracing).
+    /// The steady clock is shared by all the processes of a host, so the
+    /// traces of several processes can be loaded together to see the time
+    /// spent between a send and the matching receive.
+    class IGNITION_VISIBLE Tracer
+    {
+      /// \brief Record an event for the calling thread.
+      /// \param[in] _name Name of the event. It must be a string literal.
+      /// \param[in] _start Start time (ns).
+      /// \param[in] _duration Duration (ns).
+      public: static void Record(const char *_name, const uint64_t _start,
+                                 const uint64_t _duration);
+
+      /// \brief Get the events recorded by all the threads. Events that are
+      /// being overwritten while the buffers are read are discarded.
+      /// \param[out] _events Events sorted by start time.
+      public: static void GetEvents(std::vector<TraceEvent> &_events);
+
+      /// \brief Write all the events recorded in the Chrome trace format.
+      /// \param[in] _path Path of the file. The first "%p" is replaced by
+      /// the process id, so multiple processes can use the same path.
+      /// \return True if the file was written or false otherwise.
+      public: static bool WriteChromeTrace(const std::string &_path);
+
+      /// \brief Discard all the events recorded.
+      public: static void Clear();
+
+      /// \brief Get the current time.
+      /// \return Time in ns since the epoch of the steady clock.
+      public: static uint64_t Now()
+      {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch()).count();
+      }
+
+      /// \brief Number of events stored per thread.
+      public: static const unsigned int BufferSize = 16384;
+    };
+
+    /// \class ScopedTrace Trace.hh ignition/transport/Trace.hh
+    /// \brief Record an event covering the lifetime of this object.
+    class IGNITION_VISIBLE ScopedTrace
+    {
+      /// \brief Constructor.
+      /// \param[in] _name Name of the event. It must be a string literal.
+      public: explicit ScopedTrace(const char *_name)
+        : name(_name),
+          start(Tracer::Now())
+      {
+      }
+
+      /// \brief Destructor. Records the event.
+      public: ~ScopedTrace()
+      {
+        Tracer::Record(this->name, this->start, Tracer::Now() - this->start);
+      }
+
+      /// \brief Name of the event.
+      private: const char *name;
+
+      /// \brief Start time (ns).
+      private: uint64_t start;
+    };
+  }
+}
+
+// Tracepoints are only compiled when the ENABLE_TRACING CMake option is set.
+#define IGN_TRACE_CONCAT_IMPL(_a, _b) _a##_b
+#define IGN_TRACE_CONCAT(_a, _b) IGN_TRACE_CONCAT_IMPL(_a, _b)
+#ifdef IGN_TRANSPORT_TRACING
+# define IGN_TRACE_SCOPE(_name) \
+  ignition::transport::ScopedTrace IGN_TRACE_CONCAT(ignTrace, __LINE__)(_name)
+#else
+# define IGN_TRACE_SCOPE(_name)
+#endif
+
+#endif
@@ -30,6 +30,7 @@
 #include <memory>
 #include <string>
 #include <vector>
+#include "ignition/transport/Uuid.hh"
 
 namespace ignition
 {
@@ -39,6 +40,7 @@ namespace ignition
     class IRepHandler;
     class IReqHandler;
     class ISubscriptionHandler;
+    class MessageInfo;
     class NodePrivate;
 
     /// \def Scope This strongly typed enum defines the different options for
@@ -100,6 +102,28 @@ namespace ignition
     typedef std::function<void (const std::string &_topic,
       const ProtoMsgPtr _rep, bool _result)> RepCallback;
 
+    /// \def RawCallback
+    /// \brief Callback used for receiving topic updates without
+    /// deserializing them, with the following parameters:
+    /// \param[in] _topic Topic name.
+    /// \param[in] _data Pointer to the serialized message.
+    /// \param[in] _size Size of the serialized message in bytes.
+    /// \param[in] _info Metadata of the message.
+    typedef std::function<void (const std::string &_topic,
+      const char *_data, const size_t _size,
+      const MessageInfo &_info)> RawCallback;
+
+    /// \def RawRepCallback
+    /// \brief Callback used for answering service requests without
+    /// deserializing them, with the following parameters:
+    /// \param[in] _topic Service name.
+    /// \param[in] _req Serialized request.
+    /// \param[out] _rep Serialized response.
+    /// \param[out] _result Service call result.
+    typedef std::function<void (const std::string &_topic,
+      const std::string &_req, std::string &_rep,
+      bool &_result)> RawRepCallback;
+
     /// \def NodePrivatePtr
     /// \brief Pointer to internal class NodePrivate.
     typedef std::unique_ptr<transport::NodePrivate> NodePrivatePtr;
@@ -110,11 +134,10 @@ namespace ignition
 
     /// \def ISubscriptionHandler_M
     /// \brief Map to store the different subscription handlers for a topic.
-    /// Each node can have its own subscription handler. The node id
+    /// Each node can have its own subscription handler. The handler UUID
     /// is used as key and a pointer to a generic subscription handler is the
     /// value.
-    typedef std::map<std::string, ISubscriptionHandlerPtr>
-      ISubscriptionHandler_M;
+    typedef std::map<Uuid, ISubscriptionHandlerPtr> ISubscriptionHandler_M;
 
     /// \def IRepHandlerPtr
     /// \brief Shared pointer to IRepHandler.
@@ -129,7 +152,7 @@ namespace ignition
     /// topic. Each node can have its own request handler. The node id
     /// is used as key. The value is another map, where the key is the request
     /// UUID and the value is pointer to a generic request handler.
-    typedef std::map<std::string, std::map<std::string, IReqHandlerPtr>>
+    typedef std::map<std::string, std::map<Uuid, IReqHandlerPtr>>
       IReqHandler_M;
 
     /// \def DiscoveryCallback
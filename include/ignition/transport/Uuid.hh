@@ -18,37 +18,68 @@
 #ifndef __IGN_TRANSPORT_UUID_HH_INCLUDED__
 #define __IGN_TRANSPORT_UUID_HH_INCLUDED__
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <iostream>
 #include <string>
 #include "ignition/transport/Helpers.hh"
 
-#ifdef _WIN32
-  #include <Rpc.h>
-  #pragma comment(lib, "Rpcrt4.lib")
-  typedef UUID portable_uuid_t;
-#else /* UNIX */
-  #include <uuid/uuid.h>
-  typedef uuid_t portable_uuid_t;
-#endif
-
 namespace ignition
 {
   namespace transport
   {
     /// \class Uuid Uuid.hh ignition/transport/Uuid.hh
-    /// \brief A portable class for representing a Universally Unique Identifier
+    /// \brief A portable class for representing a Universally Unique
+    /// Identifier. A Uuid is a small value type: it can be copied, compared
+    /// and hashed without any allocation, so it can be used as a key. The
+    /// binary form (Data()) is the one sent on the wire; the string form is
+    /// only meant for logging and the command line tools.
     class IGNITION_VISIBLE Uuid
     {
-      /// \brief Constructor.
+      /// \brief Constructor. Generates a new random UUID.
       public: Uuid();
 
-      /// \brief Destructor.
-      public: virtual ~Uuid();
-
       /// \brief Return the string representation of the Uuid.
       /// \return the UUID in string format.
       public: std::string ToString() const;
 
+      /// \brief Set the UUID from its string representation.
+      /// \param[in] _str UUID in the format returned by ToString().
+      /// \return True when success or false if _str is not a valid UUID. In
+      /// that case, the UUID is not modified.
+      public: bool FromString(const std::string &_str);
+
+      /// \brief Get the binary representation of the UUID.
+      /// \return Pointer to the Size bytes of the UUID.
+      public: const uint8_t *Data() const;
+
+      /// \brief Set the UUID from its binary representation.
+      /// \param[in] _data Pointer to the bytes of the UUID.
+      /// \param[in] _size Number of bytes. It should be Size.
+      /// \return True when success or false if the size is not valid.
+      public: bool FromBytes(const void *_data, const size_t _size);
+
+      /// \brief Get a hash value of the UUID.
+      /// \return The hash value.
+      public: size_t Hash() const;
+
+      /// \brief Equality operator.
+      /// \param[in] _other UUID to compare with.
+      /// \return True if both UUIDs are the same.
+      public: bool operator==(const Uuid &_other) const;
+
+      /// \brief Inequality operator.
+      /// \param[in] _other UUID to compare with.
+      /// \return True if the UUIDs are different.
+      public: bool operator!=(const Uuid &_other) const;
+
+      /// \brief Less than operator, to use the UUID as a key of ordered
+      /// containers.
+      /// \param[in] _other UUID to compare with.
+      /// \return True if this UUID is ordered before _other.
+      public: bool operator<(const Uuid &_other) const;
+
       /// \brief Stream insertion operator.
       /// \param[out] _out The output stream.
       /// \param[in] _msg AdvMsg to write to the stream.
@@ -59,6 +90,9 @@ namespace ignition
         return _out;
       }
 
+      /// \brief Size of a UUID in bytes.
+      public: static const size_t Size = 16;
+
       /// \brief Length of a UUID in string format.
       /// A UUID is a 16-octet number. In its string representation, every octet
       /// is divided in two parts, and each part (4 bits) is represented as an
@@ -68,9 +102,23 @@ namespace ignition
       private: static const int UuidStrLen = 37;
 
       /// \brief Internal representation.
-
-      private: portable_uuid_t data;
+      private: uint8_t data[Size];
     };
   }
 }
+
+namespace std
+{
+  /// \brief Hash function, to use Uuid as a key of unordered containers.
+  template<> struct hash<ignition::transport::Uuid>
+  {
+    /// \brief Get the hash of a UUID.
+    /// \param[in] _uuid The UUID.
+    /// \return The hash value.
+    size_t operator()(const ignition::transport::Uuid &_uuid) const
+    {
+      return _uuid.Hash();
+    }
+  };
+}
 #endif
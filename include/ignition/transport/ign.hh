@@ -24,12 +24,88 @@
 #include "ignition/transport/Helpers.hh"
 
 /// \brief External hook to execute 'ign topic list' command from the command
-/// line.
-extern "C" IGNITION_VISIBLE void cmdTopicList();
+/// line. The command returns as soon as the other processes have answered.
+/// \param[in] _maxWait Maximum time waiting for the answers (ms).
+extern "C" IGNITION_VISIBLE void cmdTopicList(const int _maxWait);
 
 /// \brief External hook to execute 'ign service list' command from the command
-/// line.
-extern "C" IGNITION_VISIBLE void cmdServiceList();
+/// line. The command returns as soon as the other processes have answered.
+/// \param[in] _maxWait Maximum time waiting for the answers (ms).
+extern "C" IGNITION_VISIBLE void cmdServiceList(const int _maxWait);
+
+/// \brief External hook to execute 'ign stats' command from the command
+/// line. It prints the transport state of all the processes of the
+/// partition, as answered by their introspection services.
+/// \param[in] _maxWait Maximum time waiting for the answers (ms).
+extern "C" IGNITION_VISIBLE void cmdStats(const int _maxWait);
+
+/// \brief External hook to execute 'ign topic --hz' command from the command
+/// line. It prints the publication rate of a topic once per second.
+/// \param[in] _topic Topic name.
+/// \param[in] _window Number of messages used to compute the statistics.
+/// \param[in] _duration Duration of the measurement in seconds (0 to run
+/// until the command is interrupted).
+extern "C" IGNITION_VISIBLE void cmdTopicHz(const char *_topic,
+  const int _window, const int _duration);
+
+/// \brief External hook to execute 'ign topic --bw' command from the command
+/// line. It prints the bandwidth used by a topic once per second.
+/// \param[in] _topic Topic name.
+/// \param[in] _window Number of messages used to compute the statistics.
+/// \param[in] _duration Duration of the measurement in seconds (0 to run
+/// until the command is interrupted).
+extern "C" IGNITION_VISIBLE void cmdTopicBw(const char *_topic,
+  const int _window, const int _duration);
+
+/// \brief External hook to execute 'ign topic --record' command from the
+/// command line. It records the messages of the partition into a log.
+/// \param[in] _dir Directory of the log.
+/// \param[in] _topic Topic to record or empty to record all the topics.
+/// \param[in] _duration Duration of the recording in seconds (0 to run
+/// until the command is interrupted).
+extern "C" IGNITION_VISIBLE void cmdTopicRecord(const char *_dir,
+  const char *_topic, const int _duration);
+
+/// \brief External hook to execute 'ign topic --play' command from the
+/// command line. It publishes the messages of a log and prints the timing
+/// accuracy achieved.
+/// \param[in] _dir Directory of the log.
+/// \param[in] _rate Playback rate (0 to play as fast as possible).
+extern "C" IGNITION_VISIBLE void cmdTopicPlay(const char *_dir,
+  const double _rate);
+
+/// \brief External hook to execute 'ign topic --pub' command from the
+/// command line. It publishes synthetic messages at a fixed rate and prints
+/// the achieved rate, the time spent publishing and the CPU use.
+/// \param[in] _topic Topic name. When there are several topics, their
+/// names are _topic/0, _topic/1...
+/// \param[in] _numTopics Number of topics.
+/// \param[in] _rate Messages per second on each topic (0 for full speed).
+/// \param[in] _size Size of the messages in bytes.
+/// \param[in] _duration Duration in seconds (0 to run until the command is
+/// interrupted).
+extern "C" IGNITION_VISIBLE void cmdTopicPub(const char *_topic,
+  const int _numTopics, const double _rate, const int _size,
+  const int _duration);
+
+/// \brief External hook to execute 'ign topic --sink' command from the
+/// command line. It receives the messages of 'ign topic --pub' and prints
+/// the receive rate and the number of lost messages.
+/// \param[in] _topic Topic name (same as in cmdTopicPub()).
+/// \param[in] _numTopics Number of topics.
+/// \param[in] _duration Duration in seconds (0 to run until the command is
+/// interrupted).
+extern "C" IGNITION_VISIBLE void cmdTopicSink(const char *_topic,
+  const int _numTopics, const int _duration);
+
+/// \brief External hook to execute 'ign topic --relay' command from the
+/// command line. It republishes topics for the subscribers that use
+/// IGN_TRANSPORT_PREFER_RELAY=1 (see Relay).
+/// \param[in] _topics Comma separated list of topics.
+/// \param[in] _duration Duration in seconds (0 to run until the command is
+/// interrupted).
+extern "C" IGNITION_VISIBLE void cmdTopicRelay(const char *_topics,
+  const int _duration);
 
 /// \brief External hook to read the library version.
 /// \return C-string representing the version. Ex.: 0.1.2
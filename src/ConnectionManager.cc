@@ -0,0 +1,208 @@
+/*
+ * Copyright (C) 2015 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "ignition/transport/ConnectionManager.hh"
+#include "ignition/transport/Statistics.hh"
+
+using namespace ignition;
+using namespace transport;
+
+//////////////////////////////////////////////////
+ConnectionManager::ConnectionManager(const unsigned int _numWorkers)
+  : state(new State())
+{
+  unsigned int numWorkers = _numWorkers;
+  if (numWorkers == 0)
+  {
+    std::cerr << "ConnectionManager() error: Invalid number of workers. "
+              << "Using [" << DefNumWorkers << "]" << std::endl;
+    numWorkers = DefNumWorkers;
+  }
+
+  this->state->activeWorkers = numWorkers;
+  for (unsigned int i = 0; i < numWorkers; ++i)
+  {
+    this->workers.push_back(std::thread(&ConnectionManager::RunWorkerTask,
+      this->state));
+  }
+}
+
+//////////////////////////////////////////////////
+ConnectionManager::~ConnectionManager()
+{
+  auto &st = *this->state;
+  {
+    std::lock_guard<std::mutex> lock(st.mutex);
+    st.exit = true;
+    st.pending.clear();
+    st.ready.clear();
+  }
+  st.workAvailable.notify_all();
+
+  // Don't join on Windows, because it can hang when this object is
+  // destructed on process exit (see ~NodeShared()).
+#ifndef _WIN32
+  for (auto &worker : this->workers)
+  {
+    if (worker.joinable())
+      worker.join();
+  }
+#else
+  for (auto &worker : this->workers)
+  {
+    if (worker.joinable())
+      worker.detach();
+  }
+
+  // Give some time to the workers to finish their current task. A worker
+  // that is still running keeps the state alive.
+  std::unique_lock<std::mutex> lock(st.mutex);
+  st.workDone.wait_for(lock, std::chrono::milliseconds(ExitTimeout),
+    [&st]
+    {
+      return st.activeWorkers == 0;
+    });
+#endif
+}
+
+//////////////////////////////////////////////////
+void ConnectionManager::Queue(const std::string &_endpoint,
+  const std::string &_topic, const ConnectionTask &_task)
+{
+  auto &st = *this->state;
+  {
+    std::lock_guard<std::mutex> lock(st.mutex);
+
+    if (st.exit)
+      return;
+
+    // The latest task replaces the pending one (see the documentation).
+    auto &work = st.pending[_endpoint];
+    bool isNew = work.topics.empty();
+    work.task = _task;
+    work.topics.insert(_topic);
+
+    // The endpoint is already in the ready queue or a worker is processing
+    // it. In the latter case, the worker will requeue the endpoint when done.
+    if (!isNew || st.running.find(_endpoint) != st.running.end())
+      return;
+
+    st.ready.push_back(_endpoint);
+  }
+  st.workAvailable.notify_one();
+}
+
+//////////////////////////////////////////////////
+bool ConnectionManager::HasPendingWork(const std::string &_endpoint)
+{
+  auto &st = *this->state;
+  std::lock_guard<std::mutex> lock(st.mutex);
+  return st.pending.find(_endpoint) != st.pending.end() ||
+         st.running.find(_endpoint) != st.running.end();
+}
+
+//////////////////////////////////////////////////
+bool ConnectionManager::WaitForPendingWork(const unsigned int _timeout)
+{
+  auto &st = *this->state;
+  std::unique_lock<std::mutex> lock(st.mutex);
+  return st.workDone.wait_for(lock, std::chrono::milliseconds(_timeout),
+    [&st]
+    {
+      return st.pending.empty() && st.running.empty();
+    });
+}
+
+//////////////////////////////////////////////////
+unsigned int ConnectionManager::GetNumWorkers() const
+{
+  return this->workers.size();
+}
+
+//////////////////////////////////////////////////
+uint64_t ConnectionManager::GetCpuTime()
+{
+  uint64_t total = 0;
+  for (auto &worker : this->workers)
+    total += ThreadCpuNs(worker);
+  return total;
+}
+
+//////////////////////////////////////////////////
+void ConnectionManager::RunWorkerTask(std::shared_ptr<State> _state)
+{
+  auto &st = *_state;
+  std::unique_lock<std::mutex> lock(st.mutex);
+  while (true)
+  {
+    st.workAvailable.wait(lock, [&st]
+      {
+        return st.exit || !st.ready.empty();
+      });
+
+    if (st.exit)
+      break;
+
+    std::string endpoint = st.ready.front();
+    st.ready.pop_front();
+
+    // Take all the topics queued so far for this endpoint.
+    auto it = st.pending.find(endpoint);
+    if (it == st.pending.end())
+      continue;
+    ConnectionTask task = it->second.task;
+    std::vector<std::string> topics(it->second.topics.begin(),
+      it->second.topics.end());
+    st.pending.erase(it);
+    st.running.insert(endpoint);
+
+    // Run the task without holding the lock.
+    lock.unlock();
+    try
+    {
+      if (task)
+        task(endpoint, topics);
+    }
+    catch(const std::exception &_e)
+    {
+      std::cerr << "ConnectionManager::RunWorkerTask() error: " << _e.what()
+                << std::endl;
+    }
+    lock.lock();
+
+    st.running.erase(endpoint);
+
+    // New work arrived while the task was running.
+    if (st.pending.find(endpoint) != st.pending.end())
+    {
+      st.ready.push_back(endpoint);
+      st.workAvailable.notify_one();
+    }
+
+    st.workDone.notify_all();
+  }
+
+  --st.activeWorkers;
+  st.workDone.notify_all();
+}
@@ -0,0 +1,211 @@
+/*
+ * Copyright (C) 2015 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ignition/transport/ConnectionManager.hh"
+#include "gtest/gtest.h"
+
+using namespace ignition;
+
+//////////////////////////////////////////////////
+/// \brief Check that the topics queued for the same endpoint are coalesced
+/// and that the tasks for the same endpoint are serialized.
+TEST(ConnectionManagerTest, Coalesce)
+{
+  transport::ConnectionManager manager(2);
+  EXPECT_EQ(manager.GetNumWorkers(), 2u);
+
+  std::mutex mutex;
+  std::vector<std::string> topicsSeen;
+  std::atomic<int> executions(0);
+  std::atomic<int> concurrent(0);
+  std::atomic<bool> overlap(false);
+
+  auto task = [&](const std::string &/*_endpoint*/,
+                  const std::vector<std::string> &_topics)
+  {
+    if (++concurrent > 1)
+      overlap = true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      topicsSeen.insert(topicsSeen.end(), _topics.begin(), _topics.end());
+    }
+    ++executions;
+    --concurrent;
+  };
+
+  manager.Queue("tcp://127.0.0.1:5000", "/foo", task);
+  manager.Queue("tcp://127.0.0.1:5000", "/bar", task);
+  manager.Queue("tcp://127.0.0.1:5000", "/foo", task);
+  EXPECT_TRUE(manager.HasPendingWork("tcp://127.0.0.1:5000"));
+  EXPECT_FALSE(manager.HasPendingWork("tcp://127.0.0.1:6000"));
+
+  EXPECT_TRUE(manager.WaitForPendingWork(2000));
+  EXPECT_FALSE(manager.HasPendingWork("tcp://127.0.0.1:5000"));
+
+  // At most two executions: the first one might start before the rest of the
+  // topics are queued.
+  EXPECT_GE(executions, 1);
+  EXPECT_LE(executions, 2);
+  EXPECT_FALSE(overlap);
+  EXPECT_EQ(std::count(topicsSeen.begin(), topicsSeen.end(), "/bar"), 1);
+  EXPECT_GE(std::count(topicsSeen.begin(), topicsSeen.end(), "/foo"), 1);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that a task queued for an endpoint with pending work
+/// replaces the pending task, and that it runs once for all the topics.
+TEST(ConnectionManagerTest, LatestTask)
+{
+  transport::ConnectionManager manager(1);
+
+  std::atomic<bool> started(false);
+  std::atomic<bool> release(false);
+  auto blockingTask = [&](const std::string &/*_endpoint*/,
+                          const std::vector<std::string> &/*_topics*/)
+  {
+    started = true;
+    while (!release)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  };
+
+  std::mutex mutex;
+  std::atomic<int> executionsA(0);
+  std::atomic<int> executionsB(0);
+  std::vector<std::string> topicsB;
+
+  auto taskA = [&](const std::string &/*_endpoint*/,
+                   const std::vector<std::string> &/*_topics*/)
+  {
+    ++executionsA;
+  };
+
+  auto taskB = [&](const std::string &/*_endpoint*/,
+                   const std::vector<std::string> &_topics)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    topicsB.insert(topicsB.end(), _topics.begin(), _topics.end());
+    ++executionsB;
+  };
+
+  // Keep the only worker busy, so both tasks are queued before any of them
+  // can start.
+  manager.Queue("tcp://127.0.0.1:5000", "/block", blockingTask);
+  while (!started)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+  manager.Queue("tcp://127.0.0.1:5001", "/foo", taskA);
+  manager.Queue("tcp://127.0.0.1:5001", "/bar", taskB);
+  release = true;
+
+  EXPECT_TRUE(manager.WaitForPendingWork(2000));
+  EXPECT_EQ(executionsA, 0);
+  EXPECT_EQ(executionsB, 1);
+  std::sort(topicsB.begin(), topicsB.end());
+  EXPECT_EQ(topicsB, std::vector<std::string>({"/bar", "/foo"}));
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that different endpoints are handled in parallel.
+TEST(ConnectionManagerTest, Parallel)
+{
+  const int numTasks = 4;
+  transport::ConnectionManager manager(numTasks);
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  int started = 0;
+  std::atomic<int> concurrent(0);
+
+  // Each task waits until all the tasks have started. This is only possible
+  // if all of them are running at the same time.
+  auto task = [&](const std::string &/*_endpoint*/,
+                  const std::vector<std::string> &/*_topics*/)
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    ++started;
+    cv.notify_all();
+    if (cv.wait_for(lock, std::chrono::seconds(5),
+          [&]{return started == numTasks;}))
+    {
+      ++concurrent;
+    }
+  };
+
+  for (int i = 0; i < numTasks; ++i)
+    manager.Queue("tcp://127.0.0.1:500" + std::to_string(i), "/foo", task);
+
+  EXPECT_TRUE(manager.WaitForPendingWork(10000));
+  EXPECT_EQ(concurrent, numTasks);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the destructor discards the queued work that has not
+/// started yet and waits for the running task.
+TEST(ConnectionManagerTest, Destructor)
+{
+  const std::string lastEndpoint = "tcp://127.0.0.1:5009";
+  std::atomic<int> executions(0);
+  std::atomic<bool> started(false);
+  std::atomic<bool> discarded(false);
+  {
+    transport::ConnectionManager manager(1);
+
+    // The first task keeps the only worker busy until the destructor has
+    // discarded the rest of the work.
+    auto task = [&](const std::string &/*_endpoint*/,
+                    const std::vector<std::string> &/*_topics*/)
+    {
+      started = true;
+      auto deadline = std::chrono::steady_clock::now() +
+        std::chrono::seconds(5);
+      while (std::chrono::steady_clock::now() < deadline)
+      {
+        if (!manager.HasPendingWork(lastEndpoint))
+        {
+          discarded = true;
+          break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+      ++executions;
+    };
+
+    for (int i = 0; i < 10; ++i)
+      manager.Queue("tcp://127.0.0.1:500" + std::to_string(i), "/foo", task);
+
+    while (!started)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_TRUE(discarded);
+  EXPECT_EQ(executions, 1);
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -44,10 +44,16 @@
 #endif
 
 #include <zmq.hpp>
+#include <algorithm>
 #include <chrono>
+#include <cstdint>
 #include <iostream>
+#include <map>
 #include <mutex>
+#include <random>
 #include <string>
+#include <thread>
+#include <tuple>
 #include <vector>
 #ifdef _MSC_VER
 # pragma warning(pop)
@@ -56,6 +62,8 @@
 #include "ignition/transport/DiscoveryPrivate.hh"
 #include "ignition/transport/NetUtils.hh"
 #include "ignition/transport/Packet.hh"
+#include "ignition/transport/Statistics.hh"
+#include "ignition/transport/TopicUtils.hh"
 #include "ignition/transport/TransportTypes.hh"
 
 using namespace ignition;
@@ -71,10 +79,16 @@ Discovery::Discovery(const std::string &_pUuid, bool _verbose)
 {
   // Initialization
   this->dataPtr->pUuid = _pUuid;
+  if (!this->dataPtr->processId.FromString(_pUuid))
+  {
+    std::cerr << "Discovery::Discovery() error: Invalid process UUID ["
+              << _pUuid << "]" << std::endl;
+  }
   this->dataPtr->silenceInterval = this->dataPtr->DefSilenceInterval;
   this->dataPtr->activityInterval = this->dataPtr->DefActivityInterval;
   this->dataPtr->advertiseInterval = this->dataPtr->DefAdvertiseInterval;
   this->dataPtr->heartbeatInterval = this->dataPtr->DefHeartbeatInterval;
+  this->dataPtr->randomEngine.seed(std::random_device()());
   this->dataPtr->connectionCb = nullptr;
   this->dataPtr->disconnectionCb = nullptr;
   this->dataPtr->verbose = _verbose;
@@ -140,6 +154,9 @@ Discovery::Discovery(const std::string &_pUuid, bool _verbose)
     return;
   }
 
+  // Make a socket for sending host-scoped discovery information.
+  this->CreateHostSocket();
+
   // Join the multicast group
   struct ip_mreq group;
   group.imr_multiaddr.s_addr = inet_addr(this->dataPtr->MulticastGroup.c_str());
@@ -197,6 +214,12 @@ Discovery::~Discovery()
   this->dataPtr->exit = true;
   this->dataPtr->exitMutex.unlock();
 
+  // Wake up the heartbeat thread.
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->schedulerMutex);
+    this->dataPtr->schedulerCondition.notify_all();
+  }
+
   // Don't join on Windows, because it can hang when this object
   // is destructed on process exit (e.g., when it's a global static).
   // I think that it's due to this bug:
@@ -216,23 +239,76 @@ Discovery::~Discovery()
   // Close sockets.
 #ifdef _WIN32
   closesocket(this->dataPtr->sock);
+  if (this->dataPtr->hostSock >= 0)
+    closesocket(this->dataPtr->hostSock);
 #else
   close(this->dataPtr->sock);
+  if (this->dataPtr->hostSock >= 0)
+    close(this->dataPtr->hostSock);
 #endif
 }
 
+//////////////////////////////////////////////////
+void Discovery::CreateHostSocket()
+{
+  int hostSock = socket(PF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  if (hostSock < 0)
+  {
+    std::cerr << "Host socket creation failed." << std::endl;
+    return;
+  }
+
+#ifdef _WIN32
+  DWORD ttl = 0;
+  DWORD loop = 1;
+#else
+  unsigned char ttl = 0;
+  unsigned char loop = 1;
+#endif
+
+  // Socket option: IP_MULTICAST_IF.
+  struct in_addr ifAddr;
+  ifAddr.s_addr = inet_addr(this->dataPtr->hostAddr.c_str());
+
+  // Socket option: IP_MULTICAST_TTL. A TTL of 0 confines the messages to
+  // this host. Socket option: IP_MULTICAST_LOOP delivers the messages to the
+  // local members of the multicast group.
+  if (setsockopt(hostSock, IPPROTO_IP, IP_MULTICAST_IF,
+        reinterpret_cast<const char*>(&ifAddr), sizeof(ifAddr)) != 0 ||
+      setsockopt(hostSock, IPPROTO_IP, IP_MULTICAST_TTL,
+        reinterpret_cast<const char*>(&ttl), sizeof(ttl)) != 0 ||
+      setsockopt(hostSock, IPPROTO_IP, IP_MULTICAST_LOOP,
+        reinterpret_cast<const char*>(&loop), sizeof(loop)) != 0)
+  {
+    std::cerr << "Error setting host socket options. Host-scoped discovery "
+              << "messages will be sent to the network." << std::endl;
+#ifdef _WIN32
+    closesocket(hostSock);
+#else
+    close(hostSock);
+#endif
+    return;
+  }
+
+  this->dataPtr->hostSock = hostSock;
+}
+
 //////////////////////////////////////////////////
 void Discovery::Advertise(const MsgType &_advType, const std::string &_topic,
   const std::string &_addr, const std::string &_ctrl, const std::string &_nUuid,
-  const Scope &_scope)
+  const Scope &_scope, const bool _relay)
 {
   std::lock_guard<std::recursive_mutex> lock(this->dataPtr->mutex);
 
+  this->RegisterPartition(_topic);
+
   // Add the addressing information (local node).
   if (_advType == MsgType::Msg)
   {
     this->dataPtr->infoMsg.AddAddress(
       _topic, _addr, _ctrl, this->dataPtr->pUuid, _nUuid, _scope);
+    if (_relay)
+      this->dataPtr->relays[_topic].insert(_nUuid);
   }
   else
   {
@@ -244,11 +320,14 @@ void Discovery::Advertise(const MsgType &_advType, const std::string &_topic,
   if (_scope == Scope::Process)
     return;
 
-  // Broadcast periodically my topic information.
+  // Broadcast my topic information.
   if (_advType == MsgType::Msg)
     this->SendMsg(AdvType, _topic, _addr, _ctrl, _nUuid, _scope);
   else
     this->SendMsg(AdvSrvType, _topic, _addr, _ctrl, _nUuid, _scope);
+
+  // Repeat the advertisement quickly in case the message was lost.
+  this->ResetAdvertiseInterval();
 }
 
 //////////////////////////////////////////////////
@@ -278,6 +357,8 @@ void Discovery::Unadvertise(const MsgType &_unadvType,
 
   // Remove the topic information.
   storage->DelAddressByNode(_topic, this->dataPtr->pUuid, _nUuid);
+  if (_unadvType == MsgType::Msg)
+    this->DelRelay(_topic, _nUuid);
 
   // Do not advertise a message outside the process if the scope is 'Process'.
   if (inf.scope == Scope::Process)
@@ -286,6 +367,121 @@ void Discovery::Unadvertise(const MsgType &_unadvType,
   this->SendMsg(msgType, _topic, inf.addr, inf.ctrl, _nUuid, inf.scope);
 }
 
+//////////////////////////////////////////////////
+void Discovery::DiscoverAll(const std::string &_prefix,
+  const unsigned int _maxWait)
+{
+  const unsigned int quiet = DiscoveryPrivate::QueryQuietPeriod;
+  const unsigned int replyDelay = DiscoveryPrivate::MaxReplyDelay;
+
+  Timestamp start = std::chrono::steady_clock::now();
+  Timestamp deadline = start + std::chrono::milliseconds(_maxWait);
+  Timestamp earliest = start + std::chrono::milliseconds(replyDelay + quiet);
+
+  this->SendMsg(QueryType, _prefix, "", "", "", Scope::All);
+
+  while (true)
+  {
+    Timestamp now = std::chrono::steady_clock::now();
+    if (now >= deadline)
+      break;
+
+    Timestamp lastUpdate;
+    {
+      std::lock_guard<std::recursive_mutex> lock(this->dataPtr->mutex);
+      lastUpdate = std::max(this->dataPtr->lastUpdate, start);
+    }
+
+    // All the answers should have been sent and none arrived lately.
+    if (now >= earliest && now - lastUpdate >= std::chrono::milliseconds(quiet))
+      break;
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+}
+
+//////////////////////////////////////////////////
+void Discovery::ScheduleReply(const uint8_t _type, const std::string &_topic,
+  const Address_t &_node)
+{
+  std::lock_guard<std::recursive_mutex> lock(this->dataPtr->mutex);
+
+  // Requests received before the answer is sent are answered by the same
+  // message.
+  auto key = std::make_tuple(_type, _topic, _node.nUuid);
+  if (this->dataPtr->pendingReplies.find(key) !=
+      this->dataPtr->pendingReplies.end())
+  {
+    return;
+  }
+
+  std::lock_guard<std::mutex> schedLock(this->dataPtr->schedulerMutex);
+  std::uniform_int_distribution<unsigned int> dist(
+    this->dataPtr->MinReplyDelay, this->dataPtr->MaxReplyDelay);
+  Timestamp deadline = std::chrono::steady_clock::now() +
+    std::chrono::milliseconds(dist(this->dataPtr->randomEngine));
+
+  this->dataPtr->pendingReplies[key] = {deadline, _node};
+
+  if (deadline < this->dataPtr->nextReply)
+  {
+    this->dataPtr->nextReply = deadline;
+    this->dataPtr->schedulerCondition.notify_all();
+  }
+}
+
+//////////////////////////////////////////////////
+bool Discovery::IsRelay(const std::string &_topic, const std::string &_nUuid)
+{
+  std::lock_guard<std::recursive_mutex> lock(this->dataPtr->mutex);
+
+  auto it = this->dataPtr->relays.find(_topic);
+  return it != this->dataPtr->relays.end() &&
+         it->second.find(_nUuid) != it->second.end();
+}
+
+//////////////////////////////////////////////////
+bool Discovery::HasRelay(const std::string &_topic, const bool _local)
+{
+  std::lock_guard<std::recursive_mutex> lock(this->dataPtr->mutex);
+
+  auto it = this->dataPtr->relays.find(_topic);
+  if (it == this->dataPtr->relays.end())
+    return false;
+
+  // The relay entries are not removed when a process dies, so check that
+  // the relay is still known.
+  Addresses_M addresses;
+  if (!this->dataPtr->infoMsg.GetAddresses(_topic, addresses))
+    return false;
+
+  for (auto const &proc : addresses)
+  {
+    if ((proc.first == this->dataPtr->pUuid) != _local)
+      continue;
+
+    for (auto const &node : proc.second)
+    {
+      if (it->second.find(node.nUuid) != it->second.end())
+        return true;
+    }
+  }
+
+  return false;
+}
+
+//////////////////////////////////////////////////
+void Discovery::DelRelay(const std::string &_topic, const std::string &_nUuid)
+{
+  auto it = this->dataPtr->relays.find(_topic);
+  if (it == this->dataPtr->relays.end())
+    return;
+
+  it->second.erase(_nUuid);
+  if (it->second.empty())
+    this->dataPtr->relays.erase(it);
+}
+
 //////////////////////////////////////////////////
 void Discovery::Discover(const std::string &_topic, bool _isSrv)
 {
@@ -308,8 +504,33 @@ void Discovery::Discover(const std::string &_topic, bool _isSrv)
     cb = this->dataPtr->connectionCb;
   }
 
+  this->RegisterPartition(_topic);
+
+  // Include the remote nodes that we already know, so they don't need to
+  // answer the request.
+  std::vector<Uuid> knownAnswers;
+  Addresses_M known;
+  if (storage->GetAddresses(_topic, known))
+  {
+    for (auto &proc : known)
+    {
+      if (proc.first == this->dataPtr->pUuid)
+        continue;
+
+      for (auto &node : proc.second)
+      {
+        Uuid nUuid;
+        if (knownAnswers.size() < MaxKnownAnswers &&
+            nUuid.FromString(node.nUuid))
+        {
+          knownAnswers.push_back(nUuid);
+        }
+      }
+    }
+  }
+
   // Broadcast a discovery request for this service call.
-  this->SendMsg(msgType, _topic, "", "", "", Scope::All);
+  this->SendMsg(msgType, _topic, "", "", "", Scope::All, 0, knownAnswers);
 
   // I already have information about this topic.
   if (storage->HasTopic(_topic))
@@ -458,13 +679,14 @@ void Discovery::RunActivityTask()
            (elapsed).count() > this->dataPtr->silenceInterval)
       {
         // Remove all the info entries for this process UUID.
-        this->dataPtr->infoMsg.DelAddressesByProc(it->first);
-        this->dataPtr->infoSrv.DelAddressesByProc(it->first);
+        auto pUuid = it->first.ToString();
+        this->dataPtr->infoMsg.DelAddressesByProc(pUuid);
+        this->dataPtr->infoSrv.DelAddressesByProc(pUuid);
 
         // Notify without topic information. This is useful to inform the client
         // that a remote node is gone, even if we were not interested in its
         // topics.
-        this->dataPtr->disconnectionCb("", "", "", it->first, "", Scope::All);
+        this->dataPtr->disconnectionCb("", "", "", pUuid, "", Scope::All);
 
         // Remove the activity entry.
         this->dataPtr->activity.erase(it++);
@@ -491,11 +713,57 @@ void Discovery::RunHeartbeatTask()
 {
   while (true)
   {
+    bool heartbeatDue;
+    bool advertiseDue;
+    bool replyDue;
+
+    // Wait until the next scheduled event. The schedule might change while
+    // we are waiting (e.g.: a new topic is advertised).
     {
-      std::lock_guard<std::recursive_mutex> lock(this->dataPtr->mutex);
+      std::unique_lock<std::mutex> lock(this->dataPtr->schedulerMutex);
 
-      this->SendMsg(HeartbeatType, "", "", "", "", Scope::All);
+      // Is it time to exit?
+      {
+        std::lock_guard<std::recursive_mutex> exitLock(
+          this->dataPtr->exitMutex);
+        if (this->dataPtr->exit)
+          break;
+      }
+
+      auto &schedule = this->dataPtr->schedule;
+      Timestamp wakeUp = std::min(schedule.GetNextEvent(),
+        this->dataPtr->nextReply);
+      if (std::chrono::steady_clock::now() < wakeUp)
+      {
+        this->dataPtr->schedulerCondition.wait_until(lock, wakeUp);
+        continue;
+      }
+
+      Timestamp now = std::chrono::steady_clock::now();
+      heartbeatDue = schedule.IsHeartbeatDue(now);
+      advertiseDue = schedule.IsAdvertiseDue(now);
+      replyDue = now >= this->dataPtr->nextReply;
+      if (replyDue)
+        this->dataPtr->nextReply = Timestamp::max();
+    }
 
+    // Answer the pending subscription requests.
+    if (replyDue)
+    {
+      Timestamp next = this->SendPendingReplies();
+
+      std::lock_guard<std::mutex> schedLock(this->dataPtr->schedulerMutex);
+      this->dataPtr->nextReply = std::min(this->dataPtr->nextReply, next);
+    }
+
+    if (!heartbeatDue && !advertiseDue)
+      continue;
+
+    std::lock_guard<std::recursive_mutex> lock(this->dataPtr->mutex);
+    unsigned int sent = 0;
+
+    if (advertiseDue)
+    {
       // Re-advertise topics that are advertised inside this process.
       std::map<std::string, std::vector<Address_t>> nodes;
       this->dataPtr->infoMsg.GetAddressesByProc(this->dataPtr->pUuid, nodes);
@@ -503,32 +771,59 @@ void Discovery::RunHeartbeatTask()
       {
         for (auto &node : topic.second)
         {
+          if (node.scope == Scope::Process)
+            continue;
+
           this->SendMsg(AdvType, topic.first, node.addr, node.ctrl, node.nUuid,
             node.scope);
+          ++sent;
         }
       }
 
       // Re-advertise services that are advertised inside this process.
+      nodes.clear();
       this->dataPtr->infoSrv.GetAddressesByProc(this->dataPtr->pUuid, nodes);
       for (auto &topic : nodes)
       {
         for (auto &node : topic.second)
         {
+          if (node.scope == Scope::Process)
+            continue;
+
           this->SendMsg(AdvSrvType, topic.first, node.addr, node.ctrl,
             node.nUuid, node.scope);
+          ++sent;
         }
       }
     }
 
-    std::this_thread::sleep_for(
-      std::chrono::milliseconds(this->dataPtr->heartbeatInterval));
-
-    // Is it time to exit?
+    // Update the schedule. Any discovery message refreshes our activity in
+    // the remote nodes, so the heartbeat is only needed if we did not
+    // advertise anything.
+    bool sendHeartbeat;
     {
-      std::lock_guard<std::recursive_mutex> lock(this->dataPtr->exitMutex);
-      if (this->dataPtr->exit)
-        break;
+      std::lock_guard<std::mutex> schedLock(this->dataPtr->schedulerMutex);
+      sendHeartbeat = this->dataPtr->schedule.Update(
+        std::chrono::steady_clock::now(), heartbeatDue, advertiseDue, sent,
+        this->dataPtr->heartbeatInterval, this->dataPtr->advertiseInterval);
     }
+
+    if (sendHeartbeat)
+      this->SendMsg(HeartbeatType, "", "", "", "", Scope::All);
+  }
+}
+
+//////////////////////////////////////////////////
+void Discovery::ResetAdvertiseInterval()
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->schedulerMutex);
+
+  // Only wake up the heartbeat thread if the next re-advertisement is
+  // scheduled earlier than before.
+  if (this->dataPtr->schedule.ResetAdvertiseInterval(
+        std::chrono::steady_clock::now()))
+  {
+    this->dataPtr->schedulerCondition.notify_all();
   }
 }
 
@@ -572,9 +867,11 @@ void Discovery::RecvDiscoveryUpdate()
   sockaddr_in clntAddr;
   socklen_t addrLen = sizeof(clntAddr);
 
-  if ((recvfrom(this->dataPtr->sock, reinterpret_cast<raw_type *>(rcvStr),
-        DiscoveryPrivate::MaxRcvStr, 0, reinterpret_cast<sockaddr *>(&clntAddr),
-        reinterpret_cast<socklen_t *>(&addrLen))) < 0)
+  int received = recvfrom(this->dataPtr->sock,
+    reinterpret_cast<raw_type *>(rcvStr), DiscoveryPrivate::MaxRcvStr, 0,
+    reinterpret_cast<sockaddr *>(&clntAddr),
+    reinterpret_cast<socklen_t *>(&addrLen));
+  if (received < 0)
   {
     std:: cerr << "Receive failed" << std::endl;
     return;
@@ -588,11 +885,13 @@ void Discovery::RecvDiscoveryUpdate()
               << srcPort << std::endl;
   }
 
-  this->DispatchDiscoveryMsg(srcAddr, rcvStr);
+  this->DispatchDiscoveryMsg(srcAddr, rcvStr,
+    static_cast<size_t>(received));
 }
 
 //////////////////////////////////////////////////
-void Discovery::DispatchDiscoveryMsg(const std::string &_fromIp, char *_msg)
+void Discovery::DispatchDiscoveryMsg(const std::string &_fromIp, char *_msg,
+  const size_t _len)
 {
   Header header;
   char *pBody = _msg;
@@ -600,17 +899,42 @@ void Discovery::DispatchDiscoveryMsg(const std::string &_fromIp, char *_msg)
   std::lock_guard<std::recursive_mutex> lock(this->dataPtr->mutex);
 
   // Create the header from the raw bytes.
-  header.Unpack(_msg);
+  if (!header.Unpack(_msg, _len))
+    return;
   pBody += header.GetHeaderLength();
 
-  auto recvPUuid = header.GetPUuid();
+  // Discard messages using a different version of the discovery protocol.
+  if (header.GetVersion() != this->dataPtr->Version)
+    return;
+
+  // Discard messages from partitions that are not used in this process.
+  auto hash = header.GetPartitionHash();
+  if (hash != 0 && !this->dataPtr->partitions.empty() &&
+      this->dataPtr->partitions.find(hash) == this->dataPtr->partitions.end())
+  {
+    return;
+  }
+
+  auto recvProcessId = header.GetPUuid();
 
   // Discard our own discovery messages.
-  if (recvPUuid == this->dataPtr->pUuid)
+  if (recvProcessId == this->dataPtr->processId)
     return;
 
+  // A new remote process has been discovered. Re-advertise our topics soon,
+  // so it learns about them quickly.
+  if (header.GetType() != ByeType &&
+      this->dataPtr->activity.find(recvProcessId) ==
+        this->dataPtr->activity.end())
+  {
+    this->ResetAdvertiseInterval();
+  }
+
   // Update timestamp.
-  this->dataPtr->activity[recvPUuid] = std::chrono::steady_clock::now();
+  this->dataPtr->activity[recvProcessId] = std::chrono::steady_clock::now();
+
+  // The topic storage and the callbacks use the string form.
+  auto recvPUuid = recvProcessId.ToString();
 
   switch (header.GetType())
   {
@@ -623,7 +947,7 @@ void Discovery::DispatchDiscoveryMsg(const std::string &_fromIp, char *_msg)
       auto recvTopic = advMsg.GetTopic();
       auto recvAddr = advMsg.GetAddress();
       auto recvCtrl = advMsg.GetControlAddress();
-      auto recvNUuid = advMsg.GetNodeUuid();
+      auto recvNUuid = advMsg.GetNodeUuid().ToString();
       auto recvScope = advMsg.GetScope();
 
       // Check scope of the topic.
@@ -651,6 +975,12 @@ void Discovery::DispatchDiscoveryMsg(const std::string &_fromIp, char *_msg)
       bool added = storage->AddAddress(recvTopic, recvAddr, recvCtrl, recvPUuid,
         recvNUuid, recvScope);
 
+      if (added)
+        this->dataPtr->lastUpdate = std::chrono::steady_clock::now();
+
+      if (header.GetType() == AdvType && (header.GetFlags() & RelayFlag))
+        this->dataPtr->relays[recvTopic].insert(recvNUuid);
+
       if (added && cb)
       {
         // Execute the client's callback.
@@ -664,8 +994,11 @@ void Discovery::DispatchDiscoveryMsg(const std::string &_fromIp, char *_msg)
     {
       // Read the rest of the fields.
       SubscriptionMsg subMsg;
-      subMsg.UnpackBody(pBody);
+      subMsg.SetHeader(header);
+      if (!subMsg.UnpackBody(pBody, _len - header.GetHeaderLength()))
+        return;
       auto recvTopic = subMsg.GetTopic();
+      auto knownAnswers = subMsg.GetKnownAnswers();
 
       uint8_t msgType;
       TopicStorage *storage;
@@ -697,9 +1030,54 @@ void Discovery::DispatchDiscoveryMsg(const std::string &_fromIp, char *_msg)
               continue;
             }
 
-            // Answer an ADVERTISE message.
-            this->SendMsg(msgType, recvTopic, nodeInfo.addr, nodeInfo.ctrl,
-              nodeInfo.nUuid, nodeInfo.scope);
+            // The requester already knows about this node.
+            Uuid nUuid;
+            if (nUuid.FromString(nodeInfo.nUuid) &&
+                std::find(knownAnswers.begin(), knownAnswers.end(),
+                  nUuid) != knownAnswers.end())
+            {
+              continue;
+            }
+
+            this->ScheduleReply(msgType, recvTopic, nodeInfo);
+          }
+        }
+      }
+
+      break;
+    }
+    case QueryType:
+    {
+      // The topic of the query is a prefix of the topics requested.
+      SubscriptionMsg queryMsg;
+      queryMsg.SetHeader(header);
+      if (!queryMsg.UnpackBody(pBody, _len - header.GetHeaderLength()))
+        return;
+      auto prefix = queryMsg.GetTopic();
+
+      for (auto msgType : {AdvType, AdvSrvType})
+      {
+        TopicStorage &storage = msgType == AdvType ?
+          this->dataPtr->infoMsg : this->dataPtr->infoSrv;
+        std::map<std::string, std::vector<Address_t>> nodes;
+        storage.GetAddressesByProc(this->dataPtr->pUuid, nodes);
+
+        for (auto const &topic : nodes)
+        {
+          if (topic.first.compare(0, prefix.size(), prefix) != 0)
+            continue;
+
+          for (auto const &node : topic.second)
+          {
+            // Check scope of the topic.
+            if ((node.scope == Scope::Process) ||
+                (node.scope == Scope::Host &&
+                 _fromIp != this->dataPtr->hostAddr))
+            {
+              continue;
+            }
+
+            this->ScheduleReply(msgType, topic.first, node);
           }
         }
       }
@@ -714,7 +1092,7 @@ void Discovery::DispatchDiscoveryMsg(const std::string &_fromIp, char *_msg)
     case ByeType:
     {
       // Remove the activity entry for this publisher.
-      this->dataPtr->activity.erase(recvPUuid);
+      this->dataPtr->activity.erase(recvProcessId);
 
       if (this->dataPtr->disconnectionCb)
       {
@@ -744,7 +1122,7 @@ void Discovery::DispatchDiscoveryMsg(const std::string &_fromIp, char *_msg)
       auto recvTopic = advMsg.GetTopic();
       auto recvAddr = advMsg.GetAddress();
       auto recvCtrl = advMsg.GetControlAddress();
-      auto recvNUuid = advMsg.GetNodeUuid();
+      auto recvNUuid = advMsg.GetNodeUuid().ToString();
       auto recvScope = advMsg.GetScope();
 
       // Check scope of the topic.
@@ -776,6 +1154,8 @@ void Discovery::DispatchDiscoveryMsg(const std::string &_fromIp, char *_msg)
 
       // Remove the address entry for this topic.
       storage->DelAddressByNode(recvTopic, recvPUuid, recvNUuid);
+      if (header.GetType() == UnadvType)
+        this->DelRelay(recvTopic, recvNUuid);
 
       break;
     }
@@ -790,10 +1170,17 @@ void Discovery::DispatchDiscoveryMsg(const std::string &_fromIp, char *_msg)
 //////////////////////////////////////////////////
 void Discovery::SendMsg(uint8_t _type, const std::string &_topic,
   const std::string &_addr, const std::string &_ctrl, const std::string &_nUuid,
-  const Scope &_scope, int _flags)
+  const Scope &_scope, int _flags,
+  const std::vector<Uuid> &_knownAnswers)
 {
+  // Topics advertised by a local relay.
+  if (_type == AdvType && this->IsRelay(_topic, _nUuid))
+    _flags |= RelayFlag;
+
   // Create the header.
-  Header header(DiscoveryPrivate::Version, this->dataPtr->pUuid, _type, _flags);
+  Header header(DiscoveryPrivate::Version, this->dataPtr->processId, _type,
+    _flags);
+  header.SetPartitionHash(TopicUtils::GetPartitionHash(_topic));
   auto msgLength = 0;
   std::vector<char> buffer;
 
@@ -804,8 +1191,16 @@ void Discovery::SendMsg(uint8_t _type, const std::string &_topic,
     case AdvSrvType:
     case UnadvSrvType:
     {
+      Uuid nUuid;
+      if (!nUuid.FromString(_nUuid))
+      {
+        std::cerr << "Discovery::SendMsg() error: Invalid node UUID ["
+                  << _nUuid << "]" << std::endl;
+        return;
+      }
+
       // Create the [UN]ADVERTISE message.
-      AdvertiseMsg advMsg(header, _topic, _addr, _ctrl, _nUuid, _scope,
+      AdvertiseMsg advMsg(header, _topic, _addr, _ctrl, nUuid, _scope,
         "not used");
 
       // Allocate a buffer and serialize the message.
@@ -816,9 +1211,12 @@ void Discovery::SendMsg(uint8_t _type, const std::string &_topic,
     }
     case SubType:
     case SubSrvType:
+    case QueryType:
     {
-      // Create the [UN]SUBSCRIBE message.
+      // Create the [UN]SUBSCRIBE message. A query has the same layout: its
+      // topic is the prefix of the topics requested.
       SubscriptionMsg subMsg(header, _topic);
+      subMsg.SetKnownAnswers(_knownAnswers);
 
       // Allocate a buffer and serialize the message.
       buffer.resize(subMsg.GetMsgLength());
@@ -841,8 +1239,13 @@ void Discovery::SendMsg(uint8_t _type, const std::string &_topic,
       return;
   }
 
+  // Host-scoped messages should not reach the network.
+  int sock = this->dataPtr->sock;
+  if (_scope == Scope::Host && this->dataPtr->hostSock >= 0)
+    sock = this->dataPtr->hostSock;
+
   // Send the discovery message to the multicast group.
-  if (sendto(this->dataPtr->sock, reinterpret_cast<const raw_type *>(
+  if (sendto(sock, reinterpret_cast<const raw_type *>(
     reinterpret_cast<unsigned char*>(&buffer[0])),
     msgLength, 0, reinterpret_cast<sockaddr *>(&this->dataPtr->mcastAddr),
     sizeof(this->dataPtr->mcastAddr)) != msgLength)
@@ -856,6 +1259,54 @@ void Discovery::SendMsg(uint8_t _type, const std::string &_topic,
     std::cout << "\t* Sending " << MsgTypesStr[_type]
               << " msg [" << _topic << "]" << std::endl;
   }
+
+  // This advertise message answers any pending subscription request.
+  if (_type == AdvType || _type == AdvSrvType)
+  {
+    this->dataPtr->pendingReplies.erase(
+      std::make_tuple(_type, _topic, _nUuid));
+  }
+}
+
+//////////////////////////////////////////////////
+void Discovery::RegisterPartition(const std::string &_topic)
+{
+  auto hash = TopicUtils::GetPartitionHash(_topic);
+  if (hash == 0)
+    return;
+
+  std::lock_guard<std::recursive_mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->partitions.insert(hash);
+}
+
+//////////////////////////////////////////////////
+Timestamp Discovery::SendPendingReplies()
+{
+  std::lock_guard<std::recursive_mutex> lock(this->dataPtr->mutex);
+
+  Timestamp now = std::chrono::steady_clock::now();
+  Timestamp next = Timestamp::max();
+
+  for (auto it = this->dataPtr->pendingReplies.begin();
+       it != this->dataPtr->pendingReplies.end();)
+  {
+    if (it->second.deadline > now)
+    {
+      next = std::min(next, it->second.deadline);
+      ++it;
+      continue;
+    }
+
+    // Copy the information, SendMsg() removes the entry.
+    auto type = std::get<0>(it->first);
+    auto topic = std::get<1>(it->first);
+    auto info = it->second.info;
+    ++it;
+
+    this->SendMsg(type, topic, info.addr, info.ctrl, info.nUuid, info.scope);
+  }
+
+  return next;
 }
 
 //////////////////////////////////////////////////
@@ -914,6 +1365,16 @@ void Discovery::GetServiceList(std::vector<std::string> &_services) const
   this->dataPtr->infoSrv.GetTopicList(_services);
 }
 
+//////////////////////////////////////////////////
+void Discovery::GetThreadTimes(std::map<std::string, uint64_t> &_times)
+{
+  _times["discovery-reception"] =
+    ThreadCpuNs(*this->dataPtr->threadReception);
+  _times["discovery-heartbeat"] =
+    ThreadCpuNs(*this->dataPtr->threadHeartbeat);
+  _times["discovery-activity"] = ThreadCpuNs(*this->dataPtr->threadActivity);
+}
+
 //////////////////////////////////////////////////
 std::recursive_mutex& Discovery::GetMutex()
 {
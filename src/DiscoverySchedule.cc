@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2015 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <chrono>
+#include "ignition/transport/DiscoverySchedule.hh"
+
+using namespace ignition;
+using namespace transport;
+
+const unsigned int DiscoverySchedule::MinAdvertiseInterval;
+const unsigned int DiscoverySchedule::JitterPercent;
+
+//////////////////////////////////////////////////
+DiscoverySchedule::DiscoverySchedule(const unsigned int _seed)
+  : randomEngine(_seed)
+{
+}
+
+//////////////////////////////////////////////////
+Timestamp DiscoverySchedule::GetNextEvent() const
+{
+  return std::min(this->nextHeartbeat, this->nextAdvertise);
+}
+
+//////////////////////////////////////////////////
+bool DiscoverySchedule::IsHeartbeatDue(const Timestamp &_now) const
+{
+  return _now >= this->nextHeartbeat;
+}
+
+//////////////////////////////////////////////////
+bool DiscoverySchedule::IsAdvertiseDue(const Timestamp &_now) const
+{
+  return _now >= this->nextAdvertise;
+}
+
+//////////////////////////////////////////////////
+bool DiscoverySchedule::Update(const Timestamp &_now,
+  const bool _heartbeatDue, const bool _advertiseDue,
+  const unsigned int _sent, const unsigned int _heartbeatInterval,
+  const unsigned int _advertiseInterval)
+{
+  if (_heartbeatDue || _sent > 0)
+    this->nextHeartbeat = _now + this->Jitter(_heartbeatInterval);
+
+  if (_advertiseDue)
+  {
+    auto &current = this->currentAdvertiseInterval;
+    current = std::min(current, _advertiseInterval);
+    this->nextAdvertise = _now + this->Jitter(current);
+
+    // Exponential backoff.
+    current = std::min(2 * current, _advertiseInterval);
+  }
+
+  return _heartbeatDue && _sent == 0;
+}
+
+//////////////////////////////////////////////////
+bool DiscoverySchedule::ResetAdvertiseInterval(const Timestamp &_now)
+{
+  this->currentAdvertiseInterval = MinAdvertiseInterval;
+
+  Timestamp next = _now + this->Jitter(MinAdvertiseInterval);
+  if (next >= this->nextAdvertise)
+    return false;
+
+  this->nextAdvertise = next;
+  return true;
+}
+
+//////////////////////////////////////////////////
+unsigned int DiscoverySchedule::GetCurrentAdvertiseInterval() const
+{
+  return this->currentAdvertiseInterval;
+}
+
+//////////////////////////////////////////////////
+std::chrono::milliseconds DiscoverySchedule::Jitter(const unsigned int _ms)
+{
+  int maxJitter = static_cast<int>(_ms * JitterPercent / 100);
+  std::uniform_int_distribution<int> dist(-maxJitter, maxJitter);
+  return std::chrono::milliseconds(static_cast<int>(_ms) +
+    dist(this->randomEngine));
+}
@@ -0,0 +1,238 @@
+/*
+ * Copyright (C) 2015 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include "ignition/transport/DiscoverySchedule.hh"
+#include "ignition/transport/TransportTypes.hh"
+#include "gtest/gtest.h"
+
+using namespace ignition;
+using namespace transport;
+
+/// \brief Heartbeat interval used in the tests (ms).
+static const unsigned int HeartbeatInterval = 1000;
+
+/// \brief Advertise interval used in the tests (ms).
+static const unsigned int AdvertiseInterval = 5000;
+
+/// \brief Arbitrary origin of the simulated clock.
+static const Timestamp Start = Timestamp() + std::chrono::hours(1);
+
+//////////////////////////////////////////////////
+/// \brief Get the time elapsed between two points in milliseconds.
+static int64_t ms(const Timestamp &_from, const Timestamp &_to)
+{
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+    _to - _from).count();
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that a value is within +/- JitterPercent of an interval.
+static void expectJitter(const int64_t _value, const unsigned int _interval)
+{
+  int64_t maxJitter = _interval * DiscoverySchedule::JitterPercent / 100;
+  EXPECT_GE(_value, static_cast<int64_t>(_interval) - maxJitter);
+  EXPECT_LE(_value, static_cast<int64_t>(_interval) + maxJitter);
+}
+
+//////////////////////////////////////////////////
+/// \brief Run the schedule with a simulated clock, advertising one topic
+/// every time that the re-advertisement is due.
+/// \param[in] _schedule Schedule.
+/// \param[in] _now Simulated clock. It is moved to the next event.
+/// \param[out] _heartbeat Whether the heartbeat has to be sent.
+/// \return True if the topic was re-advertised.
+static bool step(DiscoverySchedule &_schedule, Timestamp &_now,
+  bool &_heartbeat)
+{
+  _now = _schedule.GetNextEvent();
+  bool heartbeatDue = _schedule.IsHeartbeatDue(_now);
+  bool advertiseDue = _schedule.IsAdvertiseDue(_now);
+  unsigned int sent = advertiseDue ? 1 : 0;
+  _heartbeat = _schedule.Update(_now, heartbeatDue, advertiseDue, sent,
+    HeartbeatInterval, AdvertiseInterval);
+  return advertiseDue;
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the advertise interval doubles after each round until
+/// it reaches the advertise interval.
+TEST(DiscoveryScheduleTest, ExponentialBackoff)
+{
+  DiscoverySchedule schedule(1);
+  Timestamp now = Start;
+
+  // Everything is due at the beginning.
+  EXPECT_TRUE(schedule.IsHeartbeatDue(now));
+  EXPECT_TRUE(schedule.IsAdvertiseDue(now));
+  EXPECT_EQ(schedule.GetCurrentAdvertiseInterval(),
+    DiscoverySchedule::MinAdvertiseInterval);
+
+  // 100, 200, 400, 800, 1600, 3200, 5000, 5000...
+  unsigned int expected = DiscoverySchedule::MinAdvertiseInterval;
+  Timestamp lastAdvertise;
+  bool first = true;
+  int rounds = 0;
+  while (rounds < 10)
+  {
+    bool heartbeat;
+    if (!step(schedule, now, heartbeat))
+      continue;
+
+    if (!first)
+    {
+      expectJitter(ms(lastAdvertise, now), expected);
+      expected = std::min(2 * expected, AdvertiseInterval);
+    }
+    first = false;
+    lastAdvertise = now;
+    ++rounds;
+  }
+  EXPECT_EQ(expected, AdvertiseInterval);
+  EXPECT_EQ(schedule.GetCurrentAdvertiseInterval(), AdvertiseInterval);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the jitter of both intervals never exceeds
+/// +/- JitterPercent and that it is not constant.
+TEST(DiscoveryScheduleTest, JitterBounds)
+{
+  DiscoverySchedule schedule(2);
+  Timestamp now = Start;
+
+  // Reach the steady state advertise interval first. The heartbeat is
+  // scheduled far away, so the next event is the re-advertisement.
+  const unsigned int farAway = 10 * AdvertiseInterval;
+  for (int i = 0; i < 10; ++i)
+    schedule.Update(now, true, true, 1, farAway, AdvertiseInterval);
+
+  int64_t minDelay = AdvertiseInterval;
+  int64_t maxDelay = 0;
+  for (int i = 0; i < 1000; ++i)
+  {
+    schedule.Update(now, true, true, 1, farAway, AdvertiseInterval);
+    int64_t delay = ms(now, schedule.GetNextEvent());
+    expectJitter(delay, AdvertiseInterval);
+    minDelay = std::min(minDelay, delay);
+    maxDelay = std::max(maxDelay, delay);
+  }
+
+  // 1000 samples cover most of the +/- 500 ms range.
+  EXPECT_LT(minDelay, 4600);
+  EXPECT_GT(maxDelay, 5400);
+
+  // The re-advertisement stays at about 5 s, so the next event is the
+  // heartbeat.
+  minDelay = HeartbeatInterval;
+  maxDelay = 0;
+  for (int i = 0; i < 1000; ++i)
+  {
+    schedule.Update(now, true, false, 0, HeartbeatInterval,
+      AdvertiseInterval);
+    int64_t delay = ms(now, schedule.GetNextEvent());
+    expectJitter(delay, HeartbeatInterval);
+    minDelay = std::min(minDelay, delay);
+    maxDelay = std::max(maxDelay, delay);
+  }
+  EXPECT_LT(minDelay, 920);
+  EXPECT_GT(maxDelay, 1080);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the heartbeat is only sent when nothing else was sent
+/// and that an advertisement postpones it.
+TEST(DiscoveryScheduleTest, HeartbeatSuppression)
+{
+  DiscoverySchedule schedule(3);
+  Timestamp now = Start;
+
+  // Both are due, but the advertisement refreshes our activity.
+  EXPECT_FALSE(schedule.Update(now, true, true, 1, HeartbeatInterval,
+    AdvertiseInterval));
+
+  // Nothing to advertise: the heartbeat is needed.
+  EXPECT_TRUE(schedule.Update(now, true, true, 0, HeartbeatInterval,
+    AdvertiseInterval));
+
+  // An advertisement that is not due for the heartbeat postpones it.
+  Timestamp later = now + std::chrono::milliseconds(500);
+  EXPECT_FALSE(schedule.IsHeartbeatDue(later));
+  EXPECT_FALSE(schedule.Update(later, false, true, 1, HeartbeatInterval,
+    AdvertiseInterval));
+  EXPECT_FALSE(schedule.IsHeartbeatDue(now +
+    std::chrono::milliseconds(HeartbeatInterval * 11 / 10)));
+
+  // In the steady state, the advertisements are sent every 5 s and the
+  // heartbeats only fill the gaps: 4 heartbeats per advertisement.
+  DiscoverySchedule steady(4);
+  now = Start;
+  for (int i = 0; i < 10; ++i)
+    steady.Update(now, false, true, 1, HeartbeatInterval, AdvertiseInterval);
+
+  int heartbeats = 0;
+  int advertisements = 0;
+  while (now < Start + std::chrono::seconds(100))
+  {
+    bool heartbeat;
+    if (step(steady, now, heartbeat))
+    {
+      ++advertisements;
+      EXPECT_FALSE(heartbeat);
+    }
+    else
+      EXPECT_TRUE(heartbeat);
+    if (heartbeat)
+      ++heartbeats;
+  }
+  EXPECT_GE(advertisements, 18);
+  EXPECT_LE(advertisements, 22);
+  EXPECT_GE(heartbeats, 3 * advertisements);
+  EXPECT_LE(heartbeats, 5 * advertisements);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that a reset brings the re-advertisement forward and
+/// restarts the backoff, but never delays it.
+TEST(DiscoveryScheduleTest, Reset)
+{
+  DiscoverySchedule schedule(5);
+  Timestamp now = Start;
+  for (int i = 0; i < 10; ++i)
+    schedule.Update(now, false, true, 1, HeartbeatInterval, AdvertiseInterval);
+  EXPECT_EQ(schedule.GetCurrentAdvertiseInterval(), AdvertiseInterval);
+  EXPECT_FALSE(schedule.IsAdvertiseDue(now + std::chrono::seconds(4)));
+
+  // A new peer: re-advertise within MinAdvertiseInterval.
+  EXPECT_TRUE(schedule.ResetAdvertiseInterval(now));
+  EXPECT_EQ(schedule.GetCurrentAdvertiseInterval(),
+    DiscoverySchedule::MinAdvertiseInterval);
+  EXPECT_TRUE(schedule.IsAdvertiseDue(now + std::chrono::milliseconds(
+    DiscoverySchedule::MinAdvertiseInterval * 11 / 10)));
+
+  // A second reset does not delay it.
+  EXPECT_FALSE(schedule.ResetAdvertiseInterval(now +
+    std::chrono::milliseconds(50)));
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
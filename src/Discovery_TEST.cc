@@ -15,14 +15,30 @@
  *
 */
 
+#ifdef _WIN32
+  #include <Winsock2.h>
+  #include <Ws2tcpip.h>
+#else
+  #include <arpa/inet.h>
+  #include <netinet/in.h>
+  #include <sys/socket.h>
+  #include <sys/time.h>
+  #include <unistd.h>
+#endif
+
+#include <algorithm>
 #include <chrono>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <thread>
+#include <vector>
 #include "gtest/gtest.h"
 #include "ignition/transport/Discovery.hh"
+#include "ignition/transport/DiscoveryPrivate.hh"
 #include "ignition/transport/Packet.hh"
 #include "ignition/transport/TransportTypes.hh"
+#include "ignition/transport/Uuid.hh"
 
 using namespace ignition;
 
@@ -36,13 +52,13 @@ std::string service = "/service";
 std::string addr1   = "tcp://127.0.0.1:12345";
 std::string ctrl1   = "tcp://127.0.0.1:12346";
 std::string id1     = "identity1";
-std::string pUuid1  = "UUID-Proc-1";
-std::string nUuid1  = "UUID-Node-1";
+std::string pUuid1  = transport::Uuid().ToString();
+std::string nUuid1  = transport::Uuid().ToString();
 std::string addr2   = "tcp://127.0.0.1:12347";
 std::string ctrl2   = "tcp://127.0.0.1:12348";
 std::string id2     = "identity2";
-std::string pUuid2  = "UUID-Proc-2";
-std::string nUuid2  = "UUID-Node-2";
+std::string pUuid2  = transport::Uuid().ToString();
+std::string nUuid2  = transport::Uuid().ToString();
 transport::Scope scope = transport::Scope::All;
 bool connectionExecuted = false;
 bool connectionExecutedMF = false;
@@ -94,6 +110,49 @@ void onDiscoveryResponse(const std::string &/*_topic*/,
   connectionExecuted = true;
 }
 
+//////////////////////////////////////////////////
+/// \brief Function called each time a discovery update is received for a
+/// topic advertised with 'Scope::Host'.
+void onHostDiscoveryResponse(const std::string &_topic,
+  const std::string &_addr, const std::string &/*_ctrl*/,
+  const std::string &_pUuid, const std::string &/*_nUuid*/,
+  const transport::Scope &_scope)
+{
+  if (_topic != topic)
+    return;
+
+  EXPECT_EQ(_addr, addr1);
+  EXPECT_EQ(_pUuid, pUuid1);
+  EXPECT_EQ(_scope, transport::Scope::Host);
+  connectionExecuted = true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Discovery that gives access to its sockets.
+class SocketDiscovery : public transport::Discovery
+{
+  /// \brief Constructor.
+  /// \param[in] _pUuid Process UUID.
+  public: explicit SocketDiscovery(const std::string &_pUuid)
+    : transport::Discovery(_pUuid)
+  {
+  }
+
+  /// \brief Get the socket used for the messages that can reach the network.
+  /// \return The socket.
+  public: int Socket() const
+  {
+    return this->dataPtr->sock;
+  }
+
+  /// \brief Get the socket used for the host-scoped messages.
+  /// \return The socket or -1 if the socket could not be created.
+  public: int HostSocket() const
+  {
+    return this->dataPtr->hostSock;
+  }
+};
+
 //////////////////////////////////////////////////
 /// \brief Function called each time a discovery srv call update is received.
 void onDiscoverySrvResponse(const std::string &_service,
@@ -359,6 +418,175 @@ TEST(DiscoveryTest, TestAdvertise)
   EXPECT_FALSE(disconnectionExecuted);
 }
 
+//////////////////////////////////////////////////
+/// \brief Wait for an advertise message of a topic in a socket joined to the
+/// discovery multicast group.
+/// \param[in] _sock Socket.
+/// \param[in] _topic Topic name.
+/// \param[out] _srcPort Source port of the advertise message.
+/// \return True if the advertise message was received.
+bool waitForAdvertise(const int _sock, const std::string &_topic,
+  uint16_t &_srcPort)
+{
+  std::vector<char> buffer(transport::DiscoveryPrivate::MaxRcvStr);
+  for (int i = 0; i < MaxIters; ++i)
+  {
+    sockaddr_in srcAddr;
+    socklen_t addrLen = sizeof(srcAddr);
+    int received = recvfrom(_sock, &buffer[0], buffer.size(), 0,
+      reinterpret_cast<sockaddr *>(&srcAddr), &addrLen);
+    if (received <= 0)
+      continue;
+
+    transport::Header header;
+    if (!header.Unpack(&buffer[0], static_cast<size_t>(received)) ||
+        header.GetType() != transport::AdvType)
+      continue;
+
+    transport::AdvertiseMsg advMsg;
+    advMsg.SetHeader(header);
+    advMsg.UnpackBody(&buffer[0] + header.GetHeaderLength());
+    if (advMsg.GetTopic() == _topic)
+    {
+      _srcPort = ntohs(srcAddr.sin_port);
+      return true;
+    }
+  }
+  return false;
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that host-scoped topics are sent through the host socket,
+/// which can't reach the network, and that they are discovered by the
+/// processes running in the same host.
+TEST(DiscoveryTest, TestHostScope)
+{
+  reset();
+
+  SocketDiscovery discovery1(pUuid1);
+  transport::Discovery discovery2(pUuid2);
+  discovery2.SetConnectionsCb(onHostDiscoveryResponse);
+  ASSERT_GE(discovery1.HostSocket(), 0);
+
+#ifdef _WIN32
+  DWORD ttl = 1;
+  DWORD loop = 0;
+  DWORD timeout = Nap;
+#else
+  unsigned char ttl = 1;
+  unsigned char loop = 0;
+  timeval timeout = {0, Nap * 1000};
+#endif
+  socklen_t len = sizeof(ttl);
+
+  // The host socket has a multicast TTL of 0 and loops back the messages.
+  ASSERT_EQ(getsockopt(discovery1.HostSocket(), IPPROTO_IP,
+    IP_MULTICAST_TTL, reinterpret_cast<char *>(&ttl), &len), 0);
+  EXPECT_EQ(ttl, 0u);
+  len = sizeof(loop);
+  ASSERT_EQ(getsockopt(discovery1.HostSocket(), IPPROTO_IP,
+    IP_MULTICAST_LOOP, reinterpret_cast<char *>(&loop), &len), 0);
+  EXPECT_EQ(loop, 1u);
+
+  // Listen to the discovery traffic, so we can check the source port of the
+  // messages.
+  transport::DiscoveryPrivate info;
+  uint16_t discoveryPort = transport::DiscoveryPrivate::DiscoveryPort;
+  int listener = socket(PF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  ASSERT_GE(listener, 0);
+  int reuse = 1;
+  setsockopt(listener, SOL_SOCKET, SO_REUSEADDR,
+    reinterpret_cast<const char *>(&reuse), sizeof(reuse));
+#ifdef SO_REUSEPORT
+  setsockopt(listener, SOL_SOCKET, SO_REUSEPORT,
+    reinterpret_cast<const char *>(&reuse), sizeof(reuse));
+#endif
+  setsockopt(listener, SOL_SOCKET, SO_RCVTIMEO,
+    reinterpret_cast<const char *>(&timeout), sizeof(timeout));
+  ip_mreq group;
+  group.imr_multiaddr.s_addr = inet_addr(info.MulticastGroup.c_str());
+  group.imr_interface.s_addr = inet_addr(discovery1.GetHostAddr().c_str());
+  ASSERT_EQ(setsockopt(listener, IPPROTO_IP, IP_ADD_MEMBERSHIP,
+    reinterpret_cast<const char *>(&group), sizeof(group)), 0);
+  sockaddr_in localAddr;
+  memset(&localAddr, 0, sizeof(localAddr));
+  localAddr.sin_family = AF_INET;
+  localAddr.sin_addr.s_addr = htonl(INADDR_ANY);
+  localAddr.sin_port = htons(discoveryPort);
+  ASSERT_EQ(bind(listener, reinterpret_cast<sockaddr *>(&localAddr),
+    sizeof(localAddr)), 0);
+
+  // A topic with scope 'Host' is discovered by discovery2.
+  discovery1.Advertise(transport::MsgType::Msg, topic, addr1, ctrl1, nUuid1,
+    transport::Scope::Host);
+  waitForCallback(MaxIters, Nap, connectionExecuted);
+  EXPECT_TRUE(connectionExecuted);
+
+  // The advertise message was sent through the host socket.
+  uint16_t srcPort = 0;
+  EXPECT_TRUE(waitForAdvertise(listener, topic, srcPort));
+  sockaddr_in hostAddr;
+  socklen_t addrLen = sizeof(hostAddr);
+  ASSERT_EQ(getsockname(discovery1.HostSocket(),
+    reinterpret_cast<sockaddr *>(&hostAddr), &addrLen), 0);
+  EXPECT_EQ(srcPort, ntohs(hostAddr.sin_port));
+  EXPECT_NE(srcPort, discoveryPort);
+
+  // A topic with scope 'All' is sent through the regular socket.
+  discovery1.Advertise(transport::MsgType::Msg, "/all", addr1, ctrl1, nUuid1,
+    transport::Scope::All);
+  EXPECT_TRUE(waitForAdvertise(listener, "/all", srcPort));
+  EXPECT_EQ(srcPort, discoveryPort);
+
+#ifdef _WIN32
+  closesocket(listener);
+#else
+  close(listener);
+#endif
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the relays are identified by the remote processes.
+TEST(DiscoveryTest, TestRelay)
+{
+  reset();
+
+  // Create two discovery nodes simulating they are in different processes.
+  transport::Discovery discovery1(pUuid1);
+  transport::Discovery discovery2(pUuid2);
+
+  discovery2.SetConnectionsCb(onDiscoveryResponseMultiple);
+  discovery2.SetDisconnectionsCb(ondisconnection);
+
+  discovery1.Advertise(transport::MsgType::Msg, topic, addr1, ctrl1, nUuid1,
+    scope, true);
+  EXPECT_TRUE(discovery1.IsRelay(topic, nUuid1));
+  EXPECT_TRUE(discovery1.HasRelay(topic, true));
+  EXPECT_FALSE(discovery1.HasRelay(topic));
+
+  waitForCallback(MaxIters, Nap, connectionExecuted);
+  EXPECT_TRUE(connectionExecuted);
+  EXPECT_TRUE(discovery2.IsRelay(topic, nUuid1));
+  EXPECT_TRUE(discovery2.HasRelay(topic));
+  EXPECT_FALSE(discovery2.HasRelay(topic, true));
+
+  // A regular publisher of the same topic.
+  reset();
+  discovery1.Advertise(transport::MsgType::Msg, topic, addr1, ctrl1, nUuid2,
+    scope);
+  waitForCallback(MaxIters, Nap, connectionExecuted);
+  EXPECT_TRUE(connectionExecuted);
+  EXPECT_FALSE(discovery2.IsRelay(topic, nUuid2));
+
+  reset();
+  discovery1.Unadvertise(transport::MsgType::Msg, topic, nUuid1);
+  EXPECT_FALSE(discovery1.IsRelay(topic, nUuid1));
+  waitForCallback(MaxIters, Nap, disconnectionExecuted);
+  EXPECT_TRUE(disconnectionExecuted);
+  EXPECT_FALSE(discovery2.IsRelay(topic, nUuid1));
+  EXPECT_FALSE(discovery2.HasRelay(topic));
+}
+
 //////////////////////////////////////////////////
 /// \brief Check that the discovery triggers the callbacks after an advertise.
 TEST(DiscoveryTest, TestAdvertiseSameProc)
@@ -449,6 +677,35 @@ TEST(DiscoveryTest, TestDiscover)
   EXPECT_FALSE(disconnectionExecuted);
 }
 
+//////////////////////////////////////////////////
+/// \brief Check that a query returns the topics and services of the remote
+/// processes without waiting for the maximum time.
+TEST(DiscoveryTest, TestDiscoverAll)
+{
+  reset();
+
+  transport::Discovery discovery1(pUuid1);
+  discovery1.Advertise(transport::MsgType::Msg, topic, addr1, ctrl1, nUuid1,
+    scope);
+  discovery1.Advertise(transport::MsgType::Srv, service, addr1, ctrl1, nUuid1,
+    scope);
+
+  transport::Discovery discovery2(pUuid2);
+  auto start = std::chrono::steady_clock::now();
+  discovery2.DiscoverAll("", 5000);
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  EXPECT_LT(elapsed, std::chrono::milliseconds(2000));
+
+  std::vector<std::string> topics;
+  discovery2.GetTopicList(topics);
+  EXPECT_NE(std::find(topics.begin(), topics.end(), topic), topics.end());
+
+  std::vector<std::string> services;
+  discovery2.GetServiceList(services);
+  EXPECT_NE(std::find(services.begin(), services.end(), service),
+    services.end());
+}
+
 //////////////////////////////////////////////////
 /// \brief Check that the discovery triggers the disconnection callback after
 /// an unadvertise.
@@ -787,6 +1044,64 @@ TEST(DiscoveryTest, TestDiscoverSrv)
   EXPECT_FALSE(disconnectionSrvExecuted);
 }
 
+//////////////////////////////////////////////////
+/// \brief Check that a topic advertised before a remote process starts is
+/// quickly discovered by the new process without waiting for the steady
+/// state advertise interval.
+TEST(DiscoveryTest, TestAdvertiseNewPeer)
+{
+  reset();
+
+  transport::Discovery discovery1(pUuid1);
+  discovery1.Advertise(transport::MsgType::Msg, topic, addr1, ctrl1, nUuid1,
+    scope);
+
+  // Let the fast re-advertisements of discovery1 finish.
+  std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+
+  transport::Discovery discovery2(pUuid2);
+  discovery2.SetConnectionsCb(onDiscoveryResponse);
+
+  // discovery2 does not call Discover(). The topic should be received
+  // because discovery1 re-advertises its topics when a new process appears.
+  waitForCallback(MaxIters, Nap, connectionExecuted);
+
+  EXPECT_TRUE(connectionExecuted);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the discovery messages from other partitions are
+/// discarded.
+TEST(DiscoveryTest, TestPartitionFilter)
+{
+  reset();
+
+  transport::Discovery discovery1(pUuid1);
+  transport::Discovery discovery2(pUuid2);
+  discovery2.SetConnectionsCb(onDiscoveryResponse);
+
+  // discovery2 is only interested in partition "b".
+  discovery2.Discover("@/b@/foo", false);
+
+  // This topic belongs to a different partition.
+  discovery1.Advertise(transport::MsgType::Msg, "@/a@/foo", addr1, ctrl1,
+    nUuid1, scope);
+
+  waitForCallback(MaxIters, Nap, connectionExecuted);
+  EXPECT_FALSE(connectionExecuted);
+
+  std::vector<std::string> topics;
+  discovery2.GetTopicList(topics);
+  EXPECT_TRUE(topics.empty());
+
+  // This topic belongs to the same partition.
+  discovery1.Advertise(transport::MsgType::Msg, "@/b@/foo", addr1, ctrl1,
+    nUuid1, scope);
+
+  waitForCallback(MaxIters, Nap, connectionExecuted);
+  EXPECT_TRUE(connectionExecuted);
+}
+
 //////////////////////////////////////////////////
 int main(int argc, char **argv)
 {
@@ -15,12 +15,17 @@
  *
 */
 
+#include <chrono>
+#include <cstddef>
+#include <iostream>
 #include <map>
 #include <string>
+#include <vector>
 #include "ignition/transport/HandlerStorage.hh"
 #include "ignition/transport/RepHandler.hh"
 #include "ignition/transport/SubscriptionHandler.hh"
 #include "ignition/transport/TransportTypes.hh"
+#include "ignition/transport/Uuid.hh"
 #include "gtest/gtest.h"
 #include "msg/int.pb.h"
 #include "msg/vector3d.pb.h"
@@ -31,7 +36,6 @@ using namespace ignition;
 std::string topic   = "foo";
 std::string nUuid1  = "node-UUID-1";
 std::string nUuid2  = "node-UUID-2";
-std::string hUuid   = "handler-UUID";
 int intResult       = 4;
 bool cbExecuted = false;
 
@@ -62,7 +66,8 @@ void cb1(const std::string &_topic, const transport::msgs::Vector3d &_req,
 TEST(RepStorageTest, RepStorageAPI)
 {
   transport::IRepHandlerPtr handler;
-  std::map<std::string, std::map<std::string, transport::IRepHandlerPtr>> m;
+  std::map<std::string, std::map<transport::Uuid, transport::IRepHandlerPtr>>
+    m;
   transport::HandlerStorage<transport::IRepHandler> reps;
   transport::msgs::Int rep1Msg;
   bool result;
@@ -75,7 +80,7 @@ TEST(RepStorageTest, RepStorageAPI)
   // Check some operations when there is no data stored.
   EXPECT_FALSE(reps.GetHandlers(topic, m));
   EXPECT_FALSE(reps.GetHandler(topic, handler));
-  EXPECT_FALSE(reps.GetHandler(topic, nUuid1, hUuid, handler));
+  EXPECT_FALSE(reps.GetHandler(topic, nUuid1, transport::Uuid(), handler));
   EXPECT_FALSE(reps.HasHandlersForTopic(topic));
   EXPECT_FALSE(reps.RemoveHandlersForNode(topic, nUuid1));
   EXPECT_FALSE(reps.HasHandlersForNode(topic, nUuid1));
@@ -93,11 +98,11 @@ TEST(RepStorageTest, RepStorageAPI)
   EXPECT_TRUE(reps.HasHandlersForNode(topic, nUuid1));
   EXPECT_FALSE(reps.HasHandlersForNode(topic, nUuid2));
   EXPECT_TRUE(reps.GetHandler(topic, handler));
-  std::string handlerUuid = handler->GetHandlerUuid();
+  transport::Uuid handlerUuid = handler->GetHandlerUuid();
   EXPECT_EQ(handlerUuid, rep1HandlerPtr->GetHandlerUuid());
   EXPECT_TRUE(reps.GetHandler(topic, nUuid1, handlerUuid, handler));
   EXPECT_FALSE(reps.GetHandler(topic, "wrongNodeUuid", handlerUuid, handler));
-  EXPECT_FALSE(reps.GetHandler(topic, nUuid1, "wrongHandlerUuid", handler));
+  EXPECT_FALSE(reps.GetHandler(topic, nUuid1, transport::Uuid(), handler));
   EXPECT_TRUE(reps.GetHandlers(topic, m));
   EXPECT_EQ(m.size(), 1u);
   EXPECT_EQ(m.begin()->first, nUuid1);
@@ -199,11 +204,11 @@ TEST(RepStorageTest, RepStorageAPI)
 TEST(RepStorageTest, SubStorageNoCallbacks)
 {
   transport::ISubscriptionHandlerPtr handler;
-  std::map<std::string, std::map<std::string,
-    transport::ISubscriptionHandlerPtr>> m;
+  std::map<std::string, transport::ISubscriptionHandler_M> m;
   transport::HandlerStorage<transport::ISubscriptionHandler> subs;
   transport::msgs::Int msg;
   msg.set_data(5);
+  transport::MessageInfo info;
 
   // Create a Subscription handler.
   std::shared_ptr<transport::SubscriptionHandler<transport::msgs::Int>>
@@ -214,10 +219,191 @@ TEST(RepStorageTest, SubStorageNoCallbacks)
   subs.AddHandler(topic, nUuid1, sub1HandlerPtr);
 
   transport::ISubscriptionHandlerPtr h;
-  std::string handlerUuid = sub1HandlerPtr->GetHandlerUuid();
+  transport::Uuid handlerUuid = sub1HandlerPtr->GetHandlerUuid();
   EXPECT_TRUE(subs.GetHandler(topic, nUuid1, handlerUuid, h));
-  EXPECT_FALSE(h->RunLocalCallback(topic, msg));
-  EXPECT_FALSE(h->RunCallback(topic, "some data"));
+  EXPECT_FALSE(h->RunLocalCallback(topic, msg, info));
+  EXPECT_FALSE(h->RunCallback(topic, "some data", info));
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the flat lists of handlers used for dispatching.
+TEST(RepStorageTest, FlatHandlers)
+{
+  transport::HandlerStorage<transport::ISubscriptionHandler> subs;
+  EXPECT_EQ(subs.Handlers(topic), nullptr);
+  EXPECT_EQ(subs.Handlers(0), nullptr);
+
+  // Topic identifiers are stable.
+  size_t id = subs.TopicId(topic);
+  EXPECT_EQ(subs.TopicId(topic), id);
+  EXPECT_NE(subs.TopicId("bar"), id);
+  EXPECT_EQ(subs.Handlers(id), nullptr);
+
+  std::shared_ptr<transport::SubscriptionHandler<transport::msgs::Int>>
+    sub1HandlerPtr(new transport::SubscriptionHandler
+      <transport::msgs::Int>(nUuid1));
+  std::shared_ptr<transport::SubscriptionHandler<transport::msgs::Int>>
+    sub2HandlerPtr(new transport::SubscriptionHandler
+      <transport::msgs::Int>(nUuid2));
+
+  subs.AddHandler(topic, nUuid1, sub1HandlerPtr);
+  subs.AddHandler(topic, nUuid2, sub2HandlerPtr);
+  auto handlers = subs.Handlers(id);
+  ASSERT_NE(handlers, nullptr);
+  EXPECT_EQ(subs.Handlers(topic), handlers);
+  ASSERT_EQ(handlers->size(), 2u);
+  EXPECT_EQ(handlers->at(0).nUuid, nUuid1);
+  EXPECT_EQ(handlers->at(0).handler, sub1HandlerPtr);
+  EXPECT_EQ(handlers->at(1).nUuid, nUuid2);
+  EXPECT_EQ(handlers->at(1).handler, sub2HandlerPtr);
+
+  // A snapshot is not modified by later changes.
+  EXPECT_TRUE(subs.RemoveHandlersForNode(topic, nUuid1));
+  EXPECT_EQ(handlers->size(), 2u);
+  ASSERT_NE(subs.Handlers(id), nullptr);
+  ASSERT_EQ(subs.Handlers(id)->size(), 1u);
+  EXPECT_EQ(subs.Handlers(id)->at(0).handler, sub2HandlerPtr);
+
+  EXPECT_TRUE(subs.RemoveHandler(topic, nUuid2,
+    sub2HandlerPtr->GetHandlerUuid()));
+  EXPECT_EQ(subs.Handlers(id), nullptr);
+  EXPECT_EQ(subs.TopicId(topic), id);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the handlers reuse their messages when enabled.
+TEST(RepStorageTest, ReuseMsg)
+{
+  transport::msgs::Int msg;
+  std::string data1;
+  std::string data2;
+  msg.set_data(1);
+  ASSERT_TRUE(msg.SerializeToString(&data1));
+  msg.set_data(2);
+  ASSERT_TRUE(msg.SerializeToString(&data2));
+  transport::MessageInfo info;
+
+  std::vector<const transport::msgs::Int*> addresses;
+  std::vector<int> values;
+  transport::SubscriptionHandler<transport::msgs::Int> handler(nUuid1);
+  EXPECT_FALSE(handler.ReuseMsg());
+  handler.SetCallback([&](const std::string &/*_topic*/,
+    const transport::msgs::Int &_msg)
+    {
+      addresses.push_back(&_msg);
+      values.push_back(_msg.data());
+      // A message dispatched from the callback gets its own message.
+      if (_msg.data() == 1 && values.size() == 2)
+        handler.RunCallback(topic, data2, info);
+    });
+
+  handler.SetReuseMsg(true);
+  EXPECT_TRUE(handler.ReuseMsg());
+  EXPECT_TRUE(handler.RunCallback(topic, data1, info));
+  EXPECT_TRUE(handler.RunCallback(topic, data1, info));
+  ASSERT_EQ(values, std::vector<int>({1, 1, 2}));
+  EXPECT_EQ(addresses[0], addresses[1]);
+  EXPECT_NE(addresses[1], addresses[2]);
+
+  // The reused message is overwritten by the next message.
+  EXPECT_TRUE(handler.RunCallback(topic, data2, info));
+  ASSERT_EQ(values.size(), 4u);
+  EXPECT_EQ(values.back(), 2);
+  EXPECT_EQ(addresses.back(), addresses[0]);
+
+  // Service replier.
+  bool cleared = true;
+  transport::RepHandler<transport::msgs::Int, transport::msgs::Int> rep;
+  rep.SetCallback([&cleared](const std::string &/*_topic*/,
+    const transport::msgs::Int &_req, transport::msgs::Int &_rep,
+    bool &_result)
+    {
+      cleared = cleared && !_rep.has_data();
+      _rep.set_data(_req.data() * 10);
+      _result = true;
+    });
+  rep.SetReuseMsg(true);
+  EXPECT_TRUE(rep.ReuseMsg());
+
+  std::string response;
+  bool result = false;
+  rep.RunCallback(topic, data1, response, result);
+  EXPECT_TRUE(result);
+  ASSERT_TRUE(msg.ParseFromString(response));
+  EXPECT_EQ(msg.data(), 10);
+
+  // The response is cleared between requests.
+  rep.RunCallback(topic, data2, response, result);
+  ASSERT_TRUE(msg.ParseFromString(response));
+  EXPECT_EQ(msg.data(), 20);
+  EXPECT_TRUE(cleared);
+}
+
+//////////////////////////////////////////////////
+/// \brief Microbenchmark of the handler lookups done for every message:
+/// the nested maps copied by GetHandlers() versus the flat list returned by
+/// Handlers(). The times are only reported.
+TEST(RepStorageTest, DispatchBenchmark)
+{
+  const int Topics = 100;
+  const int Nodes = 4;
+  const int Iterations = 10000;
+
+  transport::HandlerStorage<transport::ISubscriptionHandler> subs;
+  std::vector<std::string> topics;
+  for (int i = 0; i < Topics; ++i)
+  {
+    topics.push_back("@/benchmark/topic_" + std::to_string(i));
+    for (int j = 0; j < Nodes; ++j)
+    {
+      std::string node = transport::Uuid().ToString();
+      std::shared_ptr<transport::SubscriptionHandler<transport::msgs::Int>>
+        handler(new transport::SubscriptionHandler
+          <transport::msgs::Int>(node));
+      subs.AddHandler(topics.back(), node, handler);
+    }
+  }
+  const std::string &target = topics[Topics / 2];
+  size_t id = subs.TopicId(target);
+
+  size_t visited = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < Iterations; ++i)
+  {
+    std::map<std::string, transport::ISubscriptionHandler_M> handlers;
+    subs.GetHandlers(target, handlers);
+    for (auto const &node : handlers)
+      visited += node.second.size();
+  }
+  auto nested = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now() - start).count();
+  EXPECT_EQ(visited, static_cast<size_t>(Iterations * Nodes));
+
+  visited = 0;
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < Iterations; ++i)
+  {
+    auto handlers = subs.Handlers(target);
+    visited += handlers->size();
+  }
+  auto byName = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now() - start).count();
+  EXPECT_EQ(visited, static_cast<size_t>(Iterations * Nodes));
+
+  visited = 0;
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < Iterations; ++i)
+  {
+    auto handlers = subs.Handlers(id);
+    visited += handlers->size();
+  }
+  auto byId = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now() - start).count();
+  EXPECT_EQ(visited, static_cast<size_t>(Iterations * Nodes));
+
+  std::cout << "Handler lookup (ns/op): nested maps " << nested / Iterations
+            << ", flat list by name " << byName / Iterations
+            << ", flat list by id " << byId / Iterations << std::endl;
 }
 
 //////////////////////////////////////////////////
@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2015 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "ignition/transport/Introspection.hh"
+
+using namespace ignition;
+using namespace transport;
+
+/// \brief First line of a serialized state. It contains the format version.
+static const char *Header = "ign-introspection 1";
+
+//////////////////////////////////////////////////
+std::string ProcessState::Serialize() const
+{
+  std::ostringstream out;
+  out << Header << "\n"
+      << "process " << this->pUuid << " " << this->hostAddr << " "
+      << this->pid << " " << this->connections << " " << this->cpuTime
+      << "\n";
+
+  for (auto const &thread : this->threads)
+    out << "thread " << thread.first << " " << thread.second << "\n";
+
+  for (auto const &topic : this->topics)
+  {
+    auto const &s = topic.stats;
+    out << "topic " << topic.name << " " << topic.advertised << " "
+        << topic.subscribed << " " << topic.remoteSubscribers << " "
+        << s.published << " " << s.bytesPublished << " "
+        << s.serializationTime << " " << s.received << " "
+        << s.bytesReceived << " " << s.callbackTime << " " << s.dropped << " "
+        << s.lost << " " << s.latencySamples << " " << s.latencyTotal << " "
+        << s.latencyMax << " " << s.queuedMessages << " " << s.queuedBytes
+        << " " << s.limitReached << "\n";
+  }
+
+  for (auto const &service : this->services)
+  {
+    auto const &s = service.stats;
+    out << "service " << service.name << " " << service.advertised << " "
+        << s.requests << " " << s.responses << " " << s.failures << " "
+        << s.timeouts << " " << s.latencyTotal << " " << s.latencyMax << " "
+        << s.served << " " << s.callbackTime << "\n";
+  }
+
+  return out.str();
+}
+
+//////////////////////////////////////////////////
+bool ProcessState::Unserialize(const std::string &_data)
+{
+  std::istringstream in(_data);
+  std::string line;
+  if (!std::getline(in, line) || line != Header)
+  {
+    std::cerr << "ProcessState::Unserialize() error: Unknown format"
+              << std::endl;
+    return false;
+  }
+
+  *this = ProcessState();
+  while (std::getline(in, line))
+  {
+    std::istringstream fields(line);
+    std::string kind;
+    fields >> kind;
+
+    if (kind == "process")
+    {
+      fields >> this->pUuid >> this->hostAddr >> this->pid
+             >> this->connections >> this->cpuTime;
+    }
+    else if (kind == "thread")
+    {
+      std::string name;
+      uint64_t time = 0;
+      fields >> name >> time;
+      this->threads[name] = time;
+    }
+    else if (kind == "topic")
+    {
+      TopicState topic;
+      auto &s = topic.stats;
+      fields >> topic.name >> topic.advertised >> topic.subscribed
+             >> topic.remoteSubscribers >> s.published >> s.bytesPublished
+             >> s.serializationTime >> s.received >> s.bytesReceived
+             >> s.callbackTime >> s.dropped >> s.lost >> s.latencySamples
+             >> s.latencyTotal >> s.latencyMax >> s.queuedMessages
+             >> s.queuedBytes >> s.limitReached;
+      this->topics.push_back(topic);
+    }
+    else if (kind == "service")
+    {
+      ServiceState service;
+      auto &s = service.stats;
+      fields >> service.name >> service.advertised >> s.requests
+             >> s.responses >> s.failures >> s.timeouts >> s.latencyTotal
+             >> s.latencyMax >> s.served >> s.callbackTime;
+      this->services.push_back(service);
+    }
+    else
+    {
+      // Lines added by newer versions of the format are ignored.
+      continue;
+    }
+
+    if (fields.fail())
+    {
+      std::cerr << "ProcessState::Unserialize() error: Invalid line ["
+                << line << "]" << std::endl;
+      return false;
+    }
+  }
+
+  return !this->pUuid.empty();
+}
@@ -0,0 +1,200 @@
+/*
+ * Copyright (C) 2015 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <string>
+#include <vector>
+#include "ignition/transport/Discovery.hh"
+#include "ignition/transport/Introspection.hh"
+#include "ignition/transport/Node.hh"
+#include "ignition/transport/NodeShared.hh"
+#include "ignition/transport/TopicUtils.hh"
+#include "gtest/gtest.h"
+#include "ignition/transport/test_config.h"
+#include "msg/int.pb.h"
+
+using namespace ignition;
+
+//////////////////////////////////////////////////
+/// \brief Subscription callback.
+void cb(const std::string &/*_topic*/, const transport::msgs::Int &/*_msg*/)
+{
+}
+
+//////////////////////////////////////////////////
+/// \brief Service callback.
+void srvEcho(const std::string &/*_topic*/, const transport::msgs::Int &_req,
+  transport::msgs::Int &_rep, bool &_result)
+{
+  _rep.set_data(_req.data());
+  _result = true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the serialization of a process state.
+TEST(IntrospectionTest, SerializeState)
+{
+  transport::ProcessState state;
+  state.pUuid = "p1";
+  state.hostAddr = "10.0.0.1";
+  state.pid = 1234;
+  state.connections = 2;
+  state.cpuTime = 5000;
+  state.threads["reception"] = 100;
+
+  transport::TopicState topic;
+  topic.name = "/foo";
+  topic.advertised = true;
+  topic.remoteSubscribers = 3;
+  topic.stats.published = 10;
+  topic.stats.queuedBytes = 20;
+  state.topics.push_back(topic);
+
+  transport::ServiceState service;
+  service.name = "/echo";
+  service.stats.requests = 4;
+  state.services.push_back(service);
+
+  transport::ProcessState other;
+  ASSERT_TRUE(other.Unserialize(state.Serialize()));
+  EXPECT_EQ(other.pUuid, "p1");
+  EXPECT_EQ(other.hostAddr, "10.0.0.1");
+  EXPECT_EQ(other.pid, 1234u);
+  EXPECT_EQ(other.connections, 2u);
+  EXPECT_EQ(other.cpuTime, 5000u);
+  EXPECT_EQ(other.threads, state.threads);
+  ASSERT_EQ(other.topics.size(), 1u);
+  EXPECT_EQ(other.topics[0].name, "/foo");
+  EXPECT_TRUE(other.topics[0].advertised);
+  EXPECT_FALSE(other.topics[0].subscribed);
+  EXPECT_EQ(other.topics[0].remoteSubscribers, 3u);
+  EXPECT_EQ(other.topics[0].stats.published, 10u);
+  EXPECT_EQ(other.topics[0].stats.queuedBytes, 20u);
+  ASSERT_EQ(other.services.size(), 1u);
+  EXPECT_EQ(other.services[0].name, "/echo");
+  EXPECT_FALSE(other.services[0].advertised);
+  EXPECT_EQ(other.services[0].stats.requests, 4u);
+
+  EXPECT_FALSE(other.Unserialize(""));
+  EXPECT_FALSE(other.Unserialize("unknown format\n"));
+  EXPECT_FALSE(other.Unserialize("ign-introspection 1\nprocess p1 x\n"));
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the state reported by the introspection service of this
+/// process.
+TEST(IntrospectionTest, ProcessState)
+{
+  std::string partition = testing::getRandomPartition();
+  auto shared = transport::NodeShared::GetInstance();
+
+  transport::Node node(partition, "");
+  EXPECT_TRUE(node.Advertise("/foo"));
+  EXPECT_TRUE(node.Subscribe("/bar", cb));
+  EXPECT_TRUE(node.Advertise("/echo", srvEcho));
+
+  transport::msgs::Int msg;
+  msg.set_data(1);
+  EXPECT_TRUE(node.Publish("/foo", msg));
+
+  // There are no other processes in the partition.
+  std::vector<transport::ProcessState> states;
+  node.GetProcessStates(200, states);
+  ASSERT_EQ(states.size(), 1u);
+
+  auto &state = states[0];
+  EXPECT_EQ(state.pUuid, shared->pUuid);
+  EXPECT_EQ(state.hostAddr, shared->hostAddr);
+  EXPECT_GT(state.pid, 0u);
+  EXPECT_NE(state.threads.find("reception"), state.threads.end());
+  EXPECT_NE(state.threads.find("discovery-reception"), state.threads.end());
+
+  ASSERT_EQ(state.topics.size(), 2u);
+  EXPECT_EQ(state.topics[0].name, "/bar");
+  EXPECT_FALSE(state.topics[0].advertised);
+  EXPECT_TRUE(state.topics[0].subscribed);
+  EXPECT_EQ(state.topics[1].name, "/foo");
+  EXPECT_TRUE(state.topics[1].advertised);
+  EXPECT_FALSE(state.topics[1].subscribed);
+  EXPECT_EQ(state.topics[1].stats.published, 1u);
+
+  // The introspection service itself is not reported.
+  ASSERT_EQ(state.services.size(), 1u);
+  EXPECT_EQ(state.services[0].name, "/echo");
+  EXPECT_TRUE(state.services[0].advertised);
+
+  // The same state is answered by the introspection service.
+  std::string prefix;
+  ASSERT_TRUE(transport::TopicUtils::GetFullyQualifiedName(partition, "",
+    "/x", prefix));
+  prefix.erase(prefix.find_last_of("@") + 1);
+  std::string service;
+  ASSERT_TRUE(transport::TopicUtils::GetFullyQualifiedName(partition, "",
+    transport::IntrospectionPrefix + shared->pUuid, service));
+
+  transport::IRepHandlerPtr handler;
+  ASSERT_TRUE(shared->repliers.GetHandler(service, handler));
+  std::string rep;
+  bool result = false;
+  handler->RunCallback(service, prefix, rep, result);
+  EXPECT_TRUE(result);
+
+  transport::ProcessState answer;
+  ASSERT_TRUE(answer.Unserialize(rep));
+  EXPECT_EQ(answer.pUuid, shared->pUuid);
+  EXPECT_EQ(answer.topics.size(), 2u);
+
+  // The topics are not reported once unadvertised and unsubscribed.
+  EXPECT_TRUE(node.Unadvertise("/foo"));
+  node.Unsubscribe("/bar");
+  shared->GetProcessState(prefix, answer);
+  for (auto const &topic : answer.topics)
+  {
+    EXPECT_FALSE(topic.advertised);
+    EXPECT_FALSE(topic.subscribed);
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the introspection service is advertised but not listed
+/// by the nodes.
+TEST(IntrospectionTest, ServiceList)
+{
+  std::string partition = testing::getRandomPartition();
+  auto shared = transport::NodeShared::GetInstance();
+  EXPECT_TRUE(shared->introspection);
+
+  transport::Node node(partition, "");
+  EXPECT_TRUE(node.Advertise("/echo", srvEcho));
+
+  std::string service;
+  ASSERT_TRUE(transport::TopicUtils::GetFullyQualifiedName(partition, "",
+    transport::IntrospectionPrefix + shared->pUuid, service));
+  transport::Addresses_M addresses;
+  EXPECT_TRUE(shared->discovery->GetSrvAddresses(service, addresses));
+
+  std::vector<std::string> services;
+  node.GetServiceList(services);
+  ASSERT_EQ(services.size(), 1u);
+  EXPECT_EQ(services[0], "/echo");
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,735 @@
+/*
+ * Copyright (C) 2015 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef _WIN32
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <sys/types.h>
+  #include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "ignition/transport/Log.hh"
+
+using namespace ignition;
+using namespace transport;
+
+const char LogWriter::SegmentMagic[9] = "IGNLOGSG";
+const char LogWriter::IndexMagic[9] = "IGNLOGIX";
+const uint64_t LogWriter::DefSegmentSize;
+const uint32_t LogWriter::Version;
+const uint32_t LogWriter::HeaderSize;
+const uint32_t LogWriter::RecordHeaderSize;
+
+//////////////////////////////////////////////////
+/// \brief Append the binary representation of a value to a buffer.
+/// \param[in, out] _buffer Buffer.
+/// \param[in] _value Value.
+template<typename T> static void appendValue(std::string &_buffer,
+  const T &_value)
+{
+  _buffer.append(reinterpret_cast<const char *>(&_value), sizeof(_value));
+}
+
+//////////////////////////////////////////////////
+/// \brief Append a string preceded by its length (uint16) to a buffer.
+/// \param[in, out] _buffer Buffer.
+/// \param[in] _str String.
+static void appendString(std::string &_buffer, const std::string &_str)
+{
+  appendValue(_buffer, static_cast<uint16_t>(_str.size()));
+  _buffer.append(_str);
+}
+
+//////////////////////////////////////////////////
+LogWriter::~LogWriter()
+{
+  this->Close();
+}
+
+//////////////////////////////////////////////////
+bool LogWriter::Open(const std::string &_dir, const uint64_t _segmentSize)
+{
+#ifdef _WIN32
+  std::cerr << "LogWriter::Open() error: Not supported on Windows"
+            << std::endl;
+  return false;
+#else
+  if (this->IsOpen())
+  {
+    std::cerr << "LogWriter::Open() error: The log is already open"
+              << std::endl;
+    return false;
+  }
+
+  if (_dir.empty() || _segmentSize <= HeaderSize + RecordHeaderSize)
+  {
+    std::cerr << "LogWriter::Open() error: Invalid arguments" << std::endl;
+    return false;
+  }
+
+  if (mkdir(_dir.c_str(), 0755) != 0 && errno != EEXIST)
+  {
+    std::cerr << "LogWriter::Open() error: Unable to create [" << _dir
+              << "]: " << strerror(errno) << std::endl;
+    return false;
+  }
+
+  // Do not overwrite a previous log.
+  struct stat info;
+  if (stat(SegmentPath(_dir, 0, false).c_str(), &info) == 0)
+  {
+    std::cerr << "LogWriter::Open() error: [" << _dir
+              << "] already contains a log" << std::endl;
+    return false;
+  }
+
+  this->dir = _dir;
+  this->segmentSize = _segmentSize;
+  this->segments = 0;
+  this->messages = 0;
+  this->bytes = 0;
+
+  return this->OpenSegment(0);
+#endif
+}
+
+//////////////////////////////////////////////////
+bool LogWriter::IsOpen() const
+{
+  return this->base != nullptr;
+}
+
+//////////////////////////////////////////////////
+bool LogWriter::Write(const std::string &_topic, const std::string &_type,
+  const char *_data, const size_t _size, const uint64_t _time)
+{
+  if (!this->IsOpen())
+    return false;
+
+  if (_topic.size() > UINT16_MAX || _type.size() > UINT16_MAX ||
+      _size > UINT32_MAX - RecordHeaderSize - _topic.size() - _type.size())
+  {
+    std::cerr << "LogWriter::Write() error: Message too big" << std::endl;
+    return false;
+  }
+
+  uint32_t recordSize = static_cast<uint32_t>(RecordHeaderSize +
+    _topic.size() + _type.size() + _size);
+
+  // Start a new segment when the record does not fit.
+  if (this->offset + recordSize > this->mappedSize)
+  {
+    if (!this->CloseSegment() || !this->OpenSegment(recordSize))
+      return false;
+  }
+
+  // Topic table.
+  std::string key = _topic + '\0' + _type;
+  auto it = this->topicIds.find(key);
+  if (it == this->topicIds.end())
+  {
+    it = this->topicIds.insert(
+      std::make_pair(key, this->indexTopics.size())).first;
+    LogTopic logTopic;
+    logTopic.topic = _topic;
+    logTopic.type = _type;
+    this->indexTopics.push_back(logTopic);
+  }
+  ++this->indexTopics[it->second].messages;
+  this->indexEntries.push_back(IndexEntry{_time, this->offset, it->second});
+
+  // Record.
+  char *dst = this->base + this->offset;
+  uint16_t topicLen = static_cast<uint16_t>(_topic.size());
+  uint16_t typeLen = static_cast<uint16_t>(_type.size());
+  memcpy(dst, &recordSize, sizeof(recordSize));
+  memcpy(dst + 4, &topicLen, sizeof(topicLen));
+  memcpy(dst + 6, &typeLen, sizeof(typeLen));
+  memcpy(dst + 8, &_time, sizeof(_time));
+  dst += RecordHeaderSize;
+  memcpy(dst, _topic.data(), _topic.size());
+  dst += _topic.size();
+  memcpy(dst, _type.data(), _type.size());
+  dst += _type.size();
+  memcpy(dst, _data, _size);
+
+  this->offset += recordSize;
+  ++this->messages;
+  this->bytes += recordSize;
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+void LogWriter::Close()
+{
+  if (!this->IsOpen())
+    return;
+
+  this->CloseSegment();
+}
+
+//////////////////////////////////////////////////
+uint64_t LogWriter::GetMessages() const
+{
+  return this->messages;
+}
+
+//////////////////////////////////////////////////
+uint64_t LogWriter::GetBytes() const
+{
+  return this->bytes;
+}
+
+//////////////////////////////////////////////////
+unsigned int LogWriter::GetSegments() const
+{
+  return this->segments;
+}
+
+//////////////////////////////////////////////////
+uint64_t LogWriter::Now()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+//////////////////////////////////////////////////
+std::string LogWriter::SegmentPath(const std::string &_dir,
+  const unsigned int _segment, const bool _index)
+{
+  std::ostringstream path;
+  path << _dir << "/" << std::setw(6) << std::setfill('0') << _segment
+       << (_index ? ".idx" : ".seg");
+  return path.str();
+}
+
+//////////////////////////////////////////////////
+bool LogWriter::OpenSegment(const uint64_t _minSize)
+{
+#ifdef _WIN32
+  (void)_minSize;
+  return false;
+#else
+  std::string path = SegmentPath(this->dir, this->segments, false);
+  this->fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (this->fd < 0)
+  {
+    std::cerr << "LogWriter::OpenSegment() error: Unable to create [" << path
+              << "]: " << strerror(errno) << std::endl;
+    return false;
+  }
+
+  uint64_t size = std::max(this->segmentSize, _minSize + HeaderSize);
+  if (ftruncate(this->fd, size) != 0)
+  {
+    std::cerr << "LogWriter::OpenSegment() error: Unable to resize [" << path
+              << "]: " << strerror(errno) << std::endl;
+    close(this->fd);
+    this->fd = -1;
+    return false;
+  }
+
+  void *addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+    this->fd, 0);
+  if (addr == MAP_FAILED)
+  {
+    std::cerr << "LogWriter::OpenSegment() error: Unable to map [" << path
+              << "]: " << strerror(errno) << std::endl;
+    close(this->fd);
+    this->fd = -1;
+    return false;
+  }
+
+  // The segment is written sequentially: let the kernel read ahead and
+  // write back the pages in big chunks.
+  madvise(addr, size, MADV_SEQUENTIAL);
+
+  this->base = static_cast<char *>(addr);
+  this->mappedSize = size;
+
+  // Header.
+  uint32_t reserved = 0;
+  memcpy(this->base, SegmentMagic, 8);
+  memcpy(this->base + 8, &Version, sizeof(Version));
+  memcpy(this->base + 12, &reserved, sizeof(reserved));
+  this->offset = HeaderSize;
+  this->bytes += HeaderSize;
+
+  this->indexTopics.clear();
+  this->topicIds.clear();
+  this->indexEntries.clear();
+
+  ++this->segments;
+  return true;
+#endif
+}
+
+//////////////////////////////////////////////////
+bool LogWriter::CloseSegment()
+{
+#ifdef _WIN32
+  return false;
+#else
+  if (!this->base)
+    return false;
+
+  bool result = this->WriteIndex();
+
+  munmap(this->base, this->mappedSize);
+  this->base = nullptr;
+  this->mappedSize = 0;
+
+  // Remove the space reserved but not used.
+  if (ftruncate(this->fd, this->offset) != 0)
+  {
+    std::cerr << "LogWriter::CloseSegment() error: Unable to trim segment: "
+              << strerror(errno) << std::endl;
+    result = false;
+  }
+  close(this->fd);
+  this->fd = -1;
+
+  return result;
+#endif
+}
+
+//////////////////////////////////////////////////
+bool LogWriter::WriteIndex()
+{
+  std::string buffer;
+  buffer.append(IndexMagic, 8);
+  appendValue(buffer, Version);
+  appendValue(buffer, static_cast<uint32_t>(0));
+
+  uint64_t first = 0;
+  uint64_t last = 0;
+  if (!this->indexEntries.empty())
+  {
+    first = this->indexEntries.front().time;
+    last = this->indexEntries.back().time;
+  }
+  appendValue(buffer, first);
+  appendValue(buffer, last);
+
+  appendValue(buffer, static_cast<uint32_t>(this->indexTopics.size()));
+  for (auto const &topic : this->indexTopics)
+  {
+    appendString(buffer, topic.topic);
+    appendString(buffer, topic.type);
+    appendValue(buffer, topic.messages);
+  }
+
+  appendValue(buffer, static_cast<uint64_t>(this->indexEntries.size()));
+  for (auto const &entry : this->indexEntries)
+  {
+    appendValue(buffer, entry.time);
+    appendValue(buffer, entry.offset);
+    appendValue(buffer, entry.topic);
+  }
+
+  // The segment being closed is the last one created.
+  std::string path = SegmentPath(this->dir, this->segments - 1, true);
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out.write(buffer.data(), buffer.size());
+  if (!out)
+  {
+    std::cerr << "LogWriter::WriteIndex() error: Unable to write [" << path
+              << "]" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Read a value from a buffer.
+/// \param[in] _buffer Buffer.
+/// \param[in] _size Size of the buffer.
+/// \param[in, out] _offset Position of the value. It is moved after the
+/// value.
+/// \param[out] _value Value read.
+/// \return False if the buffer is too short.
+template<typename T> static bool readValue(const char *_buffer,
+  const uint64_t _size, uint64_t &_offset, T &_value)
+{
+  if (_offset + sizeof(_value) > _size)
+    return false;
+  memcpy(&_value, _buffer + _offset, sizeof(_value));
+  _offset += sizeof(_value);
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Read a string preceded by its length (uint16) from a buffer.
+/// \param[in] _buffer Buffer.
+/// \param[in] _size Size of the buffer.
+/// \param[in, out] _offset Position of the string. It is moved after the
+/// string.
+/// \param[out] _str String read.
+/// \return False if the buffer is too short.
+static bool readString(const char *_buffer, const uint64_t _size,
+  uint64_t &_offset, std::string &_str)
+{
+  uint16_t len;
+  if (!readValue(_buffer, _size, _offset, len) || _offset + len > _size)
+    return false;
+  _str.assign(_buffer + _offset, len);
+  _offset += len;
+  return true;
+}
+
+//////////////////////////////////////////////////
+LogReader::~LogReader()
+{
+  this->Close();
+}
+
+//////////////////////////////////////////////////
+bool LogReader::Open(const std::string &_dir)
+{
+#ifdef _WIN32
+  std::cerr << "LogReader::Open() error: Not supported on Windows"
+            << std::endl;
+  return false;
+#else
+  this->Close();
+
+  this->dir = _dir;
+  this->segments = 0;
+  this->topics.clear();
+  this->messages = 0;
+  this->startTime = 0;
+  this->endTime = 0;
+
+  struct stat info;
+  while (stat(LogWriter::SegmentPath(_dir, this->segments, false).c_str(),
+         &info) == 0)
+  {
+    ++this->segments;
+  }
+
+  if (this->segments == 0)
+  {
+    std::cerr << "LogReader::Open() error: No log found in [" << _dir << "]"
+              << std::endl;
+    return false;
+  }
+
+  // Summary of the log.
+  for (unsigned int i = 0; i < this->segments; ++i)
+  {
+    if (this->ReadIndex(i))
+      continue;
+
+    if (!this->MapSegment(i))
+      return false;
+    this->ScanSegment();
+    this->UnmapSegment();
+  }
+
+  this->open = true;
+  this->Rewind();
+  return true;
+#endif
+}
+
+//////////////////////////////////////////////////
+bool LogReader::IsOpen() const
+{
+  return this->open;
+}
+
+//////////////////////////////////////////////////
+bool LogReader::Next(LogRecord &_record)
+{
+  if (!this->open)
+    return false;
+
+  while (true)
+  {
+    if (this->base && this->ParseRecord(_record))
+    {
+      this->offset += LogWriter::RecordHeaderSize + _record.topic.size() +
+        _record.type.size() + _record.size;
+      return true;
+    }
+
+    // End of the segment.
+    if (this->segment + 1 >= this->segments ||
+        !this->MapSegment(this->segment + 1))
+    {
+      this->UnmapSegment();
+      return false;
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+void LogReader::Rewind()
+{
+  if (this->open)
+    this->MapSegment(0);
+}
+
+//////////////////////////////////////////////////
+void LogReader::Close()
+{
+  this->UnmapSegment();
+  this->open = false;
+}
+
+//////////////////////////////////////////////////
+std::vector<LogTopic> LogReader::GetTopics() const
+{
+  return this->topics;
+}
+
+//////////////////////////////////////////////////
+uint64_t LogReader::GetMessages() const
+{
+  return this->messages;
+}
+
+//////////////////////////////////////////////////
+uint64_t LogReader::GetStartTime() const
+{
+  return this->startTime;
+}
+
+//////////////////////////////////////////////////
+uint64_t LogReader::GetEndTime() const
+{
+  return this->endTime;
+}
+
+//////////////////////////////////////////////////
+unsigned int LogReader::GetSegments() const
+{
+  return this->segments;
+}
+
+//////////////////////////////////////////////////
+bool LogReader::MapSegment(const unsigned int _segment)
+{
+#ifdef _WIN32
+  (void)_segment;
+  return false;
+#else
+  this->UnmapSegment();
+
+  std::string path = LogWriter::SegmentPath(this->dir, _segment, false);
+  this->fd = ::open(path.c_str(), O_RDONLY);
+  if (this->fd < 0)
+  {
+    std::cerr << "LogReader::MapSegment() error: Unable to open [" << path
+              << "]: " << strerror(errno) << std::endl;
+    return false;
+  }
+
+  struct stat info;
+  if (fstat(this->fd, &info) != 0 ||
+      static_cast<uint64_t>(info.st_size) < LogWriter::HeaderSize)
+  {
+    std::cerr << "LogReader::MapSegment() error: Invalid segment [" << path
+              << "]" << std::endl;
+    ::close(this->fd);
+    this->fd = -1;
+    return false;
+  }
+
+  void *addr = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE,
+    this->fd, 0);
+  if (addr == MAP_FAILED)
+  {
+    std::cerr << "LogReader::MapSegment() error: Unable to map [" << path
+              << "]: " << strerror(errno) << std::endl;
+    ::close(this->fd);
+    this->fd = -1;
+    return false;
+  }
+  madvise(addr, info.st_size, MADV_SEQUENTIAL);
+
+  this->base = static_cast<const char *>(addr);
+  this->mappedSize = info.st_size;
+  this->segment = _segment;
+  this->offset = LogWriter::HeaderSize;
+
+  if (memcmp(this->base, LogWriter::SegmentMagic, 8) != 0)
+  {
+    std::cerr << "LogReader::MapSegment() error: [" << path
+              << "] is not a log segment" << std::endl;
+    this->UnmapSegment();
+    return false;
+  }
+
+  return true;
+#endif
+}
+
+//////////////////////////////////////////////////
+void LogReader::UnmapSegment()
+{
+#ifndef _WIN32
+  if (this->base)
+    munmap(const_cast<char *>(this->base), this->mappedSize);
+  if (this->fd >= 0)
+    ::close(this->fd);
+#endif
+  this->base = nullptr;
+  this->mappedSize = 0;
+  this->fd = -1;
+}
+
+//////////////////////////////////////////////////
+bool LogReader::ReadIndex(const unsigned int _segment)
+{
+  std::ifstream in(LogWriter::SegmentPath(this->dir, _segment, true),
+    std::ios::binary);
+  if (!in)
+    return false;
+  std::string content((std::istreambuf_iterator<char>(in)),
+    std::istreambuf_iterator<char>());
+
+  const char *buffer = content.data();
+  uint64_t size = content.size();
+  uint64_t pos = LogWriter::HeaderSize;
+  uint64_t first;
+  uint64_t last;
+  uint32_t numTopics;
+  if (size < LogWriter::HeaderSize ||
+      memcmp(buffer, LogWriter::IndexMagic, 8) != 0 ||
+      !readValue(buffer, size, pos, first) ||
+      !readValue(buffer, size, pos, last) ||
+      !readValue(buffer, size, pos, numTopics))
+  {
+    return false;
+  }
+
+  std::vector<LogTopic> indexTopics(numTopics);
+  uint64_t count = 0;
+  for (auto &topic : indexTopics)
+  {
+    if (!readString(buffer, size, pos, topic.topic) ||
+        !readString(buffer, size, pos, topic.type) ||
+        !readValue(buffer, size, pos, topic.messages))
+    {
+      return false;
+    }
+    count += topic.messages;
+  }
+
+  for (auto const &topic : indexTopics)
+    this->AddTopic(topic.topic, topic.type, topic.messages);
+
+  if (count > 0)
+  {
+    if (this->messages == 0 || first < this->startTime)
+      this->startTime = first;
+    this->endTime = std::max(this->endTime, last);
+  }
+  this->messages += count;
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+void LogReader::ScanSegment()
+{
+  std::map<std::pair<std::string, std::string>, uint64_t> counts;
+  LogRecord record;
+  while (this->ParseRecord(record))
+  {
+    this->offset += LogWriter::RecordHeaderSize + record.topic.size() +
+      record.type.size() + record.size;
+    ++counts[std::make_pair(record.topic, record.type)];
+
+    if (this->messages == 0 || record.time < this->startTime)
+      this->startTime = record.time;
+    this->endTime = std::max(this->endTime, record.time);
+    ++this->messages;
+  }
+
+  for (auto const &count : counts)
+    this->AddTopic(count.first.first, count.first.second, count.second);
+}
+
+//////////////////////////////////////////////////
+bool LogReader::ParseRecord(LogRecord &_record) const
+{
+  uint64_t pos = this->offset;
+  uint32_t recordSize;
+  uint16_t topicLen;
+  uint16_t typeLen;
+  uint64_t time;
+  if (!readValue(this->base, this->mappedSize, pos, recordSize) ||
+      !readValue(this->base, this->mappedSize, pos, topicLen) ||
+      !readValue(this->base, this->mappedSize, pos, typeLen) ||
+      !readValue(this->base, this->mappedSize, pos, time))
+  {
+    return false;
+  }
+
+  // A segment that was not closed properly ends with zeros.
+  uint64_t headers = LogWriter::RecordHeaderSize + topicLen + typeLen;
+  if (recordSize < headers || this->offset + recordSize > this->mappedSize)
+    return false;
+
+  _record.topic.assign(this->base + pos, topicLen);
+  pos += topicLen;
+  _record.type.assign(this->base + pos, typeLen);
+  pos += typeLen;
+  _record.time = time;
+  _record.data = this->base + pos;
+  _record.size = recordSize - headers;
+  return true;
+}
+
+//////////////////////////////////////////////////
+void LogReader::AddTopic(const std::string &_topic, const std::string &_type,
+  const uint64_t _messages)
+{
+  for (auto &topic : this->topics)
+  {
+    if (topic.topic == _topic && topic.type == _type)
+    {
+      topic.messages += _messages;
+      return;
+    }
+  }
+
+  LogTopic topic;
+  topic.topic = _topic;
+  topic.type = _type;
+  topic.messages = _messages;
+  this->topics.push_back(topic);
+}
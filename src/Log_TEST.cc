@@ -0,0 +1,216 @@
+/*
+ * Copyright (C) 2015 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include "ignition/transport/Log.hh"
+#include "gtest/gtest.h"
+#include "ignition/transport/test_config.h"
+
+using namespace ignition;
+
+//////////////////////////////////////////////////
+/// \brief Read a whole file.
+/// \param[in] _path Path of the file.
+/// \return The content of the file.
+std::string readFile(const std::string &_path)
+{
+  std::ifstream in(_path, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(in),
+    std::istreambuf_iterator<char>());
+}
+
+//////////////////////////////////////////////////
+/// \brief Read a value stored in a buffer.
+/// \param[in] _buffer Buffer.
+/// \param[in] _offset Position of the value.
+/// \return The value.
+template<typename T> T readValue(const std::string &_buffer,
+  const size_t _offset)
+{
+  T value;
+  memcpy(&value, _buffer.data() + _offset, sizeof(value));
+  return value;
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the on-disk format of the log.
+TEST(LogTest, WriteSegments)
+{
+  std::string dir = testing::portablePathUnion(PROJECT_BINARY_PATH,
+    "test_log_" + testing::getRandomPartition());
+  std::string topic = "/foo";
+  std::string type = "ignition.transport.msgs.Int";
+  std::string data(100, 'x');
+  uint32_t recordSize = transport::LogWriter::RecordHeaderSize +
+    topic.size() + type.size() + data.size();
+
+  transport::LogWriter writer;
+  EXPECT_FALSE(writer.IsOpen());
+  EXPECT_FALSE(writer.Write(topic, type, data.data(), data.size(), 1));
+  EXPECT_FALSE(writer.Open(dir, 10));
+
+  // Room for 3 records per segment.
+  ASSERT_TRUE(writer.Open(dir, transport::LogWriter::HeaderSize +
+    3 * recordSize + 1));
+  EXPECT_TRUE(writer.IsOpen());
+  EXPECT_FALSE(writer.Open(dir));
+
+  for (uint64_t i = 1; i <= 7; ++i)
+    EXPECT_TRUE(writer.Write(topic, type, data.data(), data.size(), i));
+
+  // A record bigger than a segment.
+  std::string big(10000, 'y');
+  EXPECT_TRUE(writer.Write(topic, type, big.data(), big.size(), 8));
+
+  EXPECT_EQ(writer.GetMessages(), 8u);
+  EXPECT_EQ(writer.GetSegments(), 4u);
+  writer.Close();
+  EXPECT_FALSE(writer.IsOpen());
+
+  // Do not overwrite an existing log.
+  transport::LogWriter other;
+  EXPECT_FALSE(other.Open(dir));
+
+  // First segment: header and three records.
+  std::string segment = readFile(
+    transport::LogWriter::SegmentPath(dir, 0, false));
+  ASSERT_EQ(segment.size(), transport::LogWriter::HeaderSize +
+    3 * recordSize);
+  EXPECT_EQ(segment.substr(0, 8), "IGNLOGSG");
+  EXPECT_EQ(readValue<uint32_t>(segment, 8), transport::LogWriter::Version);
+
+  size_t offset = transport::LogWriter::HeaderSize;
+  for (uint64_t i = 1; i <= 3; ++i)
+  {
+    EXPECT_EQ(readValue<uint32_t>(segment, offset), recordSize);
+    EXPECT_EQ(readValue<uint16_t>(segment, offset + 4), topic.size());
+    EXPECT_EQ(readValue<uint16_t>(segment, offset + 6), type.size());
+    EXPECT_EQ(readValue<uint64_t>(segment, offset + 8), i);
+    size_t pos = offset + transport::LogWriter::RecordHeaderSize;
+    EXPECT_EQ(segment.substr(pos, topic.size()), topic);
+    pos += topic.size();
+    EXPECT_EQ(segment.substr(pos, type.size()), type);
+    pos += type.size();
+    EXPECT_EQ(segment.substr(pos, data.size()), data);
+    offset += recordSize;
+  }
+
+  // Index of the first segment.
+  std::string index = readFile(transport::LogWriter::SegmentPath(dir, 0,
+    true));
+  ASSERT_GT(index.size(), 36u);
+  EXPECT_EQ(index.substr(0, 8), "IGNLOGIX");
+  EXPECT_EQ(readValue<uint64_t>(index, 16), 1u);
+  EXPECT_EQ(readValue<uint64_t>(index, 24), 3u);
+  EXPECT_EQ(readValue<uint32_t>(index, 32), 1u);
+
+  // Last segment: the big record.
+  segment = readFile(transport::LogWriter::SegmentPath(dir, 3, false));
+  EXPECT_EQ(segment.size(), transport::LogWriter::HeaderSize +
+    transport::LogWriter::RecordHeaderSize + topic.size() + type.size() +
+    big.size());
+
+  for (unsigned int i = 0; i < 4; ++i)
+  {
+    std::remove(transport::LogWriter::SegmentPath(dir, i, false).c_str());
+    std::remove(transport::LogWriter::SegmentPath(dir, i, true).c_str());
+  }
+  std::remove(dir.c_str());
+}
+
+//////////////////////////////////////////////////
+/// \brief Read back a log with several segments, with and without index.
+TEST(LogTest, ReadSegments)
+{
+  std::string dir = testing::portablePathUnion(PROJECT_BINARY_PATH,
+    "test_log_" + testing::getRandomPartition());
+  std::string type = "ignition.transport.msgs.Int";
+
+  transport::LogReader reader;
+  transport::LogRecord record;
+  EXPECT_FALSE(reader.Open(dir));
+  EXPECT_FALSE(reader.IsOpen());
+  EXPECT_FALSE(reader.Next(record));
+
+  transport::LogWriter writer;
+  ASSERT_TRUE(writer.Open(dir, 200));
+  for (uint64_t i = 1; i <= 10; ++i)
+  {
+    std::string topic = i % 2 ? "/odd" : "/even";
+    std::string data(i, 'a' + i);
+    EXPECT_TRUE(writer.Write(topic, type, data.data(), data.size(), 100 + i));
+  }
+  writer.Close();
+  unsigned int segments = writer.GetSegments();
+  ASSERT_GT(segments, 1u);
+
+  // The summary is read from the index or, if missing, from the segment.
+  std::remove(transport::LogWriter::SegmentPath(dir, 0, true).c_str());
+
+  ASSERT_TRUE(reader.Open(dir));
+  EXPECT_TRUE(reader.IsOpen());
+  EXPECT_EQ(reader.GetSegments(), segments);
+  EXPECT_EQ(reader.GetMessages(), 10u);
+  EXPECT_EQ(reader.GetStartTime(), 101u);
+  EXPECT_EQ(reader.GetEndTime(), 110u);
+
+  auto topics = reader.GetTopics();
+  ASSERT_EQ(topics.size(), 2u);
+  for (auto const &topic : topics)
+  {
+    EXPECT_TRUE(topic.topic == "/odd" || topic.topic == "/even");
+    EXPECT_EQ(topic.type, type);
+    EXPECT_EQ(topic.messages, 5u);
+  }
+
+  for (int pass = 0; pass < 2; ++pass)
+  {
+    for (uint64_t i = 1; i <= 10; ++i)
+    {
+      ASSERT_TRUE(reader.Next(record));
+      EXPECT_EQ(record.topic, i % 2 ? "/odd" : "/even");
+      EXPECT_EQ(record.type, type);
+      EXPECT_EQ(record.time, 100 + i);
+      EXPECT_EQ(std::string(record.data, record.size),
+        std::string(i, 'a' + i));
+    }
+    EXPECT_FALSE(reader.Next(record));
+    reader.Rewind();
+  }
+
+  reader.Close();
+  EXPECT_FALSE(reader.IsOpen());
+
+  for (unsigned int i = 0; i < segments; ++i)
+  {
+    std::remove(transport::LogWriter::SegmentPath(dir, i, false).c_str());
+    std::remove(transport::LogWriter::SegmentPath(dir, i, true).c_str());
+  }
+  std::remove(dir.c_str());
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
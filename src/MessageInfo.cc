@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2015 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include "ignition/transport/MessageInfo.hh"
+
+using namespace ignition;
+using namespace transport;
+
+//////////////////////////////////////////////////
+std::string MessageInfo::GetTopic() const
+{
+  return this->topic;
+}
+
+//////////////////////////////////////////////////
+std::string MessageInfo::GetType() const
+{
+  return this->type;
+}
+
+//////////////////////////////////////////////////
+std::string MessageInfo::GetPublisherAddress() const
+{
+  return this->publisherAddress;
+}
+
+//////////////////////////////////////////////////
+bool MessageInfo::HasMetadata() const
+{
+  return this->hasMetadata;
+}
+
+//////////////////////////////////////////////////
+uint64_t MessageInfo::GetSequence() const
+{
+  return this->seq;
+}
+
+//////////////////////////////////////////////////
+uint64_t MessageInfo::GetSendTime() const
+{
+  return this->sendTime;
+}
+
+//////////////////////////////////////////////////
+void MessageInfo::SetTopic(const std::string &_topic)
+{
+  this->topic = _topic;
+}
+
+//////////////////////////////////////////////////
+void MessageInfo::SetType(const std::string &_type)
+{
+  this->type = _type;
+}
+
+//////////////////////////////////////////////////
+void MessageInfo::SetPublisherAddress(const std::string &_addr)
+{
+  this->publisherAddress = _addr;
+}
+
+//////////////////////////////////////////////////
+void MessageInfo::SetMetadata(const uint64_t _seq, const uint64_t _sendTime)
+{
+  this->hasMetadata = true;
+  this->seq = _seq;
+  this->sendTime = _sendTime;
+}
+
+//////////////////////////////////////////////////
+std::string MessageInfo::Pack() const
+{
+  if (!this->hasMetadata)
+    return this->publisherAddress;
+
+  std::string frame(this->publisherAddress.size() + 1 +
+    sizeof(this->seq) + sizeof(this->sendTime) + this->type.size(), '\0');
+  char *buffer = &frame[0];
+
+  memcpy(buffer, this->publisherAddress.data(),
+    this->publisherAddress.size());
+  buffer += this->publisherAddress.size() + 1;
+
+  memcpy(buffer, &this->seq, sizeof(this->seq));
+  buffer += sizeof(this->seq);
+
+  memcpy(buffer, &this->sendTime, sizeof(this->sendTime));
+  buffer += sizeof(this->sendTime);
+
+  memcpy(buffer, this->type.data(), this->type.size());
+
+  return frame;
+}
+
+//////////////////////////////////////////////////
+bool MessageInfo::Unpack(const std::string &_frame)
+{
+  this->hasMetadata = false;
+  this->seq = 0;
+  this->sendTime = 0;
+  this->type = "";
+
+  auto pos = _frame.find('\0');
+  this->publisherAddress = _frame.substr(0, pos);
+
+  // The publisher does not send metadata.
+  if (pos == std::string::npos)
+    return false;
+
+  if (_frame.size() - pos - 1 < sizeof(this->seq) + sizeof(this->sendTime))
+  {
+    std::cerr << "MessageInfo::Unpack() error: Metadata is truncated"
+              << std::endl;
+    return false;
+  }
+
+  const char *buffer = _frame.data() + pos + 1;
+  memcpy(&this->seq, buffer, sizeof(this->seq));
+  buffer += sizeof(this->seq);
+
+  memcpy(&this->sendTime, buffer, sizeof(this->sendTime));
+  buffer += sizeof(this->sendTime);
+
+  // The type name uses the rest of the frame.
+  this->type.assign(buffer, _frame.data() + _frame.size());
+
+  this->hasMetadata = true;
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool MessageInfo::Repack(char *_frame, const size_t _size,
+  const uint64_t _seq, const uint64_t _sendTime)
+{
+  auto end = static_cast<char *>(memchr(_frame, '\0', _size));
+  if (!end ||
+      _size - (end - _frame) - 1 < sizeof(_seq) + sizeof(_sendTime))
+  {
+    return false;
+  }
+
+  char *buffer = end + 1;
+  memcpy(buffer, &_seq, sizeof(_seq));
+  buffer += sizeof(_seq);
+  memcpy(buffer, &_sendTime, sizeof(_sendTime));
+  return true;
+}
+
+//////////////////////////////////////////////////
+uint64_t MessageInfo::Now()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
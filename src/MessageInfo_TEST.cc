@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2015 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <string>
+#include "ignition/transport/MessageInfo.hh"
+#include "gtest/gtest.h"
+
+using namespace ignition;
+
+//////////////////////////////////////////////////
+/// \brief Check the default values and the accessors.
+TEST(MessageInfoTest, Accessors)
+{
+  transport::MessageInfo info;
+  EXPECT_EQ(info.GetTopic(), "");
+  EXPECT_EQ(info.GetPublisherAddress(), "");
+  EXPECT_FALSE(info.HasMetadata());
+  EXPECT_EQ(info.GetSequence(), 0u);
+  EXPECT_EQ(info.GetSendTime(), 0u);
+
+  info.SetTopic("/foo");
+  info.SetPublisherAddress("tcp://127.0.0.1:6000");
+  info.SetType("ignition.transport.msgs.Int");
+  info.SetMetadata(5, 1000);
+  EXPECT_EQ(info.GetTopic(), "/foo");
+  EXPECT_EQ(info.GetType(), "ignition.transport.msgs.Int");
+  EXPECT_EQ(info.GetPublisherAddress(), "tcp://127.0.0.1:6000");
+  EXPECT_TRUE(info.HasMetadata());
+  EXPECT_EQ(info.GetSequence(), 5u);
+  EXPECT_EQ(info.GetSendTime(), 1000u);
+
+  uint64_t t1 = transport::MessageInfo::Now();
+  uint64_t t2 = transport::MessageInfo::Now();
+  EXPECT_LE(t1, t2);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the serialization of the sender frame.
+TEST(MessageInfoTest, PackUnpack)
+{
+  std::string addr = "tcp://10.0.0.1:6000";
+  transport::MessageInfo info;
+  info.SetPublisherAddress(addr);
+
+  // Only the address is sent when there is no metadata.
+  EXPECT_EQ(info.Pack(), addr);
+
+  transport::MessageInfo other;
+  EXPECT_FALSE(other.Unpack(info.Pack()));
+  EXPECT_EQ(other.GetPublisherAddress(), addr);
+  EXPECT_FALSE(other.HasMetadata());
+
+  info.SetMetadata(123456789012345ull, 987654321098765ull);
+  std::string frame = info.Pack();
+  EXPECT_GT(frame.size(), addr.size());
+
+  EXPECT_TRUE(other.Unpack(frame));
+  EXPECT_EQ(other.GetPublisherAddress(), addr);
+  EXPECT_TRUE(other.HasMetadata());
+  EXPECT_EQ(other.GetSequence(), 123456789012345ull);
+  EXPECT_EQ(other.GetSendTime(), 987654321098765ull);
+  EXPECT_EQ(other.GetType(), "");
+
+  // The type name is appended to the metadata.
+  info.SetType("ignition.transport.msgs.Int");
+  frame = info.Pack();
+  EXPECT_TRUE(other.Unpack(frame));
+  EXPECT_EQ(other.GetSequence(), 123456789012345ull);
+  EXPECT_EQ(other.GetType(), "ignition.transport.msgs.Int");
+
+  // Truncated metadata.
+  EXPECT_FALSE(other.Unpack(frame.substr(0, addr.size() + 10)));
+  EXPECT_EQ(other.GetPublisherAddress(), addr);
+  EXPECT_FALSE(other.HasMetadata());
+  EXPECT_EQ(other.GetSequence(), 0u);
+}
+
+//////////////////////////////////////////////////
+/// \brief Repack the metadata of a sender frame.
+TEST(MessageInfoTest, Repack)
+{
+  transport::MessageInfo info;
+  info.SetPublisherAddress("tcp://127.0.0.1:1234");
+  info.SetType("ign_msgs.Int");
+  info.SetMetadata(0, 0);
+  std::string header = info.Pack();
+
+  EXPECT_TRUE(transport::MessageInfo::Repack(&header[0], header.size(), 7,
+    11));
+  transport::MessageInfo out;
+  ASSERT_TRUE(out.Unpack(header));
+  EXPECT_EQ(out.GetPublisherAddress(), "tcp://127.0.0.1:1234");
+  EXPECT_EQ(out.GetType(), "ign_msgs.Int");
+  EXPECT_EQ(out.GetSequence(), 7u);
+  EXPECT_EQ(out.GetSendTime(), 11u);
+
+  EXPECT_FALSE(transport::MessageInfo::Repack(&header[0], 3, 1, 1));
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -22,50 +22,71 @@
 #include <cassert>
 #include <cstdlib>
 #include <algorithm>
+#include <chrono>
+#include <cstdint>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 #ifdef _MSC_VER
 # pragma warning(pop)
 #endif
+#include "ignition/transport/Introspection.hh"
+#include "ignition/transport/MessageInfo.hh"
 #include "ignition/transport/Node.hh"
 #include "ignition/transport/NodeShared.hh"
+#include "ignition/transport/Publisher.hh"
+#include "ignition/transport/ReqHandler.hh"
+#include "ignition/transport/Statistics.hh"
 #include "ignition/transport/TopicUtils.hh"
+#include "ignition/transport/Trace.hh"
 #include "ignition/transport/TransportTypes.hh"
 #include "ignition/transport/Uuid.hh"
 
 using namespace ignition;
 using namespace transport;
 
+//////////////////////////////////////////////////
+/// \brief Get the partition set in the environment variable IGN_PARTITION.
+/// \param[out] _partition Partition name. Unchanged if the variable is not
+/// present or it is not valid.
+static void partitionFromEnv(std::string &_partition)
+{
+  char *envPartition = std::getenv("IGN_PARTITION");
+  if (!envPartition)
+    return;
+
+  std::string partitionStr = std::string(envPartition);
+  if (TopicUtils::IsValidNamespace(partitionStr))
+    _partition = partitionStr;
+  else
+    std::cerr << "Invalid IGN_PARTITION value [" << partitionStr << "]"
+              << std::endl;
+}
+
 //////////////////////////////////////////////////
 Node::Node()
   : dataPtr(new NodePrivate())
 {
   // Check if the environment variable IGN_PARTITION is present.
-  std::string partitionStr;
-  char *envPartition = std::getenv("IGN_PARTITION");
-
-  if (envPartition)
-  {
-    partitionStr = std::string(envPartition);
-    if (TopicUtils::IsValidNamespace(partitionStr))
-      this->dataPtr->partition = partitionStr;
-    else
-      std::cerr << "Invalid IGN_PARTITION value [" << partitionStr << "]"
-                << std::endl;
-  }
+  partitionFromEnv(this->dataPtr->partition);
 
   // Generate the node UUID.
   Uuid uuid;
   this->dataPtr->nUuid = uuid.ToString();
+
+  this->dataPtr->shared->EnableIntrospection(this->dataPtr->partition);
 }
 
 //////////////////////////////////////////////////
 Node::Node(const std::string &_partition, const std::string &_ns)
-  : Node()
+  : dataPtr(new NodePrivate())
 {
+  partitionFromEnv(this->dataPtr->partition);
+
   if (TopicUtils::IsValidNamespace(_ns))
     this->dataPtr->ns = _ns;
   else
@@ -85,6 +106,8 @@ Node::Node(const std::string &_partition, const std::string &_ns)
   // Generate the node UUID.
   Uuid uuid;
   this->dataPtr->nUuid = uuid.ToString();
+
+  this->dataPtr->shared->EnableIntrospection(this->dataPtr->partition);
 }
 
 //////////////////////////////////////////////////
@@ -131,7 +154,8 @@ bool Node::Advertise(const std::string &_topic, const Scope &_scope)
   std::lock_guard<std::recursive_mutex> lk(this->dataPtr->shared->mutex);
 
   // Add the topic to the list of advertised topics (if it was not before).
-  this->dataPtr->topicsAdvertised.insert(fullyQualifiedTopic);
+  if (this->dataPtr->topicsAdvertised.insert(fullyQualifiedTopic).second)
+    ++this->dataPtr->shared->advertisedTopics[fullyQualifiedTopic];
 
   // Notify the discovery service to register and advertise my topic.
   this->dataPtr->shared->discovery->Advertise(MsgType::Msg, fullyQualifiedTopic,
@@ -141,6 +165,29 @@ bool Node::Advertise(const std::string &_topic, const Scope &_scope)
   return true;
 }
 
+//////////////////////////////////////////////////
+PublisherStatePtr Node::CreatePublisher(const std::string &_topic,
+  const std::string &_type)
+{
+  std::string fullyQualifiedTopic;
+  if (!TopicUtils::GetFullyQualifiedName(this->dataPtr->partition,
+    this->dataPtr->ns, _topic, fullyQualifiedTopic))
+  {
+    return nullptr;
+  }
+
+  auto &shared = *this->dataPtr->shared;
+  std::lock_guard<std::recursive_mutex> lk(shared.mutex);
+
+  PublisherStatePtr state(new PublisherState());
+  state->publication = shared.GetPublication(fullyQualifiedTopic);
+  state->type = _type;
+  state->header = shared.PackHeader(_type);
+
+  this->dataPtr->publishers.insert(std::make_pair(fullyQualifiedTopic, state));
+  return state;
+}
+
 //////////////////////////////////////////////////
 std::vector<std::string> Node::AdvertisedTopics() const
 {
@@ -174,7 +221,18 @@ bool Node::Unadvertise(const std::string &_topic)
   std::lock_guard<std::recursive_mutex> lk(this->dataPtr->shared->mutex);
 
   // Remove the topic from the list of advertised topics in this node.
-  this->dataPtr->topicsAdvertised.erase(fullyQualifiedTopic);
+  if (this->dataPtr->topicsAdvertised.erase(fullyQualifiedTopic) > 0)
+  {
+    auto &shared = *this->dataPtr->shared;
+    if (--shared.advertisedTopics[fullyQualifiedTopic] == 0)
+      shared.advertisedTopics.erase(fullyQualifiedTopic);
+  }
+
+  // Invalidate the publisher handles of the topic.
+  auto range = this->dataPtr->publishers.equal_range(fullyQualifiedTopic);
+  for (auto it = range.first; it != range.second; ++it)
+    it->second->advertised = false;
+  this->dataPtr->publishers.erase(range.first, range.second);
 
   // Notify the discovery service to unregister and unadvertise my topic.
   this->dataPtr->shared->discovery->Unadvertise(MsgType::Msg,
@@ -186,6 +244,37 @@ bool Node::Unadvertise(const std::string &_topic)
 //////////////////////////////////////////////////
 bool Node::Publish(const std::string &_topic, const ProtoMsg &_msg)
 {
+  IGN_TRACE_SCOPE("Node::Publish");
+
+  std::string fullyQualifiedTopic;
+  if (!TopicUtils::GetFullyQualifiedName(this->dataPtr->partition,
+    this->dataPtr->ns, _topic, fullyQualifiedTopic))
+  {
+    std::cerr << "Topic [" << _topic << "] is not valid." << std::endl;
+    return false;
+  }
+
+  std::lock_guard<std::recursive_mutex> lk(this->dataPtr->shared->mutex);
+
+  // Topic not advertised before.
+  if (this->dataPtr->topicsAdvertised.find(fullyQualifiedTopic) ==
+      this->dataPtr->topicsAdvertised.end())
+  {
+    return false;
+  }
+
+  auto &shared = *this->dataPtr->shared;
+  std::shared_ptr<Publication> publication =
+    shared.GetPublication(fullyQualifiedTopic);
+  return shared.Publish(*publication, _msg, _msg.GetTypeName(), "");
+}
+
+//////////////////////////////////////////////////
+bool Node::PublishRaw(const std::string &_topic, const char *_data,
+  const size_t _size, const std::string &_type)
+{
+  IGN_TRACE_SCOPE("Node::PublishRaw");
+
   std::string fullyQualifiedTopic;
   if (!TopicUtils::GetFullyQualifiedName(this->dataPtr->partition,
     this->dataPtr->ns, _topic, fullyQualifiedTopic))
@@ -203,24 +292,41 @@ bool Node::Publish(const std::string &_topic, const ProtoMsg &_msg)
     return false;
   }
 
-  // Local subscribers.
-  std::map<std::string, ISubscriptionHandler_M> handlers;
-  if (this->dataPtr->shared->localSubscriptions.GetHandlers(fullyQualifiedTopic,
-        handlers))
+  auto counters = this->dataPtr->shared->stats.Topic(fullyQualifiedTopic);
+
+  // Metadata of the message.
+  MessageInfo info;
+  std::string topicName = fullyQualifiedTopic;
+  topicName.erase(0, topicName.find_last_of("@") + 1);
+  info.SetTopic(topicName);
+  info.SetType(_type);
+  info.SetMetadata(
+    ++this->dataPtr->shared->GetPublication(fullyQualifiedTopic)->sequence,
+    MessageInfo::Now());
+
+  // Local subscribers. The handlers take the payload as a string, so it is
+  // copied once for all of them.
+  auto handlers =
+    this->dataPtr->shared->localSubscriptions.Handlers(fullyQualifiedTopic);
+  if (handlers)
   {
-    for (auto &node : handlers)
+    counters->AddReceived(0);
+    std::string data(_data, _size);
+    for (auto const &entry : *handlers)
     {
-      for (auto &handler : node.second)
+      const ISubscriptionHandlerPtr &subscriptionHandlerPtr = entry.handler;
+
+      if (subscriptionHandlerPtr)
+      {
+        IGN_TRACE_SCOPE("LocalCallback");
+        auto start = std::chrono::steady_clock::now();
+        subscriptionHandlerPtr->RunCallback(fullyQualifiedTopic, data, info);
+        counters->AddCallbackTime(ElapsedNs(start));
+      }
+      else
       {
-        ISubscriptionHandlerPtr subscriptionHandlerPtr = handler.second;
-
-        if (subscriptionHandlerPtr)
-          subscriptionHandlerPtr->RunLocalCallback(fullyQualifiedTopic, _msg);
-        else
-        {
-          std::cerr << "Node::Publish(): Subscription handler is NULL"
-                    << std::endl;
-        }
+        std::cerr << "Node::PublishRaw(): Subscription handler is NULL"
+                  << std::endl;
       }
     }
   }
@@ -228,13 +334,48 @@ bool Node::Publish(const std::string &_topic, const ProtoMsg &_msg)
   // Remote subscribers.
   if (this->dataPtr->shared->remoteSubscribers.HasTopic(fullyQualifiedTopic))
   {
-    std::string data;
-    _msg.SerializeToString(&data);
-    this->dataPtr->shared->Publish(fullyQualifiedTopic, data);
+    if (!this->dataPtr->shared->Publish(fullyQualifiedTopic, _data, _size,
+          info))
+    {
+      counters->AddDropped();
+    }
+    counters->AddPublished(_size, 0);
   }
-  // Debug output.
-  // else
-  //   std::cout << "There are no remote subscribers...SKIP" << std::endl;
+  else
+    counters->AddPublished(0, 0);
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool Node::SubscribeRaw(const std::string &_topic, const RawCallback &_cb)
+{
+  std::string fullyQualifiedTopic;
+  if (!TopicUtils::GetFullyQualifiedName(this->dataPtr->partition,
+    this->dataPtr->ns, _topic, fullyQualifiedTopic))
+  {
+    std::cerr << "Topic [" << _topic << "] is not valid." << std::endl;
+    return false;
+  }
+
+  std::lock_guard<std::recursive_mutex> discLk(
+    this->dataPtr->shared->discovery->GetMutex());
+  std::lock_guard<std::recursive_mutex> lk(this->dataPtr->shared->mutex);
+
+  // Create a new subscription handler.
+  std::shared_ptr<RawSubscriptionHandler> subscrHandlerPtr(
+    new RawSubscriptionHandler(this->dataPtr->nUuid, _cb));
+
+  // Store the subscription handler.
+  this->dataPtr->shared->localSubscriptions.AddHandler(
+    fullyQualifiedTopic, this->dataPtr->nUuid, subscrHandlerPtr);
+  this->dataPtr->shared->RefreshPublication(fullyQualifiedTopic);
+
+  // Add the topic to the list of subscribed topics (if it was not before)
+  this->dataPtr->topicsSubscribed.insert(fullyQualifiedTopic);
+
+  // Discover the list of nodes that publish on the topic.
+  this->dataPtr->shared->discovery->Discover(fullyQualifiedTopic, false);
 
   return true;
 }
@@ -268,10 +409,13 @@ bool Node::Unsubscribe(const std::string &_topic)
     return false;
   }
 
+  std::lock_guard<std::recursive_mutex> discLk(
+    this->dataPtr->shared->discovery->GetMutex());
   std::lock_guard<std::recursive_mutex> lk(this->dataPtr->shared->mutex);
 
   this->dataPtr->shared->localSubscriptions.RemoveHandlersForNode(
     fullyQualifiedTopic, this->dataPtr->nUuid);
+  this->dataPtr->shared->RefreshPublication(fullyQualifiedTopic);
 
   // Remove the topic from the list of subscribed topics in this node.
   this->dataPtr->topicsSubscribed.erase(fullyQualifiedTopic);
@@ -280,8 +424,12 @@ bool Node::Unsubscribe(const std::string &_topic)
   if (!this->dataPtr->shared->localSubscriptions.HasHandlersForTopic(
     fullyQualifiedTopic))
   {
+    std::lock_guard<std::mutex> subLock(
+      this->dataPtr->shared->subscriberMutex);
     this->dataPtr->shared->subscriber->setsockopt(
       ZMQ_UNSUBSCRIBE, fullyQualifiedTopic.data(), fullyQualifiedTopic.size());
+    this->dataPtr->shared->relaySubscriber->setsockopt(
+      ZMQ_UNSUBSCRIBE, fullyQualifiedTopic.data(), fullyQualifiedTopic.size());
   }
 
   // Notify to the publishers that I am no longer interested in the topic.
@@ -381,6 +529,8 @@ bool Node::UnadvertiseSrv(const std::string &_topic)
 //////////////////////////////////////////////////
 void Node::GetTopicList(std::vector<std::string> &_topics) const
 {
+  std::lock_guard<std::recursive_mutex> discLk(
+    this->dataPtr->shared->discovery->GetMutex());
   std::lock_guard<std::recursive_mutex> lk(this->dataPtr->shared->mutex);
 
   std::vector<std::string> allTopics;
@@ -409,6 +559,8 @@ void Node::GetTopicList(std::vector<std::string> &_topics) const
 //////////////////////////////////////////////////
 void Node::GetServiceList(std::vector<std::string> &_services) const
 {
+  std::lock_guard<std::recursive_mutex> discLk(
+    this->dataPtr->shared->discovery->GetMutex());
   std::lock_guard<std::recursive_mutex> lk(this->dataPtr->shared->mutex);
 
   std::vector<std::string> allServices;
@@ -430,6 +582,13 @@ void Node::GetServiceList(std::vector<std::string> &_services) const
     // Remove the partition part from the service.
     service.erase(0, service.find_last_of("@") + 1);
 
+    // The introspection services are reserved (see GetProcessStates()).
+    if (service.compare(0, IntrospectionPrefix.size(),
+          IntrospectionPrefix) == 0)
+    {
+      continue;
+    }
+
     _services.push_back(service);
   }
 }
@@ -439,3 +598,139 @@ std::string Node::Partition() const
 {
   return this->dataPtr->partition;
 }
+
+//////////////////////////////////////////////////
+bool Node::GetTopicStats(const std::string &_topic,
+  TopicStatistics &_stats) const
+{
+  std::string fullyQualifiedTopic;
+  if (!TopicUtils::GetFullyQualifiedName(this->dataPtr->partition,
+    this->dataPtr->ns, _topic, fullyQualifiedTopic))
+  {
+    std::cerr << "Topic [" << _topic << "] is not valid." << std::endl;
+    return false;
+  }
+
+  std::lock_guard<std::recursive_mutex> lk(this->dataPtr->shared->mutex);
+  return this->dataPtr->shared->stats.GetTopicStats(fullyQualifiedTopic,
+    _stats);
+}
+
+//////////////////////////////////////////////////
+bool Node::SetTopicLimits(const std::string &_topic,
+  const QueueLimits &_limits)
+{
+  std::string fullyQualifiedTopic;
+  if (!TopicUtils::GetFullyQualifiedName(this->dataPtr->partition,
+    this->dataPtr->ns, _topic, fullyQualifiedTopic))
+  {
+    std::cerr << "Topic [" << _topic << "] is not valid." << std::endl;
+    return false;
+  }
+
+  this->dataPtr->shared->SetTopicLimits(fullyQualifiedTopic, _limits);
+  return true;
+}
+
+//////////////////////////////////////////////////
+void Node::SetReuseMsgs(const bool _reuse)
+{
+  this->dataPtr->reuseMsgs = _reuse;
+}
+
+//////////////////////////////////////////////////
+bool Node::ReuseMsgs() const
+{
+  return this->dataPtr->reuseMsgs;
+}
+
+//////////////////////////////////////////////////
+bool Node::GetServiceStats(const std::string &_topic,
+  ServiceStatistics &_stats) const
+{
+  std::string fullyQualifiedTopic;
+  if (!TopicUtils::GetFullyQualifiedName(this->dataPtr->partition,
+    this->dataPtr->ns, _topic, fullyQualifiedTopic))
+  {
+    std::cerr << "Service [" << _topic << "] is not valid." << std::endl;
+    return false;
+  }
+
+  std::lock_guard<std::recursive_mutex> lk(this->dataPtr->shared->mutex);
+  return this->dataPtr->shared->stats.GetServiceStats(fullyQualifiedTopic,
+    _stats);
+}
+
+//////////////////////////////////////////////////
+void Node::GetProcessStates(const unsigned int _timeout,
+  std::vector<ProcessState> &_states) const
+{
+  _states.clear();
+
+  // Fully qualified prefix of the partition (e.g. "@/p@").
+  std::string prefix;
+  if (!TopicUtils::GetFullyQualifiedName(this->dataPtr->partition, "", "/x",
+    prefix))
+  {
+    return;
+  }
+  prefix.erase(prefix.find_last_of("@") + 1);
+
+  auto shared = this->dataPtr->shared;
+  std::string srvPrefix = prefix + IntrospectionPrefix;
+  shared->discovery->DiscoverAll(srvPrefix, _timeout);
+
+  std::vector<std::string> services;
+  shared->discovery->GetServiceList(services);
+
+  shared->discovery->GetMutex().lock();
+  std::unique_lock<std::recursive_mutex> lk(shared->mutex);
+
+  // Send all the requests before waiting for any response.
+  std::map<std::string, std::shared_ptr<RawReqHandler>> pending;
+  for (auto const &service : services)
+  {
+    if (service.compare(0, srvPrefix.size(), srvPrefix) != 0)
+      continue;
+
+    // This process is answered directly.
+    if (service == srvPrefix + shared->pUuid)
+    {
+      ProcessState state;
+      shared->GetProcessState(prefix, state);
+      _states.push_back(state);
+      continue;
+    }
+
+    std::shared_ptr<RawReqHandler> handler(
+      new RawReqHandler(this->dataPtr->nUuid, prefix));
+    shared->requests.AddHandler(service, this->dataPtr->nUuid, handler);
+    pending[service] = handler;
+
+    Addresses_M addresses;
+    if (shared->discovery->GetSrvAddresses(service, addresses))
+      shared->SendPendingRemoteReqs(service);
+    else
+      shared->discovery->Discover(service, true);
+  }
+  shared->discovery->GetMutex().unlock();
+
+  auto deadline = std::chrono::steady_clock::now() +
+    std::chrono::milliseconds(_timeout);
+  for (auto const &request : pending)
+  {
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+      deadline - std::chrono::steady_clock::now()).count();
+    auto &handler = request.second;
+    if (!handler->WaitUntil(lk, std::max<int64_t>(remaining, 0)))
+    {
+      shared->requests.RemoveHandler(request.first, this->dataPtr->nUuid,
+        handler->GetHandlerUuid());
+      continue;
+    }
+
+    ProcessState state;
+    if (handler->GetResult() && state.Unserialize(handler->GetRep()))
+      _states.push_back(state);
+  }
+}
@@ -18,31 +18,76 @@
 #ifdef _MSC_VER
 # pragma warning(push, 0)
 #endif
+#ifdef _WIN32
+  #include <process.h>
+#else
+  #include <unistd.h>
+#endif
 #include <zmq.hpp>
+#include <algorithm>
 #include <chrono>
 #include <cstdlib>
+#include <functional>
 #include <iostream>
 #include <map>
 #include <mutex>
+#include <set>
 #include <string>
 #include <thread>
+#include <utility>
 #include <vector>
 #ifdef _MSC_VER
 # pragma warning(pop)
 #endif
 #include "ignition/transport/Discovery.hh"
+#include "ignition/transport/Introspection.hh"
+#include "ignition/transport/MessageInfo.hh"
 #include "ignition/transport/NodeShared.hh"
 #include "ignition/transport/Packet.hh"
+#include "ignition/transport/Publisher.hh"
 #include "ignition/transport/RepHandler.hh"
 #include "ignition/transport/ReqHandler.hh"
+#include "ignition/transport/Statistics.hh"
 #include "ignition/transport/SubscriptionHandler.hh"
+#include "ignition/transport/TopicQueue.hh"
 #include "ignition/transport/TopicStorage.hh"
+#include "ignition/transport/TopicUtils.hh"
+#include "ignition/transport/Trace.hh"
 #include "ignition/transport/TransportTypes.hh"
 #include "ignition/transport/Uuid.hh"
 
 using namespace ignition;
 using namespace transport;
 
+//////////////////////////////////////////////////
+/// \brief Read a 0MQ high water mark from an environment variable.
+/// \param[in] _name Name of the environment variable.
+/// \param[out] _value High water mark (messages, 0 for no limit).
+/// \return True if the variable is set and valid.
+static bool hwmFromEnv(const char *_name, int &_value)
+{
+  char const *tmp = std::getenv(_name);
+  if (!tmp)
+    return false;
+
+  try
+  {
+    _value = std::stoi(tmp);
+  }
+  catch(const std::exception &/*_e*/)
+  {
+    _value = -1;
+  }
+
+  if (_value < 0)
+  {
+    std::cerr << "Invalid value for " << _name << ": [" << tmp << "]"
+              << std::endl;
+    return false;
+  }
+  return true;
+}
+
 //////////////////////////////////////////////////
 NodeShared *NodeShared::GetInstance()
 {
@@ -56,6 +101,7 @@ NodeShared::NodeShared()
     context(new zmq::context_t(1)),
     publisher(new zmq::socket_t(*context, ZMQ_PUB)),
     subscriber(new zmq::socket_t(*context, ZMQ_SUB)),
+    relaySubscriber(new zmq::socket_t(*context, ZMQ_SUB)),
     control(new zmq::socket_t(*context, ZMQ_DEALER)),
     requester(new zmq::socket_t(*context, ZMQ_ROUTER)),
     responseReceiver(new zmq::socket_t(*context, ZMQ_ROUTER)),
@@ -68,6 +114,29 @@ NodeShared::NodeShared()
   if (tmp)
     this->verbose = std::string(tmp) == "1";
 
+  // If IGN_TRANSPORT_PREFER_RELAY=1 receive the topics through a relay when
+  // there is one.
+  tmp = std::getenv("IGN_TRANSPORT_PREFER_RELAY");
+  if (tmp)
+    this->preferRelay = std::string(tmp) == "1";
+
+  // IGN_TRANSPORT_INTROSPECTION sets the scope of the introspection service
+  // or disables it.
+  tmp = std::getenv("IGN_TRANSPORT_INTROSPECTION");
+  if (tmp)
+  {
+    std::string value = tmp;
+    if (value == "none")
+      this->introspection = false;
+    else if (value == "all")
+      this->introspectionScope = Scope::All;
+    else if (value != "host")
+    {
+      std::cerr << "Invalid value for IGN_TRANSPORT_INTROSPECTION: ["
+                << value << "]" << std::endl;
+    }
+  }
+
   char bindEndPoint[1024];
 
   // My process UUID.
@@ -86,6 +155,17 @@ NodeShared::NodeShared()
     // Publisher socket listening in a random port.
     std::string anyTcpEp = "tcp://" + this->hostAddr + ":*";
 
+    // Optional high water marks of the pub/sub sockets. They are shared by
+    // all the topics. Use SetTopicLimits() to bound a particular topic.
+    int hwm;
+    if (hwmFromEnv("IGN_TRANSPORT_SNDHWM", hwm))
+      this->publisher->setsockopt(ZMQ_SNDHWM, &hwm, sizeof(hwm));
+    if (hwmFromEnv("IGN_TRANSPORT_RCVHWM", hwm))
+    {
+      this->subscriber->setsockopt(ZMQ_RCVHWM, &hwm, sizeof(hwm));
+      this->relaySubscriber->setsockopt(ZMQ_RCVHWM, &hwm, sizeof(hwm));
+    }
+
     int lingerVal = 0;
     this->publisher->setsockopt(ZMQ_LINGER, &lingerVal, sizeof(lingerVal));
     this->publisher->bind(anyTcpEp.c_str());
@@ -141,6 +221,9 @@ NodeShared::NodeShared()
   // Start the service thread.
   this->threadReception = new std::thread(&NodeShared::RunReceptionTask, this);
 
+  // Start the workers in charge of connecting with the remote nodes.
+  this->connectionManager.reset(new ConnectionManager());
+
   // Set the callback to notify discovery updates (new topics).
   discovery->SetConnectionsCb(&NodeShared::OnNewConnection, this);
 
@@ -162,6 +245,16 @@ NodeShared::~NodeShared()
   this->exit = true;
   this->exitMutex.unlock();
 
+  // Tell the dispatch thread to terminate.
+  {
+    std::lock_guard<std::mutex> lock(this->topicQueuesMutex);
+    this->dispatchExit = true;
+  }
+  this->topicQueuesCv.notify_all();
+
+  // Stop the connection workers.
+  this->connectionManager.reset();
+
   // Don't join on Windows, because it can hang when this object
   // is destructed on process exit (e.g., when it's a global static).
   // I think that it's due to this bug:
@@ -169,11 +262,23 @@ NodeShared::~NodeShared()
 #ifndef _WIN32
   // Wait for the service thread before exit.
   this->threadReception->join();
+  if (this->threadDispatch.joinable())
+    this->threadDispatch.join();
 #else
+  if (this->threadDispatch.joinable())
+    this->threadDispatch.detach();
+
   // Give some time to the receiving thread to terminate. The receiving thread
   // is blocking in zmq::poll for a maximum of Timeout milliseconds.
   std::this_thread::sleep_for(std::chrono::milliseconds(this->Timeout * 2));
 #endif
+
+#ifdef IGN_TRANSPORT_TRACING
+  // Write the events recorded by the tracepoints.
+  char const *traceFile = std::getenv("IGN_TRACE_FILE");
+  if (traceFile)
+    Tracer::WriteChromeTrace(traceFile);
+#endif
 }
 
 //////////////////////////////////////////////////
@@ -187,19 +292,22 @@ void NodeShared::RunReceptionTask()
       {*this->subscriber, 0, ZMQ_POLLIN, 0},
       {*this->control, 0, ZMQ_POLLIN, 0},
       {*this->replier, 0, ZMQ_POLLIN, 0},
-      {*this->responseReceiver, 0, ZMQ_POLLIN, 0}
+      {*this->responseReceiver, 0, ZMQ_POLLIN, 0},
+      {*this->relaySubscriber, 0, ZMQ_POLLIN, 0}
     };
     zmq::poll(&items[0], sizeof(items) / sizeof(items[0]), this->timeout);
 
     //  If we got a reply, process it.
     if (items[0].revents & ZMQ_POLLIN)
-      this->RecvMsgUpdate();
+      this->RecvMsgUpdate(*this->subscriber);
     if (items[1].revents & ZMQ_POLLIN)
       this->RecvControlUpdate();
     if (items[2].revents & ZMQ_POLLIN)
       this->RecvSrvRequest();
     if (items[3].revents & ZMQ_POLLIN)
       this->RecvSrvResponse();
+    if (items[4].revents & ZMQ_POLLIN)
+      this->RecvMsgUpdate(*this->relaySubscriber);
 
     // Is it time to exit?
     {
@@ -211,8 +319,19 @@ void NodeShared::RunReceptionTask()
 }
 
 //////////////////////////////////////////////////
-bool NodeShared::Publish(const std::string &_topic, const std::string &_data)
+bool NodeShared::Publish(const std::string &_topic, const std::string &_data,
+  const MessageInfo &_info)
 {
+  return this->Publish(_topic, _data.data(), _data.size(), _info);
+}
+
+//////////////////////////////////////////////////
+bool NodeShared::Publish(const std::string &_topic, const char *_data,
+  const size_t _size, const MessageInfo &_info)
+{
+  IGN_TRACE_SCOPE("NodeShared::Publish");
+
+  std::lock_guard<std::mutex> lk(this->publisherMutex);
   try
   {
     zmq::message_t msg;
@@ -220,12 +339,15 @@ bool NodeShared::Publish(const std::string &_topic, const std::string &_data)
     memcpy(msg.data(), _topic.data(), _topic.size());
     this->publisher->send(msg, ZMQ_SNDMORE);
 
-    msg.rebuild(this->myAddress.size());
-    memcpy(msg.data(), this->myAddress.data(), this->myAddress.size());
+    MessageInfo info = _info;
+    info.SetPublisherAddress(this->myAddress);
+    std::string sender = info.Pack();
+    msg.rebuild(sender.size());
+    memcpy(msg.data(), sender.data(), sender.size());
     this->publisher->send(msg, ZMQ_SNDMORE);
 
-    msg.rebuild(_data.size());
-    memcpy(msg.data(), _data.data(), _data.size());
+    msg.rebuild(_size);
+    memcpy(msg.data(), _data, _size);
     this->publisher->send(msg, 0);
   }
   catch(const zmq::error_t& ze)
@@ -239,27 +361,219 @@ bool NodeShared::Publish(const std::string &_topic, const std::string &_data)
 }
 
 //////////////////////////////////////////////////
-void NodeShared::RecvMsgUpdate()
+bool NodeShared::Publish(PublisherState &_state, const ProtoMsg &_msg)
 {
-  std::lock_guard<std::recursive_mutex> lock(this->mutex);
+  return this->Publish(*_state.publication, _msg, _state.type,
+    _state.header);
+}
+
+//////////////////////////////////////////////////
+bool NodeShared::Publish(Publication &_pub, const ProtoMsg &_msg,
+  const std::string &_type, const std::string &_header)
+{
+  IGN_TRACE_SCOPE("NodeShared::PublishMsg");
+
+  auto &counters = _pub.counters;
+  uint64_t seq = ++_pub.sequence;
+  uint64_t sendTime = MessageInfo::Now();
+
+  // The raw local subscribers need the message serialized in a string.
+  std::string data;
+  bool serialized = false;
+  uint64_t serializationTime = 0;
+  auto serialize = [&]()
+  {
+    if (serialized)
+      return true;
+    IGN_TRACE_SCOPE("Serialize");
+    auto start = std::chrono::steady_clock::now();
+    serialized = _msg.SerializeToString(&data);
+    serializationTime = ElapsedNs(start);
+    if (!serialized)
+      std::cerr << "Node::Publish(): Error serializing data" << std::endl;
+    return serialized;
+  };
+
+  // Local subscribers. Their handlers are the only state that needs the
+  // mutex.
+  if (_pub.hasLocal)
+  {
+    std::lock_guard<std::recursive_mutex> lk(this->mutex);
+
+    MessageInfo info;
+    info.SetTopic(_pub.topicName);
+    info.SetType(_type);
+    info.SetMetadata(seq, sendTime);
+
+    auto handlers = this->localSubscriptions.Handlers(_pub.handlersId);
+    if (handlers)
+    {
+      counters->AddReceived(0);
+      for (auto const &entry : *handlers)
+      {
+        const ISubscriptionHandlerPtr &subscriptionHandlerPtr = entry.handler;
+
+        if (subscriptionHandlerPtr)
+        {
+          IGN_TRACE_SCOPE("LocalCallback");
+          if (subscriptionHandlerPtr->IsRaw())
+          {
+            if (!serialize())
+            {
+              counters->AddDropped();
+              continue;
+            }
+            auto start = std::chrono::steady_clock::now();
+            subscriptionHandlerPtr->RunCallback(_pub.topic, data, info);
+            counters->AddCallbackTime(ElapsedNs(start));
+          }
+          else
+          {
+            auto start = std::chrono::steady_clock::now();
+            subscriptionHandlerPtr->RunLocalCallback(_pub.topic, _msg, info);
+            counters->AddCallbackTime(ElapsedNs(start));
+          }
+        }
+        else
+        {
+          std::cerr << "Node::Publish(): Subscription handler is NULL"
+                    << std::endl;
+        }
+      }
+    }
+  }
+
+  // Remote subscribers.
+  if (!_pub.hasRemote)
+  {
+    counters->AddPublished(0, serializationTime);
+    return true;
+  }
+
+  // Serialize straight into the 0MQ frame, unless it was already done.
+  zmq::message_t payload;
+  if (serialized)
+  {
+    payload.rebuild(data.size());
+    memcpy(payload.data(), data.data(), data.size());
+  }
+  else
+  {
+    IGN_TRACE_SCOPE("Serialize");
+    auto start = std::chrono::steady_clock::now();
+#if GOOGLE_PROTOBUF_VERSION >= 3004000
+    size_t size = _msg.ByteSizeLong();
+#else
+    size_t size = _msg.ByteSize();
+#endif
+    payload.rebuild(size);
+    if (!_msg.SerializeToArray(payload.data(), static_cast<int>(size)))
+    {
+      std::cerr << "Node::Publish(): Error serializing data" << std::endl;
+      counters->AddDropped();
+      counters->AddPublished(0, ElapsedNs(start));
+      return true;
+    }
+    serializationTime += ElapsedNs(start);
+  }
+  size_t bytes = payload.size();
+
+  // Node::Publish() does not cache the header, it is only packed when
+  // there are remote subscribers.
+  std::string packed;
+  if (_header.empty())
+    packed = this->PackHeader(_type);
+  const std::string &senderFrame = _header.empty() ? packed : _header;
+
+  zmq::message_t header(senderFrame.data(), senderFrame.size());
+  MessageInfo::Repack(static_cast<char *>(header.data()), header.size(), seq,
+    sendTime);
+
+  try
+  {
+    std::lock_guard<std::mutex> lk(this->publisherMutex);
+    zmq::message_t topic;
+    topic.copy(&_pub.topicFrame);
+    this->publisher->send(topic, ZMQ_SNDMORE);
+    this->publisher->send(header, ZMQ_SNDMORE);
+    this->publisher->send(payload, 0);
+  }
+  catch(const zmq::error_t& ze)
+  {
+    std::cerr << "NodeShared::Publish() Error: " << ze.what() << std::endl;
+    counters->AddDropped();
+  }
+  counters->AddPublished(bytes, serializationTime);
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+std::string NodeShared::PackHeader(const std::string &_type) const
+{
+  MessageInfo info;
+  info.SetPublisherAddress(this->myAddress);
+  info.SetType(_type);
+  info.SetMetadata(0, 0);
+  return info.Pack();
+}
+
+//////////////////////////////////////////////////
+std::shared_ptr<Publication> NodeShared::GetPublication(
+  const std::string &_topic)
+{
+  auto &publication = this->publications[_topic];
+  if (!publication)
+  {
+    publication.reset(new Publication(_topic, this->stats.Topic(_topic),
+      this->localSubscriptions.TopicId(_topic)));
+    this->RefreshPublication(_topic);
+  }
+  return publication;
+}
+
+//////////////////////////////////////////////////
+void NodeShared::RefreshPublication(const std::string &_topic)
+{
+  auto it = this->publications.find(_topic);
+  if (it == this->publications.end())
+    return;
+
+  it->second->hasLocal = this->localSubscriptions.HasHandlersForTopic(_topic);
+  it->second->hasRemote = this->remoteSubscribers.HasTopic(_topic);
+}
+
+//////////////////////////////////////////////////
+void NodeShared::RefreshPublications()
+{
+  for (auto const &publication : this->publications)
+    this->RefreshPublication(publication.first);
+}
+
+//////////////////////////////////////////////////
+void NodeShared::RecvMsgUpdate(zmq::socket_t &_socket)
+{
+  IGN_TRACE_SCOPE("NodeShared::RecvMsgUpdate");
 
   zmq::message_t msg(0);
   std::string topic;
-  // std::string sender;
+  std::string sender;
   std::string data;
 
+  std::unique_lock<std::mutex> subLock(this->subscriberMutex);
   try
   {
-    if (!this->subscriber->recv(&msg, 0))
+    IGN_TRACE_SCOPE("Recv");
+
+    if (!_socket.recv(&msg, 0))
       return;
     topic = std::string(reinterpret_cast<char *>(msg.data()), msg.size());
 
-    // ToDo(caguero): Use this as extra metadata for the subscriber.
-    if (!this->subscriber->recv(&msg, 0))
+    if (!_socket.recv(&msg, 0))
       return;
-    // sender = std::string(reinterpret_cast<char *>(msg.data()), msg.size());
+    sender = std::string(reinterpret_cast<char *>(msg.data()), msg.size());
 
-    if (!this->subscriber->recv(&msg, 0))
+    if (!_socket.recv(&msg, 0))
       return;
     data = std::string(reinterpret_cast<char *>(msg.data()), msg.size());
   }
@@ -268,28 +582,234 @@ void NodeShared::RecvMsgUpdate()
     std::cout << "Error: " << _error.what() << std::endl;
     return;
   }
+  subLock.unlock();
+
+  // The messages of the topics with limits are queued without locking
+  // 'mutex', so a slow callback running in the dispatch thread (or any other
+  // thread holding 'mutex') does not stop the reception.
+  std::unique_lock<std::recursive_mutex> lock(this->mutex, std::defer_lock);
+  TopicCountersPtr counters = this->QueueCounters(topic);
+  bool queued = counters != nullptr;
+  if (!queued)
+  {
+    lock.lock();
+    counters = this->stats.Topic(topic);
+  }
+  counters->AddReceived(data.size());
+
+  MessageInfo info;
+  std::string topicName = topic;
+  topicName.erase(0, topicName.find_last_of("@") + 1);
+  info.SetTopic(topicName);
+  if (info.Unpack(sender))
+  {
+    subLock.lock();
+
+    // The topic is received through a relay. Discard the copies sent by the
+    // original publishers that share a connection with other topics.
+    if (!this->relayConnections.empty())
+    {
+      auto relays = this->relayConnections.find(topic);
+      if (relays != this->relayConnections.end())
+      {
+        bool fromRelay = false;
+        for (auto const &relay : relays->second)
+          fromRelay = fromRelay || relay.second == info.GetPublisherAddress();
+        if (!fromRelay)
+          return;
+      }
+    }
+
+    // Detect gaps in the sequence numbers. A lower number means that the
+    // publisher has been restarted.
+    auto &last = this->lastSequences[info.GetPublisherAddress()][topic];
+    if (last != 0 && info.GetSequence() > last + 1)
+      counters->AddLost(info.GetSequence() - last - 1);
+    last = info.GetSequence();
+
+    subLock.unlock();
+
+    // The send time is only comparable with our clock in the same host.
+    auto now = MessageInfo::Now();
+    if (info.GetPublisherAddress().find("://" + this->hostAddr + ":") !=
+          std::string::npos && now >= info.GetSendTime())
+    {
+      counters->AddLatency(now - info.GetSendTime());
+    }
+  }
 
+  // Topics with limits are delivered by the dispatch thread.
+  if (queued)
+  {
+    this->EnqueueMsg(topic, data, info, counters);
+    return;
+  }
+
+  this->DispatchMsg(topic, this->localSubscriptions.Handlers(topic), data,
+    info, counters);
+}
+
+//////////////////////////////////////////////////
+void NodeShared::DispatchMsg(const std::string &_topic,
+  const HandlerStorage<ISubscriptionHandler>::HandlerListPtr &_handlers,
+  const std::string &_data, const MessageInfo &_info,
+  const TopicCountersPtr &_counters)
+{
   // Execute the callbacks registered.
-  std::map<std::string, ISubscriptionHandler_M> handlers;
-  if (this->localSubscriptions.GetHandlers(topic, handlers))
+  if (_handlers)
   {
-    for (auto &node : handlers)
+    for (auto const &entry : *_handlers)
     {
-      for (auto &handler : node.second)
+      const ISubscriptionHandlerPtr &subscriptionHandlerPtr = entry.handler;
+      if (subscriptionHandlerPtr)
       {
-        ISubscriptionHandlerPtr subscriptionHandlerPtr = handler.second;
-        if (subscriptionHandlerPtr)
-        {
-          // ToDo(caguero): Unserialize only once.
-          subscriptionHandlerPtr->RunCallback(topic, data);
-        }
-        else
-          std::cerr << "Subscription handler is NULL" << std::endl;
+        IGN_TRACE_SCOPE("Callback");
+        auto start = std::chrono::steady_clock::now();
+        // ToDo(caguero): Unserialize only once.
+        if (!subscriptionHandlerPtr->RunCallback(_topic, _data, _info))
+          _counters->AddDropped();
+        _counters->AddCallbackTime(ElapsedNs(start));
       }
+      else
+        std::cerr << "Subscription handler is NULL" << std::endl;
     }
   }
   else
-    std::cerr << "I am not subscribed to topic [" << topic << "]\n";
+  {
+    _counters->AddDropped();
+    std::cerr << "I am not subscribed to topic [" << _topic << "]\n";
+  }
+}
+
+//////////////////////////////////////////////////
+TopicCountersPtr NodeShared::QueueCounters(const std::string &_topic)
+{
+  std::lock_guard<std::mutex> lock(this->topicQueuesMutex);
+  auto it = this->queueCounters.find(_topic);
+  if (it == this->queueCounters.end())
+    return nullptr;
+  return it->second;
+}
+
+//////////////////////////////////////////////////
+void NodeShared::EnqueueMsg(const std::string &_topic, std::string &_data,
+  const MessageInfo &_info, const TopicCountersPtr &_counters)
+{
+  LimitCallback onLimit;
+  uint64_t messages;
+  uint64_t bytes;
+  {
+    std::lock_guard<std::mutex> lock(this->topicQueuesMutex);
+    auto it = this->topicQueues.find(_topic);
+    if (it == this->topicQueues.end())
+      return;
+
+    QueuedMsg msg;
+    msg.topic = _topic;
+    msg.data = std::move(_data);
+    msg.info = _info;
+
+    bool alert;
+    uint64_t dropped = it->second->Push(std::move(msg), alert);
+    for (uint64_t i = 0; i < dropped; ++i)
+      _counters->AddDropped();
+
+    messages = it->second->GetMessages();
+    bytes = it->second->GetBytes();
+    _counters->SetQueued(messages, bytes);
+
+    if (alert)
+    {
+      _counters->AddLimitReached();
+      onLimit = it->second->GetLimits().onLimit;
+    }
+  }
+  this->topicQueuesCv.notify_one();
+
+  // Notify the application without holding any lock.
+  if (onLimit)
+  {
+    std::string topicName = _topic;
+    topicName.erase(0, topicName.find_last_of("@") + 1);
+    onLimit(topicName, messages, bytes);
+  }
+}
+
+//////////////////////////////////////////////////
+void NodeShared::SetTopicLimits(const std::string &_topic,
+  const QueueLimits &_limits)
+{
+  std::lock_guard<std::recursive_mutex> lock(this->mutex);
+  std::lock_guard<std::mutex> queueLock(this->topicQueuesMutex);
+
+  auto &queue = this->topicQueues[_topic];
+  if (queue)
+    queue->SetLimits(_limits);
+  else
+  {
+    queue.reset(new TopicQueue(_limits));
+    this->queueCounters[_topic] = this->stats.Topic(_topic);
+  }
+
+  // Start the dispatch thread the first time that it is needed.
+  if (!this->threadDispatch.joinable() && !this->dispatchExit)
+    this->threadDispatch = std::thread(&NodeShared::RunDispatchTask, this);
+}
+
+//////////////////////////////////////////////////
+void NodeShared::RunDispatchTask()
+{
+  auto hasWork = [this]
+  {
+    if (this->dispatchExit)
+      return true;
+    for (auto const &queue : this->topicQueues)
+    {
+      if (queue.second->GetMessages() > 0)
+        return true;
+    }
+    return false;
+  };
+
+  while (true)
+  {
+    // Take one message of each topic, so a busy topic does not starve the
+    // rest.
+    std::vector<QueuedMsg> batch;
+    {
+      std::unique_lock<std::mutex> lock(this->topicQueuesMutex);
+      this->topicQueuesCv.wait(lock, hasWork);
+      if (this->dispatchExit)
+        return;
+
+      for (auto &queue : this->topicQueues)
+      {
+        QueuedMsg msg;
+        if (queue.second->Pop(msg))
+          batch.push_back(std::move(msg));
+      }
+    }
+
+    for (auto const &msg : batch)
+    {
+      TopicCountersPtr counters;
+      {
+        std::lock_guard<std::mutex> queueLock(this->topicQueuesMutex);
+        auto &queue = this->topicQueues[msg.topic];
+        counters = this->queueCounters[msg.topic];
+        counters->SetQueued(queue->GetMessages(), queue->GetBytes());
+      }
+
+      // Run the callbacks on a snapshot of the subscribers without holding
+      // 'mutex', so a slow callback does not block the reception thread.
+      HandlerStorage<ISubscriptionHandler>::HandlerListPtr handlers;
+      {
+        std::lock_guard<std::recursive_mutex> lock(this->mutex);
+        handlers = this->localSubscriptions.Handlers(msg.topic);
+      }
+      this->DispatchMsg(msg.topic, handlers, msg.data, msg.info, counters);
+    }
+  }
 }
 
 //////////////////////////////////////////////////
@@ -339,6 +859,7 @@ void NodeShared::RecvControlUpdate()
 
     // Register that we have another remote subscriber.
     this->remoteSubscribers.AddAddress(topic, "", "", procUuid, nodeUuid);
+    this->RefreshPublication(topic);
   }
   else if (std::stoi(data) == EndConnection)
   {
@@ -351,12 +872,15 @@ void NodeShared::RecvControlUpdate()
 
     // Delete a remote subscriber.
     this->remoteSubscribers.DelAddressByNode(topic, procUuid, nodeUuid);
+    this->RefreshPublication(topic);
   }
 }
 
 //////////////////////////////////////////////////
 void NodeShared::RecvSrvRequest()
 {
+  IGN_TRACE_SCOPE("NodeShared::RecvSrvRequest");
+
   std::lock_guard<std::recursive_mutex> lock(this->mutex);
 
   if (verbose)
@@ -374,6 +898,8 @@ void NodeShared::RecvSrvRequest()
 
   try
   {
+    IGN_TRACE_SCOPE("Recv");
+
     if (!this->replier->recv(&msg, 0))
       return;
 
@@ -414,7 +940,12 @@ void NodeShared::RecvSrvRequest()
   {
     bool result;
     // Run the service call and get the results.
-    repHandler->RunCallback(topic, req, rep, result);
+    {
+      IGN_TRACE_SCOPE("ServiceCallback");
+      auto start = std::chrono::steady_clock::now();
+      repHandler->RunCallback(topic, req, rep, result);
+      this->stats.Service(topic)->AddServed(ElapsedNs(start));
+    }
 
     if (result)
       resultStr = "1";
@@ -439,6 +970,8 @@ void NodeShared::RecvSrvRequest()
     // Send the reply.
     try
     {
+      IGN_TRACE_SCOPE("SendResponse");
+
       zmq::message_t response;
 
       response.rebuild(dstId.size());
@@ -480,6 +1013,8 @@ void NodeShared::RecvSrvRequest()
 //////////////////////////////////////////////////
 void NodeShared::RecvSrvResponse()
 {
+  IGN_TRACE_SCOPE("NodeShared::RecvSrvResponse");
+
   std::lock_guard<std::recursive_mutex> lock(this->mutex);
 
   if (verbose)
@@ -488,13 +1023,15 @@ void NodeShared::RecvSrvResponse()
   zmq::message_t msg(0);
   std::string topic;
   std::string nodeUuid;
-  std::string reqUuid;
+  Uuid reqUuid;
   std::string rep;
   std::string resultStr;
   bool result;
 
   try
   {
+    IGN_TRACE_SCOPE("Recv");
+
     if (!this->responseReceiver->recv(&msg, 0))
       return;
 
@@ -508,7 +1045,12 @@ void NodeShared::RecvSrvResponse()
 
     if (!this->responseReceiver->recv(&msg, 0))
       return;
-    reqUuid = std::string(reinterpret_cast<char *>(msg.data()), msg.size());
+    if (!reqUuid.FromBytes(msg.data(), msg.size()))
+    {
+      std::cerr << "NodeShared::RecvSrvResponse() error: Invalid request UUID"
+                << std::endl;
+      return;
+    }
 
     if (!this->responseReceiver->recv(&msg, 0))
       return;
@@ -529,6 +1071,11 @@ void NodeShared::RecvSrvResponse()
   IReqHandlerPtr reqHandlerPtr;
   if (this->requests.GetHandler(topic, nodeUuid, reqUuid, reqHandlerPtr))
   {
+    IGN_TRACE_SCOPE("NotifyResult");
+
+    this->stats.Service(topic)->AddResponse(result,
+      ElapsedNs(reqHandlerPtr->GetCreationTime()));
+
     // Notify the result.
     reqHandlerPtr->NotifyResult(topic, rep, result);
 
@@ -545,6 +1092,8 @@ void NodeShared::RecvSrvResponse()
 //////////////////////////////////////////////////
 void NodeShared::SendPendingRemoteReqs(const std::string &_topic)
 {
+  IGN_TRACE_SCOPE("NodeShared::SendPendingRemoteReqs");
+
   std::string responserAddr;
   std::string responserId;
   Addresses_M addresses;
@@ -557,6 +1106,15 @@ void NodeShared::SendPendingRemoteReqs(const std::string &_topic)
   responserAddr = v.at(0).addr;
   responserId = v.at(0).ctrl;
 
+  // The connection with the responser is still being established. The
+  // connection manager will send the requests when the connection is ready.
+  if (std::find(this->srvConnectionsPending.begin(),
+        this->srvConnectionsPending.end(), responserAddr) !=
+      this->srvConnectionsPending.end())
+  {
+    return;
+  }
+
   if (verbose)
   {
     std::cout << "Found a service call responser at ["
@@ -579,12 +1137,18 @@ void NodeShared::SendPendingRemoteReqs(const std::string &_topic)
       // Mark the handler as requested.
       req.second->SetRequested(true);
 
-      auto data = req.second->Serialize();
+      std::string data;
+      {
+        IGN_TRACE_SCOPE("Serialize");
+        data = req.second->Serialize();
+      }
       auto nodeUuid = req.second->GetNodeUuid();
       auto reqUuid = req.second->GetHandlerUuid();
 
       try
       {
+        IGN_TRACE_SCOPE("SendRequest");
+
         zmq::message_t msg;
 
         msg.rebuild(responserId.size());
@@ -609,8 +1173,10 @@ void NodeShared::SendPendingRemoteReqs(const std::string &_topic)
         memcpy(msg.data(), nodeUuid.data(), nodeUuid.size());
         this->requester->send(msg, ZMQ_SNDMORE);
 
-        msg.rebuild(reqUuid.size());
-        memcpy(msg.data(), reqUuid.data(), reqUuid.size());
+        // The request UUID is sent in binary form. The replier echoes it
+        // back without interpreting it.
+        msg.rebuild(Uuid::Size);
+        memcpy(msg.data(), reqUuid.Data(), Uuid::Size);
         this->requester->send(msg, ZMQ_SNDMORE);
 
         msg.rebuild(data.size());
@@ -645,73 +1211,265 @@ void NodeShared::OnNewConnection(const std::string &_topic,
   }
 
   // Check if we are interested in this topic.
-  if (this->localSubscriptions.HasHandlersForTopic(_topic) &&
-      this->pUuid.compare(_pUuid) != 0)
+  if (!this->localSubscriptions.HasHandlersForTopic(_topic) ||
+      this->pUuid.compare(_pUuid) == 0)
   {
-    try
-    {
-      // I am not connected to the process.
-      if (!this->connections.HasAddress(_addr))
-        this->subscriber->connect(_addr.c_str());
+    return;
+  }
+
+  // Relays are only used when requested. Otherwise, the messages would be
+  // received twice: from the original publisher and from the relay. A relay
+  // always receives its topics from the original publishers, so two relays
+  // never feed each other.
+  bool relay = this->discovery->IsRelay(_topic, _nUuid);
+  bool useRelay = this->preferRelay &&
+    !this->discovery->HasRelay(_topic, true);
+  if (relay != useRelay &&
+      (relay || this->discovery->HasRelay(_topic)))
+  {
+    return;
+  }
 
-      // Add a new filter for the topic.
-      this->subscriber->setsockopt(ZMQ_SUBSCRIBE, _topic.data(), _topic.size());
+  if (!this->ConnectToPublisher(_topic, _addr, _ctrl, _pUuid, _nUuid, _scope,
+        relay))
+  {
+    return;
+  }
+
+  if (relay)
+    this->DropOrigins(_topic);
+}
+
+//////////////////////////////////////////////////
+bool NodeShared::ConnectToPublisher(const std::string &_topic,
+  const std::string &_addr, const std::string &_ctrl,
+  const std::string &_pUuid, const std::string &_nUuid,
+  const Scope &_scope, const bool _relay)
+{
+  try
+  {
+    std::lock_guard<std::mutex> subLock(this->subscriberMutex);
+    auto &socket = _relay ? this->relaySubscriber : this->subscriber;
 
-      // Register the new connection with the publisher.
-      this->connections.AddAddress(
-        _topic, _addr, _ctrl, _pUuid, _nUuid, _scope);
+    // I am not connected to the process.
+    if (!this->SubscriberHasAddress(_addr, _relay))
+      socket->connect(_addr.c_str());
 
-      // Send a message to the publisher's control socket to notify it
-      // about all my remoteSubscribers.
-      zmq::socket_t socket(*this->context, ZMQ_DEALER);
+    // Add a new filter for the topic.
+    socket->setsockopt(ZMQ_SUBSCRIBE, _topic.data(), _topic.size());
 
-      if (this->verbose)
+    // Register the new connection with the publisher.
+    this->connections.AddAddress(
+      _topic, _addr, _ctrl, _pUuid, _nUuid, _scope);
+    if (_relay)
+      this->relayConnections[_topic][_pUuid] = _addr;
+
+    if (this->verbose)
+      std::cout << "\t* Connected to [" << _addr << "] for data\n";
+  }
+  // The remote node might not be available when we are connecting.
+  catch(const zmq::error_t& ze)
+  {
+    return false;
+  }
+
+  // Notifying the publisher requires a new control connection. Let the
+  // connection manager do it, so the discovery thread is not blocked.
+  this->connectionManager->Queue(_ctrl, _topic,
+    std::bind(&NodeShared::NotifyRemotePublisher, this,
+      std::placeholders::_1, std::placeholders::_2));
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+void NodeShared::DropOrigins(const std::string &_topic)
+{
+  Addresses_M addresses;
+  if (!this->connections.GetAddresses(_topic, addresses))
+    return;
+
+  std::set<std::string> controls;
+  {
+    std::lock_guard<std::mutex> subLock(this->subscriberMutex);
+    auto &relays = this->relayConnections[_topic];
+    for (auto const &proc : addresses)
+    {
+      if (relays.find(proc.first) != relays.end())
+        continue;
+
+      for (auto const &node : proc.second)
       {
-        std::cout << "\t* Connected to [" << _addr << "] for data\n";
-        std::cout << "\t* Connected to [" << _ctrl << "] for control\n";
+        this->connections.DelAddressByNode(_topic, proc.first, node.nUuid);
+        this->lastSequences[node.addr].erase(_topic);
+        controls.insert(node.ctrl);
+
+        // Remove the filter added by ConnectToPublisher(). Otherwise, the
+        // publisher keeps sending the topic if the connection is still used
+        // by other topics. The relays are connected through another socket.
+        this->subscriber->setsockopt(ZMQ_UNSUBSCRIBE, _topic.data(),
+          _topic.size());
+
+        // The address might still be used by other topics.
+        if (!this->SubscriberHasAddress(node.addr, false))
+          this->subscriber->disconnect(node.addr.c_str());
+
+        if (this->verbose)
+        {
+          std::cout << "\t* Using a relay instead of [" << node.addr
+                    << "] for [" << _topic << "]\n";
+        }
       }
+    }
+  }
 
-      int lingerVal = 300;
-      socket.setsockopt(ZMQ_LINGER, &lingerVal, sizeof(lingerVal));
-      socket.connect(_ctrl.c_str());
+  // The connection is no longer registered, so the publishers are notified
+  // about the end of the subscriptions.
+  for (auto const &ctrl : controls)
+  {
+    this->connectionManager->Queue(ctrl, _topic,
+      std::bind(&NodeShared::NotifyRemotePublisher, this,
+        std::placeholders::_1, std::placeholders::_2));
+  }
+}
 
-      std::this_thread::sleep_for(std::chrono::milliseconds(300));
+//////////////////////////////////////////////////
+bool NodeShared::SubscriberHasAddress(const std::string &_addr,
+  const bool _relay)
+{
+  if (_relay)
+  {
+    for (auto const &topic : this->relayConnections)
+    {
+      for (auto const &relay : topic.second)
+      {
+        if (relay.second == _addr)
+          return true;
+      }
+    }
+    return false;
+  }
 
-      std::map<std::string, ISubscriptionHandler_M> handlers;
-      if (this->localSubscriptions.GetHandlers(_topic, handlers))
+  std::vector<std::string> topics;
+  this->connections.GetTopicList(topics);
+  for (auto const &topic : topics)
+  {
+    Addresses_M addresses;
+    this->connections.GetAddresses(topic, addresses);
+    auto relays = this->relayConnections.find(topic);
+    for (auto const &proc : addresses)
+    {
+      if (relays != this->relayConnections.end() &&
+          relays->second.find(proc.first) != relays->second.end())
       {
-        for (auto &node : handlers)
-        {
-          for (auto &handler : node.second)
-          {
-            std::string nodeUuid = handler.second->GetNodeUuid();
+        continue;
+      }
 
-            zmq::message_t msg;
-            msg.rebuild(_topic.size());
-            memcpy(msg.data(), _topic.data(), _topic.size());
-            socket.send(msg, ZMQ_SNDMORE);
+      for (auto const &node : proc.second)
+      {
+        if (node.addr == _addr)
+          return true;
+      }
+    }
+  }
+  return false;
+}
 
-            msg.rebuild(this->pUuid.size());
-            memcpy(msg.data(), this->pUuid.data(), this->pUuid.size());
-            socket.send(msg, ZMQ_SNDMORE);
+//////////////////////////////////////////////////
+void NodeShared::ConnectToOrigins(const std::string &_topic)
+{
+  if (!this->localSubscriptions.HasHandlersForTopic(_topic))
+    return;
 
-            msg.rebuild(nodeUuid.size());
-            memcpy(msg.data(), nodeUuid.data(), nodeUuid.size());
-            socket.send(msg, ZMQ_SNDMORE);
+  Addresses_M addresses;
+  if (!this->discovery->GetMsgAddresses(_topic, addresses))
+    return;
 
-            std::string data = std::to_string(NewConnection);
-            msg.rebuild(data.size());
-            memcpy(msg.data(), data.data(), data.size());
-            socket.send(msg, 0);
-          }
-        }
+  for (auto const &proc : addresses)
+  {
+    if (proc.first == this->pUuid)
+      continue;
+
+    for (auto const &node : proc.second)
+    {
+      if (!this->discovery->IsRelay(_topic, node.nUuid))
+      {
+        this->ConnectToPublisher(_topic, node.addr, node.ctrl, proc.first,
+          node.nUuid, node.scope, false);
       }
     }
-    // The remote node might not be available when we are connecting.
-    catch(const zmq::error_t& ze)
+  }
+}
+
+//////////////////////////////////////////////////
+void NodeShared::NotifyRemotePublisher(const std::string &_ctrl,
+  const std::vector<std::string> &_topics)
+{
+  try
+  {
+    // Send a message to the publisher's control socket to notify it
+    // about all my remoteSubscribers.
+    zmq::socket_t socket(*this->context, ZMQ_DEALER);
+
+    int lingerVal = 300;
+    socket.setsockopt(ZMQ_LINGER, &lingerVal, sizeof(lingerVal));
+    socket.connect(_ctrl.c_str());
+
+    if (this->verbose)
+      std::cout << "\t* Connected to [" << _ctrl << "] for control\n";
+
+    // Give the connection some time to be established. Notice that we are
+    // not holding any lock here.
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+
+    for (auto const &topic : _topics)
     {
+      auto handlers = this->localSubscriptions.Handlers(topic);
+      if (!handlers)
+        continue;
+
+      // The connection might have been dropped while the notification was
+      // queued (see DropOrigins()).
+      bool connected = false;
+      Addresses_M addresses;
+      this->connections.GetAddresses(topic, addresses);
+      for (auto const &proc : addresses)
+      {
+        for (auto const &node : proc.second)
+          connected = connected || node.ctrl == _ctrl;
+      }
+      std::string data = std::to_string(
+        connected ? NewConnection : EndConnection);
+
+      for (auto const &entry : *handlers)
+      {
+        std::string nodeUuid = entry.handler->GetNodeUuid();
+
+        zmq::message_t msg;
+        msg.rebuild(topic.size());
+        memcpy(msg.data(), topic.data(), topic.size());
+        socket.send(msg, ZMQ_SNDMORE);
+
+        msg.rebuild(this->pUuid.size());
+        memcpy(msg.data(), this->pUuid.data(), this->pUuid.size());
+        socket.send(msg, ZMQ_SNDMORE);
+
+        msg.rebuild(nodeUuid.size());
+        memcpy(msg.data(), nodeUuid.data(), nodeUuid.size());
+        socket.send(msg, ZMQ_SNDMORE);
+
+        msg.rebuild(data.size());
+        memcpy(msg.data(), data.data(), data.size());
+        socket.send(msg, 0);
+      }
     }
   }
+  // The remote node might not be available when we are connecting.
+  catch(const zmq::error_t& ze)
+  {
+  }
 }
 
 //////////////////////////////////////////////////
@@ -732,33 +1490,101 @@ void NodeShared::OnNewDisconnection(const std::string &_topic,
   if (_topic != "" && _nUuid != "")
   {
     this->remoteSubscribers.DelAddressByNode(_topic, _pUuid, _nUuid);
+    this->RefreshPublication(_topic);
 
     Address_t connection;
     if (!this->connections.GetAddress(_topic, _pUuid, _nUuid, connection))
       return;
 
-    // Disconnect from a publisher's socket.
-    // for (const auto &connection : this->connections[_pUuid])
-    //   this->subscriber->disconnect(connection.addr.c_str());
-    this->subscriber->disconnect(connection.addr.c_str());
+    bool orphan = false;
+    {
+      std::lock_guard<std::mutex> subLock(this->subscriberMutex);
+      this->lastSequences[connection.addr].erase(_topic);
+
+      // The relay is gone, use the original publishers again.
+      bool relay = false;
+      auto relays = this->relayConnections.find(_topic);
+      if (relays != this->relayConnections.end() &&
+          relays->second.erase(_pUuid) > 0)
+      {
+        relay = true;
+        if (relays->second.empty())
+        {
+          this->relayConnections.erase(relays);
+          orphan = true;
+        }
+      }
+
+      // I am no longer connected.
+      this->connections.DelAddressByNode(_topic, _pUuid, _nUuid);
 
-    // I am no longer connected.
-    this->connections.DelAddressByNode(_topic, _pUuid, _nUuid);
+      // Disconnect from a publisher's socket if no other topic uses it.
+      if (!this->SubscriberHasAddress(connection.addr, relay))
+      {
+        auto &socket = relay ? this->relaySubscriber : this->subscriber;
+        socket->disconnect(connection.addr.c_str());
+      }
+    }
+
+    if (orphan)
+      this->ConnectToOrigins(_topic);
   }
   else
   {
     this->remoteSubscribers.DelAddressesByProc(_pUuid);
+    this->RefreshPublications();
 
-    Addresses_M info;
-    if (!this->connections.GetAddresses(_topic, info))
+    std::map<std::string, std::vector<Address_t>> info;
+    this->connections.GetAddressesByProc(_pUuid, info);
+    if (info.empty())
       return;
 
-    // Disconnect from all the connections of that publisher.
-    for (auto &connection : info[_pUuid])
-      this->subscriber->disconnect(connection.addr.c_str());
+    // If the process was a relay, use the original publishers again.
+    std::vector<std::string> orphans;
+    {
+      std::lock_guard<std::mutex> subLock(this->subscriberMutex);
+
+      // The sockets connected to the process. Its address is not used by
+      // any other process.
+      std::map<std::string, std::pair<bool, bool>> sockets;
+      for (auto const &topic : info)
+      {
+        for (auto const &connection : topic.second)
+        {
+          sockets[connection.addr] = std::make_pair(
+            this->SubscriberHasAddress(connection.addr, false),
+            this->SubscriberHasAddress(connection.addr, true));
+        }
+      }
+
+      // Disconnect from all the connections of that publisher.
+      for (auto const &socket : sockets)
+      {
+        if (socket.second.first)
+          this->subscriber->disconnect(socket.first.c_str());
+        if (socket.second.second)
+          this->relaySubscriber->disconnect(socket.first.c_str());
+        this->lastSequences.erase(socket.first);
+      }
+
+      for (auto it = this->relayConnections.begin();
+           it != this->relayConnections.end();)
+      {
+        if (it->second.erase(_pUuid) > 0 && it->second.empty())
+        {
+          orphans.push_back(it->first);
+          it = this->relayConnections.erase(it);
+        }
+        else
+          ++it;
+      }
+
+      // Remove all the connections from the process disonnected.
+      this->connections.DelAddressesByProc(_pUuid);
+    }
 
-    // Remove all the connections from the process disonnected.
-    this->connections.DelAddressesByProc(_pUuid);
+    for (auto const &topic : orphans)
+      this->ConnectToOrigins(topic);
   }
 }
 
@@ -780,22 +1606,86 @@ void NodeShared::OnNewSrvConnection(const std::string &_topic,
     std::cout << "Node UUID: [" << _nUuid << "]" << std::endl;
   }
 
-  // I am still not connected to this address.
+  // I am already connected to this address.
   if (std::find(this->srvConnections.begin(), this->srvConnections.end(),
-        _addr) == this->srvConnections.end())
+        _addr) != this->srvConnections.end())
   {
-    this->requester->connect(_addr.c_str());
-    this->srvConnections.push_back(_addr);
+    // Request all pending service calls for this topic.
+    this->SendPendingRemoteReqs(_topic);
+    return;
+  }
+
+  // I am still not connected to this address.
+  if (std::find(this->srvConnectionsPending.begin(),
+        this->srvConnectionsPending.end(), _addr) ==
+      this->srvConnectionsPending.end())
+  {
+    try
+    {
+      this->requester->connect(_addr.c_str());
+    }
+    catch(const zmq::error_t& ze)
+    {
+      std::cerr << "NodeShared::OnNewSrvConnection() error connecting to ["
+                << _addr << "]: " << ze.what() << std::endl;
+      return;
+    }
+    this->srvConnectionsPending.push_back(_addr);
+  }
+
+  // The connection needs some time to be established. The connection manager
+  // will send the pending requests when the connection is ready.
+  this->connectionManager->Queue(_addr, _topic,
+    std::bind(&NodeShared::OnSrvConnectionReady, this,
+      std::placeholders::_1, std::placeholders::_2));
+}
+
+//////////////////////////////////////////////////
+void NodeShared::OnSrvConnectionReady(const std::string &_addr,
+  const std::vector<std::string> &_topics)
+{
+  // Topics queued while the connection was being established are handled
+  // in a second run, once the address is connected.
+  bool connected;
+  {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    connected = std::find(this->srvConnections.begin(),
+      this->srvConnections.end(), _addr) != this->srvConnections.end();
+  }
+
+  // Give the connection some time to be established. Notice that we are
+  // not holding any lock here.
+  if (!connected)
     std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+  // SendPendingRemoteReqs() reads the discovery information. Lock the
+  // discovery mutex first, as the rest of the code does (see 'mutex').
+  std::lock_guard<std::recursive_mutex> discLk(this->discovery->GetMutex());
+  std::lock_guard<std::recursive_mutex> lock(this->mutex);
+
+  auto it = std::find(this->srvConnectionsPending.begin(),
+    this->srvConnectionsPending.end(), _addr);
+  if (it != this->srvConnectionsPending.end())
+  {
+    this->srvConnectionsPending.erase(it);
+    this->srvConnections.push_back(_addr);
+
     if (this->verbose)
     {
       std::cout << "\t* Connected to [" << _addr
                 << "] for service requests" << std::endl;
     }
   }
+  // The connection might have been removed while we were waiting.
+  else if (std::find(this->srvConnections.begin(),
+    this->srvConnections.end(), _addr) == this->srvConnections.end())
+  {
+    return;
+  }
 
-  // Request all pending service calls for this topic.
-  this->SendPendingRemoteReqs(_topic);
+  // Request all pending service calls for these topics.
+  for (auto const &topic : _topics)
+    this->SendPendingRemoteReqs(topic);
 }
 
 //////////////////////////////////////////////////
@@ -810,6 +1700,10 @@ void NodeShared::OnNewSrvDisconnection(const std::string &_topic,
   this->srvConnections.erase(std::remove(std::begin(this->srvConnections),
     std::end(this->srvConnections), _addr.c_str()),
     std::end(this->srvConnections));
+  this->srvConnectionsPending.erase(
+    std::remove(std::begin(this->srvConnectionsPending),
+      std::end(this->srvConnectionsPending), _addr.c_str()),
+    std::end(this->srvConnectionsPending));
 
   if (this->verbose)
   {
@@ -821,3 +1715,134 @@ void NodeShared::OnNewSrvDisconnection(const std::string &_topic,
     std::cout << "Node UUID: [" << _nUuid << "]" << std::endl;
   }
 }
+
+//////////////////////////////////////////////////
+void NodeShared::EnableIntrospection(const std::string &_partition)
+{
+  if (!this->introspection)
+    return;
+
+  std::string service;
+  if (!TopicUtils::GetFullyQualifiedName(_partition, "",
+    IntrospectionPrefix + this->pUuid, service))
+  {
+    return;
+  }
+
+  std::lock_guard<std::recursive_mutex> discLk(this->discovery->GetMutex());
+  std::lock_guard<std::recursive_mutex> lk(this->mutex);
+
+  if (!this->introspectionPartitions.insert(_partition).second)
+    return;
+
+  std::shared_ptr<RawRepHandler> handler(new RawRepHandler(
+    std::bind(&NodeShared::OnIntrospectionRequest, this,
+      std::placeholders::_1, std::placeholders::_2, std::placeholders::_3,
+      std::placeholders::_4)));
+
+  // The service is registered as if it belonged to a node whose UUID is the
+  // process UUID, so it is not listed by any of the nodes.
+  this->repliers.AddHandler(service, this->pUuid, handler);
+  this->discovery->Advertise(MsgType::Srv, service, this->myReplierAddress,
+    this->replierId.ToString(), this->pUuid, this->introspectionScope);
+}
+
+//////////////////////////////////////////////////
+void NodeShared::GetProcessState(const std::string &_prefix,
+  ProcessState &_state)
+{
+  std::lock_guard<std::recursive_mutex> lk(this->mutex);
+
+  _state = ProcessState();
+  _state.pUuid = this->pUuid;
+  _state.hostAddr = this->hostAddr;
+#ifdef _WIN32
+  _state.pid = _getpid();
+#else
+  _state.pid = getpid();
+#endif
+  _state.cpuTime = ProcessCpuNs();
+
+  // Each remote publisher is connected once, whatever the number of topics.
+  std::vector<std::string> topics;
+  std::set<std::string> publishers;
+  this->connections.GetTopicList(topics);
+  for (auto const &topic : topics)
+  {
+    Addresses_M addresses;
+    this->connections.GetAddresses(topic, addresses);
+    for (auto const &proc : addresses)
+      for (auto const &node : proc.second)
+        publishers.insert(node.addr);
+  }
+  _state.connections = publishers.size();
+
+  _state.threads["reception"] = ThreadCpuNs(*this->threadReception);
+  if (this->threadDispatch.joinable())
+    _state.threads["dispatch"] = ThreadCpuNs(this->threadDispatch);
+  if (this->connectionManager)
+    _state.threads["connections"] = this->connectionManager->GetCpuTime();
+  this->discovery->GetThreadTimes(_state.threads);
+
+  // All the topics used by the process: advertised, subscribed or with
+  // counters.
+  std::set<std::string> names;
+  for (auto const &topic : this->advertisedTopics)
+    names.insert(topic.first);
+  this->localSubscriptions.GetTopicList(topics);
+  names.insert(topics.begin(), topics.end());
+  this->stats.GetTopicList(topics);
+  names.insert(topics.begin(), topics.end());
+
+  for (auto const &name : names)
+  {
+    if (name.compare(0, _prefix.size(), _prefix) != 0)
+      continue;
+
+    TopicState topic;
+    topic.name = name.substr(name.find_last_of("@") + 1);
+    topic.advertised = this->advertisedTopics.find(name) !=
+      this->advertisedTopics.end();
+    topic.subscribed = this->localSubscriptions.HasHandlersForTopic(name);
+
+    Addresses_M subscribers;
+    this->remoteSubscribers.GetAddresses(name, subscribers);
+    for (auto const &proc : subscribers)
+      topic.remoteSubscribers += proc.second.size();
+
+    this->stats.GetTopicStats(name, topic.stats);
+    _state.topics.push_back(topic);
+  }
+
+  names.clear();
+  this->repliers.GetTopicList(topics);
+  names.insert(topics.begin(), topics.end());
+  this->stats.GetServiceList(topics);
+  names.insert(topics.begin(), topics.end());
+
+  for (auto const &name : names)
+  {
+    // Skip the introspection services themselves.
+    if (name.compare(0, _prefix.size(), _prefix) != 0 ||
+        name.find(IntrospectionPrefix) != std::string::npos)
+    {
+      continue;
+    }
+
+    ServiceState service;
+    service.name = name.substr(name.find_last_of("@") + 1);
+    service.advertised = this->repliers.HasHandlersForTopic(name);
+    this->stats.GetServiceStats(name, service.stats);
+    _state.services.push_back(service);
+  }
+}
+
+//////////////////////////////////////////////////
+void NodeShared::OnIntrospectionRequest(const std::string &/*_topic*/,
+  const std::string &_req, std::string &_rep, bool &_result)
+{
+  ProcessState state;
+  this->GetProcessState(_req, state);
+  _rep = state.Serialize();
+  _result = true;
+}
@@ -21,6 +21,7 @@
 #include <memory>
 #include <string>
 #include <thread>
+#include <vector>
 #include "gtest/gtest.h"
 #include "ignition/transport/Node.hh"
 #include "ignition/transport/TopicUtils.hh"
@@ -617,6 +618,20 @@ TEST(NodeTest, ServiceCallSync)
   EXPECT_EQ(rep.data(), req.data());
 }
 
+//////////////////////////////////////////////////
+/// \brief Check that only the services advertised by the nodes are listed.
+/// The introspection service of the process is not listed.
+TEST(NodeTest, ServiceList)
+{
+  transport::Node node;
+  EXPECT_TRUE(node.Advertise(topic, srvEcho));
+
+  std::vector<std::string> services;
+  node.GetServiceList(services);
+  ASSERT_EQ(services.size(), 1u);
+  EXPECT_EQ(services[0], topic);
+}
+
 //////////////////////////////////////////////////
 /// \brief A thread can create a node, and send and receive messages.
 TEST(NodeTest, ServiceCallSyncTimeout)
@@ -644,6 +659,201 @@ TEST(NodeTest, ServiceCallSyncTimeout)
   EXPECT_FALSE(executed);
 }
 
+//////////////////////////////////////////////////
+/// \brief Subscription callback used to check the statistics.
+void statsCb(const std::string &/*_topic*/,
+  const transport::msgs::Int &/*_msg*/)
+{
+}
+
+//////////////////////////////////////////////////
+/// \brief Service used to check the statistics.
+void statsSrv(const std::string &/*_topic*/, const transport::msgs::Int &_req,
+  transport::msgs::Int &_rep, bool &_result)
+{
+  _rep.set_data(_req.data());
+  _result = true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the runtime statistics of topics and services.
+TEST(NodeTest, Statistics)
+{
+  std::string statsTopic = "/stats";
+  std::string statsService = "/statsSrv";
+  std::string unknownService = "/statsUnknownSrv";
+  transport::msgs::Int msg;
+  msg.set_data(data);
+  transport::msgs::Int rep;
+  bool result;
+  transport::TopicStatistics topicStats;
+  transport::ServiceStatistics srvStats;
+
+  transport::Node node;
+
+  EXPECT_FALSE(node.GetTopicStats("invalid topic", topicStats));
+  EXPECT_FALSE(node.GetTopicStats(statsTopic, topicStats));
+
+  EXPECT_TRUE(node.Advertise(statsTopic));
+  EXPECT_TRUE(node.Publish(statsTopic, msg));
+
+  ASSERT_TRUE(node.GetTopicStats(statsTopic, topicStats));
+  EXPECT_EQ(topicStats.published, 1u);
+  EXPECT_EQ(topicStats.received, 0u);
+
+  // Local subscriber.
+  EXPECT_TRUE(node.Subscribe(statsTopic, statsCb));
+  EXPECT_TRUE(node.Publish(statsTopic, msg));
+  EXPECT_TRUE(node.Publish(statsTopic, msg));
+
+  ASSERT_TRUE(node.GetTopicStats(statsTopic, topicStats));
+  EXPECT_EQ(topicStats.published, 3u);
+  EXPECT_EQ(topicStats.received, 2u);
+  EXPECT_EQ(topicStats.dropped, 0u);
+
+  // Service calls.
+  EXPECT_FALSE(node.GetServiceStats(statsService, srvStats));
+  EXPECT_TRUE(node.Advertise(statsService, statsSrv));
+  EXPECT_TRUE(node.Request(statsService, msg, 1000, rep, result));
+  EXPECT_TRUE(node.Request(statsService, msg, 1000, rep, result));
+
+  ASSERT_TRUE(node.GetServiceStats(statsService, srvStats));
+  EXPECT_EQ(srvStats.requests, 2u);
+  EXPECT_EQ(srvStats.responses, 2u);
+  EXPECT_EQ(srvStats.served, 2u);
+  EXPECT_EQ(srvStats.failures, 0u);
+  EXPECT_EQ(srvStats.timeouts, 0u);
+  EXPECT_GE(srvStats.latencyTotal, srvStats.latencyMax);
+
+  // A service that nobody provides.
+  EXPECT_FALSE(node.Request(unknownService, msg, 100, rep, result));
+  ASSERT_TRUE(node.GetServiceStats(unknownService, srvStats));
+  EXPECT_EQ(srvStats.requests, 1u);
+  EXPECT_EQ(srvStats.responses, 0u);
+  EXPECT_EQ(srvStats.timeouts, 1u);
+}
+
+//////////////////////////////////////////////////
+/// \brief Sequence numbers received by infoCb.
+std::vector<uint64_t> infoSequences;
+
+//////////////////////////////////////////////////
+/// \brief Subscription callback that receives the message metadata.
+void infoCb(const std::string &_topic, const transport::msgs::Int &_msg,
+  const transport::MessageInfo &_info)
+{
+  EXPECT_EQ(_topic, "/info");
+  EXPECT_EQ(_info.GetTopic(), "/info");
+  EXPECT_EQ(_msg.data(), data);
+  EXPECT_TRUE(_info.HasMetadata());
+  infoSequences.push_back(_info.GetSequence());
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the subscribers receive consecutive sequence numbers.
+TEST(NodeTest, MessageInfo)
+{
+  std::string infoTopic = "/info";
+  transport::msgs::Int msg;
+  msg.set_data(data);
+  infoSequences.clear();
+
+  transport::Node node;
+  EXPECT_TRUE(node.Advertise(infoTopic));
+  EXPECT_TRUE(node.Subscribe(infoTopic, infoCb));
+
+  for (int i = 0; i < 5; ++i)
+    EXPECT_TRUE(node.Publish(infoTopic, msg));
+
+  ASSERT_EQ(infoSequences.size(), 5u);
+  for (size_t i = 1; i < infoSequences.size(); ++i)
+    EXPECT_EQ(infoSequences[i], infoSequences[i - 1] + 1);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that a raw subscriber receives the serialized messages.
+TEST(NodeTest, RawSubscription)
+{
+  std::string rawTopic = "/raw";
+  transport::msgs::Int msg;
+  msg.set_data(data);
+  std::string expected;
+  ASSERT_TRUE(msg.SerializeToString(&expected));
+
+  int rawCounter = 0;
+  auto rawCb = [&](const std::string &_topic, const char *_data,
+    const size_t _size, const transport::MessageInfo &_info)
+  {
+    EXPECT_EQ(_topic, rawTopic);
+    EXPECT_EQ(std::string(_data, _size), expected);
+    EXPECT_EQ(_info.GetSequence(), static_cast<uint64_t>(rawCounter + 1));
+    EXPECT_EQ(_info.GetType(), msg.GetTypeName());
+    ++rawCounter;
+  };
+
+  transport::Node node;
+  EXPECT_FALSE(node.SubscribeRaw("invalid topic", rawCb));
+  EXPECT_TRUE(node.Advertise(rawTopic));
+  EXPECT_TRUE(node.SubscribeRaw(rawTopic, rawCb));
+
+  EXPECT_TRUE(node.Publish(rawTopic, msg));
+  EXPECT_TRUE(node.Publish(rawTopic, msg));
+  EXPECT_EQ(rawCounter, 2);
+
+  EXPECT_TRUE(node.Unsubscribe(rawTopic));
+  EXPECT_TRUE(node.Publish(rawTopic, msg));
+  EXPECT_EQ(rawCounter, 2);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the limits of a topic can be set.
+TEST(NodeTest, TopicLimits)
+{
+  transport::QueueLimits limits;
+  limits.maxMessages = 10;
+  limits.maxBytes = 1024;
+  limits.policy = transport::DropPolicy::DropNewest;
+
+  transport::Node node;
+  EXPECT_FALSE(node.SetTopicLimits("invalid topic", limits));
+  EXPECT_TRUE(node.SetTopicLimits(topic, limits));
+
+  // Change the limits of the same topic.
+  limits.policy = transport::DropPolicy::DropOldest;
+  EXPECT_TRUE(node.SetTopicLimits(topic, limits));
+
+  // Messages published in the same process are not queued.
+  transport::msgs::Int msg;
+  msg.set_data(data);
+  reset();
+  EXPECT_TRUE(node.Advertise(topic));
+  EXPECT_TRUE(node.Subscribe(topic, cb));
+  EXPECT_TRUE(node.Publish(topic, msg));
+  EXPECT_TRUE(cbExecuted);
+  reset();
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the subscriptions of a node can reuse their messages.
+TEST(NodeTest, ReuseMsgs)
+{
+  transport::Node node;
+  EXPECT_FALSE(node.ReuseMsgs());
+  node.SetReuseMsgs(true);
+  EXPECT_TRUE(node.ReuseMsgs());
+
+  // Messages published in the same process are not parsed, so they are
+  // delivered as usual.
+  transport::msgs::Int msg;
+  msg.set_data(data);
+  reset();
+  EXPECT_TRUE(node.Advertise(topic));
+  EXPECT_TRUE(node.Subscribe(topic, cb));
+  EXPECT_TRUE(node.Publish(topic, msg));
+  EXPECT_TRUE(cbExecuted);
+  reset();
+}
+
 //////////////////////////////////////////////////
 /// \brief Create a publisher that sends messages "forever". This function will
 /// be used emiting a SIGINT or SIGTERM signal, to make sure that the transport
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2015 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include "ignition/transport/Pacer.hh"
+
+using namespace ignition;
+using namespace transport;
+
+const uint64_t Pacer::SpinTime;
+const unsigned int Pacer::MaxSleep;
+
+//////////////////////////////////////////////////
+Pacer::Pacer(const double _rate)
+  : period(_rate > 0 ? static_cast<uint64_t>(1e9 / _rate) : 0),
+    start(std::chrono::steady_clock::now()),
+    noStop(false)
+{
+}
+
+//////////////////////////////////////////////////
+void Pacer::Reset()
+{
+  this->start = std::chrono::steady_clock::now();
+  this->events = 0;
+}
+
+//////////////////////////////////////////////////
+uint64_t Pacer::Wait()
+{
+  uint64_t n = this->events++;
+  if (this->period == 0)
+    return 0;
+
+  return WaitUntil(this->start + std::chrono::nanoseconds(n * this->period),
+    this->noStop);
+}
+
+//////////////////////////////////////////////////
+uint64_t Pacer::GetEvents() const
+{
+  return this->events;
+}
+
+//////////////////////////////////////////////////
+uint64_t Pacer::WaitUntil(
+  const std::chrono::steady_clock::time_point &_target,
+  const std::atomic<bool> &_stop)
+{
+  const std::chrono::nanoseconds spin(SpinTime);
+
+  // Sleep while there is time left, then spin.
+  auto now = std::chrono::steady_clock::now();
+  while (!_stop && _target - now > spin)
+  {
+    std::this_thread::sleep_for(std::min<std::chrono::nanoseconds>(
+      _target - now - spin, std::chrono::milliseconds(MaxSleep)));
+    now = std::chrono::steady_clock::now();
+  }
+
+  if (_stop)
+    return 0;
+
+  while (now < _target)
+    now = std::chrono::steady_clock::now();
+
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    now - _target).count();
+}
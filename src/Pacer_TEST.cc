@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2015 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include "ignition/transport/Pacer.hh"
+#include "gtest/gtest.h"
+
+using namespace ignition;
+
+//////////////////////////////////////////////////
+/// \brief Check that the events follow the requested rate.
+TEST(PacerTest, Rate)
+{
+  // 1 kHz during 50 ms.
+  transport::Pacer pacer(1000);
+  auto start = std::chrono::steady_clock::now();
+  pacer.Reset();
+  uint64_t maxError = 0;
+  for (int i = 0; i < 51; ++i)
+    maxError = std::max(maxError, pacer.Wait());
+  auto elapsed = std::chrono::steady_clock::now() - start;
+
+  EXPECT_EQ(pacer.GetEvents(), 51u);
+  EXPECT_GE(elapsed, std::chrono::milliseconds(50));
+  EXPECT_LT(elapsed, std::chrono::milliseconds(500));
+  EXPECT_LT(maxError, 20000000u);
+
+  // No pacing.
+  transport::Pacer unpaced(0);
+  for (int i = 0; i < 1000; ++i)
+    EXPECT_EQ(unpaced.Wait(), 0u);
+  EXPECT_EQ(unpaced.GetEvents(), 1000u);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that a wait can be interrupted.
+TEST(PacerTest, Stop)
+{
+  std::atomic<bool> stop(false);
+  auto target = std::chrono::steady_clock::now() +
+    std::chrono::milliseconds(5);
+  transport::Pacer::WaitUntil(target, stop);
+  EXPECT_GE(std::chrono::steady_clock::now(), target);
+
+  stop = true;
+  target = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  EXPECT_EQ(transport::Pacer::WaitUntil(target, stop), 0u);
+  EXPECT_LT(std::chrono::steady_clock::now(), target);
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
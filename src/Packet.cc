@@ -17,6 +17,7 @@
 
 #include <cstring>
 #include <string>
+#include <vector>
 #include "ignition/transport/Packet.hh"
 
 using namespace ignition;
@@ -24,7 +25,7 @@ using namespace transport;
 
 //////////////////////////////////////////////////
 Header::Header(const uint16_t _version,
-               const std::string &_pUuid,
+               const Uuid &_pUuid,
                const uint8_t _type,
                const uint16_t _flags)
 {
@@ -41,7 +42,7 @@ uint16_t Header::GetVersion() const
 }
 
 //////////////////////////////////////////////////
-std::string Header::GetPUuid() const
+Uuid Header::GetPUuid() const
 {
   return this->pUuid;
 }
@@ -58,6 +59,12 @@ uint16_t Header::GetFlags() const
   return this->flags;
 }
 
+//////////////////////////////////////////////////
+uint32_t Header::GetPartitionHash() const
+{
+  return this->partitionHash;
+}
+
 //////////////////////////////////////////////////
 void Header::SetVersion(const uint16_t _version)
 {
@@ -65,7 +72,7 @@ void Header::SetVersion(const uint16_t _version)
 }
 
 //////////////////////////////////////////////////
-void Header::SetPUuid(const std::string &_pUuid)
+void Header::SetPUuid(const Uuid &_pUuid)
 {
   this->pUuid = _pUuid;
 }
@@ -82,20 +89,25 @@ void Header::SetFlags(const uint16_t _flags)
   this->flags = _flags;
 }
 
+//////////////////////////////////////////////////
+void Header::SetPartitionHash(const uint32_t _hash)
+{
+  this->partitionHash = _hash;
+}
+
 //////////////////////////////////////////////////
 int Header::GetHeaderLength()
 {
-  return sizeof(this->version) +
-         sizeof(uint64_t) + this->pUuid.size() +
-         sizeof(this->type) + sizeof(this->flags);
+  return sizeof(this->version) + Uuid::Size +
+         sizeof(this->type) + sizeof(this->flags) +
+         sizeof(this->partitionHash);
 }
 
 //////////////////////////////////////////////////
 size_t Header::Pack(char *_buffer)
 {
   // Uninitialized.
-  if ((this->version == 0) || (this->pUuid == "") ||
-      (this->type  == Uninitialized))
+  if ((this->version == 0) || (this->type  == Uninitialized))
   {
     std::cerr << "Header::Pack() error: You're trying to pack an incomplete "
               << "header:" << std::endl << *this;
@@ -113,14 +125,9 @@ size_t Header::Pack(char *_buffer)
   memcpy(_buffer, &this->version, sizeof(this->version));
   _buffer += sizeof(this->version);
 
-  // Pack the process UUID length.
-  uint64_t pUuidLength = this->pUuid.size();
-  memcpy(_buffer, &pUuidLength, sizeof(pUuidLength));
-  _buffer += sizeof(pUuidLength);
-
   // Pack the process UUID.
-  memcpy(_buffer, this->pUuid.data(), static_cast<size_t>(pUuidLength));
-  _buffer += pUuidLength;
+  memcpy(_buffer, this->pUuid.Data(), Uuid::Size);
+  _buffer += Uuid::Size;
 
   // Pack the message type (ADVERTISE, SUBSCRIPTION, ...), which is uint8_t
   memcpy(_buffer, &this->type, sizeof(this->type));
@@ -128,12 +135,16 @@ size_t Header::Pack(char *_buffer)
 
   // Pack the flags, which is uint16_t
   memcpy(_buffer, &this->flags, sizeof(this->flags));
+  _buffer += sizeof(this->flags);
+
+  // Pack the partition hash, which is uint32_t
+  memcpy(_buffer, &this->partitionHash, sizeof(this->partitionHash));
 
   return this->GetHeaderLength();
 }
 
 //////////////////////////////////////////////////
-size_t Header::Unpack(const char *_buffer)
+size_t Header::Unpack(const char *_buffer, const size_t _len)
 {
   // null buffer.
   if (!_buffer)
@@ -142,18 +153,21 @@ size_t Header::Unpack(const char *_buffer)
     return 0;
   }
 
+  // The header is received from the network, so the buffer might be shorter
+  // than a header.
+  if (_len < static_cast<size_t>(this->GetHeaderLength()))
+  {
+    std::cerr << "Header::Unpack() error: Truncated header" << std::endl;
+    return 0;
+  }
+
   // Unpack the version.
   memcpy(&this->version, _buffer, sizeof(this->version));
   _buffer += sizeof(this->version);
 
-  // Unpack the process UUID length.
-  uint64_t pUuidLength;
-  memcpy(&pUuidLength, _buffer, sizeof(pUuidLength));
-  _buffer += sizeof(pUuidLength);
-
   // Unpack the process UUID.
-  this->pUuid = std::string(_buffer, _buffer + pUuidLength);
-  _buffer += pUuidLength;
+  this->pUuid.FromBytes(_buffer, Uuid::Size);
+  _buffer += Uuid::Size;
 
   // Unpack the message type.
   memcpy(&this->type, _buffer, sizeof(this->type));
@@ -163,6 +177,10 @@ size_t Header::Unpack(const char *_buffer)
   memcpy(&this->flags, _buffer, sizeof(this->flags));
   _buffer += sizeof(this->flags);
 
+  // Unpack the partition hash.
+  memcpy(&this->partitionHash, _buffer, sizeof(this->partitionHash));
+  _buffer += sizeof(this->partitionHash);
+
   return this->GetHeaderLength();
 }
 
@@ -198,18 +216,42 @@ void SubscriptionMsg::SetTopic(const std::string &_topic)
   this->topic = _topic;
 }
 
+//////////////////////////////////////////////////
+std::vector<Uuid> SubscriptionMsg::GetKnownAnswers() const
+{
+  return this->knownAnswers;
+}
+
+//////////////////////////////////////////////////
+void SubscriptionMsg::SetKnownAnswers(const std::vector<Uuid> &_nUuids)
+{
+  this->knownAnswers = _nUuids;
+}
+
 //////////////////////////////////////////////////
 size_t SubscriptionMsg::GetMsgLength()
 {
-  return this->header.GetHeaderLength() +
-         sizeof(uint64_t) + this->topic.size();
+  size_t len = this->header.GetHeaderLength() +
+    sizeof(uint64_t) + this->topic.size();
+
+  if (!this->knownAnswers.empty())
+    len += sizeof(uint64_t) + this->knownAnswers.size() * Uuid::Size;
+
+  return len;
 }
 
 //////////////////////////////////////////////////
 size_t SubscriptionMsg::Pack(char *_buffer)
 {
+  // The flag is only set when the message contains known answers.
+  Header hdr = this->GetHeader();
+  uint16_t flags = hdr.GetFlags() & ~KnownAnswersFlag;
+  if (!this->knownAnswers.empty())
+    flags |= KnownAnswersFlag;
+  hdr.SetFlags(flags);
+
   // Pack the header.
-  size_t headerLen = this->GetHeader().Pack(_buffer);
+  size_t headerLen = hdr.Pack(_buffer);
   if (headerLen == 0)
     return 0;
 
@@ -229,12 +271,28 @@ size_t SubscriptionMsg::Pack(char *_buffer)
 
   // Pack the topic.
   memcpy(_buffer, this->topic.data(), static_cast<size_t>(topicLength));
+  _buffer += topicLength;
+
+  if (!this->knownAnswers.empty())
+  {
+    // Pack the number of known answers.
+    uint64_t numAnswers = this->knownAnswers.size();
+    memcpy(_buffer, &numAnswers, sizeof(numAnswers));
+    _buffer += sizeof(numAnswers);
+
+    // Pack each known answer.
+    for (auto const &nUuid : this->knownAnswers)
+    {
+      memcpy(_buffer, nUuid.Data(), Uuid::Size);
+      _buffer += Uuid::Size;
+    }
+  }
 
   return this->GetMsgLength();
 }
 
 //////////////////////////////////////////////////
-size_t SubscriptionMsg::UnpackBody(char *_buffer)
+size_t SubscriptionMsg::UnpackBody(char *_buffer, const size_t _len)
 {
   // null buffer.
   if (!_buffer)
@@ -244,16 +302,63 @@ size_t SubscriptionMsg::UnpackBody(char *_buffer)
     return 0;
   }
 
+  this->knownAnswers.clear();
+
+  // The body is received from the network, so every length is checked
+  // against the bytes that are left in the buffer.
+  auto truncated = []()
+  {
+    std::cerr << "SubscriptionMsg::UnpackBody() error: Truncated message"
+              << std::endl;
+    return 0u;
+  };
+
   // Unpack the topic length.
   uint64_t topicLength;
+  if (_len < sizeof(topicLength))
+    return truncated();
   memcpy(&topicLength, _buffer, sizeof(topicLength));
   _buffer += sizeof(topicLength);
+  size_t len = sizeof(topicLength);
 
   // Unpack the topic.
+  if (topicLength > _len - len)
+    return truncated();
   this->topic = std::string(_buffer, _buffer + topicLength);
   _buffer += topicLength;
+  len += static_cast<size_t>(topicLength);
 
-  return sizeof(topicLength) + static_cast<size_t>(topicLength);
+  if (!(this->header.GetFlags() & KnownAnswersFlag))
+    return len;
+
+  // Unpack the number of known answers.
+  uint64_t numAnswers;
+  if (_len - len < sizeof(numAnswers))
+    return truncated();
+  memcpy(&numAnswers, _buffer, sizeof(numAnswers));
+  _buffer += sizeof(numAnswers);
+  len += sizeof(numAnswers);
+
+  if (numAnswers > MaxKnownAnswers)
+  {
+    std::cerr << "SubscriptionMsg::UnpackBody() error: Too many known answers"
+              << " [" << numAnswers << "]" << std::endl;
+    return 0;
+  }
+
+  // Unpack each known answer.
+  if (numAnswers * Uuid::Size > _len - len)
+    return truncated();
+
+  this->knownAnswers.resize(static_cast<size_t>(numAnswers));
+  for (auto &nUuid : this->knownAnswers)
+  {
+    nUuid.FromBytes(_buffer, Uuid::Size);
+    _buffer += Uuid::Size;
+    len += Uuid::Size;
+  }
+
+  return len;
 }
 
 //////////////////////////////////////////////////
@@ -261,7 +366,7 @@ AdvertiseBase::AdvertiseBase(const Header &_header,
                              const std::string &_topic,
                              const std::string &_addr,
                              const std::string &_ctrl,
-                             const std::string &_nUuid,
+                             const Uuid &_nUuid,
                              const Scope &_scope)
 {
   this->SetHeader(_header);
@@ -297,7 +402,7 @@ std::string AdvertiseBase::GetControlAddress() const
 }
 
 //////////////////////////////////////////////////
-std::string AdvertiseBase::GetNodeUuid() const
+Uuid AdvertiseBase::GetNodeUuid() const
 {
   return this->nUuid;
 }
@@ -333,7 +438,7 @@ void AdvertiseBase::SetControlAddress(const std::string &_ctrl)
 }
 
 //////////////////////////////////////////////////
-void AdvertiseBase::SetNodeUuid(const std::string &_nUuid)
+void AdvertiseBase::SetNodeUuid(const Uuid &_nUuid)
 {
   this->nUuid = _nUuid;
 }
@@ -351,7 +456,7 @@ size_t AdvertiseBase::GetMsgLength()
          sizeof(uint64_t) + this->topic.size() +
          sizeof(uint64_t) + this->addr.size() +
          sizeof(uint64_t) + this->ctrl.size() +
-         sizeof(uint64_t) + this->nUuid.size() +
+         Uuid::Size +
          sizeof(uint8_t);
 }
 
@@ -363,7 +468,7 @@ size_t AdvertiseBase::Pack(char *_buffer)
   if (headerLen == 0)
     return 0;
 
-  if ((this->topic == "") || (this->addr == "") || (this->nUuid == ""))
+  if ((this->topic == "") || (this->addr == ""))
   {
     std::cerr << "AdvertiseBase::Pack() error: You're trying to pack an "
               << "incomplete msg body:" << std::endl << *this;
@@ -399,14 +504,9 @@ size_t AdvertiseBase::Pack(char *_buffer)
   memcpy(_buffer, this->ctrl.data(), static_cast<size_t>(ctrlLength));
   _buffer += ctrlLength;
 
-  // Pack the node UUID length.
-  uint64_t nUuidLength = this->nUuid.size();
-  memcpy(_buffer, &nUuidLength, sizeof(nUuidLength));
-  _buffer += sizeof(nUuidLength);
-
   // Pack the node UUID.
-  memcpy(_buffer, this->nUuid.data(), static_cast<size_t>(nUuidLength));
-  _buffer += nUuidLength;
+  memcpy(_buffer, this->nUuid.Data(), Uuid::Size);
+  _buffer += Uuid::Size;
 
   // Pack the topic scope.
   uint8_t intscope = static_cast<uint8_t>(this->scope);
@@ -453,14 +553,9 @@ size_t AdvertiseBase::UnpackBody(char *_buffer)
   this->ctrl = std::string(_buffer, _buffer + ctrlLength);
   _buffer += ctrlLength;
 
-  // Unpack the node UUID length.
-  uint64_t nUuidLength;
-  memcpy(&nUuidLength, _buffer, sizeof(nUuidLength));
-  _buffer += sizeof(nUuidLength);
-
   // Unpack the node UUID.
-  this->nUuid = std::string(_buffer, _buffer + nUuidLength);
-  _buffer += nUuidLength;
+  this->nUuid.FromBytes(_buffer, Uuid::Size);
+  _buffer += Uuid::Size;
 
   // Unpack the topic scope.
   uint8_t intscope;
@@ -470,8 +565,7 @@ size_t AdvertiseBase::UnpackBody(char *_buffer)
   return sizeof(topicLength) + static_cast<size_t>(topicLength) +
          sizeof(addrLength) + static_cast<size_t>(addrLength) +
          sizeof(ctrlLength) + static_cast<size_t>(ctrlLength) +
-         sizeof(nUuidLength) + static_cast<size_t>(nUuidLength) +
-         sizeof(intscope);
+         Uuid::Size + sizeof(intscope);
 }
 
 //////////////////////////////////////////////////
@@ -479,7 +573,7 @@ AdvertiseMsg::AdvertiseMsg(const Header &_header,
                            const std::string &_topic,
                            const std::string &_addr,
                            const std::string &_ctrl,
-                           const std::string &_nUuid,
+                           const Uuid &_nUuid,
                            const Scope &_scope,
                            const std::string &_msgTypeName)
   : AdvertiseBase(_header, _topic, _addr, _ctrl, _nUuid, _scope)
@@ -561,7 +655,7 @@ AdvertiseSrv::AdvertiseSrv(const Header &_header,
                            const std::string &_topic,
                            const std::string &_addr,
                            const std::string &_ctrl,
-                           const std::string &_nUuid,
+                           const Uuid &_nUuid,
                            const Scope &_scope,
                            const std::string &_reqTypeName,
                            const std::string &_repTypeName)
@@ -16,7 +16,9 @@
 */
 
 #include <limits.h>
+#include <cstring>
 #include <iostream>
+#include <limits>
 #include <string>
 #include <vector>
 #include "ignition/transport/Packet.hh"
@@ -24,11 +26,22 @@
 
 using namespace ignition;
 
+//////////////////////////////////////////////////
+/// \brief Get a UUID from its string representation.
+/// \param[in] _str UUID in the format of Uuid::ToString().
+/// \return The UUID.
+transport::Uuid makeUuid(const std::string &_str)
+{
+  transport::Uuid uuid;
+  EXPECT_TRUE(uuid.FromString(_str));
+  return uuid;
+}
+
 //////////////////////////////////////////////////
 /// \brief Check the getters and setters.
 TEST(PacketTest, BasicHeaderAPI)
 {
-  std::string pUuid = "Process-UUID-1";
+  transport::Uuid pUuid = makeUuid("01234567-89ab-cdef-0123-456789abcdef");
   uint8_t version   = 1;
   transport::Header header(version, pUuid, transport::AdvType);
 
@@ -38,21 +51,26 @@ TEST(PacketTest, BasicHeaderAPI)
   EXPECT_EQ(header.GetType(), transport::AdvType);
   EXPECT_EQ(header.GetFlags(), 0);
   int headerLength = sizeof(header.GetVersion()) +
-    sizeof(uint64_t) + header.GetPUuid().size() +
-    sizeof(header.GetType()) + sizeof(header.GetFlags());
+    transport::Uuid::Size +
+    sizeof(header.GetType()) + sizeof(header.GetFlags()) +
+    sizeof(header.GetPartitionHash());
   EXPECT_EQ(header.GetHeaderLength(), headerLength);
 
   // Check Header setters.
-  pUuid = "Different-process-UUID-1";
+  pUuid = makeUuid("fedcba98-7654-3210-fedc-ba9876543210");
   header.SetPUuid(pUuid);
   EXPECT_EQ(header.GetPUuid(), pUuid);
   header.SetType(transport::SubType);
   EXPECT_EQ(header.GetType(), transport::SubType);
   header.SetFlags(1);
   EXPECT_EQ(header.GetFlags(), 1);
+  EXPECT_EQ(header.GetPartitionHash(), 0u);
+  header.SetPartitionHash(1234u);
+  EXPECT_EQ(header.GetPartitionHash(), 1234u);
   headerLength = sizeof(header.GetVersion()) +
-    sizeof(uint64_t) + header.GetPUuid().size() +
-    sizeof(header.GetType()) + sizeof(header.GetFlags());
+    transport::Uuid::Size +
+    sizeof(header.GetType()) + sizeof(header.GetFlags()) +
+    sizeof(header.GetPartitionHash());
   EXPECT_EQ(header.GetHeaderLength(), headerLength);
 
   // Check << operator
@@ -62,7 +80,7 @@ TEST(PacketTest, BasicHeaderAPI)
     "--------------------------------------\n"
     "Header:\n"
     "\tVersion: 1\n"
-    "\tProcess UUID: Different-process-UUID-1\n"
+    "\tProcess UUID: fedcba98-7654-3210-fedc-ba9876543210\n"
     "\tType: SUBSCRIBE\n"
     "\tFlags: 1\n";
 
@@ -73,7 +91,7 @@ TEST(PacketTest, BasicHeaderAPI)
 /// \brief Check the serialization and unserialization of a header.
 TEST(PacketTest, HeaderIO)
 {
-  std::string pUuid = "Process-UUID-1";
+  transport::Uuid pUuid = makeUuid("01234567-89ab-cdef-0123-456789abcdef");
   uint8_t version   = 1;
 
   // Try to pack an empty header.
@@ -83,6 +101,7 @@ TEST(PacketTest, HeaderIO)
 
   // Pack a Header.
   transport::Header header(version, pUuid, transport::AdvSrvType, 2);
+  header.SetPartitionHash(1234u);
 
   buffer.resize(header.GetHeaderLength());
   int bytes = header.Pack(&buffer[0]);
@@ -90,27 +109,32 @@ TEST(PacketTest, HeaderIO)
 
   // Unpack the Header.
   transport::Header otherHeader;
-  otherHeader.Unpack(&buffer[0]);
+  otherHeader.Unpack(&buffer[0], buffer.size());
 
   // Check that after Pack() and Unpack() the Header remains the same.
   EXPECT_EQ(header.GetVersion(), otherHeader.GetVersion());
   EXPECT_EQ(header.GetPUuid(), otherHeader.GetPUuid());
   EXPECT_EQ(header.GetType(), otherHeader.GetType());
   EXPECT_EQ(header.GetFlags(), otherHeader.GetFlags());
+  EXPECT_EQ(header.GetPartitionHash(), otherHeader.GetPartitionHash());
   EXPECT_EQ(header.GetHeaderLength(), otherHeader.GetHeaderLength());
 
   // Try to pack a header passing a NULL buffer.
   EXPECT_EQ(otherHeader.Pack(nullptr), 0u);
 
   // Try to unpack a header passing a NULL buffer.
-  EXPECT_EQ(otherHeader.Unpack(nullptr), 0u);
+  EXPECT_EQ(otherHeader.Unpack(nullptr, buffer.size()), 0u);
+
+  // Try to unpack a truncated header.
+  EXPECT_EQ(otherHeader.Unpack(&buffer[0], buffer.size() - 1), 0u);
+  EXPECT_EQ(otherHeader.Unpack(&buffer[0], 0), 0u);
 }
 
 //////////////////////////////////////////////////
 /// \brief Check the basic API for creating/reading an ADV message.
 TEST(PacketTest, BasicSubscriptionAPI)
 {
-  std::string pUuid = "Process-UUID-1";
+  transport::Uuid pUuid = makeUuid("01234567-89ab-cdef-0123-456789abcdef");
   uint8_t version   = 1;
 
   transport::Header otherHeader(version, pUuid, transport::SubType, 3);
@@ -137,7 +161,7 @@ TEST(PacketTest, BasicSubscriptionAPI)
     "--------------------------------------\n"
     "Header:\n"
     "\tVersion: 1\n"
-    "\tProcess UUID: Process-UUID-1\n"
+    "\tProcess UUID: 01234567-89ab-cdef-0123-456789abcdef\n"
     "\tType: SUBSCRIBE\n"
     "\tFlags: 3\n"
     "Body:\n"
@@ -150,7 +174,7 @@ TEST(PacketTest, BasicSubscriptionAPI)
 /// \brief Check the serialization and unserialization of a SUB message.
 TEST(PacketTest, SubscriptionIO)
 {
-  std::string pUuid = "Process-UUID-1";
+  transport::Uuid pUuid = makeUuid("01234567-89ab-cdef-0123-456789abcdef");
   uint8_t version   = 1;
 
   // Try to pack an empty SubscriptionMsg.
@@ -174,11 +198,12 @@ TEST(PacketTest, SubscriptionIO)
   // Unpack a SubscriptionMsg.
   transport::Header header;
   transport::SubscriptionMsg otherSubMsg;
-  int headerBytes = header.Unpack(&buffer[0]);
+  int headerBytes = header.Unpack(&buffer[0], buffer.size());
   EXPECT_EQ(headerBytes, header.GetHeaderLength());
   otherSubMsg.SetHeader(header);
   char *pBody = &buffer[0] + header.GetHeaderLength();
-  size_t bodyBytes = otherSubMsg.UnpackBody(pBody);
+  size_t bodyBytes = otherSubMsg.UnpackBody(pBody,
+    buffer.size() - header.GetHeaderLength());
 
   // Check that after Pack() and Unpack() the data does not change.
   EXPECT_EQ(otherSubMsg.GetTopic(), subMsg.GetTopic());
@@ -192,14 +217,97 @@ TEST(PacketTest, SubscriptionIO)
   EXPECT_EQ(otherSubMsg.Pack(nullptr), 0u);
 
   // Try to unpack a SubscriptionMsg passing a NULL buffer.
-  EXPECT_EQ(otherSubMsg.UnpackBody(nullptr), 0u);
+  EXPECT_EQ(otherSubMsg.UnpackBody(nullptr, 0), 0u);
+
+  // Pack a SubscriptionMsg with known answers.
+  std::vector<transport::Uuid> knownAnswers =
+  {
+    makeUuid("00000000-0000-0000-0000-000000000001"),
+    makeUuid("00000000-0000-0000-0000-000000000002")
+  };
+  subMsg.SetKnownAnswers(knownAnswers);
+  EXPECT_EQ(subMsg.GetKnownAnswers(), knownAnswers);
+  buffer.resize(subMsg.GetMsgLength());
+  bytes = subMsg.Pack(&buffer[0]);
+  EXPECT_EQ(bytes, subMsg.GetMsgLength());
+
+  // Unpack a SubscriptionMsg with known answers.
+  header.Unpack(&buffer[0], buffer.size());
+  EXPECT_TRUE((header.GetFlags() & transport::KnownAnswersFlag) != 0);
+  transport::SubscriptionMsg answersSubMsg;
+  answersSubMsg.SetHeader(header);
+  pBody = &buffer[0] + header.GetHeaderLength();
+  size_t bodyLength = buffer.size() - header.GetHeaderLength();
+  bodyBytes = answersSubMsg.UnpackBody(pBody, bodyLength);
+  EXPECT_EQ(answersSubMsg.GetTopic(), topic);
+  EXPECT_EQ(answersSubMsg.GetKnownAnswers(), knownAnswers);
+  EXPECT_EQ(bodyBytes, subMsg.GetMsgLength() - header.GetHeaderLength());
+
+  // A receiver that ignores the flag still reads the topic.
+  transport::SubscriptionMsg oldSubMsg;
+  oldSubMsg.UnpackBody(pBody, bodyLength);
+  EXPECT_EQ(oldSubMsg.GetTopic(), topic);
+  EXPECT_TRUE(oldSubMsg.GetKnownAnswers().empty());
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that a SUB message with a malformed list of known answers
+/// is rejected without reading past the end of the buffer.
+TEST(PacketTest, SubscriptionMsgMalformedKnownAnswers)
+{
+  transport::Header header(1, transport::Uuid(), transport::SubType);
+  std::string topic = "topic_test";
+  transport::SubscriptionMsg subMsg(header, topic);
+  subMsg.SetKnownAnswers({transport::Uuid(), transport::Uuid()});
+  std::vector<char> buffer(subMsg.GetMsgLength());
+  ASSERT_EQ(subMsg.Pack(&buffer[0]), buffer.size());
+
+  transport::Header otherHeader;
+  otherHeader.Unpack(&buffer[0], buffer.size());
+  size_t headerLength = otherHeader.GetHeaderLength();
+  char *pBody = &buffer[0] + headerLength;
+  size_t bodyLength = buffer.size() - headerLength;
+
+  // Every truncation of the body is detected.
+  for (size_t len = 0; len < bodyLength; ++len)
+  {
+    transport::SubscriptionMsg truncMsg;
+    truncMsg.SetHeader(otherHeader);
+    EXPECT_EQ(truncMsg.UnpackBody(pBody, len), 0u);
+    EXPECT_TRUE(truncMsg.GetKnownAnswers().empty());
+  }
+
+  // A number of known answers that would overflow the length check.
+  char *pAnswers = pBody + sizeof(uint64_t) + topic.size();
+  uint64_t numAnswers = std::numeric_limits<uint64_t>::max();
+  memcpy(pAnswers, &numAnswers, sizeof(numAnswers));
+  transport::SubscriptionMsg hugeMsg;
+  hugeMsg.SetHeader(otherHeader);
+  EXPECT_EQ(hugeMsg.UnpackBody(pBody, bodyLength), 0u);
+  EXPECT_TRUE(hugeMsg.GetKnownAnswers().empty());
+
+  // Too many known answers.
+  numAnswers = transport::MaxKnownAnswers + 1;
+  memcpy(pAnswers, &numAnswers, sizeof(numAnswers));
+  transport::SubscriptionMsg oversizedMsg;
+  oversizedMsg.SetHeader(otherHeader);
+  EXPECT_EQ(oversizedMsg.UnpackBody(pBody, bodyLength), 0u);
+  EXPECT_TRUE(oversizedMsg.GetKnownAnswers().empty());
+
+  // A list that claims the maximum number of answers but is truncated.
+  numAnswers = transport::MaxKnownAnswers;
+  memcpy(pAnswers, &numAnswers, sizeof(numAnswers));
+  transport::SubscriptionMsg shortMsg;
+  shortMsg.SetHeader(otherHeader);
+  EXPECT_EQ(shortMsg.UnpackBody(pBody, bodyLength), 0u);
+  EXPECT_TRUE(shortMsg.GetKnownAnswers().empty());
 }
 
 //////////////////////////////////////////////////
 /// \brief Check the basic API for creating/reading an ADV message.
 TEST(PacketTest, BasicAdvertiseMsgAPI)
 {
-  std::string pUuid = "Process-UUID-1";
+  transport::Uuid pUuid = makeUuid("01234567-89ab-cdef-0123-456789abcdef");
   uint8_t version   = 1;
 
   transport::Header otherHeader(version, pUuid, transport::AdvType, 3);
@@ -207,7 +315,7 @@ TEST(PacketTest, BasicAdvertiseMsgAPI)
   std::string topic = "topic_test";
   std::string addr = "tcp://10.0.0.1:6000";
   std::string ctrl = "tcp://10.0.0.1:60011";
-  std::string nodeUuid = "nodeUUID";
+  transport::Uuid nodeUuid = makeUuid("11111111-2222-3333-4444-555555555555");
   transport::Scope scope = transport::Scope::All;
   std::string typeName = "StringMsg";
   transport::AdvertiseMsg advMsg(otherHeader, topic, addr, ctrl, nodeUuid,
@@ -219,6 +327,7 @@ TEST(PacketTest, BasicAdvertiseMsgAPI)
   EXPECT_EQ(header.GetPUuid(), otherHeader.GetPUuid());
   EXPECT_EQ(header.GetType(), otherHeader.GetType());
   EXPECT_EQ(header.GetFlags(), otherHeader.GetFlags());
+  EXPECT_EQ(header.GetPartitionHash(), otherHeader.GetPartitionHash());
   EXPECT_EQ(header.GetHeaderLength(), otherHeader.GetHeaderLength());
 
   EXPECT_EQ(advMsg.GetTopic(), topic);
@@ -232,12 +341,12 @@ TEST(PacketTest, BasicAdvertiseMsgAPI)
     sizeof(uint64_t) + topic.size() +
     sizeof(uint64_t) + addr.size() +
     sizeof(uint64_t) + ctrl.size() +
-    sizeof(uint64_t) + nodeUuid.size() +
+    transport::Uuid::Size +
     sizeof(uint8_t) +
     sizeof(uint64_t) + advMsg.GetMsgTypeName().size();
   EXPECT_EQ(advMsg.GetMsgLength(), msgLength);
 
-  pUuid = "Different-process-UUID-1";
+  pUuid = makeUuid("fedcba98-7654-3210-fedc-ba9876543210");
 
   // Check AdvertiseMsg setters.
   transport::Header anotherHeader(version + 1, pUuid, transport::AdvSrvType, 3);
@@ -248,14 +357,15 @@ TEST(PacketTest, BasicAdvertiseMsgAPI)
   EXPECT_EQ(header.GetType(), transport::AdvSrvType);
   EXPECT_EQ(header.GetFlags(), 3);
   int headerLength = sizeof(header.GetVersion()) +
-    sizeof(uint64_t) + header.GetPUuid().size() +
-    sizeof(header.GetType()) + sizeof(header.GetFlags());
+    transport::Uuid::Size +
+    sizeof(header.GetType()) + sizeof(header.GetFlags()) +
+    sizeof(header.GetPartitionHash());
   EXPECT_EQ(header.GetHeaderLength(), headerLength);
 
   topic = "a_new_topic_test";
   addr = "inproc://local";
   ctrl = "inproc://control";
-  nodeUuid = "nodeUUID2";
+  nodeUuid = makeUuid("66666666-7777-8888-9999-aaaaaaaaaaaa");
   scope = transport::Scope::Host;
   typeName = "Int";
   advMsg.SetTopic(topic);
@@ -278,14 +388,14 @@ TEST(PacketTest, BasicAdvertiseMsgAPI)
     "--------------------------------------\n"
     "Header:\n"
     "\tVersion: 2\n"
-    "\tProcess UUID: Different-process-UUID-1\n"
+    "\tProcess UUID: fedcba98-7654-3210-fedc-ba9876543210\n"
     "\tType: ADV_SRV\n"
     "\tFlags: 3\n"
     "Body:\n"
     "\tTopic: [a_new_topic_test]\n"
     "\tAddress: inproc://local\n"
     "\tControl address: inproc://control\n"
-    "\tNode UUID: nodeUUID2\n"
+    "\tNode UUID: 66666666-7777-8888-9999-aaaaaaaaaaaa\n"
     "\tTopic Scope: Host\n"
     "\tMessage type: Int\n";
 
@@ -298,14 +408,14 @@ TEST(PacketTest, BasicAdvertiseMsgAPI)
     "--------------------------------------\n"
     "Header:\n"
     "\tVersion: 2\n"
-    "\tProcess UUID: Different-process-UUID-1\n"
+    "\tProcess UUID: fedcba98-7654-3210-fedc-ba9876543210\n"
     "\tType: ADV_SRV\n"
     "\tFlags: 3\n"
     "Body:\n"
     "\tTopic: [a_new_topic_test]\n"
     "\tAddress: inproc://local\n"
     "\tControl address: inproc://control\n"
-    "\tNode UUID: nodeUUID2\n"
+    "\tNode UUID: 66666666-7777-8888-9999-aaaaaaaaaaaa\n"
     "\tTopic Scope: Process\n"
     "\tMessage type: Int\n";
 
@@ -319,14 +429,14 @@ TEST(PacketTest, BasicAdvertiseMsgAPI)
     "--------------------------------------\n"
     "Header:\n"
     "\tVersion: 2\n"
-    "\tProcess UUID: Different-process-UUID-1\n"
+    "\tProcess UUID: fedcba98-7654-3210-fedc-ba9876543210\n"
     "\tType: ADV_SRV\n"
     "\tFlags: 3\n"
     "Body:\n"
     "\tTopic: [a_new_topic_test]\n"
     "\tAddress: inproc://local\n"
     "\tControl address: inproc://control\n"
-    "\tNode UUID: nodeUUID2\n"
+    "\tNode UUID: 66666666-7777-8888-9999-aaaaaaaaaaaa\n"
     "\tTopic Scope: All\n"
     "\tMessage type: Int\n";
 
@@ -337,12 +447,12 @@ TEST(PacketTest, BasicAdvertiseMsgAPI)
 /// \brief Check the serialization and unserialization of an ADV message.
 TEST(PacketTest, AdvertiseMsgIO)
 {
-  std::string pUuid = "Process-UUID-1";
+  transport::Uuid pUuid = makeUuid("01234567-89ab-cdef-0123-456789abcdef");
   uint8_t version   = 1;
   std::string topic = "topic_test";
   std::string addr = "tcp://10.0.0.1:6000";
   std::string ctrl = "tcp://10.0.0.1:60011";
-  std::string nodeUuid = "nodeUUID";
+  transport::Uuid nodeUuid = makeUuid("11111111-2222-3333-4444-555555555555");
   transport::Scope scope = transport::Scope::Host;
   std::string typeName = "StringMsg";
 
@@ -364,12 +474,6 @@ TEST(PacketTest, AdvertiseMsgIO)
   buffer.resize(noAddrMsg.GetMsgLength());
   EXPECT_EQ(0u, noAddrMsg.Pack(&buffer[0]));
 
-  // Try to pack an incomplete AdvMsg (empty node UUID).
-  transport::AdvertiseMsg noNodeUuidMsg(otherHeader, topic, addr, ctrl, "",
-    scope, typeName);
-  buffer.resize(noNodeUuidMsg.GetMsgLength());
-  EXPECT_EQ(0u, noNodeUuidMsg.Pack(&buffer[0]));
-
   // Try to pack an incomplete AdvMsg (empty message type name).
   transport::AdvertiseMsg noTypeMsg(otherHeader, topic, addr, ctrl, nodeUuid,
     scope, "");
@@ -386,7 +490,7 @@ TEST(PacketTest, AdvertiseMsgIO)
   // Unpack an AdvertiseMsg.
   transport::Header header;
   transport::AdvertiseMsg otherAdvMsg;
-  int headerBytes = header.Unpack(&buffer[0]);
+  int headerBytes = header.Unpack(&buffer[0], buffer.size());
   EXPECT_EQ(headerBytes, header.GetHeaderLength());
   otherAdvMsg.SetHeader(header);
   char *pBody = &buffer[0] + header.GetHeaderLength();
@@ -417,7 +521,7 @@ TEST(PacketTest, AdvertiseMsgIO)
 /// \brief Check the basic API for creating/reading an ADV SRV message.
 TEST(PacketTest, BasicAdvertiseSrvAPI)
 {
-  std::string pUuid = "Process-UUID-1";
+  transport::Uuid pUuid = makeUuid("01234567-89ab-cdef-0123-456789abcdef");
   uint8_t version   = 1;
 
   transport::Header otherHeader(version, pUuid, transport::AdvType, 3);
@@ -425,7 +529,7 @@ TEST(PacketTest, BasicAdvertiseSrvAPI)
   std::string topic = "topic_test";
   std::string addr = "tcp://10.0.0.1:6000";
   std::string ctrl = "tcp://10.0.0.1:60011";
-  std::string nodeUuid = "nodeUUID";
+  transport::Uuid nodeUuid = makeUuid("11111111-2222-3333-4444-555555555555");
   transport::Scope scope = transport::Scope::All;
   std::string reqType = "StringMsg";
   std::string repType = "Int";
@@ -438,6 +542,7 @@ TEST(PacketTest, BasicAdvertiseSrvAPI)
   EXPECT_EQ(header.GetPUuid(), otherHeader.GetPUuid());
   EXPECT_EQ(header.GetType(), otherHeader.GetType());
   EXPECT_EQ(header.GetFlags(), otherHeader.GetFlags());
+  EXPECT_EQ(header.GetPartitionHash(), otherHeader.GetPartitionHash());
   EXPECT_EQ(header.GetHeaderLength(), otherHeader.GetHeaderLength());
 
   EXPECT_EQ(advSrv.GetTopic(), topic);
@@ -452,13 +557,13 @@ TEST(PacketTest, BasicAdvertiseSrvAPI)
     sizeof(uint64_t) + topic.size() +
     sizeof(uint64_t) + addr.size() +
     sizeof(uint64_t) + ctrl.size() +
-    sizeof(uint64_t) + nodeUuid.size() +
+    transport::Uuid::Size +
     sizeof(uint8_t) +
     sizeof(uint64_t) + advSrv.GetReqTypeName().size() +
     sizeof(uint64_t) + advSrv.GetRepTypeName().size();
   EXPECT_EQ(advSrv.GetMsgLength(), msgLength);
 
-  pUuid = "Different-process-UUID-1";
+  pUuid = makeUuid("fedcba98-7654-3210-fedc-ba9876543210");
 
   // Check AdvertiseSrv setters.
   transport::Header anotherHeader(version + 1, pUuid, transport::AdvSrvType, 3);
@@ -469,14 +574,15 @@ TEST(PacketTest, BasicAdvertiseSrvAPI)
   EXPECT_EQ(header.GetType(), transport::AdvSrvType);
   EXPECT_EQ(header.GetFlags(), 3);
   int headerLength = sizeof(header.GetVersion()) +
-    sizeof(uint64_t) + header.GetPUuid().size() +
-    sizeof(header.GetType()) + sizeof(header.GetFlags());
+    transport::Uuid::Size +
+    sizeof(header.GetType()) + sizeof(header.GetFlags()) +
+    sizeof(header.GetPartitionHash());
   EXPECT_EQ(header.GetHeaderLength(), headerLength);
 
   topic = "a_new_topic_test";
   addr = "inproc://local";
   ctrl = "inproc://control";
-  nodeUuid = "nodeUUID2";
+  nodeUuid = makeUuid("66666666-7777-8888-9999-aaaaaaaaaaaa");
   scope = transport::Scope::Host;
   reqType = "Type1";
   repType = "Type2";
@@ -502,14 +608,14 @@ TEST(PacketTest, BasicAdvertiseSrvAPI)
     "--------------------------------------\n"
     "Header:\n"
     "\tVersion: 2\n"
-    "\tProcess UUID: Different-process-UUID-1\n"
+    "\tProcess UUID: fedcba98-7654-3210-fedc-ba9876543210\n"
     "\tType: ADV_SRV\n"
     "\tFlags: 3\n"
     "Body:\n"
     "\tTopic: [a_new_topic_test]\n"
     "\tAddress: inproc://local\n"
     "\tControl address: inproc://control\n"
-    "\tNode UUID: nodeUUID2\n"
+    "\tNode UUID: 66666666-7777-8888-9999-aaaaaaaaaaaa\n"
     "\tTopic Scope: Host\n"
     "\tRequest type: Type1\n"
     "\tResponse type: Type2\n";
@@ -521,12 +627,12 @@ TEST(PacketTest, BasicAdvertiseSrvAPI)
 /// \brief Check the serialization and unserialization of an ADV SRV message.
 TEST(PacketTest, AdvertiseSrvIO)
 {
-  std::string pUuid = "Process-UUID-1";
+  transport::Uuid pUuid = makeUuid("01234567-89ab-cdef-0123-456789abcdef");
   uint8_t version   = 1;
   std::string topic = "topic_test";
   std::string addr = "tcp://10.0.0.1:6000";
   std::string ctrl = "tcp://10.0.0.1:60011";
-  std::string nodeUuid = "nodeUUID";
+  transport::Uuid nodeUuid = makeUuid("11111111-2222-3333-4444-555555555555");
   transport::Scope scope = transport::Scope::Host;
   std::string reqType = "StringMsg";
   std::string repType = "Int";
@@ -559,7 +665,7 @@ TEST(PacketTest, AdvertiseSrvIO)
   // Unpack an AdvertiseSrv.
   transport::Header header;
   transport::AdvertiseSrv otherAdvSrv;
-  int headerBytes = header.Unpack(&buffer[0]);
+  int headerBytes = header.Unpack(&buffer[0], buffer.size());
   EXPECT_EQ(headerBytes, header.GetHeaderLength());
   otherAdvSrv.SetHeader(header);
   char *pBody = &buffer[0] + header.GetHeaderLength();
@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2015 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "ignition/transport/Log.hh"
+#include "ignition/transport/Node.hh"
+#include "ignition/transport/Pacer.hh"
+#include "ignition/transport/Player.hh"
+
+using namespace ignition;
+using namespace transport;
+
+//////////////////////////////////////////////////
+Player::Player()
+  : node(new Node()),
+    stop(false)
+{
+}
+
+//////////////////////////////////////////////////
+Player::Player(const std::string &_partition)
+  : node(new Node(_partition, "")),
+    stop(false)
+{
+}
+
+//////////////////////////////////////////////////
+Player::~Player()
+{
+  this->Stop();
+}
+
+//////////////////////////////////////////////////
+bool Player::Open(const std::string &_dir)
+{
+  for (auto const &topic : this->node->AdvertisedTopics())
+    this->node->Unadvertise(topic);
+
+  if (!this->reader.Open(_dir))
+    return false;
+
+  for (auto const &topic : this->reader.GetTopics())
+  {
+    if (!this->node->Advertise(topic.topic))
+    {
+      std::cerr << "Player::Open() error: Unable to advertise ["
+                << topic.topic << "]" << std::endl;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool Player::Play(const double _rate)
+{
+  if (!this->reader.IsOpen())
+  {
+    std::cerr << "Player::Play() error: No log opened" << std::endl;
+    return false;
+  }
+
+  this->stop = false;
+  this->messages = 0;
+  this->bytes = 0;
+  this->requestedDuration = 0;
+  this->duration = 0;
+  this->totalError = 0;
+  this->maxError = 0;
+
+  this->reader.Rewind();
+
+  LogRecord record;
+  uint64_t firstTime = 0;
+  auto start = std::chrono::steady_clock::now();
+  bool done = true;
+  while (this->reader.Next(record))
+  {
+    if (this->messages == 0)
+    {
+      firstTime = record.time;
+      start = std::chrono::steady_clock::now();
+    }
+
+    if (_rate > 0)
+    {
+      uint64_t offset = static_cast<uint64_t>(
+        (record.time - std::min(firstTime, record.time)) / _rate);
+      auto target = start + std::chrono::nanoseconds(offset);
+      this->requestedDuration = std::max(this->requestedDuration, offset);
+
+      uint64_t error = Pacer::WaitUntil(target, this->stop);
+      this->totalError += error;
+      this->maxError = std::max(this->maxError, error);
+    }
+
+    if (this->stop)
+    {
+      done = false;
+      break;
+    }
+
+    this->node->PublishRaw(record.topic, record.data, record.size,
+      record.type);
+    ++this->messages;
+    this->bytes += record.size;
+  }
+
+  this->duration = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now() - start).count();
+  return done;
+}
+
+//////////////////////////////////////////////////
+void Player::Stop()
+{
+  this->stop = true;
+}
+
+//////////////////////////////////////////////////
+const LogReader &Player::GetLog() const
+{
+  return this->reader;
+}
+
+//////////////////////////////////////////////////
+uint64_t Player::GetMessages() const
+{
+  return this->messages;
+}
+
+//////////////////////////////////////////////////
+uint64_t Player::GetBytes() const
+{
+  return this->bytes;
+}
+
+//////////////////////////////////////////////////
+uint64_t Player::GetRequestedDuration() const
+{
+  return this->requestedDuration;
+}
+
+//////////////////////////////////////////////////
+uint64_t Player::GetDuration() const
+{
+  return this->duration;
+}
+
+//////////////////////////////////////////////////
+uint64_t Player::GetMeanError() const
+{
+  if (this->messages == 0)
+    return 0;
+  return this->totalError / this->messages;
+}
+
+//////////////////////////////////////////////////
+uint64_t Player::GetMaxError() const
+{
+  return this->maxError;
+}
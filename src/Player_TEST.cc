@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2015 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "ignition/transport/Log.hh"
+#include "ignition/transport/Node.hh"
+#include "ignition/transport/Player.hh"
+#include "gtest/gtest.h"
+#include "ignition/transport/test_config.h"
+#include "msg/int.pb.h"
+
+using namespace ignition;
+
+/// \brief Data received by the subscriber.
+std::vector<int> received;
+
+//////////////////////////////////////////////////
+/// \brief Subscription callback.
+/// \param[in] _topic Topic name.
+/// \param[in] _msg Message received.
+void cb(const std::string &/*_topic*/, const transport::msgs::Int &_msg)
+{
+  received.push_back(_msg.data());
+}
+
+//////////////////////////////////////////////////
+/// \brief Play a log in the same process, scaled and as fast as possible.
+TEST(PlayerTest, PlayLog)
+{
+  std::string dir = testing::portablePathUnion(PROJECT_BINARY_PATH,
+    "test_player_" + testing::getRandomPartition());
+  std::string topic = "/played";
+  std::string type = "ignition.transport.msgs.Int";
+
+  // One message every 10 ms.
+  transport::LogWriter writer;
+  ASSERT_TRUE(writer.Open(dir));
+  for (int i = 0; i < 10; ++i)
+  {
+    transport::msgs::Int msg;
+    msg.set_data(i);
+    std::string data;
+    ASSERT_TRUE(msg.SerializeToString(&data));
+    EXPECT_TRUE(writer.Write(topic, type, data.data(), data.size(),
+      1000000000u + i * 10000000u));
+  }
+  writer.Close();
+
+  transport::Player player;
+  EXPECT_FALSE(player.Play());
+  ASSERT_TRUE(player.Open(dir));
+  EXPECT_EQ(player.GetLog().GetMessages(), 10u);
+
+  transport::Node node;
+  EXPECT_TRUE(node.Subscribe(topic, cb));
+
+  // Twice as fast: 45 ms.
+  EXPECT_TRUE(player.Play(2.0));
+  ASSERT_EQ(received.size(), 10u);
+  for (int i = 0; i < 10; ++i)
+    EXPECT_EQ(received[i], i);
+  EXPECT_EQ(player.GetMessages(), 10u);
+  EXPECT_GT(player.GetBytes(), 0u);
+  EXPECT_EQ(player.GetRequestedDuration(), 45000000u);
+  EXPECT_GE(player.GetDuration(), player.GetRequestedDuration());
+  EXPECT_LE(player.GetMeanError(), player.GetMaxError());
+  EXPECT_LT(player.GetMaxError(), 20000000u);
+
+  // As fast as possible.
+  received.clear();
+  EXPECT_TRUE(player.Play(0));
+  EXPECT_EQ(received.size(), 10u);
+  EXPECT_EQ(player.GetRequestedDuration(), 0u);
+  EXPECT_EQ(player.GetMaxError(), 0u);
+
+  std::remove(transport::LogWriter::SegmentPath(dir, 0, false).c_str());
+  std::remove(transport::LogWriter::SegmentPath(dir, 0, true).c_str());
+  std::remove(dir.c_str());
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,33 @@
+/*
+ * Copyright (C) 2015 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <string>
+#include "ignition/transport/Publisher.hh"
+
+using namespace ignition;
+using namespace transport;
+
+//////////////////////////////////////////////////
+Publication::Publication(const std::string &_topic,
+  const TopicCountersPtr &_counters, const size_t _handlersId)
+  : topic(_topic),
+    topicName(_topic.substr(_topic.find_last_of("@") + 1)),
+    topicFrame(_topic.data(), _topic.size()),
+    counters(_counters),
+    handlersId(_handlersId)
+{
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2015 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ignition/transport/MessageInfo.hh"
+#include "ignition/transport/Node.hh"
+#include "ignition/transport/Publisher.hh"
+#include "gtest/gtest.h"
+#include "ignition/transport/test_config.h"
+#include "msg/int.pb.h"
+
+using namespace ignition;
+
+std::vector<int> data;
+std::vector<uint64_t> sequences;
+
+//////////////////////////////////////////////////
+/// \brief Store the messages received.
+void cb(const std::string &/*_topic*/, const transport::msgs::Int &_msg,
+  const transport::MessageInfo &_info)
+{
+  data.push_back(_msg.data());
+  sequences.push_back(_info.GetSequence());
+}
+
+//////////////////////////////////////////////////
+/// \brief A default constructed handle cannot publish.
+TEST(PublisherTest, InvalidHandle)
+{
+  transport::Publisher<transport::msgs::Int> pub;
+  EXPECT_FALSE(pub.Valid());
+  EXPECT_FALSE(pub);
+  EXPECT_FALSE(pub.HasSubscribers());
+  EXPECT_TRUE(pub.Topic().empty());
+
+  transport::msgs::Int msg;
+  EXPECT_FALSE(pub.Publish(msg));
+
+  transport::Node node;
+  EXPECT_FALSE(node.Advertise<transport::msgs::Int>("invalid topic"));
+}
+
+//////////////////////////////////////////////////
+/// \brief Publish through a handle and check that the local subscribers
+/// receive the messages with the same sequence numbers as Node::Publish().
+TEST(PublisherTest, PubSub)
+{
+  std::string partition = testing::getRandomPartition();
+  std::string topic = "/foo";
+  data.clear();
+  sequences.clear();
+
+  transport::Node node(partition, "");
+  auto pub = node.Advertise<transport::msgs::Int>(topic);
+  ASSERT_TRUE(pub.Valid());
+  EXPECT_EQ(pub.Topic(), topic);
+  EXPECT_FALSE(pub.HasSubscribers());
+
+  EXPECT_TRUE(node.Subscribe(topic, cb));
+  EXPECT_TRUE(pub.HasSubscribers());
+
+  transport::msgs::Int msg;
+  msg.set_data(1);
+  EXPECT_TRUE(pub.Publish(msg));
+  msg.set_data(2);
+  EXPECT_TRUE(node.Publish(topic, msg));
+  msg.set_data(3);
+  EXPECT_TRUE(pub.Publish(msg));
+
+  ASSERT_EQ(data.size(), 3u);
+  EXPECT_EQ(data, std::vector<int>({1, 2, 3}));
+  EXPECT_EQ(sequences, std::vector<uint64_t>({1, 2, 3}));
+
+  // Copies share the state of the handle.
+  auto copy = pub;
+  node.Unsubscribe(topic);
+  EXPECT_FALSE(copy.HasSubscribers());
+
+  EXPECT_TRUE(node.Unadvertise(topic));
+  EXPECT_FALSE(pub.Valid());
+  EXPECT_FALSE(copy.Valid());
+  EXPECT_FALSE(pub.Publish(msg));
+  EXPECT_EQ(data.size(), 3u);
+}
+
+//////////////////////////////////////////////////
+/// \brief The handles of a node become invalid when it is destroyed.
+TEST(PublisherTest, NodeDestroyed)
+{
+  std::string partition = testing::getRandomPartition();
+  transport::Publisher<transport::msgs::Int> pub;
+  {
+    transport::Node node(partition, "");
+    pub = node.Advertise<transport::msgs::Int>("/bar");
+    EXPECT_TRUE(pub.Valid());
+  }
+  EXPECT_FALSE(pub.Valid());
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2015 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "ignition/transport/Log.hh"
+#include "ignition/transport/MessageInfo.hh"
+#include "ignition/transport/Node.hh"
+#include "ignition/transport/Recorder.hh"
+
+using namespace ignition;
+using namespace transport;
+
+const unsigned int Recorder::DiscoveryPeriod;
+
+//////////////////////////////////////////////////
+Recorder::Recorder()
+  : node(new Node())
+{
+}
+
+//////////////////////////////////////////////////
+Recorder::Recorder(const std::string &_partition)
+  : node(new Node(_partition, ""))
+{
+}
+
+//////////////////////////////////////////////////
+Recorder::~Recorder()
+{
+  this->Stop();
+}
+
+//////////////////////////////////////////////////
+bool Recorder::Start(const std::string &_dir,
+  const std::vector<std::string> &_topics, const uint64_t _segmentSize)
+{
+  if (this->recording)
+  {
+    std::cerr << "Recorder::Start() error: Already recording" << std::endl;
+    return false;
+  }
+
+  {
+    std::lock_guard<std::mutex> lk(this->writerMutex);
+    if (!this->writer.Open(_dir, _segmentSize))
+      return false;
+    this->dropped = 0;
+  }
+
+  this->recording = true;
+  this->exit = false;
+
+  if (_topics.empty())
+  {
+    this->discoveryThread = std::thread(&Recorder::RunDiscoveryTask, this);
+  }
+  else
+  {
+    for (auto const &topic : _topics)
+      this->Subscribe(topic);
+  }
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+void Recorder::Stop()
+{
+  if (!this->recording)
+    return;
+
+  {
+    std::lock_guard<std::mutex> lk(this->exitMutex);
+    this->exit = true;
+  }
+  this->exitCv.notify_all();
+  if (this->discoveryThread.joinable())
+    this->discoveryThread.join();
+
+  // No callbacks are executed after unsubscribing.
+  {
+    std::lock_guard<std::mutex> lk(this->topicsMutex);
+    for (auto const &topic : this->topics)
+      this->node->Unsubscribe(topic);
+    this->topics.clear();
+  }
+
+  {
+    std::lock_guard<std::mutex> lk(this->writerMutex);
+    this->writer.Close();
+  }
+
+  this->recording = false;
+}
+
+//////////////////////////////////////////////////
+bool Recorder::IsRecording() const
+{
+  return this->recording;
+}
+
+//////////////////////////////////////////////////
+std::vector<std::string> Recorder::GetTopics() const
+{
+  std::lock_guard<std::mutex> lk(this->topicsMutex);
+  return std::vector<std::string>(this->topics.begin(), this->topics.end());
+}
+
+//////////////////////////////////////////////////
+uint64_t Recorder::GetMessages() const
+{
+  std::lock_guard<std::mutex> lk(this->writerMutex);
+  return this->writer.GetMessages();
+}
+
+//////////////////////////////////////////////////
+uint64_t Recorder::GetBytes() const
+{
+  std::lock_guard<std::mutex> lk(this->writerMutex);
+  return this->writer.GetBytes();
+}
+
+//////////////////////////////////////////////////
+uint64_t Recorder::GetDropped() const
+{
+  std::lock_guard<std::mutex> lk(this->writerMutex);
+  return this->dropped;
+}
+
+//////////////////////////////////////////////////
+void Recorder::Subscribe(const std::string &_topic)
+{
+  {
+    std::lock_guard<std::mutex> lk(this->topicsMutex);
+    if (this->topics.find(_topic) != this->topics.end())
+      return;
+    this->topics.insert(_topic);
+  }
+
+  // Do not hold a recorder lock here: the subscription takes the transport
+  // locks, which are also held while executing OnMessage().
+  if (!this->node->SubscribeRaw(_topic, std::bind(&Recorder::OnMessage, this,
+        std::placeholders::_1, std::placeholders::_2, std::placeholders::_3,
+        std::placeholders::_4)))
+  {
+    std::lock_guard<std::mutex> lk(this->topicsMutex);
+    this->topics.erase(_topic);
+  }
+}
+
+//////////////////////////////////////////////////
+void Recorder::OnMessage(const std::string &_topic, const char *_data,
+  const size_t _size, const MessageInfo &_info)
+{
+  uint64_t now = LogWriter::Now();
+
+  std::lock_guard<std::mutex> lk(this->writerMutex);
+  if (!this->writer.Write(_topic, _info.GetType(), _data, _size, now))
+    ++this->dropped;
+}
+
+//////////////////////////////////////////////////
+void Recorder::RunDiscoveryTask()
+{
+  std::unique_lock<std::mutex> lk(this->exitMutex);
+  while (!this->exit)
+  {
+    lk.unlock();
+    std::vector<std::string> advertised;
+    this->node->GetTopicList(advertised);
+    for (auto const &topic : advertised)
+      this->Subscribe(topic);
+    lk.lock();
+
+    this->exitCv.wait_for(lk, std::chrono::milliseconds(DiscoveryPeriod),
+      [this]{return this->exit;});
+  }
+}
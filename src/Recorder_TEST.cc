@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2015 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "ignition/transport/Log.hh"
+#include "ignition/transport/Node.hh"
+#include "ignition/transport/Recorder.hh"
+#include "gtest/gtest.h"
+#include "ignition/transport/test_config.h"
+#include "msg/int.pb.h"
+
+using namespace ignition;
+
+//////////////////////////////////////////////////
+/// \brief Record the messages of a topic published in the same process.
+TEST(RecorderTest, RecordTopic)
+{
+  std::string dir = testing::portablePathUnion(PROJECT_BINARY_PATH,
+    "test_recorder_" + testing::getRandomPartition());
+  std::string topic = "/recorded";
+  transport::msgs::Int msg;
+  msg.set_data(5);
+
+  transport::Node node;
+  EXPECT_TRUE(node.Advertise(topic));
+
+  transport::Recorder recorder;
+  EXPECT_FALSE(recorder.IsRecording());
+  ASSERT_TRUE(recorder.Start(dir, {topic}));
+  EXPECT_TRUE(recorder.IsRecording());
+  EXPECT_FALSE(recorder.Start(dir, {topic}));
+
+  std::vector<std::string> topics = recorder.GetTopics();
+  ASSERT_EQ(topics.size(), 1u);
+  EXPECT_EQ(topics[0], topic);
+
+  for (int i = 0; i < 10; ++i)
+    EXPECT_TRUE(node.Publish(topic, msg));
+
+  EXPECT_EQ(recorder.GetMessages(), 10u);
+#if GOOGLE_PROTOBUF_VERSION >= 3004000
+  size_t msgSize = msg.ByteSizeLong();
+#else
+  size_t msgSize = msg.ByteSize();
+#endif
+  EXPECT_GT(recorder.GetBytes(), 10u * msgSize);
+  EXPECT_EQ(recorder.GetDropped(), 0u);
+
+  recorder.Stop();
+  EXPECT_FALSE(recorder.IsRecording());
+  EXPECT_TRUE(recorder.GetTopics().empty());
+
+  // Nothing is recorded after stopping.
+  EXPECT_TRUE(node.Publish(topic, msg));
+  EXPECT_EQ(recorder.GetMessages(), 10u);
+
+  std::remove(transport::LogWriter::SegmentPath(dir, 0, false).c_str());
+  std::remove(transport::LogWriter::SegmentPath(dir, 0, true).c_str());
+  std::remove(dir.c_str());
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
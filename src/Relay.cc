@@ -0,0 +1,210 @@
+/*
+ * Copyright (C) 2015 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "ignition/transport/MessageInfo.hh"
+#include "ignition/transport/Node.hh"
+#include "ignition/transport/NodeShared.hh"
+#include "ignition/transport/Relay.hh"
+#include "ignition/transport/TopicUtils.hh"
+#include "ignition/transport/Uuid.hh"
+
+using namespace ignition;
+using namespace transport;
+
+//////////////////////////////////////////////////
+Relay::Relay()
+  : node(new Node()),
+    shared(NodeShared::GetInstance()),
+    nUuid(Uuid().ToString())
+{
+}
+
+//////////////////////////////////////////////////
+Relay::Relay(const std::string &_partition)
+  : node(new Node(_partition, "")),
+    shared(NodeShared::GetInstance()),
+    nUuid(Uuid().ToString())
+{
+}
+
+//////////////////////////////////////////////////
+Relay::~Relay()
+{
+  this->Stop();
+}
+
+//////////////////////////////////////////////////
+bool Relay::Start(const std::vector<std::string> &_topics)
+{
+  if (this->running)
+  {
+    std::cerr << "Relay::Start() error: Already running" << std::endl;
+    return false;
+  }
+
+  std::map<std::string, std::string> fullyQualified;
+  for (auto const &topic : _topics)
+  {
+    std::string fullyQualifiedTopic;
+    if (!TopicUtils::GetFullyQualifiedName(this->node->Partition(), "",
+      topic, fullyQualifiedTopic))
+    {
+      std::cerr << "Topic [" << topic << "] is not valid." << std::endl;
+      return false;
+    }
+    std::string name = fullyQualifiedTopic;
+    name.erase(0, name.find_last_of("@") + 1);
+    fullyQualified[name] = fullyQualifiedTopic;
+  }
+
+  {
+    std::lock_guard<std::recursive_mutex> discLk(
+      this->shared->discovery->GetMutex());
+    std::lock_guard<std::recursive_mutex> lk(this->shared->mutex);
+
+    this->topics = fullyQualified;
+    this->messages = 0;
+    this->bytes = 0;
+
+    // Advertise first, so the subscriptions below know that this process
+    // relays the topics and connect to the original publishers.
+    for (auto const &topic : this->topics)
+    {
+      this->shared->discovery->Advertise(MsgType::Msg, topic.second,
+        this->shared->myAddress, this->shared->myControlAddress,
+        this->nUuid, Scope::All, true);
+      ++this->shared->advertisedTopics[topic.second];
+    }
+  }
+  this->running = true;
+
+  for (auto const &topic : this->topics)
+  {
+    if (!this->node->SubscribeRaw(topic.first, std::bind(&Relay::OnMessage,
+          this, std::placeholders::_1, std::placeholders::_2,
+          std::placeholders::_3, std::placeholders::_4)))
+    {
+      this->Stop();
+      return false;
+    }
+  }
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+void Relay::Stop()
+{
+  if (!this->running)
+    return;
+
+  // No callbacks are executed after unsubscribing.
+  for (auto const &topic : this->topics)
+    this->node->Unsubscribe(topic.first);
+
+  {
+    std::lock_guard<std::recursive_mutex> discLk(
+      this->shared->discovery->GetMutex());
+    std::lock_guard<std::recursive_mutex> lk(this->shared->mutex);
+
+    for (auto const &topic : this->topics)
+    {
+      this->shared->discovery->Unadvertise(MsgType::Msg, topic.second,
+        this->nUuid);
+      if (--this->shared->advertisedTopics[topic.second] == 0)
+        this->shared->advertisedTopics.erase(topic.second);
+    }
+    this->topics.clear();
+  }
+
+  this->running = false;
+}
+
+//////////////////////////////////////////////////
+bool Relay::IsRunning() const
+{
+  return this->running;
+}
+
+//////////////////////////////////////////////////
+std::vector<std::string> Relay::GetTopics() const
+{
+  std::lock_guard<std::recursive_mutex> lk(this->shared->mutex);
+  std::vector<std::string> v;
+  for (auto const &topic : this->topics)
+    v.push_back(topic.first);
+  return v;
+}
+
+//////////////////////////////////////////////////
+uint64_t Relay::GetMessages() const
+{
+  std::lock_guard<std::recursive_mutex> lk(this->shared->mutex);
+  return this->messages;
+}
+
+//////////////////////////////////////////////////
+uint64_t Relay::GetBytes() const
+{
+  std::lock_guard<std::recursive_mutex> lk(this->shared->mutex);
+  return this->bytes;
+}
+
+//////////////////////////////////////////////////
+void Relay::OnMessage(const std::string &_topic, const char *_data,
+  const size_t _size, const MessageInfo &_info)
+{
+  // The publishers of this process already send their messages through the
+  // same socket.
+  if (_info.GetPublisherAddress().empty() ||
+      _info.GetPublisherAddress() == this->shared->myAddress)
+  {
+    return;
+  }
+
+  std::lock_guard<std::recursive_mutex> lk(this->shared->mutex);
+
+  auto topic = this->topics.find(_topic);
+  if (topic == this->topics.end() ||
+      !this->shared->remoteSubscribers.HasTopic(topic->second))
+  {
+    return;
+  }
+
+  // The relay has its own sequence numbers, so the subscribers can detect
+  // the messages lost between the relay and them, but the send time is the
+  // one of the original publisher.
+  MessageInfo info = _info;
+  info.SetMetadata(++this->shared->GetPublication(topic->second)->sequence,
+    _info.GetSendTime());
+
+  auto counters = this->shared->stats.Topic(topic->second);
+  if (!this->shared->Publish(topic->second, _data, _size, info))
+  {
+    counters->AddDropped();
+    return;
+  }
+  counters->AddPublished(_size, 0);
+
+  ++this->messages;
+  this->bytes += _size;
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2015 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <string>
+#include <vector>
+#include "ignition/transport/Node.hh"
+#include "ignition/transport/NodeShared.hh"
+#include "ignition/transport/Relay.hh"
+#include "ignition/transport/TopicUtils.hh"
+#include "gtest/gtest.h"
+#include "ignition/transport/test_config.h"
+#include "msg/int.pb.h"
+
+using namespace ignition;
+
+//////////////////////////////////////////////////
+/// \brief Check that a relay advertises its topics as relayed and that it
+/// does not republish the messages of its own process.
+TEST(RelayTest, RelayTopic)
+{
+  std::string partition = testing::getRandomPartition();
+  std::string topic = "/relayed";
+  std::string fullyQualifiedTopic;
+  ASSERT_TRUE(transport::TopicUtils::GetFullyQualifiedName(partition, "",
+    topic, fullyQualifiedTopic));
+  auto discovery = transport::NodeShared::GetInstance()->discovery.get();
+
+  transport::Relay relay(partition);
+  EXPECT_FALSE(relay.IsRunning());
+  EXPECT_FALSE(relay.Start({"invalid topic"}));
+  EXPECT_FALSE(relay.IsRunning());
+
+  ASSERT_TRUE(relay.Start({topic}));
+  EXPECT_TRUE(relay.IsRunning());
+  EXPECT_FALSE(relay.Start({topic}));
+  ASSERT_EQ(relay.GetTopics().size(), 1u);
+  EXPECT_EQ(relay.GetTopics()[0], topic);
+  EXPECT_TRUE(discovery->HasRelay(fullyQualifiedTopic, true));
+  EXPECT_FALSE(discovery->HasRelay(fullyQualifiedTopic));
+
+  transport::msgs::Int msg;
+  msg.set_data(1);
+  transport::Node node(partition, "");
+  EXPECT_TRUE(node.Advertise(topic));
+  EXPECT_TRUE(node.Publish(topic, msg));
+  EXPECT_EQ(relay.GetMessages(), 0u);
+  EXPECT_EQ(relay.GetBytes(), 0u);
+
+  relay.Stop();
+  EXPECT_FALSE(relay.IsRunning());
+  EXPECT_TRUE(relay.GetTopics().empty());
+  EXPECT_FALSE(discovery->HasRelay(fullyQualifiedTopic, true));
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,255 @@
+/*
+ * Copyright (C) 2015 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef _WIN32
+  #include <pthread.h>
+  #include <sys/resource.h>
+  #include <time.h>
+#endif
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ignition/transport/Statistics.hh"
+
+using namespace ignition;
+using namespace transport;
+
+// All the counters are statistics: relaxed ordering is enough.
+static const std::memory_order Relaxed = std::memory_order_relaxed;
+
+//////////////////////////////////////////////////
+/// \brief Update a maximum without taking a lock.
+/// \param[in, out] _max Current maximum.
+/// \param[in] _value New value.
+static void updateMax(std::atomic<uint64_t> &_max, const uint64_t _value)
+{
+  uint64_t max = _max.load(Relaxed);
+  while (_value > max && !_max.compare_exchange_weak(max, _value, Relaxed))
+  {
+  }
+}
+
+//////////////////////////////////////////////////
+void TopicCounters::AddPublished(const uint64_t _bytes,
+  const uint64_t _serializationTime)
+{
+  this->published.fetch_add(1, Relaxed);
+  this->bytesPublished.fetch_add(_bytes, Relaxed);
+  this->serializationTime.fetch_add(_serializationTime, Relaxed);
+}
+
+//////////////////////////////////////////////////
+void TopicCounters::AddReceived(const uint64_t _bytes)
+{
+  this->received.fetch_add(1, Relaxed);
+  this->bytesReceived.fetch_add(_bytes, Relaxed);
+}
+
+//////////////////////////////////////////////////
+void TopicCounters::AddCallbackTime(const uint64_t _time)
+{
+  this->callbackTime.fetch_add(_time, Relaxed);
+}
+
+//////////////////////////////////////////////////
+void TopicCounters::AddDropped()
+{
+  this->dropped.fetch_add(1, Relaxed);
+}
+
+//////////////////////////////////////////////////
+void TopicCounters::AddLost(const uint64_t _count)
+{
+  this->lost.fetch_add(_count, Relaxed);
+}
+
+//////////////////////////////////////////////////
+void TopicCounters::AddLatency(const uint64_t _latency)
+{
+  this->latencySamples.fetch_add(1, Relaxed);
+  this->latencyTotal.fetch_add(_latency, Relaxed);
+  updateMax(this->latencyMax, _latency);
+}
+
+//////////////////////////////////////////////////
+void TopicCounters::SetQueued(const uint64_t _messages, const uint64_t _bytes)
+{
+  this->queuedMessages.store(_messages, Relaxed);
+  this->queuedBytes.store(_bytes, Relaxed);
+}
+
+//////////////////////////////////////////////////
+void TopicCounters::AddLimitReached()
+{
+  this->limitReached.fetch_add(1, Relaxed);
+}
+
+//////////////////////////////////////////////////
+void TopicCounters::Snapshot(TopicStatistics &_stats) const
+{
+  _stats.published = this->published.load(Relaxed);
+  _stats.bytesPublished = this->bytesPublished.load(Relaxed);
+  _stats.serializationTime = this->serializationTime.load(Relaxed);
+  _stats.received = this->received.load(Relaxed);
+  _stats.bytesReceived = this->bytesReceived.load(Relaxed);
+  _stats.callbackTime = this->callbackTime.load(Relaxed);
+  _stats.dropped = this->dropped.load(Relaxed);
+  _stats.lost = this->lost.load(Relaxed);
+  _stats.latencySamples = this->latencySamples.load(Relaxed);
+  _stats.latencyTotal = this->latencyTotal.load(Relaxed);
+  _stats.latencyMax = this->latencyMax.load(Relaxed);
+  _stats.queuedMessages = this->queuedMessages.load(Relaxed);
+  _stats.queuedBytes = this->queuedBytes.load(Relaxed);
+  _stats.limitReached = this->limitReached.load(Relaxed);
+}
+
+//////////////////////////////////////////////////
+void ServiceCounters::AddRequest()
+{
+  this->requests.fetch_add(1, Relaxed);
+}
+
+//////////////////////////////////////////////////
+void ServiceCounters::AddResponse(const bool _result, const uint64_t _latency)
+{
+  this->responses.fetch_add(1, Relaxed);
+  if (!_result)
+    this->failures.fetch_add(1, Relaxed);
+  this->latencyTotal.fetch_add(_latency, Relaxed);
+  updateMax(this->latencyMax, _latency);
+}
+
+//////////////////////////////////////////////////
+void ServiceCounters::AddTimeout()
+{
+  this->timeouts.fetch_add(1, Relaxed);
+}
+
+//////////////////////////////////////////////////
+void ServiceCounters::AddServed(const uint64_t _time)
+{
+  this->served.fetch_add(1, Relaxed);
+  this->callbackTime.fetch_add(_time, Relaxed);
+}
+
+//////////////////////////////////////////////////
+void ServiceCounters::Snapshot(ServiceStatistics &_stats) const
+{
+  _stats.requests = this->requests.load(Relaxed);
+  _stats.responses = this->responses.load(Relaxed);
+  _stats.failures = this->failures.load(Relaxed);
+  _stats.timeouts = this->timeouts.load(Relaxed);
+  _stats.latencyTotal = this->latencyTotal.load(Relaxed);
+  _stats.latencyMax = this->latencyMax.load(Relaxed);
+  _stats.served = this->served.load(Relaxed);
+  _stats.callbackTime = this->callbackTime.load(Relaxed);
+}
+
+//////////////////////////////////////////////////
+TopicCountersPtr StatisticsStorage::Topic(const std::string &_topic)
+{
+  auto &counters = this->topics[_topic];
+  if (!counters)
+    counters.reset(new TopicCounters());
+  return counters;
+}
+
+//////////////////////////////////////////////////
+ServiceCountersPtr StatisticsStorage::Service(const std::string &_topic)
+{
+  auto &counters = this->services[_topic];
+  if (!counters)
+    counters.reset(new ServiceCounters());
+  return counters;
+}
+
+//////////////////////////////////////////////////
+bool StatisticsStorage::GetTopicStats(const std::string &_topic,
+  TopicStatistics &_stats) const
+{
+  auto it = this->topics.find(_topic);
+  if (it == this->topics.end())
+    return false;
+
+  it->second->Snapshot(_stats);
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool StatisticsStorage::GetServiceStats(const std::string &_topic,
+  ServiceStatistics &_stats) const
+{
+  auto it = this->services.find(_topic);
+  if (it == this->services.end())
+    return false;
+
+  it->second->Snapshot(_stats);
+  return true;
+}
+
+//////////////////////////////////////////////////
+void StatisticsStorage::GetTopicList(std::vector<std::string> &_topics) const
+{
+  _topics.clear();
+  for (auto const &topic : this->topics)
+    _topics.push_back(topic.first);
+}
+
+//////////////////////////////////////////////////
+void StatisticsStorage::GetServiceList(
+  std::vector<std::string> &_services) const
+{
+  _services.clear();
+  for (auto const &service : this->services)
+    _services.push_back(service.first);
+}
+
+//////////////////////////////////////////////////
+uint64_t transport::ThreadCpuNs(std::thread &_thread)
+{
+#ifdef _WIN32
+  (void)_thread;
+  return 0;
+#else
+  clockid_t clock;
+  struct timespec ts;
+  if (pthread_getcpuclockid(_thread.native_handle(), &clock) != 0 ||
+      clock_gettime(clock, &ts) != 0)
+  {
+    return 0;
+  }
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000u + ts.tv_nsec;
+#endif
+}
+
+//////////////////////////////////////////////////
+uint64_t transport::ProcessCpuNs()
+{
+#ifdef _WIN32
+  return 0;
+#else
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+  return (static_cast<uint64_t>(usage.ru_utime.tv_sec) +
+          usage.ru_stime.tv_sec) * 1000000000u +
+         (static_cast<uint64_t>(usage.ru_utime.tv_usec) +
+          usage.ru_stime.tv_usec) * 1000u;
+#endif
+}
@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2015 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <string>
+#include <thread>
+#include <vector>
+#include "ignition/transport/Statistics.hh"
+#include "gtest/gtest.h"
+
+using namespace ignition;
+
+//////////////////////////////////////////////////
+/// \brief Check the topic counters.
+TEST(StatisticsTest, TopicCounters)
+{
+  transport::TopicCounters counters;
+  transport::TopicStatistics stats;
+
+  counters.Snapshot(stats);
+  EXPECT_EQ(stats.published, 0u);
+  EXPECT_EQ(stats.received, 0u);
+  EXPECT_EQ(stats.dropped, 0u);
+
+  counters.AddPublished(100, 10);
+  counters.AddPublished(50, 5);
+  counters.AddReceived(20);
+  counters.AddCallbackTime(7);
+  counters.AddDropped();
+  counters.AddLost(3);
+  counters.AddLatency(30);
+  counters.AddLatency(10);
+  counters.SetQueued(4, 400);
+  counters.SetQueued(2, 200);
+  counters.AddLimitReached();
+
+  counters.Snapshot(stats);
+  EXPECT_EQ(stats.published, 2u);
+  EXPECT_EQ(stats.bytesPublished, 150u);
+  EXPECT_EQ(stats.serializationTime, 15u);
+  EXPECT_EQ(stats.received, 1u);
+  EXPECT_EQ(stats.bytesReceived, 20u);
+  EXPECT_EQ(stats.callbackTime, 7u);
+  EXPECT_EQ(stats.dropped, 1u);
+  EXPECT_EQ(stats.lost, 3u);
+  EXPECT_EQ(stats.latencySamples, 2u);
+  EXPECT_EQ(stats.latencyTotal, 40u);
+  EXPECT_EQ(stats.latencyMax, 30u);
+  EXPECT_EQ(stats.queuedMessages, 2u);
+  EXPECT_EQ(stats.queuedBytes, 200u);
+  EXPECT_EQ(stats.limitReached, 1u);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the service counters.
+TEST(StatisticsTest, ServiceCounters)
+{
+  transport::ServiceCounters counters;
+  transport::ServiceStatistics stats;
+
+  counters.AddRequest();
+  counters.AddRequest();
+  counters.AddRequest();
+  counters.AddResponse(true, 100);
+  counters.AddResponse(false, 300);
+  counters.AddTimeout();
+  counters.AddServed(40);
+
+  counters.Snapshot(stats);
+  EXPECT_EQ(stats.requests, 3u);
+  EXPECT_EQ(stats.responses, 2u);
+  EXPECT_EQ(stats.failures, 1u);
+  EXPECT_EQ(stats.timeouts, 1u);
+  EXPECT_EQ(stats.latencyTotal, 400u);
+  EXPECT_EQ(stats.latencyMax, 300u);
+  EXPECT_EQ(stats.served, 1u);
+  EXPECT_EQ(stats.callbackTime, 40u);
+}
+
+//////////////////////////////////////////////////
+/// \brief Update the counters from multiple threads at the same time.
+TEST(StatisticsTest, Concurrency)
+{
+  const unsigned int numThreads = 4;
+  const unsigned int iters = 10000;
+  transport::TopicCounters topicCounters;
+  transport::ServiceCounters srvCounters;
+
+  std::vector<std::thread> threads;
+  for (unsigned int t = 0; t < numThreads; ++t)
+  {
+    threads.push_back(std::thread([&, t]()
+    {
+      for (unsigned int i = 0; i < iters; ++i)
+      {
+        topicCounters.AddPublished(1, 1);
+        srvCounters.AddResponse(true, t * iters + i);
+      }
+    }));
+  }
+  for (auto &t : threads)
+    t.join();
+
+  transport::TopicStatistics topicStats;
+  topicCounters.Snapshot(topicStats);
+  EXPECT_EQ(topicStats.published, numThreads * iters);
+  EXPECT_EQ(topicStats.bytesPublished, numThreads * iters);
+
+  transport::ServiceStatistics srvStats;
+  srvCounters.Snapshot(srvStats);
+  EXPECT_EQ(srvStats.responses, numThreads * iters);
+  EXPECT_EQ(srvStats.latencyMax, numThreads * iters - 1);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the StatisticsStorage class.
+TEST(StatisticsTest, Storage)
+{
+  transport::StatisticsStorage storage;
+  transport::TopicStatistics topicStats;
+  transport::ServiceStatistics srvStats;
+  std::vector<std::string> list;
+
+  EXPECT_FALSE(storage.GetTopicStats("/foo", topicStats));
+  EXPECT_FALSE(storage.GetServiceStats("/srv", srvStats));
+
+  auto topicCounters = storage.Topic("/foo");
+  ASSERT_TRUE(topicCounters != nullptr);
+  topicCounters->AddReceived(10);
+
+  // The same counters are returned for the same topic.
+  EXPECT_EQ(storage.Topic("/foo"), topicCounters);
+  EXPECT_NE(storage.Topic("/bar"), topicCounters);
+
+  EXPECT_TRUE(storage.GetTopicStats("/foo", topicStats));
+  EXPECT_EQ(topicStats.received, 1u);
+  EXPECT_EQ(topicStats.bytesReceived, 10u);
+  EXPECT_FALSE(storage.GetServiceStats("/foo", srvStats));
+
+  storage.Service("/srv")->AddRequest();
+  EXPECT_TRUE(storage.GetServiceStats("/srv", srvStats));
+  EXPECT_EQ(srvStats.requests, 1u);
+
+  storage.GetTopicList(list);
+  ASSERT_EQ(list.size(), 2u);
+  EXPECT_EQ(list[0], "/bar");
+  EXPECT_EQ(list[1], "/foo");
+
+  storage.GetServiceList(list);
+  ASSERT_EQ(list.size(), 1u);
+  EXPECT_EQ(list[0], "/srv");
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
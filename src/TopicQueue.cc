@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2015 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include "ignition/transport/TopicQueue.hh"
+
+using namespace ignition;
+using namespace transport;
+
+//////////////////////////////////////////////////
+TopicQueue::TopicQueue(const QueueLimits &_limits)
+  : limits(_limits)
+{
+}
+
+//////////////////////////////////////////////////
+const QueueLimits &TopicQueue::GetLimits() const
+{
+  return this->limits;
+}
+
+//////////////////////////////////////////////////
+void TopicQueue::SetLimits(const QueueLimits &_limits)
+{
+  this->limits = _limits;
+}
+
+//////////////////////////////////////////////////
+bool TopicQueue::IsFull(const uint64_t _size) const
+{
+  return (this->limits.maxMessages > 0 &&
+          this->msgs.size() >= this->limits.maxMessages) ||
+         (this->limits.maxBytes > 0 &&
+          this->bytes + _size > this->limits.maxBytes);
+}
+
+//////////////////////////////////////////////////
+uint64_t TopicQueue::Push(QueuedMsg &&_msg, bool &_alert)
+{
+  _alert = false;
+  uint64_t size = _msg.data.size();
+
+  if (!this->IsFull(size))
+  {
+    this->bytes += size;
+    this->msgs.push_back(std::move(_msg));
+    return 0;
+  }
+
+  _alert = this->alertArmed;
+  this->alertArmed = false;
+
+  // A message bigger than the byte limit never fits.
+  if (this->limits.policy == DropPolicy::DropNewest ||
+      (this->limits.maxBytes > 0 && size > this->limits.maxBytes))
+  {
+    return 1;
+  }
+
+  uint64_t dropped = 0;
+  while (!this->msgs.empty() && this->IsFull(size))
+  {
+    this->bytes -= this->msgs.front().data.size();
+    this->msgs.pop_front();
+    ++dropped;
+  }
+
+  this->bytes += size;
+  this->msgs.push_back(std::move(_msg));
+  return dropped;
+}
+
+//////////////////////////////////////////////////
+bool TopicQueue::Pop(QueuedMsg &_msg)
+{
+  if (this->msgs.empty())
+    return false;
+
+  _msg = std::move(this->msgs.front());
+  this->msgs.pop_front();
+  this->bytes -= _msg.data.size();
+
+  if (this->msgs.empty())
+    this->alertArmed = true;
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+uint64_t TopicQueue::GetMessages() const
+{
+  return this->msgs.size();
+}
+
+//////////////////////////////////////////////////
+uint64_t TopicQueue::GetBytes() const
+{
+  return this->bytes;
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2015 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <string>
+#include "ignition/transport/TopicQueue.hh"
+#include "gtest/gtest.h"
+
+using namespace ignition;
+
+//////////////////////////////////////////////////
+/// \brief Create a queued message.
+/// \param[in] _size Size of the message.
+/// \param[in] _seq Sequence number of the message.
+/// \return The message.
+transport::QueuedMsg createMsg(const size_t _size, const uint64_t _seq)
+{
+  transport::QueuedMsg msg;
+  msg.topic = "@/foo";
+  msg.data = std::string(_size, 'x');
+  msg.info.SetMetadata(_seq, 0);
+  return msg;
+}
+
+//////////////////////////////////////////////////
+/// \brief Check a queue without limits.
+TEST(TopicQueueTest, Unlimited)
+{
+  transport::TopicQueue queue{transport::QueueLimits()};
+  transport::QueuedMsg msg;
+  bool alert;
+
+  EXPECT_FALSE(queue.Pop(msg));
+  for (uint64_t i = 1; i <= 100; ++i)
+  {
+    EXPECT_EQ(queue.Push(createMsg(10, i), alert), 0u);
+    EXPECT_FALSE(alert);
+  }
+  EXPECT_EQ(queue.GetMessages(), 100u);
+  EXPECT_EQ(queue.GetBytes(), 1000u);
+
+  for (uint64_t i = 1; i <= 100; ++i)
+  {
+    ASSERT_TRUE(queue.Pop(msg));
+    EXPECT_EQ(msg.info.GetSequence(), i);
+  }
+  EXPECT_EQ(queue.GetMessages(), 0u);
+  EXPECT_EQ(queue.GetBytes(), 0u);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the drop newest policy and the alerts.
+TEST(TopicQueueTest, DropNewest)
+{
+  transport::QueueLimits limits;
+  limits.maxMessages = 3;
+  limits.policy = transport::DropPolicy::DropNewest;
+  transport::TopicQueue queue(limits);
+  transport::QueuedMsg msg;
+  bool alert;
+
+  for (uint64_t i = 1; i <= 3; ++i)
+    EXPECT_EQ(queue.Push(createMsg(10, i), alert), 0u);
+
+  // The queue is full: the new messages are discarded and only the first
+  // one raises an alert.
+  EXPECT_EQ(queue.Push(createMsg(10, 4), alert), 1u);
+  EXPECT_TRUE(alert);
+  EXPECT_EQ(queue.Push(createMsg(10, 5), alert), 1u);
+  EXPECT_FALSE(alert);
+  EXPECT_EQ(queue.GetMessages(), 3u);
+
+  ASSERT_TRUE(queue.Pop(msg));
+  EXPECT_EQ(msg.info.GetSequence(), 1u);
+
+  // The alert is re-armed when the queue is empty.
+  EXPECT_TRUE(queue.Pop(msg));
+  EXPECT_TRUE(queue.Pop(msg));
+  EXPECT_EQ(msg.info.GetSequence(), 3u);
+  for (uint64_t i = 6; i <= 8; ++i)
+    EXPECT_EQ(queue.Push(createMsg(10, i), alert), 0u);
+  EXPECT_EQ(queue.Push(createMsg(10, 9), alert), 1u);
+  EXPECT_TRUE(alert);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the drop oldest policy with a byte limit.
+TEST(TopicQueueTest, DropOldestBytes)
+{
+  transport::QueueLimits limits;
+  limits.maxBytes = 100;
+  limits.policy = transport::DropPolicy::DropOldest;
+  transport::TopicQueue queue(limits);
+  transport::QueuedMsg msg;
+  bool alert;
+
+  for (uint64_t i = 1; i <= 4; ++i)
+    EXPECT_EQ(queue.Push(createMsg(25, i), alert), 0u);
+  EXPECT_EQ(queue.GetBytes(), 100u);
+
+  // Two old messages are needed to make room for this one.
+  EXPECT_EQ(queue.Push(createMsg(40, 5), alert), 2u);
+  EXPECT_TRUE(alert);
+  EXPECT_EQ(queue.GetMessages(), 3u);
+  EXPECT_EQ(queue.GetBytes(), 90u);
+
+  // A message bigger than the limit is always discarded.
+  EXPECT_EQ(queue.Push(createMsg(101, 6), alert), 1u);
+  EXPECT_EQ(queue.GetMessages(), 3u);
+
+  ASSERT_TRUE(queue.Pop(msg));
+  EXPECT_EQ(msg.info.GetSequence(), 3u);
+
+  // New limits.
+  limits.maxBytes = 0;
+  limits.maxMessages = 1;
+  queue.SetLimits(limits);
+  EXPECT_EQ(queue.GetLimits().maxMessages, 1u);
+  EXPECT_EQ(queue.Push(createMsg(10, 7), alert), 2u);
+  EXPECT_EQ(queue.GetMessages(), 1u);
+  ASSERT_TRUE(queue.Pop(msg));
+  EXPECT_EQ(msg.info.GetSequence(), 7u);
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
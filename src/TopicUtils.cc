@@ -100,3 +100,26 @@ bool TopicUtils::GetFullyQualifiedName(const std::string &_partition,
 
   return true;
 }
+
+//////////////////////////////////////////////////
+uint32_t TopicUtils::GetPartitionHash(const std::string &_name)
+{
+  // The partition is enclosed between the first two '@'.
+  if (_name.empty() || _name.front() != '@')
+    return 0;
+
+  auto end = _name.find('@', 1);
+  if (end == std::string::npos)
+    return 0;
+
+  // 32-bit FNV-1a.
+  uint32_t hash = 2166136261u;
+  for (size_t i = 1; i < end; ++i)
+  {
+    hash ^= static_cast<uint8_t>(_name[i]);
+    hash *= 16777619u;
+  }
+
+  // 0 is reserved for messages without partition.
+  return hash == 0 ? 1 : hash;
+}
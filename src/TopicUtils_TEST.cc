@@ -232,6 +232,36 @@ TEST(TopicUtilsTest, testGetFullyQualifiedName)
   EXPECT_FALSE(transport::TopicUtils::GetFullyQualifiedName(p4, ns2, t8, name));
 }
 
+//////////////////////////////////////////////////
+/// \brief Check GetPartitionHash.
+TEST(TopicUtilsTest, testGetPartitionHash)
+{
+  std::string name1;
+  std::string name2;
+  std::string name3;
+  EXPECT_TRUE(transport::TopicUtils::GetFullyQualifiedName("partition", "",
+    "/foo", name1));
+  EXPECT_TRUE(transport::TopicUtils::GetFullyQualifiedName("partition", "ns",
+    "bar", name2));
+  EXPECT_TRUE(transport::TopicUtils::GetFullyQualifiedName("other", "",
+    "/foo", name3));
+
+  // Names without partition.
+  EXPECT_EQ(transport::TopicUtils::GetPartitionHash(""), 0u);
+  EXPECT_EQ(transport::TopicUtils::GetPartitionHash("/foo"), 0u);
+  EXPECT_EQ(transport::TopicUtils::GetPartitionHash("@/foo"), 0u);
+
+  // The hash only depends on the partition.
+  auto hash1 = transport::TopicUtils::GetPartitionHash(name1);
+  EXPECT_NE(hash1, 0u);
+  EXPECT_EQ(hash1, transport::TopicUtils::GetPartitionHash(name2));
+  EXPECT_NE(hash1, transport::TopicUtils::GetPartitionHash(name3));
+
+  // The default partition has its own hash.
+  EXPECT_NE(transport::TopicUtils::GetPartitionHash("@@/foo"), 0u);
+  EXPECT_NE(transport::TopicUtils::GetPartitionHash("@@/foo"), hash1);
+}
+
 //////////////////////////////////////////////////
 int main(int argc, char **argv)
 {
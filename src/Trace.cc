@@ -0,0 +1,227 @@
+/*
+ * Copyright (C) 2015 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifdef _WIN32
+  #include <process.h>
+  #define getpid _getpid
+#else
+  #include <unistd.h>
+#endif
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "ignition/transport/Trace.hh"
+
+using namespace ignition;
+using namespace transport;
+
+namespace
+{
+  /// \brief Slot of a ring buffer. The slots are read by other threads
+  /// while the owner thread writes them, so every field is atomic and
+  /// 'sequence' works as a seqlock: it is odd while the event is written,
+  /// and 2 * (index + 1) once the event with that index is complete.
+  struct Slot
+  {
+    /// \brief Sequence number of the slot.
+    std::atomic<uint64_t> sequence{0};
+
+    /// \brief Name of the section.
+    std::atomic<const char *> name{nullptr};
+
+    /// \brief Start time (ns).
+    std::atomic<uint64_t> start{0};
+
+    /// \brief Duration (ns).
+    std::atomic<uint64_t> duration{0};
+  };
+
+  /// \brief Ring buffer of events written by a single thread.
+  struct ThreadBuffer
+  {
+    /// \brief Index of the thread.
+    uint32_t thread = 0;
+
+    /// \brief Number of events written so far.
+    std::atomic<uint64_t> head{0};
+
+    /// \brief Number of events written when the buffer was cleared. Only
+    /// the events written after this one are reported.
+    std::atomic<uint64_t> cleared{0};
+
+    /// \brief Events.
+    std::array<Slot, Tracer::BufferSize> slots;
+  };
+
+  /// \brief Buffers of all the threads. The buffers are kept after the
+  /// threads finish, so their events can still be written.
+  struct Registry
+  {
+    /// \brief Protects the list of buffers. Only used when a thread records
+    /// its first event and when the events are read.
+    std::mutex mutex;
+
+    /// \brief Buffers.
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+  };
+
+  //////////////////////////////////////////////////
+  Registry &registry()
+  {
+    // Never destroyed: the events can be written while the static objects
+    // are destroyed at exit (e.g. by NodeShared).
+    static Registry *instance = new Registry();
+    return *instance;
+  }
+
+  //////////////////////////////////////////////////
+  ThreadBuffer &threadBuffer()
+  {
+    thread_local std::shared_ptr<ThreadBuffer> buffer;
+    if (!buffer)
+    {
+      buffer.reset(new ThreadBuffer());
+      auto &reg = registry();
+      std::lock_guard<std::mutex> lk(reg.mutex);
+      buffer->thread = static_cast<uint32_t>(reg.buffers.size());
+      reg.buffers.push_back(buffer);
+    }
+    return *buffer;
+  }
+}
+
+//////////////////////////////////////////////////
+void Tracer::Record(const char *_name, const uint64_t _start,
+  const uint64_t _duration)
+{
+  auto &buffer = threadBuffer();
+  uint64_t head = buffer.head.load(std::memory_order_relaxed);
+
+  // Mark the slot as being written. The fence keeps the writes of the
+  // fields below ordered after the mark.
+  auto &slot = buffer.slots[head % BufferSize];
+  slot.sequence.store(2 * head + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  slot.name.store(_name, std::memory_order_relaxed);
+  slot.start.store(_start, std::memory_order_relaxed);
+  slot.duration.store(_duration, std::memory_order_relaxed);
+
+  // Publish the event.
+  slot.sequence.store(2 * (head + 1), std::memory_order_release);
+  buffer.head.store(head + 1, std::memory_order_release);
+}
+
+//////////////////////////////////////////////////
+void Tracer::GetEvents(std::vector<TraceEvent> &_events)
+{
+  _events.clear();
+
+  auto &reg = registry();
+  std::lock_guard<std::mutex> lk(reg.mutex);
+  for (auto const &buffer : reg.buffers)
+  {
+    uint64_t head = buffer->head.load(std::memory_order_acquire);
+    uint64_t first = head > BufferSize ? head - BufferSize : 0;
+    first = std::max(first, buffer->cleared.load(std::memory_order_acquire));
+
+    for (uint64_t i = first; i < head; ++i)
+    {
+      auto const &slot = buffer->slots[i % BufferSize];
+      uint64_t expected = 2 * (i + 1);
+      if (slot.sequence.load(std::memory_order_acquire) != expected)
+        continue;
+
+      TraceEvent event;
+      event.name = slot.name.load(std::memory_order_relaxed);
+      event.start = slot.start.load(std::memory_order_relaxed);
+      event.duration = slot.duration.load(std::memory_order_relaxed);
+      event.thread = buffer->thread;
+
+      // The writer might have started to overwrite the slot while copying.
+      // The fence keeps the copy above ordered before the second load.
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (slot.sequence.load(std::memory_order_relaxed) != expected)
+        continue;
+
+      _events.push_back(event);
+    }
+  }
+
+  std::sort(_events.begin(), _events.end(),
+    [](const TraceEvent &_a, const TraceEvent &_b)
+    {
+      return _a.start < _b.start;
+    });
+}
+
+//////////////////////////////////////////////////
+bool Tracer::WriteChromeTrace(const std::string &_path)
+{
+  std::string path = _path;
+  auto pos = path.find("%p");
+  if (pos != std::string::npos)
+    path.replace(pos, 2, std::to_string(getpid()));
+
+  std::ofstream out(path);
+  if (!out)
+  {
+    std::cerr << "Tracer::WriteChromeTrace() error: Unable to open ["
+              << path << "]" << std::endl;
+    return false;
+  }
+
+  std::vector<TraceEvent> events;
+  GetEvents(events);
+
+  // Chrome expects microseconds.
+  out << std::fixed << std::setprecision(3);
+  out << "{\"traceEvents\": [\n";
+  for (size_t i = 0; i < events.size(); ++i)
+  {
+    auto const &event = events[i];
+    out << "  {\"name\": \"" << event.name << "\", \"ph\": \"X\""
+        << ", \"ts\": " << event.start / 1000.0
+        << ", \"dur\": " << event.duration / 1000.0
+        << ", \"pid\": " << getpid()
+        << ", \"tid\": " << event.thread << "}"
+        << (i + 1 < events.size() ? ",\n" : "\n");
+  }
+  out << "]}\n";
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+void Tracer::Clear()
+{
+  auto &reg = registry();
+  std::lock_guard<std::mutex> lk(reg.mutex);
+  for (auto const &buffer : reg.buffers)
+  {
+    buffer->cleared.store(buffer->head.load(std::memory_order_acquire),
+      std::memory_order_release);
+  }
+}
@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2015 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ignition/transport/Trace.hh"
+#include "gtest/gtest.h"
+#include "ignition/transport/test_config.h"
+
+using namespace ignition;
+
+//////////////////////////////////////////////////
+/// \brief Record events from multiple threads and read them.
+TEST(TraceTest, RecordAndGetEvents)
+{
+  transport::Tracer::Clear();
+
+  std::vector<transport::TraceEvent> events;
+  transport::Tracer::GetEvents(events);
+  EXPECT_TRUE(events.empty());
+
+  {
+    transport::ScopedTrace trace("scope");
+  }
+  transport::Tracer::Record("manual", 100, 50);
+
+  std::thread t([]()
+  {
+    transport::Tracer::Record("thread", 200, 10);
+  });
+  t.join();
+
+  transport::Tracer::GetEvents(events);
+  ASSERT_EQ(events.size(), 3u);
+
+  // Sorted by start time.
+  EXPECT_EQ(std::string(events[0].name), "manual");
+  EXPECT_EQ(events[0].start, 100u);
+  EXPECT_EQ(events[0].duration, 50u);
+  EXPECT_EQ(std::string(events[1].name), "thread");
+  EXPECT_NE(events[1].thread, events[0].thread);
+  EXPECT_EQ(std::string(events[2].name), "scope");
+  EXPECT_EQ(events[2].thread, events[0].thread);
+
+  transport::Tracer::Clear();
+  transport::Tracer::GetEvents(events);
+  EXPECT_TRUE(events.empty());
+}
+
+//////////////////////////////////////////////////
+/// \brief Only the most recent events are kept when a buffer is full.
+TEST(TraceTest, Overwrite)
+{
+  transport::Tracer::Clear();
+
+  const unsigned int bufferSize = transport::Tracer::BufferSize;
+  const unsigned int total = bufferSize + 100;
+  for (unsigned int i = 0; i < total; ++i)
+    transport::Tracer::Record("event", i, 1);
+
+  std::vector<transport::TraceEvent> events;
+  transport::Tracer::GetEvents(events);
+  ASSERT_EQ(events.size(), bufferSize);
+  EXPECT_EQ(events.front().start, 100u);
+  EXPECT_EQ(events.back().start, total - 1);
+
+  transport::Tracer::Clear();
+}
+
+//////////////////////////////////////////////////
+/// \brief Read the events while another thread overwrites them. Every
+/// event reported must be complete.
+TEST(TraceTest, ReadWhileWriting)
+{
+  transport::Tracer::Clear();
+
+  std::atomic<bool> exit{false};
+  std::thread writer([&exit]()
+  {
+    for (uint64_t i = 1; !exit; ++i)
+      transport::Tracer::Record("event", i, 2 * i);
+  });
+
+  std::vector<transport::TraceEvent> events;
+  for (int i = 0; i < 100; ++i)
+  {
+    transport::Tracer::GetEvents(events);
+    for (auto const &event : events)
+    {
+      EXPECT_EQ(std::string(event.name), "event");
+      EXPECT_EQ(event.duration, 2 * event.start);
+    }
+  }
+
+  exit = true;
+  writer.join();
+  transport::Tracer::Clear();
+}
+
+//////////////////////////////////////////////////
+/// \brief Write the events in the Chrome trace format.
+TEST(TraceTest, WriteChromeTrace)
+{
+  transport::Tracer::Clear();
+  transport::Tracer::Record("first", 1000, 2000);
+  transport::Tracer::Record("second", 4000, 1000);
+
+  std::string path = testing::portablePathUnion(PROJECT_BINARY_PATH,
+    "test_trace.json");
+  ASSERT_TRUE(transport::Tracer::WriteChromeTrace(path));
+
+  std::ifstream in(path);
+  std::stringstream content;
+  content << in.rdbuf();
+  std::string json = content.str();
+
+  EXPECT_NE(json.find("\"traceEvents\""), std::string::npos);
+  EXPECT_NE(json.find("\"name\": \"first\", \"ph\": \"X\", \"ts\": 1.000, "
+                      "\"dur\": 2.000"), std::string::npos);
+  EXPECT_NE(json.find("\"name\": \"second\""), std::string::npos);
+
+  EXPECT_FALSE(transport::Tracer::WriteChromeTrace("/invalid/dir/trace"));
+
+  transport::Tracer::Clear();
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
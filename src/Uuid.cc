@@ -15,75 +15,142 @@
  *
 */
 
+#ifdef _WIN32
+  #include <Rpc.h>
+  #pragma comment(lib, "Rpcrt4.lib")
+#else /* UNIX */
+  #include <uuid/uuid.h>
+#endif
+
+#include <cctype>
+#include <cstdio>
+#include <cstring>
 #include <string>
-#include <vector>
 #include "ignition/transport/Uuid.hh"
 
 using namespace ignition;
 using namespace transport;
 
+const size_t Uuid::Size;
+
 #ifdef _WIN32
-/* Windows implementation using libuuid library */
+/* Windows implementation using the RPC library */
 //////////////////////////////////////////////////
 Uuid::Uuid()
 {
-  RPC_STATUS Result = ::UuidCreate(&this->data);
+  UUID uuid;
+  RPC_STATUS Result = ::UuidCreate(&uuid);
   if (Result != RPC_S_OK)
   {
     std::cerr << "Call to UuidCreate return a non success RPC call. " <<
                  "Return code: " << Result << std::endl;
   }
+  static_assert(sizeof(uuid) == Uuid::Size, "Unexpected size of UUID");
+  memcpy(this->data, &uuid, Uuid::Size);
 }
+#else
+/* Unix implementation using libuuid library */
 
 //////////////////////////////////////////////////
-Uuid::~Uuid()
+Uuid::Uuid()
 {
-  // No method in windows to release the uuid
+  static_assert(sizeof(uuid_t) == Uuid::Size, "Unexpected size of uuid_t");
+  uuid_generate(this->data);
 }
+#endif
 
 //////////////////////////////////////////////////
 std::string Uuid::ToString() const
 {
-  std::string uuidStr;
-  char* szUuid = NULL;
-  if (::UuidToStringA(&this->data, reinterpret_cast<RPC_CSTR*>(&szUuid)) ==
-    RPC_S_OK)
+  char uuidStr[Uuid::UuidStrLen];
+
+  snprintf(uuidStr, Uuid::UuidStrLen,
+    "%02x%02x%02x%02x-%02x%02x-%02x%02x-%02x%02x-%02x%02x%02x%02x%02x%02x",
+    this->data[0], this->data[1], this->data[2], this->data[3],
+    this->data[4], this->data[5], this->data[6], this->data[7],
+    this->data[8], this->data[9], this->data[10], this->data[11],
+    this->data[12], this->data[13], this->data[14], this->data[15]);
+
+  // Do not include the \0 in the string.
+  return std::string(uuidStr, Uuid::UuidStrLen - 1);
+}
+
+//////////////////////////////////////////////////
+bool Uuid::FromString(const std::string &_str)
+{
+  if (_str.size() != Uuid::UuidStrLen - 1)
+    return false;
+
+  uint8_t bytes[Uuid::Size];
+  size_t pos = 0;
+  for (size_t i = 0; i < Uuid::Size; ++i)
   {
-        uuidStr = szUuid;
-        ::RpcStringFreeA(reinterpret_cast<RPC_CSTR*>(&szUuid));
+    // Skip the hyphens between groups.
+    if (pos == 8 || pos == 13 || pos == 18 || pos == 23)
+    {
+      if (_str[pos] != '-')
+        return false;
+      ++pos;
+    }
+
+    unsigned int value = 0;
+    for (size_t j = 0; j < 2; ++j, ++pos)
+    {
+      char c = _str[pos];
+      if (!isxdigit(static_cast<unsigned char>(c)))
+        return false;
+      value = value * 16 +
+        (isdigit(static_cast<unsigned char>(c)) ? c - '0' :
+         tolower(static_cast<unsigned char>(c)) - 'a' + 10);
+    }
+    bytes[i] = static_cast<uint8_t>(value);
   }
 
-  return uuidStr;
+  memcpy(this->data, bytes, Uuid::Size);
+  return true;
 }
-#else
-/* Unix implementation using libuuid library */
 
 //////////////////////////////////////////////////
-Uuid::Uuid()
+const uint8_t *Uuid::Data() const
 {
-  uuid_generate(this->data);
+  return this->data;
 }
 
 //////////////////////////////////////////////////
-Uuid::~Uuid()
+bool Uuid::FromBytes(const void *_data, const size_t _size)
 {
-  uuid_clear(this->data);
+  if (!_data || _size != Uuid::Size)
+    return false;
+
+  memcpy(this->data, _data, Uuid::Size);
+  return true;
 }
 
 //////////////////////////////////////////////////
-std::string Uuid::ToString() const
+size_t Uuid::Hash() const
 {
-  std::vector<char> uuidStr(Uuid::UuidStrLen);
+  // The bytes are random, any part of them is a good hash.
+  uint64_t a;
+  uint64_t b;
+  memcpy(&a, this->data, sizeof(a));
+  memcpy(&b, this->data + sizeof(a), sizeof(b));
+  return static_cast<size_t>(a ^ b);
+}
 
-  snprintf(&uuidStr[0], Uuid::UuidStrLen,
-    "%02x%02x%02x%02x-%02x%02x-%02x%02x-%02x%02x-%02x%02x%02x%02x%02x%02x",
-    this->data[0], this->data[1], this->data[2], this->data[3],
-    this->data[4], this->data[5], this->data[6], this->data[7],
-    this->data[8], this->data[9], this->data[10], this->data[11],
-    this->data[12], this->data[13], this->data[14], this->data[15]);
+//////////////////////////////////////////////////
+bool Uuid::operator==(const Uuid &_other) const
+{
+  return memcmp(this->data, _other.data, Uuid::Size) == 0;
+}
 
-  // Do not include the \0 in the string.
-  return std::string(uuidStr.begin(), uuidStr.end() - 1);
+//////////////////////////////////////////////////
+bool Uuid::operator!=(const Uuid &_other) const
+{
+  return !(*this == _other);
 }
 
-#endif
+//////////////////////////////////////////////////
+bool Uuid::operator<(const Uuid &_other) const
+{
+  return memcmp(this->data, _other.data, Uuid::Size) < 0;
+}
@@ -16,8 +16,10 @@
 */
 
 #include <cctype>
+#include <functional>
 #include <iostream>
 #include <string>
+#include <unordered_set>
 #include "ignition/transport/Uuid.hh"
 #include "gtest/gtest.h"
 
@@ -51,6 +53,55 @@ TEST(UuidTest, testToString)
     EXPECT_TRUE(isxdigit(output.str()[i]));
 }
 
+//////////////////////////////////////////////////
+/// \brief Check the comparison, hash and conversion operations.
+TEST(UuidTest, ValueType)
+{
+  transport::Uuid uuid1;
+  transport::Uuid uuid2;
+  transport::Uuid copy = uuid1;
+
+  EXPECT_TRUE(copy == uuid1);
+  EXPECT_FALSE(copy != uuid1);
+  EXPECT_FALSE(uuid1 == uuid2);
+  EXPECT_TRUE(uuid1 != uuid2);
+  EXPECT_NE(uuid1 < uuid2, uuid2 < uuid1);
+  EXPECT_FALSE(uuid1 < copy);
+  EXPECT_EQ(std::hash<transport::Uuid>()(uuid1),
+            std::hash<transport::Uuid>()(copy));
+
+  std::unordered_set<transport::Uuid> set = {uuid1, uuid2, copy};
+  EXPECT_EQ(set.size(), 2u);
+
+  // Binary form.
+  transport::Uuid other;
+  EXPECT_FALSE(other.FromBytes(uuid1.Data(), transport::Uuid::Size - 1));
+  EXPECT_FALSE(other.FromBytes(nullptr, transport::Uuid::Size));
+  EXPECT_NE(other, uuid1);
+  EXPECT_TRUE(other.FromBytes(uuid1.Data(), transport::Uuid::Size));
+  EXPECT_EQ(other, uuid1);
+
+  // String form.
+  EXPECT_TRUE(other.FromString(uuid2.ToString()));
+  EXPECT_EQ(other, uuid2);
+  EXPECT_EQ(other.ToString(), uuid2.ToString());
+
+  std::string str = uuid1.ToString();
+  for (auto &c : str)
+    c = static_cast<char>(toupper(c));
+  EXPECT_TRUE(other.FromString(str));
+  EXPECT_EQ(other, uuid1);
+
+  EXPECT_FALSE(other.FromString(""));
+  EXPECT_FALSE(other.FromString(str.substr(1)));
+  str[8] = '0';
+  EXPECT_FALSE(other.FromString(str));
+  str = uuid2.ToString();
+  str[0] = 'g';
+  EXPECT_FALSE(other.FromString(str));
+  EXPECT_EQ(other, uuid1);
+}
+
 //////////////////////////////////////////////////
 int main(int argc, char **argv)
 {
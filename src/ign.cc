@@ -15,22 +15,380 @@
  *
 */
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cmath>
+#include <csignal>
+#include <deque>
+#include <iomanip>
 #include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
 #include <vector>
+#ifndef _WIN32
+  #include <sys/resource.h>
+#endif
 #include "ignition/transport/ign.hh"
+#include "ignition/transport/Introspection.hh"
+#include "ignition/transport/MessageInfo.hh"
 #include "ignition/transport/Node.hh"
+#include "ignition/transport/NodeShared.hh"
+#include "ignition/transport/Pacer.hh"
+#include "ignition/transport/Player.hh"
+#include "ignition/transport/Recorder.hh"
+#include "ignition/transport/Relay.hh"
+#include "ignition/transport/TopicUtils.hh"
 
 using namespace ignition;
 using namespace transport;
 
+/// \brief Set to true when the user interrupts a monitoring command.
+static volatile std::sig_atomic_t monitorInterrupted = 0;
+
+//////////////////////////////////////////////////
+/// \brief Signal handler used while monitoring a topic.
+/// \param[in] _signal Signal received.
+static void monitorSignalHandler(int _signal)
+{
+  if (_signal == SIGINT || _signal == SIGTERM)
+    monitorInterrupted = 1;
+}
+
 //////////////////////////////////////////////////
-extern "C" IGNITION_VISIBLE void cmdTopicList()
+/// \brief Format an amount of bytes using the most appropriate unit.
+/// \param[in] _bytes Number of bytes.
+/// \return The formatted string. E.g.: "1.50 KB".
+static std::string formatBytes(const double _bytes)
 {
+  const char *units[] = {"B", "KB", "MB", "GB"};
+  double value = _bytes;
+  unsigned int unit = 0;
+  while (value >= 1024 && unit < 3)
+  {
+    value /= 1024;
+    ++unit;
+  }
+
+  std::ostringstream out;
+  out << std::fixed << std::setprecision(unit == 0 ? 0 : 2) << value << " "
+      << units[unit];
+  return out.str();
+}
+
+//////////////////////////////////////////////////
+/// \brief Get the CPU time used by this process.
+/// \return User plus system time in seconds or a negative value if it is
+/// not available.
+static double cpuTime()
+{
+#ifdef _WIN32
+  return -1;
+#else
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return -1;
+  return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+         usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+#endif
+}
+
+//////////////////////////////////////////////////
+/// \brief Get the topics used by the load generator and the sink.
+/// \param[in] _topic Base topic name.
+/// \param[in] _numTopics Number of topics.
+/// \return _topic if there is only one topic, or _topic/0, _topic/1...
+static std::vector<std::string> loadTopics(const std::string &_topic,
+  const int _numTopics)
+{
+  std::vector<std::string> topics;
+  if (_numTopics == 1)
+    topics.push_back(_topic);
+  else
+  {
+    for (int i = 0; i < _numTopics; ++i)
+      topics.push_back(_topic + "/" + std::to_string(i));
+  }
+  return topics;
+}
+
+/// \class LoadSink
+/// \brief Counts the messages received on the topics of the load generator
+/// and detects the lost ones using the sequence numbers of each publisher.
+class LoadSink
+{
+  /// \brief Raw subscription callback.
+  /// \param[in] _topic Topic name.
+  /// \param[in] _data Serialized message.
+  /// \param[in] _size Size of the message.
+  /// \param[in] _info Metadata of the message.
+  public: void OnMessage(const std::string &_topic, const char * /*_data*/,
+    const size_t _size, const MessageInfo &_info)
+  {
+    std::lock_guard<std::mutex> lk(this->mutex);
+    ++this->messages;
+    this->bytes += _size;
+
+    if (!_info.HasMetadata())
+      return;
+
+    // A lower sequence number means that the publisher was restarted.
+    auto &last = this->sequences[_info.GetPublisherAddress()][_topic];
+    if (last != 0 && _info.GetSequence() > last + 1)
+      this->lost += _info.GetSequence() - last - 1;
+    last = _info.GetSequence();
+  }
+
+  /// \brief Get the counters.
+  /// \param[out] _messages Messages received.
+  /// \param[out] _bytes Bytes received.
+  /// \param[out] _lost Messages lost.
+  public: void Counters(uint64_t &_messages, uint64_t &_bytes,
+    uint64_t &_lost)
+  {
+    std::lock_guard<std::mutex> lk(this->mutex);
+    _messages = this->messages;
+    _bytes = this->bytes;
+    _lost = this->lost;
+  }
+
+  /// \brief Messages received.
+  private: uint64_t messages = 0;
+
+  /// \brief Bytes received.
+  private: uint64_t bytes = 0;
+
+  /// \brief Messages lost.
+  private: uint64_t lost = 0;
+
+  /// \brief Last sequence number received. The first key is the publisher
+  /// address and the second key is the topic name.
+  private: std::map<std::string, std::map<std::string, uint64_t>> sequences;
+
+  /// \brief Protect the counters (the callback runs in the reception
+  /// thread).
+  private: std::mutex mutex;
+};
+
+/// \class TopicMonitor
+/// \brief Keeps the arrival time and the size of the last messages received
+/// on a topic and computes the publication rate and the bandwidth over this
+/// sliding window.
+class TopicMonitor
+{
+  /// \brief Constructor.
+  /// \param[in] _window Number of messages in the sliding window.
+  public: explicit TopicMonitor(const unsigned int _window)
+    : window(std::max(_window, 2u))
+  {
+  }
+
+  /// \brief Raw subscription callback.
+  /// \param[in] _topic Topic name.
+  /// \param[in] _data Serialized message.
+  /// \param[in] _size Size of the message.
+  /// \param[in] _info Metadata of the message.
+  public: void OnMessage(const std::string &/*_topic*/,
+    const char * /*_data*/, const size_t _size,
+    const MessageInfo &/*_info*/)
+  {
+    std::lock_guard<std::mutex> lk(this->mutex);
+    this->samples.push_back(Sample{std::chrono::steady_clock::now(), _size});
+    while (this->samples.size() > this->window)
+      this->samples.pop_front();
+    ++this->total;
+  }
+
+  /// \brief Print the publication rate, the minimum, maximum and standard
+  /// deviation of the period between messages.
+  public: void PrintRate()
+  {
+    std::lock_guard<std::mutex> lk(this->mutex);
+    if (!this->HasNewMessages())
+      return;
+
+    if (this->samples.size() < 2)
+    {
+      std::cout << "waiting for more messages" << std::endl;
+      return;
+    }
+
+    std::vector<double> periods;
+    for (size_t i = 1; i < this->samples.size(); ++i)
+    {
+      periods.push_back(std::chrono::duration<double>(
+        this->samples[i].time - this->samples[i - 1].time).count());
+    }
+
+    double sum = 0;
+    for (auto const &period : periods)
+      sum += period;
+    double mean = sum / periods.size();
+
+    double sqSum = 0;
+    for (auto const &period : periods)
+      sqSum += (period - mean) * (period - mean);
+    double stdDev = std::sqrt(sqSum / periods.size());
+
+    std::cout << std::fixed << std::setprecision(3)
+              << "average rate: " << (mean > 0 ? 1.0 / mean : 0) << " Hz"
+              << std::endl << std::setprecision(5)
+              << "\tmin: " << *std::min_element(periods.begin(), periods.end())
+              << "s max: " << *std::max_element(periods.begin(), periods.end())
+              << "s std dev: " << stdDev << "s window: "
+              << this->samples.size() << std::endl;
+  }
+
+  /// \brief Print the bandwidth and the mean, minimum and maximum message
+  /// size.
+  public: void PrintBandwidth()
+  {
+    std::lock_guard<std::mutex> lk(this->mutex);
+    if (!this->HasNewMessages())
+      return;
+
+    size_t bytes = 0;
+    size_t minSize = this->samples.front().size;
+    size_t maxSize = minSize;
+    for (auto const &sample : this->samples)
+    {
+      bytes += sample.size;
+      minSize = std::min(minSize, sample.size);
+      maxSize = std::max(maxSize, sample.size);
+    }
+
+    // Use the current time, so the bandwidth decreases when the publisher
+    // slows down.
+    double elapsed = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - this->samples.front().time).count();
+
+    std::cout << "average: "
+              << formatBytes(elapsed > 0 ? bytes / elapsed : 0) << "/s"
+              << std::endl
+              << "\tmean: " << formatBytes(
+                   static_cast<double>(bytes) / this->samples.size())
+              << " min: " << formatBytes(minSize)
+              << " max: " << formatBytes(maxSize)
+              << " window: " << this->samples.size() << std::endl;
+  }
+
+  /// \brief Check if new messages arrived since the last call.
+  /// \return True if there are new messages.
+  private: bool HasNewMessages()
+  {
+    if (this->total == this->lastTotal)
+    {
+      std::cout << "no new messages" << std::endl;
+      return false;
+    }
+    this->lastTotal = this->total;
+    return true;
+  }
+
+  /// \brief Arrival time and size of a message.
+  private: struct Sample
+  {
+    /// \brief Arrival time.
+    std::chrono::steady_clock::time_point time;
+
+    /// \brief Size of the serialized message.
+    size_t size;
+  };
+
+  /// \brief Number of messages in the sliding window.
+  private: unsigned int window;
+
+  /// \brief Messages in the sliding window.
+  private: std::deque<Sample> samples;
+
+  /// \brief Total number of messages received.
+  private: uint64_t total = 0;
+
+  /// \brief Value of 'total' during the last print.
+  private: uint64_t lastTotal = 0;
+
+  /// \brief Protect the samples (the callback runs in the reception thread).
+  private: std::mutex mutex;
+};
+
+//////////////////////////////////////////////////
+/// \brief Subscribe to a topic and print its rate or bandwidth once per
+/// second until the user interrupts the command or the duration expires.
+/// \param[in] _topic Topic name.
+/// \param[in] _window Number of messages in the sliding window.
+/// \param[in] _duration Duration in seconds (0 for no limit).
+/// \param[in] _bandwidth True to print the bandwidth, false for the rate.
+static void monitorTopic(const char *_topic, const int _window,
+  const int _duration, const bool _bandwidth)
+{
+  if (!_topic || _window <= 0 || _duration < 0)
+  {
+    std::cerr << "Invalid arguments" << std::endl;
+    return;
+  }
+
+  TopicMonitor monitor(_window);
   Node node;
+  if (!node.SubscribeRaw(_topic, std::bind(&TopicMonitor::OnMessage,
+        &monitor, std::placeholders::_1, std::placeholders::_2,
+        std::placeholders::_3, std::placeholders::_4)))
+  {
+    return;
+  }
+
+  monitorInterrupted = 0;
+  auto prevInt = std::signal(SIGINT, monitorSignalHandler);
+  auto prevTerm = std::signal(SIGTERM, monitorSignalHandler);
+
+  auto start = std::chrono::steady_clock::now();
+  auto next = start;
+  while (!monitorInterrupted)
+  {
+    next += std::chrono::seconds(1);
+    while (!monitorInterrupted && std::chrono::steady_clock::now() < next)
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    if (monitorInterrupted)
+      break;
+
+    if (_bandwidth)
+      monitor.PrintBandwidth();
+    else
+      monitor.PrintRate();
+
+    if (_duration > 0 && next - start >= std::chrono::seconds(_duration))
+      break;
+  }
+
+  node.Unsubscribe(_topic);
+  std::signal(SIGINT, prevInt);
+  std::signal(SIGTERM, prevTerm);
+}
+
+//////////////////////////////////////////////////
+/// \brief Ask the other processes of the node's partition to advertise
+/// their topics and services, and wait for the answers.
+/// \param[in] _node Node.
+/// \param[in] _maxWait Maximum waiting time (ms).
+static void discoverAll(const Node &_node, const int _maxWait)
+{
+  std::string prefix;
+  if (!TopicUtils::GetFullyQualifiedName(_node.Partition(), "", "/x", prefix))
+    return;
+  prefix.erase(prefix.find_last_of("@") + 1);
 
-  // Give the node some time to receive topic updates.
-  std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+  NodeShared::GetInstance()->discovery->DiscoverAll(prefix,
+    static_cast<unsigned int>(std::max(_maxWait, 0)));
+}
+
+//////////////////////////////////////////////////
+extern "C" IGNITION_VISIBLE void cmdTopicList(const int _maxWait)
+{
+  Node node;
+  discoverAll(node, _maxWait);
 
   std::vector<std::string> topics;
   node.GetTopicList(topics);
@@ -40,12 +398,10 @@ extern "C" IGNITION_VISIBLE void cmdTopicList()
 }
 
 //////////////////////////////////////////////////
-extern "C" IGNITION_VISIBLE void cmdServiceList()
+extern "C" IGNITION_VISIBLE void cmdServiceList(const int _maxWait)
 {
   Node node;
-
-  // Give the node some time to receive topic updates.
-  std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+  discoverAll(node, _maxWait);
 
   std::vector<std::string> services;
   node.GetServiceList(services);
@@ -54,6 +410,449 @@ extern "C" IGNITION_VISIBLE void cmdServiceList()
     std::cout << service << std::endl;
 }
 
+//////////////////////////////////////////////////
+extern "C" IGNITION_VISIBLE void cmdStats(const int _maxWait)
+{
+  Node node;
+  std::vector<ProcessState> states;
+  node.GetProcessStates(static_cast<unsigned int>(std::max(_maxWait, 0)),
+    states);
+
+  /// \brief Totals of a topic over all the processes.
+  struct TopicTotals
+  {
+    unsigned int publishers = 0;
+    unsigned int subscribers = 0;
+    uint64_t published = 0;
+    uint64_t received = 0;
+    uint64_t bytes = 0;
+    uint64_t lost = 0;
+  };
+  std::map<std::string, TopicTotals> totals;
+
+  for (auto const &state : states)
+  {
+    std::cout << "Process " << state.pUuid << " (pid " << state.pid
+              << ", " << state.hostAddr << ")\n"
+              << "  CPU: " << std::fixed << std::setprecision(2)
+              << state.cpuTime / 1e9 << " s, connections: "
+              << state.connections << "\n  Threads:";
+    for (auto const &thread : state.threads)
+    {
+      std::cout << " " << thread.first << " " << std::setprecision(2)
+                << thread.second / 1e9 << " s";
+    }
+    std::cout << "\n";
+
+    for (auto const &topic : state.topics)
+    {
+      auto const &s = topic.stats;
+      std::cout << "  Topic " << topic.name << " ["
+                << (topic.advertised ? "P" : "-")
+                << (topic.subscribed ? "S" : "-") << "] published: "
+                << s.published << " received: " << s.received
+                << " dropped: " << s.dropped << " lost: " << s.lost
+                << " queued: " << s.queuedMessages << " ("
+                << formatBytes(s.queuedBytes) << ") remote subscribers: "
+                << topic.remoteSubscribers << "\n";
+
+      auto &total = totals[topic.name];
+      total.publishers += topic.advertised;
+      total.subscribers += topic.subscribed;
+      total.published += s.published;
+      total.received += s.received;
+      total.bytes += s.bytesPublished;
+      total.lost += s.lost;
+    }
+
+    for (auto const &service : state.services)
+    {
+      auto const &s = service.stats;
+      std::cout << "  Service " << service.name << " ["
+                << (service.advertised ? "R" : "-") << "] requests: "
+                << s.requests << " served: " << s.served << " timeouts: "
+                << s.timeouts << "\n";
+    }
+  }
+
+  std::cout << "\n" << states.size() << " processes\n";
+  for (auto const &topic : totals)
+  {
+    auto const &t = topic.second;
+    std::cout << "  " << topic.first << ": " << t.publishers
+              << " publishers, " << t.subscribers << " subscribers, "
+              << t.published << " published (" << formatBytes(t.bytes)
+              << "), " << t.received << " received, " << t.lost << " lost\n";
+  }
+  std::cout << std::flush;
+}
+
+//////////////////////////////////////////////////
+extern "C" IGNITION_VISIBLE void cmdTopicHz(const char *_topic,
+  const int _window, const int _duration)
+{
+  monitorTopic(_topic, _window, _duration, false);
+}
+
+//////////////////////////////////////////////////
+extern "C" IGNITION_VISIBLE void cmdTopicBw(const char *_topic,
+  const int _window, const int _duration)
+{
+  monitorTopic(_topic, _window, _duration, true);
+}
+
+//////////////////////////////////////////////////
+extern "C" IGNITION_VISIBLE void cmdTopicRecord(const char *_dir,
+  const char *_topic, const int _duration)
+{
+  if (!_dir || _duration < 0)
+  {
+    std::cerr << "Invalid arguments" << std::endl;
+    return;
+  }
+
+  std::vector<std::string> topics;
+  if (_topic && std::string(_topic) != "")
+    topics.push_back(_topic);
+
+  Recorder recorder;
+  if (!recorder.Start(_dir, topics))
+    return;
+
+  monitorInterrupted = 0;
+  auto prevInt = std::signal(SIGINT, monitorSignalHandler);
+  auto prevTerm = std::signal(SIGTERM, monitorSignalHandler);
+
+  std::cout << "Recording into [" << _dir << "]. Press Ctrl-C to stop."
+            << std::endl;
+
+  auto start = std::chrono::steady_clock::now();
+  while (!monitorInterrupted && (_duration == 0 ||
+         std::chrono::steady_clock::now() - start <
+           std::chrono::seconds(_duration)))
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+
+  recorder.Stop();
+  std::signal(SIGINT, prevInt);
+  std::signal(SIGTERM, prevTerm);
+
+  double elapsed = std::chrono::duration<double>(
+    std::chrono::steady_clock::now() - start).count();
+  std::cout << "Recorded " << recorder.GetMessages() << " messages ("
+            << formatBytes(recorder.GetBytes()) << ") in " << std::fixed
+            << std::setprecision(1) << elapsed << " s";
+  if (recorder.GetDropped() > 0)
+    std::cout << ", " << recorder.GetDropped() << " dropped";
+  std::cout << std::endl;
+}
+
+//////////////////////////////////////////////////
+extern "C" IGNITION_VISIBLE void cmdTopicPlay(const char *_dir,
+  const double _rate)
+{
+  if (!_dir || _rate < 0)
+  {
+    std::cerr << "Invalid arguments" << std::endl;
+    return;
+  }
+
+  Player player;
+  if (!player.Open(_dir))
+    return;
+
+  const LogReader &log = player.GetLog();
+  std::cout << "Playing " << log.GetMessages() << " messages on "
+            << log.GetTopics().size() << " topics from [" << _dir << "]. "
+            << "Press Ctrl-C to stop." << std::endl;
+
+  monitorInterrupted = 0;
+  auto prevInt = std::signal(SIGINT, monitorSignalHandler);
+  auto prevTerm = std::signal(SIGTERM, monitorSignalHandler);
+
+  // Give the remote subscribers some time to connect.
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+
+  std::atomic<bool> done(false);
+  std::thread playThread([&]
+    {
+      player.Play(_rate);
+      done = true;
+    });
+
+  while (!done)
+  {
+    if (monitorInterrupted)
+      player.Stop();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+  playThread.join();
+
+  std::signal(SIGINT, prevInt);
+  std::signal(SIGTERM, prevTerm);
+
+  std::cout << "Published " << player.GetMessages() << " messages ("
+            << formatBytes(player.GetBytes()) << ") in " << std::fixed
+            << std::setprecision(3) << player.GetDuration() / 1e9 << " s";
+  if (_rate > 0)
+  {
+    std::cout << " (requested " << player.GetRequestedDuration() / 1e9
+              << " s). Timing error: mean "
+              << player.GetMeanError() / 1e3 << " us, max "
+              << player.GetMaxError() / 1e3 << " us";
+  }
+  std::cout << std::endl;
+}
+
+//////////////////////////////////////////////////
+extern "C" IGNITION_VISIBLE void cmdTopicPub(const char *_topic,
+  const int _numTopics, const double _rate, const int _size,
+  const int _duration)
+{
+  if (!_topic || _numTopics <= 0 || _rate < 0 || _size < 0 || _duration < 0)
+  {
+    std::cerr << "Invalid arguments" << std::endl;
+    return;
+  }
+
+  // The payload is opaque: the load generator only measures the transport.
+  const std::string type = "ignition.transport.Load";
+  std::string payload(_size, 'x');
+
+  Node node;
+  std::vector<std::string> topics = loadTopics(_topic, _numTopics);
+  for (auto const &topic : topics)
+  {
+    if (!node.Advertise(topic))
+      return;
+  }
+
+  monitorInterrupted = 0;
+  auto prevInt = std::signal(SIGINT, monitorSignalHandler);
+  auto prevTerm = std::signal(SIGTERM, monitorSignalHandler);
+
+  std::cout << "Publishing " << formatBytes(_size) << " messages on "
+            << topics.size() << " topics at ";
+  if (_rate > 0)
+    std::cout << _rate << " Hz per topic.";
+  else
+    std::cout << "full speed.";
+  std::cout << " Press Ctrl-C to stop." << std::endl;
+
+  // Give the subscribers some time to connect.
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+
+  uint64_t messages = 0;
+  uint64_t lastMessages = 0;
+  uint64_t maxDelay = 0;
+  std::chrono::nanoseconds pubTime(0);
+  std::chrono::nanoseconds lastPubTime(0);
+  std::chrono::nanoseconds maxPubTime(0);
+
+  Pacer pacer(_rate);
+  auto start = std::chrono::steady_clock::now();
+  auto last = start;
+  double startCpu = cpuTime();
+  double lastCpu = startCpu;
+  pacer.Reset();
+  while (!monitorInterrupted)
+  {
+    maxDelay = std::max(maxDelay, pacer.Wait());
+
+    for (auto const &topic : topics)
+    {
+      auto before = std::chrono::steady_clock::now();
+      node.PublishRaw(topic, payload.data(), payload.size(), type);
+      auto elapsed = std::chrono::steady_clock::now() - before;
+      pubTime += elapsed;
+      maxPubTime = std::max<std::chrono::nanoseconds>(maxPubTime, elapsed);
+    }
+    messages += topics.size();
+
+    auto now = std::chrono::steady_clock::now();
+    if (now - last < std::chrono::seconds(1))
+      continue;
+
+    // Report once per second.
+    double elapsed = std::chrono::duration<double>(now - last).count();
+    double cpu = cpuTime();
+    double rate = (messages - lastMessages) / elapsed;
+    std::cout << std::fixed << std::setprecision(1)
+              << "rate: " << rate << " msg/s ("
+              << formatBytes(rate * _size) << "/s) publish: "
+              << 100.0 * std::chrono::duration<double>(
+                   pubTime - lastPubTime).count() / elapsed
+              << "% of the time, max "
+              << std::chrono::duration<double, std::micro>(maxPubTime).count()
+              << " us. max delay: " << maxDelay / 1e3 << " us.";
+    if (cpu >= 0)
+      std::cout << " cpu: " << 100.0 * (cpu - lastCpu) / elapsed << "%";
+    std::cout << std::endl;
+
+    last = now;
+    lastCpu = cpu;
+    lastMessages = messages;
+    lastPubTime = pubTime;
+    maxPubTime = std::chrono::nanoseconds(0);
+    maxDelay = 0;
+
+    if (_duration > 0 && now - start >= std::chrono::seconds(_duration))
+      break;
+  }
+
+  std::signal(SIGINT, prevInt);
+  std::signal(SIGTERM, prevTerm);
+
+  double elapsed = std::chrono::duration<double>(
+    std::chrono::steady_clock::now() - start).count();
+  std::cout << "Published " << messages << " messages in " << std::fixed
+            << std::setprecision(1) << elapsed << " s ("
+            << messages / elapsed << " msg/s";
+  if (_rate > 0)
+    std::cout << ", requested " << _rate * topics.size() << " msg/s";
+  std::cout << ")";
+  double cpu = cpuTime();
+  if (cpu >= 0)
+    std::cout << ". cpu: " << 100.0 * (cpu - startCpu) / elapsed << "%";
+  std::cout << std::endl;
+}
+
+//////////////////////////////////////////////////
+extern "C" IGNITION_VISIBLE void cmdTopicSink(const char *_topic,
+  const int _numTopics, const int _duration)
+{
+  if (!_topic || _numTopics <= 0 || _duration < 0)
+  {
+    std::cerr << "Invalid arguments" << std::endl;
+    return;
+  }
+
+  LoadSink sink;
+  Node node;
+  std::vector<std::string> topics = loadTopics(_topic, _numTopics);
+  for (auto const &topic : topics)
+  {
+    if (!node.SubscribeRaw(topic, std::bind(&LoadSink::OnMessage, &sink,
+          std::placeholders::_1, std::placeholders::_2,
+          std::placeholders::_3, std::placeholders::_4)))
+    {
+      return;
+    }
+  }
+
+  monitorInterrupted = 0;
+  auto prevInt = std::signal(SIGINT, monitorSignalHandler);
+  auto prevTerm = std::signal(SIGTERM, monitorSignalHandler);
+
+  uint64_t messages = 0;
+  uint64_t bytes = 0;
+  uint64_t lost = 0;
+  uint64_t lastMessages = 0;
+  uint64_t lastBytes = 0;
+  uint64_t lastLost = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  auto next = start;
+  while (!monitorInterrupted)
+  {
+    next += std::chrono::seconds(1);
+    while (!monitorInterrupted && std::chrono::steady_clock::now() < next)
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    if (monitorInterrupted)
+      break;
+
+    sink.Counters(messages, bytes, lost);
+    std::cout << "rate: " << messages - lastMessages << " msg/s ("
+              << formatBytes(bytes - lastBytes) << "/s) lost: "
+              << lost - lastLost << std::endl;
+    lastMessages = messages;
+    lastBytes = bytes;
+    lastLost = lost;
+
+    if (_duration > 0 && next - start >= std::chrono::seconds(_duration))
+      break;
+  }
+
+  for (auto const &topic : topics)
+    node.Unsubscribe(topic);
+  std::signal(SIGINT, prevInt);
+  std::signal(SIGTERM, prevTerm);
+
+  sink.Counters(messages, bytes, lost);
+  std::cout << "Received " << messages << " messages ("
+            << formatBytes(bytes) << "), lost " << lost;
+  if (messages + lost > 0)
+  {
+    std::cout << " (" << std::fixed << std::setprecision(2)
+              << 100.0 * lost / (messages + lost) << "%)";
+  }
+  std::cout << std::endl;
+}
+
+//////////////////////////////////////////////////
+extern "C" IGNITION_VISIBLE void cmdTopicRelay(const char *_topics,
+  const int _duration)
+{
+  if (!_topics || _duration < 0)
+  {
+    std::cerr << "Invalid arguments" << std::endl;
+    return;
+  }
+
+  std::vector<std::string> topics;
+  std::istringstream in(_topics);
+  std::string topic;
+  while (std::getline(in, topic, ','))
+  {
+    if (!topic.empty())
+      topics.push_back(topic);
+  }
+
+  Relay relay;
+  if (!relay.Start(topics))
+    return;
+
+  monitorInterrupted = 0;
+  auto prevInt = std::signal(SIGINT, monitorSignalHandler);
+  auto prevTerm = std::signal(SIGTERM, monitorSignalHandler);
+
+  std::cout << "Relaying " << topics.size() << " topics. Press Ctrl-C to "
+            << "stop." << std::endl;
+
+  uint64_t lastMessages = 0;
+  uint64_t lastBytes = 0;
+  auto start = std::chrono::steady_clock::now();
+  auto next = start;
+  while (!monitorInterrupted)
+  {
+    next += std::chrono::seconds(1);
+    while (!monitorInterrupted && std::chrono::steady_clock::now() < next)
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    if (monitorInterrupted)
+      break;
+
+    uint64_t messages = relay.GetMessages();
+    uint64_t bytes = relay.GetBytes();
+    std::cout << "relayed: " << messages - lastMessages << " msg/s ("
+              << formatBytes(bytes - lastBytes) << "/s)" << std::endl;
+    lastMessages = messages;
+    lastBytes = bytes;
+
+    if (_duration > 0 && next - start >= std::chrono::seconds(_duration))
+      break;
+  }
+
+  relay.Stop();
+  std::signal(SIGINT, prevInt);
+  std::signal(SIGTERM, prevTerm);
+
+  std::cout << "Relayed " << relay.GetMessages() << " messages ("
+            << formatBytes(relay.GetBytes()) << ")" << std::endl;
+}
+
 //////////////////////////////////////////////////
 extern "C" IGNITION_VISIBLE char *ignitionVersion()
 {
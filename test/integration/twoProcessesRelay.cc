@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2015 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "ignition/transport/MessageInfo.hh"
+#include "ignition/transport/Node.hh"
+#include "gtest/gtest.h"
+#include "ignition/transport/test_config.h"
+
+using namespace ignition;
+
+std::string partition;
+std::string relayedTopic = "/relayed";
+std::string directTopic = "/direct";
+
+std::mutex mutex;
+std::condition_variable condition;
+std::string originAddr;
+uint64_t relayedMsgs = 0;
+uint64_t msgsFromRelay = 0;
+
+//////////////////////////////////////////////////
+/// \brief Callback of the topic published only by the original publisher.
+void onDirect(const std::string &/*_topic*/, const char * /*_data*/,
+  const size_t /*_size*/, const transport::MessageInfo &_info)
+{
+  std::lock_guard<std::mutex> lk(mutex);
+  originAddr = _info.GetPublisherAddress();
+  condition.notify_all();
+}
+
+//////////////////////////////////////////////////
+/// \brief Callback of the relayed topic.
+void onRelayed(const std::string &/*_topic*/, const char * /*_data*/,
+  const size_t /*_size*/, const transport::MessageInfo &_info)
+{
+  std::lock_guard<std::mutex> lk(mutex);
+  ++relayedMsgs;
+  if (!originAddr.empty() && _info.GetPublisherAddress() != originAddr)
+    ++msgsFromRelay;
+  condition.notify_all();
+}
+
+//////////////////////////////////////////////////
+/// \brief Once the relay is used, the original publisher must stop sending
+/// the relayed topic to this process, even if the connection is still used
+/// by another topic.
+TEST(twoProcRelay, OriginStopsSendingRelayedTopic)
+{
+  std::string relayPath = testing::portablePathUnion(
+     PROJECT_BINARY_PATH,
+     "test/integration/INTEGRATION_twoProcessesRelay_aux");
+  std::string publisherPath = testing::portablePathUnion(
+     PROJECT_BINARY_PATH,
+     "test/integration/INTEGRATION_twoProcessesRelayPublisher_aux");
+
+  testing::forkHandlerType relayPi = testing::forkAndRun(relayPath.c_str(),
+    partition.c_str());
+  testing::forkHandlerType publisherPi = testing::forkAndRun(
+    publisherPath.c_str(), partition.c_str());
+
+  transport::Node node;
+  EXPECT_TRUE(node.SubscribeRaw(directTopic, onDirect));
+  EXPECT_TRUE(node.SubscribeRaw(relayedTopic, onRelayed));
+
+  {
+    std::unique_lock<std::mutex> lk(mutex);
+    EXPECT_TRUE(condition.wait_for(lk, std::chrono::seconds(10),
+      []{return msgsFromRelay >= 20;}));
+  }
+
+  // Give the original publisher some time to process the changes.
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+  // The received counter includes the copies of the original publisher
+  // discarded by the reception thread.
+  transport::TopicStatistics before;
+  EXPECT_TRUE(node.GetTopicStats(relayedTopic, before));
+  uint64_t delivered;
+  {
+    std::unique_lock<std::mutex> lk(mutex);
+    delivered = relayedMsgs;
+    EXPECT_TRUE(condition.wait_for(lk, std::chrono::seconds(10),
+      [&]{return relayedMsgs >= delivered + 100;}));
+    delivered = relayedMsgs - delivered;
+  }
+  transport::TopicStatistics after;
+  EXPECT_TRUE(node.GetTopicStats(relayedTopic, after));
+
+  // A few messages might be counted but not delivered yet.
+  EXPECT_LE(after.received - before.received, delivered + 5);
+
+  testing::killFork(publisherPi);
+  testing::waitAndCleanupFork(publisherPi);
+  testing::killFork(relayPi);
+  testing::waitAndCleanupFork(relayPi);
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  // Get a random partition name.
+  partition = testing::getRandomPartition();
+
+  // Set the partition name for this process.
+  setenv("IGN_PARTITION", partition.c_str(), 1);
+
+  // Receive the relayed topics through the relay.
+  setenv("IGN_TRANSPORT_PREFER_RELAY", "1", 1);
+
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
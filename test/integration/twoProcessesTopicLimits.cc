@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2015 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include "ignition/transport/Node.hh"
+#include "gtest/gtest.h"
+#include "ignition/transport/test_config.h"
+#include "msg/int.pb.h"
+
+using namespace ignition;
+
+std::string partition;
+std::string slowTopic = "/slow";
+std::string fastTopic = "/fast";
+
+std::mutex mutex;
+std::condition_variable condition;
+int slowMsgs = 0;
+int fastMsgs = 0;
+bool release = false;
+
+//////////////////////////////////////////////////
+/// \brief Callback of the topic with limits. It blocks the dispatch thread
+/// until the test releases it.
+void onSlow(const std::string &/*_topic*/, const transport::msgs::Int &/*_msg*/)
+{
+  std::unique_lock<std::mutex> lk(mutex);
+  ++slowMsgs;
+  condition.notify_all();
+  condition.wait_for(lk, std::chrono::seconds(10), []{return release;});
+}
+
+//////////////////////////////////////////////////
+/// \brief Callback of the topic without limits.
+void onFast(const std::string &/*_topic*/, const transport::msgs::Int &/*_msg*/)
+{
+  std::lock_guard<std::mutex> lk(mutex);
+  ++fastMsgs;
+  condition.notify_all();
+}
+
+//////////////////////////////////////////////////
+/// \brief A slow callback on a topic with limits should not stall the
+/// reception of the rest of the topics. The messages of the slow topic are
+/// queued and dropped according to its limits.
+TEST(twoProcTopicLimits, SlowCallbackDoesNotBlockOtherTopics)
+{
+  std::string publisherPath = testing::portablePathUnion(
+     PROJECT_BINARY_PATH,
+     "test/integration/INTEGRATION_twoProcessesTopicLimitsPublisher_aux");
+
+  testing::forkHandlerType pi = testing::forkAndRun(publisherPath.c_str(),
+    partition.c_str());
+
+  transport::QueueLimits limits;
+  limits.maxMessages = 5;
+  limits.policy = transport::DropPolicy::DropOldest;
+
+  transport::Node node;
+  EXPECT_TRUE(node.SetTopicLimits(slowTopic, limits));
+  EXPECT_TRUE(node.Subscribe(slowTopic, onSlow));
+  EXPECT_TRUE(node.Subscribe(fastTopic, onFast));
+
+  {
+    std::unique_lock<std::mutex> lk(mutex);
+
+    // Wait until the dispatch thread is blocked in the slow callback.
+    EXPECT_TRUE(condition.wait_for(lk, std::chrono::seconds(10),
+      []{return slowMsgs > 0;}));
+
+    // The messages of the other topic keep arriving.
+    int fastBefore = fastMsgs;
+    EXPECT_TRUE(condition.wait_for(lk, std::chrono::seconds(5),
+      [&]{return fastMsgs >= fastBefore + 50;}));
+
+    release = true;
+  }
+  condition.notify_all();
+
+  // The slow topic was received while its callback was blocked, so its
+  // queue overflowed.
+  transport::TopicStatistics stats;
+  EXPECT_TRUE(node.GetTopicStats(slowTopic, stats));
+  EXPECT_GT(stats.dropped, 0u);
+  EXPECT_GT(stats.limitReached, 0u);
+
+  testing::killFork(pi);
+  testing::waitAndCleanupFork(pi);
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  // Get a random partition name.
+  partition = testing::getRandomPartition();
+
+  // Set the partition name for this process.
+  setenv("IGN_PARTITION", partition.c_str(), 1);
+
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2015 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include "ignition/transport/Node.hh"
+#include "ignition/transport/test_config.h"
+#include "msg/int.pb.h"
+
+using namespace ignition;
+
+std::string slowTopic = "/slow";
+std::string fastTopic = "/fast";
+
+//////////////////////////////////////////////////
+/// \brief Publish on both topics at a constant rate.
+void advertiseAndPublish()
+{
+  transport::msgs::Int msg;
+  transport::Node node;
+  node.Advertise(slowTopic);
+  node.Advertise(fastTopic);
+
+  for (int i = 0; i < 1000; ++i)
+  {
+    msg.set_data(i);
+    node.Publish(slowTopic, msg);
+    node.Publish(fastTopic, msg);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  if (argc != 2)
+  {
+    std::cerr << "Partition name has not be passed as argument" << std::endl;
+    return -1;
+  }
+
+  // Set the partition name for this test.
+  setenv("IGN_PARTITION", argv[1], 1);
+
+  advertiseAndPublish();
+}
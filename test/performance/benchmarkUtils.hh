@@ -0,0 +1,347 @@
+/*
+ * Copyright (C) 2014 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef __IGN_TRANSPORT_TEST_BENCHMARK_UTILS_HH_INCLUDED__
+#define __IGN_TRANSPORT_TEST_BENCHMARK_UTILS_HH_INCLUDED__
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "ignition/transport/test_config.h"
+
+namespace testing
+{
+  namespace perf
+  {
+    /// \brief Summary of a set of latency samples (microseconds).
+    struct Stats
+    {
+      /// \brief Number of samples.
+      size_t samples = 0;
+
+      /// \brief Minimum value.
+      double min = 0;
+
+      /// \brief Average value.
+      double mean = 0;
+
+      /// \brief Median.
+      double p50 = 0;
+
+      /// \brief 99th percentile.
+      double p99 = 0;
+
+      /// \brief 99.9th percentile.
+      double p999 = 0;
+
+      /// \brief Maximum value.
+      double max = 0;
+    };
+
+    /// \brief Get a percentile from a sorted list of samples using the
+    /// nearest-rank method.
+    /// \param[in] _sorted Samples sorted in ascending order.
+    /// \param[in] _p Percentile in the range (0, 1].
+    /// \return The percentile value.
+    inline double percentile(const std::vector<double> &_sorted,
+      const double _p)
+    {
+      if (_sorted.empty())
+        return 0;
+
+      size_t rank = static_cast<size_t>(std::ceil(_p * _sorted.size()));
+      rank = std::max<size_t>(rank, 1);
+      return _sorted[std::min(rank, _sorted.size()) - 1];
+    }
+
+    /// \brief Compute the statistics of a set of samples.
+    /// \param[in] _samples Samples (microseconds).
+    /// \return The statistics.
+    inline Stats computeStats(std::vector<double> _samples)
+    {
+      Stats stats;
+      if (_samples.empty())
+        return stats;
+
+      std::sort(_samples.begin(), _samples.end());
+      double sum = 0;
+      for (auto const &s : _samples)
+        sum += s;
+
+      stats.samples = _samples.size();
+      stats.min = _samples.front();
+      stats.max = _samples.back();
+      stats.mean = sum / _samples.size();
+      stats.p50 = percentile(_samples, 0.5);
+      stats.p99 = percentile(_samples, 0.99);
+      stats.p999 = percentile(_samples, 0.999);
+      return stats;
+    }
+
+    /// \brief Compute a latency histogram with power of two buckets.
+    /// \param[in] _samples Samples (microseconds).
+    /// \return List of {bucket upper bound (us), number of samples}. Empty
+    /// buckets are not included.
+    inline std::vector<std::pair<double, size_t>> histogram(
+      const std::vector<double> &_samples)
+    {
+      std::vector<size_t> counts;
+      for (auto const &s : _samples)
+      {
+        size_t bucket = 0;
+        while ((1u << bucket) < s && bucket < 31)
+          ++bucket;
+        if (counts.size() <= bucket)
+          counts.resize(bucket + 1, 0);
+        ++counts[bucket];
+      }
+
+      std::vector<std::pair<double, size_t>> result;
+      for (size_t i = 0; i < counts.size(); ++i)
+      {
+        if (counts[i] > 0)
+          result.push_back(std::make_pair(double(1u << i), counts[i]));
+      }
+      return result;
+    }
+
+    /// \brief Get a numeric parameter from an environment variable.
+    /// \param[in] _name Name of the environment variable.
+    /// \param[in] _default Value used when the variable is not set.
+    /// \return The value of the parameter.
+    inline unsigned int envParam(const char *_name,
+      const unsigned int _default)
+    {
+      char *env = std::getenv(_name);
+      if (!env)
+        return _default;
+      return static_cast<unsigned int>(std::strtoul(env, nullptr, 10));
+    }
+
+    /// \brief Get the list of payload sizes to evaluate: from 16 B to 16 MB
+    /// multiplying by 4. The maximum size can be reduced using the
+    /// IGN_PERF_MAX_SIZE environment variable (bytes).
+    /// \return The list of sizes in bytes.
+    inline std::vector<size_t> payloadSizes()
+    {
+      size_t maxSize = 16 * 1024 * 1024;
+      char *env = std::getenv("IGN_PERF_MAX_SIZE");
+      if (env)
+        maxSize = std::strtoul(env, nullptr, 10);
+
+      std::vector<size_t> sizes;
+      for (size_t size = 16; size <= maxSize; size *= 4)
+        sizes.push_back(size);
+      return sizes;
+    }
+
+    /// \brief Get the number of iterations for a payload size. The number of
+    /// iterations decreases with the size, so each test moves ~256 MB.
+    /// \param[in] _size Payload size in bytes.
+    /// \param[in] _max Maximum number of iterations.
+    /// \return Number of iterations.
+    inline unsigned int iterations(const size_t _size, const unsigned int _max)
+    {
+      const size_t budget = 256 * 1024 * 1024;
+      size_t iters = budget / std::max<size_t>(_size, 1);
+      return static_cast<unsigned int>(
+        std::max<size_t>(10, std::min<size_t>(iters, _max)));
+    }
+
+    /// \brief Minimal JSON object writer.
+    class JsonObject
+    {
+      /// \brief Set a string value.
+      /// \param[in] _key Key.
+      /// \param[in] _value Value.
+      /// \return Reference to this object.
+      public: JsonObject &Set(const std::string &_key,
+                              const std::string &_value)
+      {
+        return this->SetRaw(_key, "\"" + _value + "\"");
+      }
+
+      /// \brief Set a numeric value.
+      /// \param[in] _key Key.
+      /// \param[in] _value Value.
+      /// \return Reference to this object.
+      public: JsonObject &Set(const std::string &_key, const double _value)
+      {
+        std::ostringstream out;
+        out << std::setprecision(12) << _value;
+        return this->SetRaw(_key, out.str());
+      }
+
+      /// \brief Set a nested object.
+      /// \param[in] _key Key.
+      /// \param[in] _value Value.
+      /// \return Reference to this object.
+      public: JsonObject &Set(const std::string &_key,
+                              const JsonObject &_value)
+      {
+        return this->SetRaw(_key, _value.Str());
+      }
+
+      /// \brief Set a value that is already serialized.
+      /// \param[in] _key Key.
+      /// \param[in] _value Serialized JSON value.
+      /// \return Reference to this object.
+      public: JsonObject &SetRaw(const std::string &_key,
+                                 const std::string &_value)
+      {
+        this->fields.push_back(std::make_pair(_key, _value));
+        return *this;
+      }
+
+      /// \brief Serialize the object.
+      /// \return The JSON string.
+      public: std::string Str() const
+      {
+        std::string out = "{";
+        for (size_t i = 0; i < this->fields.size(); ++i)
+        {
+          if (i > 0)
+            out += ", ";
+          out += "\"" + this->fields[i].first + "\": " + this->fields[i].second;
+        }
+        return out + "}";
+      }
+
+      /// \brief Keys and serialized values.
+      private: std::vector<std::pair<std::string, std::string>> fields;
+    };
+
+    /// \brief Serialize latency statistics.
+    /// \param[in] _stats Statistics.
+    /// \return JSON object.
+    inline JsonObject toJson(const Stats &_stats)
+    {
+      JsonObject obj;
+      obj.Set("samples", static_cast<double>(_stats.samples))
+         .Set("min", _stats.min)
+         .Set("mean", _stats.mean)
+         .Set("p50", _stats.p50)
+         .Set("p99", _stats.p99)
+         .Set("p99.9", _stats.p999)
+         .Set("max", _stats.max);
+      return obj;
+    }
+
+    /// \brief Serialize a histogram.
+    /// \param[in] _histogram Histogram.
+    /// \return JSON array.
+    inline std::string toJson(
+      const std::vector<std::pair<double, size_t>> &_histogram)
+    {
+      std::string out = "[";
+      for (size_t i = 0; i < _histogram.size(); ++i)
+      {
+        if (i > 0)
+          out += ", ";
+        JsonObject bucket;
+        bucket.Set("le_us", _histogram[i].first)
+              .Set("count", static_cast<double>(_histogram[i].second));
+        out += bucket.Str();
+      }
+      return out + "]";
+    }
+
+    /// \brief Collects the results of a benchmark and writes them as JSON.
+    /// The file is written in the directory set in the IGN_PERF_RESULTS_DIR
+    /// environment variable or in <build>/test_results by default.
+    class Report
+    {
+      /// \brief Constructor.
+      /// \param[in] _name Benchmark name. Used as the file name.
+      public: explicit Report(const std::string &_name)
+        : name(_name)
+      {
+      }
+
+      /// \brief Add a result.
+      /// \param[in] _result Result.
+      public: void Add(const JsonObject &_result)
+      {
+        this->results.push_back(_result);
+      }
+
+      /// \brief Write the report.
+      /// \return True if the file was written.
+      public: bool Write() const
+      {
+        std::string dir = portablePathUnion(PROJECT_BINARY_PATH,
+          "test_results");
+        char *env = std::getenv("IGN_PERF_RESULTS_DIR");
+        if (env)
+          dir = env;
+
+        std::string path = portablePathUnion(dir, this->name + ".json");
+        std::ofstream out(path);
+        if (!out)
+        {
+          std::cerr << "Unable to write [" << path << "]" << std::endl;
+          return false;
+        }
+
+        out << "{\"benchmark\": \"" << this->name << "\", \"results\": [\n";
+        for (size_t i = 0; i < this->results.size(); ++i)
+        {
+          out << "  " << this->results[i].Str();
+          out << (i + 1 < this->results.size() ? ",\n" : "\n");
+        }
+        out << "]}\n";
+
+        std::cout << "Results written to [" << path << "]" << std::endl;
+        return true;
+      }
+
+      /// \brief Benchmark name.
+      private: std::string name;
+
+      /// \brief Results.
+      private: std::vector<JsonObject> results;
+    };
+
+    /// \brief Print a result in a human readable format.
+    /// \param[in] _mode Test mode.
+    /// \param[in] _size Payload size in bytes.
+    /// \param[in] _opsPerSec Operations per second.
+    /// \param[in] _stats Latency statistics.
+    inline void printResult(const std::string &_mode, const size_t _size,
+      const double _opsPerSec, const Stats &_stats)
+    {
+      std::cout << std::left << std::setw(24) << _mode
+                << std::right << std::setw(10) << _size << " B "
+                << std::setw(12) << std::fixed << std::setprecision(0)
+                << _opsPerSec << " ops/s  "
+                << std::setprecision(1)
+                << "p50 " << std::setw(9) << _stats.p50 << " us  "
+                << "p99 " << std::setw(9) << _stats.p99 << " us  "
+                << "p99.9 " << std::setw(9) << _stats.p999 << " us"
+                << std::endl;
+    }
+  }
+}
+
+#endif
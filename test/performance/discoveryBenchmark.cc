@@ -0,0 +1,558 @@
+/*
+ * Copyright (C) 2014 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ignition/transport/Discovery.hh"
+#include "ignition/transport/DiscoveryPrivate.hh"
+#include "ignition/transport/Packet.hh"
+#include "ignition/transport/TopicStorage.hh"
+#include "ignition/transport/TopicUtils.hh"
+#include "ignition/transport/Uuid.hh"
+#include "gtest/gtest.h"
+#include "ignition/transport/test_config.h"
+#include "performance/benchmarkUtils.hh"
+
+using namespace ignition;
+
+// The benchmark is configured with the following environment variables:
+//   IGN_PERF_DISC_PROCS: Number of simulated processes (default 10).
+//   IGN_PERF_DISC_TOPICS: Total number of topics (default 1000).
+//   IGN_PERF_DISC_CHURN: Number of processes that leave and join again
+//                        (default 2).
+//   IGN_PERF_DISC_TIMEOUT: Maximum time waiting for each phase (ms).
+// E.g.: IGN_PERF_DISC_PROCS=100 IGN_PERF_DISC_TOPICS=20000.
+
+std::string partition;
+unsigned int numProcs;
+unsigned int numTopics;
+unsigned int numChurn;
+unsigned int timeout;
+
+testing::perf::Report report("PERFORMANCE_discoveryBenchmark");
+
+using Clock = std::chrono::steady_clock;
+
+//////////////////////////////////////////////////
+/// \brief Get the fully qualified name of a topic.
+/// \param[in] _index Topic index.
+/// \return The topic name.
+std::string topicName(const unsigned int _index)
+{
+  return "@" + partition + "@/bench/topic_" + std::to_string(_index);
+}
+
+//////////////////////////////////////////////////
+/// \brief Get the CPU time consumed by the calling thread.
+/// \return CPU time in microseconds.
+double threadCpuUs()
+{
+  timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+//////////////////////////////////////////////////
+/// \brief Elapsed milliseconds since a given time.
+double elapsedMs(const Clock::time_point &_start)
+{
+  return std::chrono::duration<double, std::milli>(
+    Clock::now() - _start).count();
+}
+
+//////////////////////////////////////////////////
+/// \brief Counts the discovery datagrams of our partition sent to the
+/// multicast group.
+class DatagramCounter
+{
+  /// \brief Constructor. Joins the multicast group and starts counting.
+  public: DatagramCounter()
+  {
+    transport::DiscoveryPrivate discoveryInfo;
+    this->hash = transport::TopicUtils::GetPartitionHash(topicName(0));
+
+    this->sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    EXPECT_GE(this->sock, 0);
+
+    int reuse = 1;
+    setsockopt(this->sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    int rcvBuf = 8 * 1024 * 1024;
+    setsockopt(this->sock, SOL_SOCKET, SO_RCVBUF, &rcvBuf, sizeof(rcvBuf));
+    timeval tv = {0, 100000};
+    setsockopt(this->sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    sockaddr_in localAddr;
+    memset(&localAddr, 0, sizeof(localAddr));
+    localAddr.sin_family = AF_INET;
+    localAddr.sin_addr.s_addr = htonl(INADDR_ANY);
+    localAddr.sin_port = htons(discoveryInfo.DiscoveryPort);
+    EXPECT_EQ(bind(this->sock, reinterpret_cast<sockaddr *>(&localAddr),
+      sizeof(localAddr)), 0);
+
+    ip_mreq group;
+    group.imr_multiaddr.s_addr =
+      inet_addr(discoveryInfo.MulticastGroup.c_str());
+    group.imr_interface.s_addr = htonl(INADDR_ANY);
+    setsockopt(this->sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, &group,
+      sizeof(group));
+
+    this->thread = std::thread(&DatagramCounter::Run, this);
+  }
+
+  /// \brief Destructor.
+  public: ~DatagramCounter()
+  {
+    this->exit = true;
+    this->thread.join();
+    close(this->sock);
+  }
+
+  /// \brief Get the number of datagrams received so far.
+  /// \return Number of datagrams.
+  public: uint64_t Count() const
+  {
+    return this->count;
+  }
+
+  /// \brief Reception loop.
+  private: void Run()
+  {
+    std::vector<char> buffer(transport::DiscoveryPrivate::MaxRcvStr);
+    while (!this->exit)
+    {
+      ssize_t bytes = recv(this->sock, buffer.data(), buffer.size(), 0);
+      if (bytes <= 0)
+        continue;
+
+      transport::Header header;
+      if (header.Unpack(buffer.data(), static_cast<size_t>(bytes)) &&
+          header.GetPartitionHash() == this->hash)
+        ++this->count;
+    }
+  }
+
+  /// \brief UDP socket.
+  private: int sock = -1;
+
+  /// \brief Partition hash of the benchmark.
+  private: uint32_t hash = 0;
+
+  /// \brief Number of datagrams received.
+  private: std::atomic<uint64_t> count{0};
+
+  /// \brief When true, the reception thread finishes.
+  private: std::atomic<bool> exit{false};
+
+  /// \brief Reception thread.
+  private: std::thread thread;
+};
+
+//////////////////////////////////////////////////
+/// \brief A simulated process: a discovery instance advertising a set of
+/// topics.
+struct SimProcess
+{
+  /// \brief Constructor. Advertises all the topics.
+  /// \param[in] _first Index of the first topic.
+  /// \param[in] _num Number of topics.
+  SimProcess(const unsigned int _first, const unsigned int _num)
+    : pUuid(transport::Uuid().ToString()),
+      nUuid(transport::Uuid().ToString()),
+      discovery(new transport::Discovery(pUuid)),
+      first(_first),
+      num(_num)
+  {
+    std::string addr = "tcp://127.0.0.1:" + std::to_string(10000 + _first);
+    for (unsigned int i = _first; i < _first + _num; ++i)
+    {
+      this->discovery->Advertise(transport::MsgType::Msg, topicName(i), addr,
+        addr, this->nUuid, transport::Scope::All);
+    }
+  }
+
+  /// \brief Process UUID.
+  std::string pUuid;
+
+  /// \brief Node UUID.
+  std::string nUuid;
+
+  /// \brief Discovery instance.
+  std::unique_ptr<transport::Discovery> discovery;
+
+  /// \brief Index of the first topic advertised.
+  unsigned int first;
+
+  /// \brief Number of topics advertised.
+  unsigned int num;
+};
+
+//////////////////////////////////////////////////
+/// \brief A discovery instance that tracks the topics and the departures
+/// of the simulated processes.
+class Observer
+{
+  /// \brief Constructor.
+  public: Observer()
+    : discovery(transport::Uuid().ToString())
+  {
+    this->discovery.RegisterPartition(topicName(0));
+    this->discovery.SetConnectionsCb(&Observer::OnConnection, this);
+    this->discovery.SetDisconnectionsCb(&Observer::OnDisconnection, this);
+  }
+
+  /// \brief Wait until a process has been discovered with all its topics.
+  /// \param[in] _procs Processes.
+  /// \return True if all the topics were discovered before the timeout.
+  public: bool WaitForTopics(const std::vector<SimProcess *> &_procs)
+  {
+    std::unique_lock<std::mutex> lk(this->mutex);
+    return this->condition.wait_for(lk, std::chrono::milliseconds(timeout),
+      [&]
+      {
+        for (auto const proc : _procs)
+        {
+          auto it = this->topics.find(proc->pUuid);
+          if (it == this->topics.end() || it->second < proc->num)
+            return false;
+        }
+        return true;
+      });
+  }
+
+  /// \brief Wait until the departure of a process has been detected.
+  /// \param[in] _pUuid Process UUID.
+  /// \return True if the departure was detected before the timeout.
+  public: bool WaitForDeparture(const std::string &_pUuid)
+  {
+    std::unique_lock<std::mutex> lk(this->mutex);
+    return this->condition.wait_for(lk, std::chrono::milliseconds(timeout),
+      [&]
+      {
+        return this->departures.find(_pUuid) != this->departures.end();
+      });
+  }
+
+  /// \brief Connection callback.
+  private: void OnConnection(const std::string &/*_topic*/,
+    const std::string &/*_addr*/, const std::string &/*_ctrl*/,
+    const std::string &_pUuid, const std::string &/*_nUuid*/,
+    const transport::Scope &/*_scope*/)
+  {
+    std::lock_guard<std::mutex> lk(this->mutex);
+    ++this->topics[_pUuid];
+    this->condition.notify_all();
+  }
+
+  /// \brief Disconnection callback.
+  private: void OnDisconnection(const std::string &/*_topic*/,
+    const std::string &/*_addr*/, const std::string &/*_ctrl*/,
+    const std::string &_pUuid, const std::string &/*_nUuid*/,
+    const transport::Scope &/*_scope*/)
+  {
+    std::lock_guard<std::mutex> lk(this->mutex);
+    this->topics.erase(_pUuid);
+    this->departures.insert(_pUuid);
+    this->condition.notify_all();
+  }
+
+  /// \brief Discovery instance.
+  private: transport::Discovery discovery;
+
+  /// \brief Number of topics discovered per process.
+  private: std::map<std::string, unsigned int> topics;
+
+  /// \brief Processes that left.
+  private: std::set<std::string> departures;
+
+  /// \brief Protects the observer state.
+  private: std::mutex mutex;
+
+  /// \brief Notifies discovery updates.
+  private: std::condition_variable condition;
+};
+
+//////////////////////////////////////////////////
+/// \brief Store a timing result.
+/// \param[in] _phase Name of the phase.
+/// \param[in] _ms Duration of the phase (ms).
+/// \param[in] _datagrams Datagrams sent during the phase.
+/// \param[in] _ok Whether the phase finished before the timeout.
+void addPhase(const std::string &_phase, const double _ms,
+  const uint64_t _datagrams, const bool _ok)
+{
+  double rate = _ms > 0 ? _datagrams / (_ms / 1000.0) : 0;
+  std::cout << std::left << std::setw(24) << _phase << std::right
+            << std::fixed << std::setprecision(1)
+            << std::setw(10) << _ms << " ms "
+            << std::setw(10) << _datagrams << " datagrams "
+            << std::setw(10) << rate << " datagrams/s"
+            << (_ok ? "" : "  [TIMEOUT]") << std::endl;
+
+  testing::perf::JsonObject result;
+  result.Set("phase", _phase)
+        .Set("processes", numProcs)
+        .Set("topics", numTopics)
+        .Set("churn", numChurn)
+        .Set("time_ms", _ms)
+        .Set("datagrams", static_cast<double>(_datagrams))
+        .Set("datagrams_per_sec", rate)
+        .Set("completed", _ok ? "true" : "false");
+  report.Add(result);
+}
+
+//////////////////////////////////////////////////
+/// \brief Store a CPU time result.
+/// \param[in] _operation Name of the operation.
+/// \param[in] _cpuUs CPU time (us).
+/// \param[in] _ops Number of operations.
+void addCpu(const std::string &_operation, const double _cpuUs,
+  const size_t _ops)
+{
+  double nsPerOp = _ops > 0 ? _cpuUs * 1000.0 / _ops : 0;
+  std::cout << std::left << std::setw(32) << _operation << std::right
+            << std::fixed << std::setprecision(1)
+            << std::setw(12) << _cpuUs / 1000.0 << " ms cpu "
+            << std::setw(10) << _ops << " ops "
+            << std::setw(10) << nsPerOp << " ns/op" << std::endl;
+
+  testing::perf::JsonObject result;
+  result.Set("operation", _operation)
+        .Set("processes", numProcs)
+        .Set("topics", numTopics)
+        .Set("cpu_ms", _cpuUs / 1000.0)
+        .Set("ops", static_cast<double>(_ops))
+        .Set("cpu_ns_per_op", nsPerOp);
+  report.Add(result);
+}
+
+//////////////////////////////////////////////////
+/// \brief Start all the simulated processes, wait for the observers to
+/// discover them, and then make some of them leave and join again.
+TEST(DiscoveryBenchmark, Lifecycle)
+{
+  ASSERT_GT(numProcs, 0u);
+  unsigned int topicsPerProc = std::max(1u, numTopics / numProcs);
+  DatagramCounter counter;
+
+  // Time to discover all the topics when they are advertised.
+  Observer observer;
+  std::vector<std::unique_ptr<SimProcess>> procs;
+  std::vector<SimProcess *> all;
+  auto start = Clock::now();
+  auto datagrams = counter.Count();
+  for (unsigned int i = 0; i < numProcs; ++i)
+  {
+    procs.push_back(std::unique_ptr<SimProcess>(
+      new SimProcess(i * topicsPerProc, topicsPerProc)));
+    all.push_back(procs.back().get());
+  }
+  bool ok = observer.WaitForTopics(all);
+  addPhase("startup", elapsedMs(start), counter.Count() - datagrams, ok);
+  EXPECT_TRUE(ok);
+
+  // Time to discover all the topics for a process that joins later.
+  start = Clock::now();
+  datagrams = counter.Count();
+  Observer lateObserver;
+  ok = lateObserver.WaitForTopics(all);
+  addPhase("late_join", elapsedMs(start), counter.Count() - datagrams, ok);
+  EXPECT_TRUE(ok);
+
+  // Traffic when nothing changes.
+  start = Clock::now();
+  datagrams = counter.Count();
+  std::this_thread::sleep_for(std::chrono::seconds(5));
+  addPhase("steady_state", elapsedMs(start), counter.Count() - datagrams,
+    true);
+
+  // Time to detect the departure of a process.
+  unsigned int churn = std::min(numChurn, numProcs);
+  std::vector<SimProcess *> rejoined;
+  for (unsigned int i = 0; i < churn; ++i)
+  {
+    auto &proc = procs[i];
+    std::string pUuid = proc->pUuid;
+    unsigned int first = proc->first;
+
+    start = Clock::now();
+    datagrams = counter.Count();
+    proc.reset();
+    ok = observer.WaitForDeparture(pUuid);
+    addPhase("departure", elapsedMs(start), counter.Count() - datagrams, ok);
+    EXPECT_TRUE(ok);
+
+    // The process comes back with the same topics.
+    start = Clock::now();
+    datagrams = counter.Count();
+    proc.reset(new SimProcess(first, topicsPerProc));
+    ok = observer.WaitForTopics({proc.get()});
+    addPhase("rejoin", elapsedMs(start), counter.Count() - datagrams, ok);
+    EXPECT_TRUE(ok);
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief CPU time spent processing discovery messages and updating the
+/// topic storage. Messages are injected directly, so the results do not
+/// depend on the network.
+TEST(DiscoveryBenchmark, CpuTime)
+{
+  unsigned int topicsPerProc = std::max(1u, numTopics / numProcs);
+  uint32_t hash = transport::TopicUtils::GetPartitionHash(topicName(0));
+  auto version = transport::DiscoveryPrivate::Version;
+
+  // The discovery messages carry the binary UUIDs and the topic storage
+  // the string ones.
+  std::vector<transport::Uuid> pIds(numProcs);
+  std::vector<transport::Uuid> nIds(numProcs);
+  std::vector<std::string> pUuids;
+  std::vector<std::string> nUuids;
+  for (unsigned int i = 0; i < numProcs; ++i)
+  {
+    pUuids.push_back(pIds[i].ToString());
+    nUuids.push_back(nIds[i].ToString());
+  }
+
+  // Prepare all the messages.
+  std::vector<std::vector<char>> advs;
+  std::vector<std::vector<char>> subs;
+  std::vector<std::vector<char>> heartbeats;
+  std::vector<std::vector<char>> byes;
+  for (unsigned int p = 0; p < numProcs; ++p)
+  {
+    std::string addr = "tcp://127.0.0.1:" + std::to_string(10000 + p);
+    for (unsigned int t = p * topicsPerProc; t < (p + 1) * topicsPerProc;
+         ++t)
+    {
+      transport::Header header(version, pIds[p], transport::AdvType);
+      header.SetPartitionHash(hash);
+      transport::AdvertiseMsg adv(header, topicName(t), addr, addr,
+        nIds[p], transport::Scope::All, "ignition.msgs.Payload");
+      advs.push_back(std::vector<char>(adv.GetMsgLength()));
+      adv.Pack(advs.back().data());
+
+      header.SetType(transport::SubType);
+      transport::SubscriptionMsg sub(header, topicName(t));
+      subs.push_back(std::vector<char>(sub.GetMsgLength()));
+      sub.Pack(subs.back().data());
+    }
+
+    transport::Header header(version, pIds[p], transport::HeartbeatType);
+    header.SetPartitionHash(hash);
+    heartbeats.push_back(std::vector<char>(header.GetHeaderLength()));
+    header.Pack(heartbeats.back().data());
+
+    header.SetType(transport::ByeType);
+    byes.push_back(std::vector<char>(header.GetHeaderLength()));
+    header.Pack(byes.back().data());
+  }
+
+  // Discovery message processing.
+  {
+    transport::Discovery discovery(transport::Uuid().ToString());
+    discovery.RegisterPartition(topicName(0));
+    std::string fromIp = discovery.GetHostAddr();
+
+    auto dispatch = [&](const std::string &_name,
+      std::vector<std::vector<char>> &_msgs)
+    {
+      double cpu = threadCpuUs();
+      for (auto &msg : _msgs)
+        discovery.DispatchDiscoveryMsg(fromIp, msg.data(), msg.size());
+      addCpu(_name, threadCpuUs() - cpu, _msgs.size());
+    };
+
+    dispatch("dispatch_adv_new", advs);
+    dispatch("dispatch_adv_known", advs);
+    dispatch("dispatch_sub", subs);
+    dispatch("dispatch_heartbeat", heartbeats);
+    dispatch("dispatch_bye", byes);
+  }
+
+  // Topic storage operations.
+  {
+    transport::TopicStorage storage;
+
+    double cpu = threadCpuUs();
+    for (unsigned int p = 0; p < numProcs; ++p)
+    {
+      std::string addr = "tcp://127.0.0.1:" + std::to_string(10000 + p);
+      for (unsigned int t = p * topicsPerProc; t < (p + 1) * topicsPerProc;
+           ++t)
+      {
+        storage.AddAddress(topicName(t), addr, addr, pUuids[p], nUuids[p]);
+      }
+    }
+    addCpu("storage_add", threadCpuUs() - cpu, numProcs * topicsPerProc);
+
+    cpu = threadCpuUs();
+    for (unsigned int t = 0; t < numProcs * topicsPerProc; ++t)
+    {
+      transport::Addresses_M addresses;
+      storage.GetAddresses(topicName(t), addresses);
+    }
+    addCpu("storage_get", threadCpuUs() - cpu, numProcs * topicsPerProc);
+
+    cpu = threadCpuUs();
+    for (unsigned int p = 0; p < numProcs; ++p)
+    {
+      for (unsigned int t = p * topicsPerProc; t < (p + 1) * topicsPerProc;
+           ++t)
+      {
+        storage.HasAnyAddresses(topicName(t), pUuids[p]);
+      }
+    }
+    addCpu("storage_has_any", threadCpuUs() - cpu, numProcs * topicsPerProc);
+
+    cpu = threadCpuUs();
+    for (auto const &pUuid : pUuids)
+      storage.DelAddressesByProc(pUuid);
+    addCpu("storage_del_by_proc", threadCpuUs() - cpu, numProcs);
+  }
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  // Get a random partition name.
+  partition = testing::getRandomPartition();
+
+  numProcs = testing::perf::envParam("IGN_PERF_DISC_PROCS", 10);
+  numTopics = testing::perf::envParam("IGN_PERF_DISC_TOPICS", 1000);
+  numChurn = testing::perf::envParam("IGN_PERF_DISC_CHURN", 2);
+  timeout = testing::perf::envParam("IGN_PERF_DISC_TIMEOUT", 60000);
+
+  ::testing::InitGoogleTest(&argc, argv);
+  int result = RUN_ALL_TESTS();
+
+  report.Write();
+  return result;
+}
@@ -0,0 +1,321 @@
+/*
+ * Copyright (C) 2014 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+#include "ignition/transport/Node.hh"
+#include "gtest/gtest.h"
+#include "ignition/transport/test_config.h"
+#include "msg/payload.pb.h"
+#include "performance/benchmarkUtils.hh"
+
+using namespace ignition;
+
+std::string partition;
+std::string pingTopic  = "/ping";
+std::string pongTopic  = "/pong";
+std::string intraTopic = "/intra";
+
+/// \brief Number of subscriber processes used in the fan-out test.
+static const unsigned int NumFanOutPeers = 4;
+
+/// \brief Maximum time waiting for an answer (ms).
+static const int Timeout = 5000;
+
+testing::perf::Report report("PERFORMANCE_pubSubBenchmark");
+
+std::mutex mutex;
+std::condition_variable condition;
+
+/// \brief Sequence number of the message waiting for answers.
+int64_t pendingSeq = -1;
+
+/// \brief Number of answers received for 'pendingSeq'.
+unsigned int pongs = 0;
+
+/// \brief Number of answers received for any sequence number.
+unsigned int totalPongs = 0;
+
+/// \brief Identifiers of the subscriber processes that are ready.
+std::set<int> peers;
+
+/// \brief Time when the last intra-process message was received.
+std::chrono::steady_clock::time_point intraRecvTime;
+
+/// \brief Number of intra-process messages received.
+unsigned int intraReceived = 0;
+
+//////////////////////////////////////////////////
+/// \brief Answer received from a subscriber process.
+void onPong(const std::string &/*_topic*/,
+  const transport::msgs::Payload &_msg)
+{
+  std::lock_guard<std::mutex> lk(mutex);
+  if (_msg.seq() < 0)
+    peers.insert(_msg.id());
+  else
+  {
+    ++totalPongs;
+    if (_msg.seq() == pendingSeq)
+      ++pongs;
+  }
+  condition.notify_all();
+}
+
+//////////////////////////////////////////////////
+/// \brief Intra-process subscription callback.
+void onIntra(const std::string &/*_topic*/,
+  const transport::msgs::Payload &/*_msg*/)
+{
+  intraRecvTime = std::chrono::steady_clock::now();
+  ++intraReceived;
+}
+
+//////////////////////////////////////////////////
+/// \brief Elapsed microseconds since a given time.
+double elapsedUs(const std::chrono::steady_clock::time_point &_start,
+  const std::chrono::steady_clock::time_point &_end =
+    std::chrono::steady_clock::now())
+{
+  return std::chrono::duration<double, std::micro>(_end - _start).count();
+}
+
+//////////////////////////////////////////////////
+/// \brief Store and print a result.
+/// \param[in] _lost Messages lost while measuring the latency.
+/// \param[in] _burstLost Messages lost while measuring the throughput. The
+/// burst is sent back to back, so some messages can be dropped when the
+/// queues reach their high water mark.
+void addResult(const std::string &_mode, const unsigned int _subscribers,
+  const size_t _size, const double _msgsPerSec,
+  const std::vector<double> &_samples, const unsigned int _lost,
+  const unsigned int _burstLost, const std::string &_latencyType)
+{
+  auto stats = testing::perf::computeStats(_samples);
+  testing::perf::printResult(_mode, _size, _msgsPerSec, stats);
+  if (_burstLost > 0)
+  {
+    std::cout << "  " << _burstLost << " messages lost during the throughput"
+              << " burst" << std::endl;
+  }
+
+  testing::perf::JsonObject result;
+  result.Set("mode", _mode)
+        .Set("subscribers", _subscribers)
+        .Set("payload_bytes", static_cast<double>(_size))
+        .Set("lost", _lost)
+        .Set("burst_lost", _burstLost)
+        .Set("msgs_per_sec", _msgsPerSec)
+        .Set("mbytes_per_sec", _msgsPerSec * _size * _subscribers / 1e6)
+        .Set("latency_type", _latencyType)
+        .Set("latency_us", testing::perf::toJson(stats));
+  report.Add(result);
+}
+
+//////////////////////////////////////////////////
+/// \brief Publisher and subscriber in the same process. The subscription
+/// callback is executed by RunLocalCallback() inside Publish().
+TEST(PubSubBenchmark, IntraProcess)
+{
+  transport::Node pubNode;
+  transport::Node subNode;
+  ASSERT_TRUE(pubNode.Advertise(intraTopic));
+  ASSERT_TRUE(subNode.Subscribe(intraTopic, onIntra));
+
+  transport::msgs::Payload msg;
+  for (auto const size : testing::perf::payloadSizes())
+  {
+    msg.set_data(std::string(size, 'x'));
+    auto iters = testing::perf::iterations(size, 10000);
+
+    // Latency.
+    std::vector<double> samples;
+    intraReceived = 0;
+    for (unsigned int i = 0; i < iters; ++i)
+    {
+      msg.set_seq(i);
+      unsigned int received = intraReceived;
+      auto start = std::chrono::steady_clock::now();
+      EXPECT_TRUE(pubNode.Publish(intraTopic, msg));
+
+      // 'intraRecvTime' is only valid if the callback was executed.
+      if (intraReceived > received)
+        samples.push_back(elapsedUs(start, intraRecvTime));
+    }
+    unsigned int lost = iters - intraReceived;
+
+    // Throughput.
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < iters; ++i)
+      pubNode.Publish(intraTopic, msg);
+    double msgsPerSec = iters / (elapsedUs(start) / 1e6);
+
+    EXPECT_EQ(lost, 0u);
+    addResult("intra_process", 1, size, msgsPerSec, samples, lost, 0,
+      "one_way");
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Publish to a set of subscriber processes that echo every message.
+/// The latency is the round trip time until all the subscribers answer. The
+/// throughput is measured publishing a batch of messages back to back and
+/// waiting for all the answers.
+/// \param[in] _mode Name of the test.
+/// \param[in] _numPeers Number of subscriber processes.
+void runRemote(const std::string &_mode, const unsigned int _numPeers)
+{
+  std::string echoPath = testing::portablePathUnion(
+     PROJECT_BINARY_PATH, "test/performance/PERFORMANCE_pubSubEcho_aux");
+
+  std::vector<testing::forkHandlerType> pis;
+  for (unsigned int i = 0; i < _numPeers; ++i)
+    pis.push_back(testing::forkAndRun(echoPath.c_str(), partition.c_str()));
+
+  {
+    std::lock_guard<std::mutex> lk(mutex);
+    peers.clear();
+  }
+
+  transport::Node node;
+  ASSERT_TRUE(node.Advertise(pingTopic));
+  ASSERT_TRUE(node.Subscribe(pongTopic, onPong));
+
+  // Wait until all the subscribers are connected.
+  transport::msgs::Payload msg;
+  msg.set_seq(-1);
+  msg.set_data("");
+  bool ready = false;
+  for (int i = 0; i < 100 && !ready; ++i)
+  {
+    node.Publish(pingTopic, msg);
+    std::unique_lock<std::mutex> lk(mutex);
+    ready = condition.wait_for(lk, std::chrono::milliseconds(100),
+      [&]{return peers.size() >= _numPeers;});
+  }
+  EXPECT_TRUE(ready);
+
+  int64_t seq = 0;
+  for (auto const size : testing::perf::payloadSizes())
+  {
+    if (!ready)
+      break;
+
+    msg.set_data(std::string(size, 'x'));
+    auto iters = testing::perf::iterations(size, 1000);
+
+    // Latency.
+    std::vector<double> samples;
+    unsigned int lost = 0;
+    for (unsigned int i = 0; i < iters; ++i, ++seq)
+    {
+      {
+        std::lock_guard<std::mutex> lk(mutex);
+        pendingSeq = seq;
+        pongs = 0;
+      }
+      msg.set_seq(seq);
+
+      auto start = std::chrono::steady_clock::now();
+      node.Publish(pingTopic, msg);
+
+      std::unique_lock<std::mutex> lk(mutex);
+      if (condition.wait_for(lk, std::chrono::milliseconds(Timeout),
+            [&]{return pongs >= _numPeers;}))
+      {
+        samples.push_back(elapsedUs(start));
+      }
+      else
+        ++lost;
+    }
+
+    EXPECT_EQ(lost, 0u);
+
+    // Throughput. The batch is limited to keep the queued data under 64 MB.
+    // The messages are sent back to back, so the losses are only reported.
+    unsigned int batch = std::min(iters, static_cast<unsigned int>(
+      std::max<size_t>(4, 64 * 1024 * 1024 / size)));
+    {
+      std::lock_guard<std::mutex> lk(mutex);
+      pendingSeq = -2;
+      totalPongs = 0;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < batch; ++i, ++seq)
+    {
+      msg.set_seq(seq);
+      node.Publish(pingTopic, msg);
+    }
+
+    unsigned int burstLost = 0;
+    {
+      std::unique_lock<std::mutex> lk(mutex);
+      if (!condition.wait_for(lk, std::chrono::milliseconds(Timeout * 6),
+            [&]{return totalPongs >= batch * _numPeers;}))
+      {
+        burstLost = batch * _numPeers - totalPongs;
+      }
+    }
+    double msgsPerSec = batch / (elapsedUs(start) / 1e6);
+
+    addResult(_mode, _numPeers, size, msgsPerSec, samples, lost, burstLost,
+      "round_trip");
+  }
+
+  for (auto &pi : pis)
+  {
+    testing::killFork(pi);
+    testing::waitAndCleanupFork(pi);
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Publisher and subscriber in different processes.
+TEST(PubSubBenchmark, InterProcess)
+{
+  runRemote("inter_process", 1);
+}
+
+//////////////////////////////////////////////////
+/// \brief One publisher and multiple subscriber processes.
+TEST(PubSubBenchmark, FanOut)
+{
+  runRemote("fan_out", NumFanOutPeers);
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  // Get a random partition name.
+  partition = testing::getRandomPartition();
+
+  // Set the partition name for this process.
+  setenv("IGN_PARTITION", partition.c_str(), 1);
+
+  ::testing::InitGoogleTest(&argc, argv);
+  int result = RUN_ALL_TESTS();
+
+  report.Write();
+  return result;
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2014 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <limits>
+#include <random>
+#include <string>
+#include <thread>
+#include "ignition/transport/Node.hh"
+#include "gtest/gtest.h"
+#include "ignition/transport/test_config.h"
+#include "msg/payload.pb.h"
+
+using namespace ignition;
+
+std::string pingTopic = "/ping";
+std::string pongTopic = "/pong";
+transport::Node *node = nullptr;
+int id = 0;
+
+//////////////////////////////////////////////////
+/// \brief Send back every message received.
+void cb(const std::string &/*_topic*/, const transport::msgs::Payload &_msg)
+{
+  transport::msgs::Payload pong(_msg);
+  pong.set_id(id);
+  node->Publish(pongTopic, pong);
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  if (argc != 2)
+  {
+    std::cerr << "Partition name has not be passed as argument" << std::endl;
+    return -1;
+  }
+
+  // Set the partition name for this test.
+  setenv("IGN_PARTITION", argv[1], 1);
+
+  // Random identifier of this peer, used by the benchmark to count the
+  // peers that answer. It works the same way on every platform.
+  std::random_device rd;
+  std::uniform_int_distribution<int> dist(1, std::numeric_limits<int>::max());
+  id = dist(rd);
+
+  transport::Node echoNode;
+  node = &echoNode;
+  if (!echoNode.Advertise(pongTopic) || !echoNode.Subscribe(pingTopic, cb))
+    return -1;
+
+  // The benchmark kills this process when done. Exit anyway after a while to
+  // avoid orphan processes.
+  std::this_thread::sleep_for(std::chrono::seconds(300));
+  return 0;
+}
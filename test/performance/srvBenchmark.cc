@@ -0,0 +1,319 @@
+/*
+ * Copyright (C) 2014 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ignition/transport/Node.hh"
+#include "gtest/gtest.h"
+#include "ignition/transport/test_config.h"
+#include "msg/payload.pb.h"
+#include "performance/benchmarkUtils.hh"
+
+using namespace ignition;
+
+std::string partition;
+std::string service = "/echo";
+
+/// \brief Number of replier processes used in the multi-responder test.
+static const unsigned int NumResponders = 3;
+
+/// \brief Number of threads used for the concurrent requests.
+static const unsigned int NumThreads = 4;
+
+/// \brief Largest request evaluated (bytes).
+static const size_t MaxSize = 1024 * 1024;
+
+/// \brief Maximum time waiting for a response (ms).
+static const unsigned int Timeout = 5000;
+
+testing::perf::Report report("PERFORMANCE_srvBenchmark");
+
+std::mutex mutex;
+std::condition_variable condition;
+
+/// \brief Number of asynchronous responses received.
+unsigned int responses = 0;
+
+//////////////////////////////////////////////////
+/// \brief Service executed by the local responder.
+void srvEcho(const std::string &/*_topic*/,
+  const transport::msgs::Payload &_req, transport::msgs::Payload &_rep,
+  bool &_result)
+{
+  _rep = _req;
+  _result = true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Response received for an asynchronous request.
+void onResponse(const std::string &/*_topic*/,
+  const transport::msgs::Payload &/*_rep*/, bool /*_result*/)
+{
+  std::lock_guard<std::mutex> lk(mutex);
+  ++responses;
+  condition.notify_all();
+}
+
+//////////////////////////////////////////////////
+/// \brief Elapsed microseconds since a given time.
+double elapsedUs(const std::chrono::steady_clock::time_point &_start)
+{
+  return std::chrono::duration<double, std::micro>(
+    std::chrono::steady_clock::now() - _start).count();
+}
+
+//////////////////////////////////////////////////
+/// \brief Store and print a result.
+void addResult(const std::string &_setup, const std::string &_mode,
+  const size_t _size, const double _callsPerSec,
+  const std::vector<double> &_samples, const unsigned int _failed)
+{
+  auto stats = testing::perf::computeStats(_samples);
+  testing::perf::printResult(_setup + "/" + _mode, _size, _callsPerSec, stats);
+
+  testing::perf::JsonObject result;
+  result.Set("setup", _setup)
+        .Set("mode", _mode)
+        .Set("payload_bytes", static_cast<double>(_size))
+        .Set("failed", _failed)
+        .Set("calls_per_sec", _callsPerSec)
+        .Set("latency_us", testing::perf::toJson(stats))
+        .SetRaw("histogram", testing::perf::toJson(
+          testing::perf::histogram(_samples)));
+  report.Add(result);
+}
+
+//////////////////////////////////////////////////
+/// \brief Blocking requests issued one after the other.
+void runSync(const std::string &_setup, transport::Node &_node,
+  const transport::msgs::Payload &_req, const unsigned int _iters)
+{
+  transport::msgs::Payload rep;
+  bool result;
+  std::vector<double> samples;
+  unsigned int failed = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned int i = 0; i < _iters; ++i)
+  {
+    auto callStart = std::chrono::steady_clock::now();
+    if (_node.Request(service, _req, Timeout, rep, result) && result)
+      samples.push_back(elapsedUs(callStart));
+    else
+      ++failed;
+  }
+  double callsPerSec = _iters / (elapsedUs(start) / 1e6);
+
+  EXPECT_EQ(failed, 0u);
+  addResult(_setup, "sync", _req.data().size(), callsPerSec, samples, failed);
+}
+
+//////////////////////////////////////////////////
+/// \brief Non-blocking requests with a callback. Each request is issued
+/// after receiving the previous response.
+void runCallback(const std::string &_setup, transport::Node &_node,
+  const transport::msgs::Payload &_req, const unsigned int _iters)
+{
+  std::vector<double> samples;
+  unsigned int failed = 0;
+
+  {
+    std::lock_guard<std::mutex> lk(mutex);
+    responses = 0;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned int i = 0; i < _iters; ++i)
+  {
+    // Compare against the responses received so far, so a request that
+    // failed or timed out does not affect the next ones.
+    unsigned int previous;
+    {
+      std::lock_guard<std::mutex> lk(mutex);
+      previous = responses;
+    }
+
+    auto callStart = std::chrono::steady_clock::now();
+    if (!_node.Request(service, _req, onResponse))
+    {
+      ++failed;
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lk(mutex);
+    if (condition.wait_for(lk, std::chrono::milliseconds(Timeout),
+          [&]{return responses > previous;}))
+    {
+      samples.push_back(elapsedUs(callStart));
+    }
+    else
+      ++failed;
+  }
+  double callsPerSec = _iters / (elapsedUs(start) / 1e6);
+
+  EXPECT_EQ(failed, 0u);
+  addResult(_setup, "callback", _req.data().size(), callsPerSec, samples,
+    failed);
+}
+
+//////////////////////////////////////////////////
+/// \brief Blocking requests issued from multiple threads at the same time.
+void runConcurrent(const std::string &_setup, transport::Node &_node,
+  const transport::msgs::Payload &_req, const unsigned int _iters)
+{
+  std::vector<std::vector<double>> threadSamples(NumThreads);
+  std::vector<unsigned int> threadFailed(NumThreads, 0);
+  std::vector<std::thread> threads;
+
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned int t = 0; t < NumThreads; ++t)
+  {
+    threads.push_back(std::thread([&, t]()
+    {
+      transport::msgs::Payload rep;
+      bool result;
+      for (unsigned int i = 0; i < _iters / NumThreads; ++i)
+      {
+        auto callStart = std::chrono::steady_clock::now();
+        if (_node.Request(service, _req, Timeout, rep, result) && result)
+          threadSamples[t].push_back(elapsedUs(callStart));
+        else
+          ++threadFailed[t];
+      }
+    }));
+  }
+
+  for (auto &t : threads)
+    t.join();
+  double elapsed = elapsedUs(start);
+
+  std::vector<double> samples;
+  unsigned int failed = 0;
+  for (unsigned int t = 0; t < NumThreads; ++t)
+  {
+    samples.insert(samples.end(), threadSamples[t].begin(),
+      threadSamples[t].end());
+    failed += threadFailed[t];
+  }
+  double callsPerSec = (_iters / NumThreads) * NumThreads / (elapsed / 1e6);
+
+  EXPECT_EQ(failed, 0u);
+  addResult(_setup, "concurrent", _req.data().size(), callsPerSec, samples,
+    failed);
+}
+
+//////////////////////////////////////////////////
+/// \brief Run all the request modes for all the payload sizes.
+/// \param[in] _setup Name of the setup.
+/// \param[in] _node Node used to make the requests.
+void runAll(const std::string &_setup, transport::Node &_node)
+{
+  // Wait until the service is available.
+  transport::msgs::Payload req;
+  transport::msgs::Payload rep;
+  bool result = false;
+  req.set_seq(0);
+  req.set_data("");
+  bool ready = false;
+  for (int i = 0; i < 10 && !ready; ++i)
+    ready = _node.Request(service, req, 1000, rep, result) && result;
+  ASSERT_TRUE(ready);
+
+  for (auto const size : testing::perf::payloadSizes())
+  {
+    if (size > MaxSize)
+      break;
+
+    req.set_data(std::string(size, 'x'));
+    auto iters = testing::perf::iterations(size, 2000);
+
+    runSync(_setup, _node, req, iters);
+    runCallback(_setup, _node, req, iters);
+    runConcurrent(_setup, _node, req, iters);
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Run the benchmark against a set of replier processes.
+/// \param[in] _setup Name of the setup.
+/// \param[in] _numResponders Number of replier processes.
+void runRemote(const std::string &_setup, const unsigned int _numResponders)
+{
+  std::string replierPath = testing::portablePathUnion(
+     PROJECT_BINARY_PATH, "test/performance/PERFORMANCE_srvEcho_aux");
+
+  std::vector<testing::forkHandlerType> pis;
+  for (unsigned int i = 0; i < _numResponders; ++i)
+    pis.push_back(testing::forkAndRun(replierPath.c_str(), partition.c_str()));
+
+  {
+    transport::Node node;
+    runAll(_setup, node);
+  }
+
+  for (auto &pi : pis)
+  {
+    testing::killFork(pi);
+    testing::waitAndCleanupFork(pi);
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief The responder is in the same process.
+TEST(SrvBenchmark, LocalResponder)
+{
+  transport::Node replier;
+  ASSERT_TRUE(replier.Advertise(service, srvEcho));
+
+  transport::Node requester;
+  runAll("local", requester);
+}
+
+//////////////////////////////////////////////////
+/// \brief The responder is in a different process.
+TEST(SrvBenchmark, SameHost)
+{
+  runRemote("same_host", 1);
+}
+
+//////////////////////////////////////////////////
+/// \brief Multiple processes advertise the same service.
+TEST(SrvBenchmark, MultiResponder)
+{
+  runRemote("multi_responder", NumResponders);
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  // Get a random partition name.
+  partition = testing::getRandomPartition();
+
+  // Set the partition name for this process.
+  setenv("IGN_PARTITION", partition.c_str(), 1);
+
+  ::testing::InitGoogleTest(&argc, argv);
+  int result = RUN_ALL_TESTS();
+
+  report.Write();
+  return result;
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2014 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include "ignition/transport/Node.hh"
+#include "gtest/gtest.h"
+#include "ignition/transport/test_config.h"
+#include "msg/payload.pb.h"
+
+using namespace ignition;
+
+std::string service = "/echo";
+
+//////////////////////////////////////////////////
+/// \brief Provide a service that sends back the request.
+void srvEcho(const std::string &/*_topic*/,
+  const transport::msgs::Payload &_req, transport::msgs::Payload &_rep,
+  bool &_result)
+{
+  _rep = _req;
+  _result = true;
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  if (argc != 2)
+  {
+    std::cerr << "Partition name has not be passed as argument" << std::endl;
+    return -1;
+  }
+
+  // Set the partition name for this test.
+  setenv("IGN_PARTITION", argv[1], 1);
+
+  transport::Node node;
+  if (!node.Advertise(service, srvEcho))
+    return -1;
+
+  // The benchmark kills this process when done. Exit anyway after a while to
+  // avoid orphan processes.
+  std::this_thread::sleep_for(std::chrono::seconds(300));
+  return 0;
+}
@@ -0,0 +1,451 @@
+/*
+ * Copyright (C) 2015 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include "ignition/transport/MessageInfo.hh"
+#include "ignition/transport/Node.hh"
+#include "gtest/gtest.h"
+#include "ignition/transport/test_config.h"
+#include "msg/int.pb.h"
+
+using namespace ignition;
+
+// Heap allocations are counted by replacing the global operator new. Only
+// the allocations made by the thread under measurement are counted, so the
+// background threads (reception, discovery) do not add noise.
+
+/// \brief True while the current thread is being measured.
+static thread_local bool counting = false;
+
+/// \brief Allocations made by the current thread while counting.
+static thread_local uint64_t allocations = 0;
+
+//////////////////////////////////////////////////
+void *operator new(std::size_t _size)
+{
+  if (counting)
+    ++allocations;
+
+  void *ptr = std::malloc(_size ? _size : 1);
+  if (!ptr)
+    throw std::bad_alloc();
+  return ptr;
+}
+
+//////////////////////////////////////////////////
+void *operator new[](std::size_t _size)
+{
+  return ::operator new(_size);
+}
+
+//////////////////////////////////////////////////
+void *operator new(std::size_t _size, const std::nothrow_t &) noexcept
+{
+  if (counting)
+    ++allocations;
+
+  return std::malloc(_size ? _size : 1);
+}
+
+//////////////////////////////////////////////////
+void *operator new[](std::size_t _size, const std::nothrow_t &_tag) noexcept
+{
+  return ::operator new(_size, _tag);
+}
+
+//////////////////////////////////////////////////
+void operator delete(void *_ptr) noexcept
+{
+  std::free(_ptr);
+}
+
+//////////////////////////////////////////////////
+void operator delete[](void *_ptr) noexcept
+{
+  std::free(_ptr);
+}
+
+//////////////////////////////////////////////////
+void operator delete(void *_ptr, const std::nothrow_t &) noexcept
+{
+  std::free(_ptr);
+}
+
+//////////////////////////////////////////////////
+void operator delete[](void *_ptr, const std::nothrow_t &) noexcept
+{
+  std::free(_ptr);
+}
+
+/// \brief Number of times that each operation is measured.
+static const unsigned int Iterations = 100;
+
+/// \brief Number of times that each operation runs before measuring, so
+/// the caches and lazily created structures are in steady state.
+static const unsigned int WarmUp = 10;
+
+//////////////////////////////////////////////////
+/// \brief Measure the average number of heap allocations made by an
+/// operation in the calling thread.
+/// \param[in] _op Operation to be measured.
+/// \return Average number of allocations per execution.
+template<typename F> double allocationsPerOp(F _op)
+{
+  for (unsigned int i = 0; i < WarmUp; ++i)
+    _op();
+
+  allocations = 0;
+  counting = true;
+  for (unsigned int i = 0; i < Iterations; ++i)
+    _op();
+  counting = false;
+
+  return static_cast<double>(allocations) / Iterations;
+}
+
+// Allocation budgets per operation. They are the counts measured with
+// GCC 12, libstdc++ and protobuf 3.21 on Linux: lower them when an allocation
+// is removed, never raise them without a good reason. The checks allow
+// Margin extra allocations, because other toolchains and library versions
+// allocate a bit differently (e.g. the small string buffer of std::string
+// or the internal buffers of protobuf).
+
+/// \brief Extra allocations per operation allowed over each budget.
+static const double Margin = 1;
+
+/// \brief Publish() of a topic without subscribers.
+static const double PublishNoSubscribersBudget = 4;
+
+/// \brief Publish() to a subscriber in the same process.
+static const double PublishLocalBudget = 7;
+
+/// \brief Publish() to a raw subscriber in the same process.
+static const double PublishLocalRawBudget = 7;
+
+/// \brief Publisher<T>::Publish() of a topic without subscribers.
+static const double HandleNoSubscribersBudget = 0;
+
+/// \brief Publisher<T>::Publish() to a subscriber in the same process.
+static const double HandleLocalBudget = 3;
+
+/// \brief Reception of a message from another process by a typed
+/// subscriber.
+static const double ReceiveBudget = 11;
+
+/// \brief Reception of a message from another process by a typed
+/// subscriber that reuses its message.
+static const double ReceiveReuseBudget = 9;
+
+/// \brief Reception of a message from another process by a raw
+/// subscriber.
+static const double ReceiveRawBudget = 9;
+
+/// \brief Blocking Request() to a replier in the same process.
+static const double RequestBlockingBudget = 4;
+
+/// \brief Asynchronous Request() to a replier in the same process.
+static const double RequestCallbackBudget = 5;
+
+/// \brief Topic used in the tests. It is longer than the small string
+/// buffer of std::string, like most of the real topic names.
+std::string topic = "/allocations/regression/topic";
+
+/// \brief Service used in the tests.
+std::string service = "/allocations/regression/service";
+
+/// \brief Partition used in the tests.
+std::string partition;
+
+/// \brief Protects the reception measurement.
+std::mutex receptionMutex;
+
+/// \brief Notifies the end of the reception measurement.
+std::condition_variable receptionCondition;
+
+/// \brief Messages received from the other process.
+unsigned int received = 0;
+
+/// \brief Average number of allocations per message received, or a
+/// negative number while the measurement is running.
+double receptionAllocations = -1;
+
+//////////////////////////////////////////////////
+/// \brief Count the allocations made by the reception thread. It is called
+/// from the subscription callbacks, so it runs in the reception thread: the
+/// counting starts after WarmUp messages and stops after Iterations more.
+void measureReception()
+{
+  std::lock_guard<std::mutex> lk(receptionMutex);
+  ++received;
+  if (received == WarmUp)
+  {
+    allocations = 0;
+    counting = true;
+  }
+  else if (received == WarmUp + Iterations)
+  {
+    counting = false;
+    receptionAllocations = static_cast<double>(allocations) / Iterations;
+    receptionCondition.notify_all();
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Subscription callback.
+void onMsg(const std::string &/*_topic*/, const transport::msgs::Int &/*_msg*/)
+{
+}
+
+//////////////////////////////////////////////////
+/// \brief Raw subscription callback.
+void onRawMsg(const std::string &/*_topic*/, const char * /*_data*/,
+  const size_t /*_size*/, const transport::MessageInfo &/*_info*/)
+{
+}
+
+//////////////////////////////////////////////////
+/// \brief Subscription callback of the messages from another process.
+void onRemoteMsg(const std::string &/*_topic*/,
+  const transport::msgs::Int &/*_msg*/)
+{
+  measureReception();
+}
+
+//////////////////////////////////////////////////
+/// \brief Raw subscription callback of the messages from another process.
+void onRemoteRawMsg(const std::string &/*_topic*/, const char * /*_data*/,
+  const size_t /*_size*/, const transport::MessageInfo &/*_info*/)
+{
+  measureReception();
+}
+
+//////////////////////////////////////////////////
+/// \brief Service callback.
+void onRequest(const std::string &/*_topic*/,
+  const transport::msgs::Int &_req, transport::msgs::Int &_rep, bool &_result)
+{
+  _rep.set_data(_req.data());
+  _result = true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Service response callback.
+void onResponse(const std::string &/*_topic*/,
+  const transport::msgs::Int &/*_rep*/, const bool /*_result*/)
+{
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the harness counts the allocations.
+TEST(AllocationsTest, Harness)
+{
+  double count = allocationsPerOp([]
+    {
+      std::unique_ptr<int> ptr(new int(1));
+    });
+  EXPECT_DOUBLE_EQ(count, 1.0);
+
+  count = allocationsPerOp([]{});
+  EXPECT_DOUBLE_EQ(count, 0.0);
+}
+
+//////////////////////////////////////////////////
+/// \brief Publish without subscribers.
+TEST(AllocationsTest, PublishNoSubscribers)
+{
+  transport::Node node;
+  transport::msgs::Int msg;
+  msg.set_data(1);
+  std::string noSubsTopic = topic + "/none";
+  ASSERT_TRUE(node.Advertise(noSubsTopic));
+
+  double count = allocationsPerOp([&]
+    {
+      node.Publish(noSubsTopic, msg);
+    });
+  std::cout << "Publish (no subscribers): " << count << std::endl;
+  EXPECT_LE(count, PublishNoSubscribersBudget + Margin);
+}
+
+//////////////////////////////////////////////////
+/// \brief Publish to a subscriber in the same process.
+TEST(AllocationsTest, PublishLocalSubscriber)
+{
+  transport::Node node;
+  transport::msgs::Int msg;
+  msg.set_data(1);
+  ASSERT_TRUE(node.Advertise(topic));
+  ASSERT_TRUE(node.Subscribe(topic, onMsg));
+
+  double count = allocationsPerOp([&]
+    {
+      node.Publish(topic, msg);
+    });
+  std::cout << "Publish (local subscriber): " << count << std::endl;
+  EXPECT_LE(count, PublishLocalBudget + Margin);
+
+  ASSERT_TRUE(node.Unsubscribe(topic));
+  ASSERT_TRUE(node.SubscribeRaw(topic, onRawMsg));
+  count = allocationsPerOp([&]
+    {
+      node.Publish(topic, msg);
+    });
+  std::cout << "Publish (local raw subscriber): " << count << std::endl;
+  EXPECT_LE(count, PublishLocalRawBudget + Margin);
+}
+
+//////////////////////////////////////////////////
+/// \brief Publish through a publisher handle.
+TEST(AllocationsTest, PublishHandle)
+{
+  transport::Node node;
+  transport::msgs::Int msg;
+  msg.set_data(1);
+  std::string handleTopic = topic + "/handle";
+  auto pub = node.Advertise<transport::msgs::Int>(handleTopic);
+  ASSERT_TRUE(pub.Valid());
+
+  double count = allocationsPerOp([&]
+    {
+      pub.Publish(msg);
+    });
+  std::cout << "Publisher (no subscribers): " << count << std::endl;
+  EXPECT_LE(count, HandleNoSubscribersBudget + Margin);
+
+  ASSERT_TRUE(node.Subscribe(handleTopic, onMsg));
+  count = allocationsPerOp([&]
+    {
+      pub.Publish(msg);
+    });
+  std::cout << "Publisher (local subscriber): " << count << std::endl;
+  EXPECT_LE(count, HandleLocalBudget + Margin);
+}
+
+//////////////////////////////////////////////////
+/// \brief Receive the messages of a publisher in another process. The
+/// allocations are counted in the reception thread, from the reception of
+/// a message to the reception of the next one, so they include the work
+/// done by NodeShared before the subscription callback is executed.
+/// \param[in] _topic Topic to subscribe to.
+/// \param[in] _raw True to use a raw subscription.
+/// \param[in] _reuse True to reuse the messages of the subscription.
+/// \return Average number of allocations per message received, or a
+/// negative number if the messages were not received.
+double allocationsPerMsg(const std::string &_topic, const bool _raw,
+  const bool _reuse)
+{
+  {
+    std::lock_guard<std::mutex> lk(receptionMutex);
+    received = 0;
+    receptionAllocations = -1;
+  }
+
+  transport::Node node;
+  node.SetReuseMsgs(_reuse);
+  if (_raw)
+    EXPECT_TRUE(node.SubscribeRaw(_topic, onRemoteRawMsg));
+  else
+    EXPECT_TRUE(node.Subscribe(_topic, onRemoteMsg));
+
+  double count;
+  {
+    std::unique_lock<std::mutex> lk(receptionMutex);
+    receptionCondition.wait_for(lk, std::chrono::seconds(30),
+      []{return receptionAllocations >= 0;});
+    count = receptionAllocations;
+  }
+
+  EXPECT_TRUE(node.Unsubscribe(_topic));
+  return count;
+}
+
+//////////////////////////////////////////////////
+/// \brief Receive messages published by another process, as the reception
+/// thread does for every message received from other processes.
+TEST(AllocationsTest, ReceiveRemote)
+{
+  std::string publisherPath = testing::portablePathUnion(
+     PROJECT_BINARY_PATH,
+     "test/regression/REGRESSION_allocationsPublisher_aux");
+
+  testing::forkHandlerType pi = testing::forkAndRun(publisherPath.c_str(),
+    partition.c_str());
+
+  double count = allocationsPerMsg(topic + "/typed", false, false);
+  std::cout << "Receive (typed): " << count << std::endl;
+  EXPECT_GE(count, 0);
+  EXPECT_LE(count, ReceiveBudget + Margin);
+
+  count = allocationsPerMsg(topic + "/reused", false, true);
+  std::cout << "Receive (typed, reused): " << count << std::endl;
+  EXPECT_GE(count, 0);
+  EXPECT_LE(count, ReceiveReuseBudget + Margin);
+
+  count = allocationsPerMsg(topic + "/raw", true, false);
+  std::cout << "Receive (raw): " << count << std::endl;
+  EXPECT_GE(count, 0);
+  EXPECT_LE(count, ReceiveRawBudget + Margin);
+
+  testing::killFork(pi);
+}
+
+//////////////////////////////////////////////////
+/// \brief Service requests to a replier in the same process.
+TEST(AllocationsTest, RequestLocalReplier)
+{
+  transport::Node node;
+  transport::msgs::Int req;
+  transport::msgs::Int rep;
+  req.set_data(1);
+  bool result;
+  ASSERT_TRUE(node.Advertise(service, onRequest));
+
+  double count = allocationsPerOp([&]
+    {
+      node.Request(service, req, 1000, rep, result);
+    });
+  std::cout << "Request (blocking): " << count << std::endl;
+  EXPECT_LE(count, RequestBlockingBudget + Margin);
+
+  count = allocationsPerOp([&]
+    {
+      node.Request(service, req, onResponse);
+    });
+  std::cout << "Request (callback): " << count << std::endl;
+  EXPECT_LE(count, RequestCallbackBudget + Margin);
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  // Get a random partition name.
+  partition = testing::getRandomPartition();
+
+  // Set the partition name for this process.
+  setenv("IGN_PARTITION", partition.c_str(), 1);
+
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2015 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "ignition/transport/Node.hh"
+#include "ignition/transport/test_config.h"
+#include "msg/int.pb.h"
+
+using namespace ignition;
+
+/// \brief Prefix of the topics measured by the allocations test.
+std::string topic = "/allocations/regression/topic";
+
+//////////////////////////////////////////////////
+/// \brief Publish on the topics measured by the allocations test until the
+/// process is killed.
+void advertiseAndPublish()
+{
+  std::string typedTopic = topic + "/typed";
+  std::string reusedTopic = topic + "/reused";
+  std::string rawTopic = topic + "/raw";
+  transport::msgs::Int msg;
+  transport::Node node;
+  node.Advertise(typedTopic);
+  node.Advertise(reusedTopic);
+  node.Advertise(rawTopic);
+
+  for (int i = 0; i < 60000; ++i)
+  {
+    msg.set_data(i);
+    node.Publish(typedTopic, msg);
+    node.Publish(reusedTopic, msg);
+    node.Publish(rawTopic, msg);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  if (argc != 2)
+  {
+    std::cerr << "Partition name has not be passed as argument" << std::endl;
+    return -1;
+  }
+
+  // Set the partition name for this test.
+  setenv("IGN_PARTITION", argv[1], 1);
+
+  advertiseAndPublish();
+}